@@ -2,13 +2,21 @@
 
 #include <spdlog/spdlog.h>
 
+#include <format>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <utility>
 
 #include "module/capturer/common.hpp"
 #include "module/capturer/hikcamera.hpp"
 #include "module/capturer/local_video.hpp"
 #include "module/debug/framerate.hpp"
+#include "utility/image/image.details.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/publish/frame_bus.hpp"
 #include "utility/singleton/running.hpp"
+#include "utility/thread/execution.hpp"
 #include "utility/thread/spsc_queue.hpp"
 #include "utility/times_limit.hpp"
 
@@ -25,6 +33,34 @@ struct Capturer::Impl {
     std::chrono::milliseconds reconnect_wait_interval{500};
 
     util::spsc_queue<Image*, 10> capture_queue;
+
+    util::metrics::Counter& captured = util::metrics::registry().counter(
+        "pingpong_capture_frames_total", "Frames delivered by the camera");
+    util::metrics::Counter& dropped = util::metrics::registry().counter(
+        "pingpong_capture_dropped_total", "Frames dropped because the capture queue was full");
+    util::metrics::Counter& skipped = util::metrics::registry().counter(
+        "pingpong_capture_skipped_total", "Queued frames skipped for a newer one by the consumer");
+    util::metrics::Counter& failures = util::metrics::registry().counter(
+        "pingpong_capture_failures_total", "Failed waits for a camera frame");
+    util::metrics::Counter& reconnects = util::metrics::registry().counter(
+        "pingpong_capture_reconnects_total", "Attempts to reconnect the camera");
+    util::metrics::Gauge& queue_depth = util::metrics::registry().gauge(
+        "pingpong_capture_queue_depth", "Frames waiting in the capture queue");
+    util::metrics::Gauge& capture_fps = util::metrics::registry().rate(
+        "pingpong_capture_fps", "Frames delivered by the camera per second", captured);
+
+    // Raw frames for other processes, written by the capture thread
+    std::optional<util::FrameBusWriter> frame_bus;
+    std::uint64_t frame_bus_overwritten = 0;
+
+    util::metrics::Counter& bus_frames = util::metrics::registry().counter(
+        "pingpong_frame_bus_frames_total", "Frames written to the shared-memory frame bus");
+    util::metrics::Counter& bus_rejected = util::metrics::registry().counter(
+        "pingpong_frame_bus_rejected_total", "Frames larger than a frame bus slot");
+    util::metrics::Counter& bus_overwritten = util::metrics::registry().counter(
+        "pingpong_frame_bus_overwritten_total", "Frame bus slots reused while a reader held them");
+
+    std::mutex consumer_mutex;
     std::jthread runtime_thread;
 
     auto initialize(const YAML::Node& yaml) noexcept -> Result try {
@@ -70,6 +106,18 @@ struct Capturer::Impl {
         reconnect_wait_interval =
             std::chrono::milliseconds{yaml["reconnect_wait_interval"].as<int>()};
 
+        if (const auto bus = yaml["frame_bus"]; bus && bus["enable"].as<bool>()) {
+            const auto name     = bus["name"].as<std::string>();
+            const auto takeover = bus["takeover"] && bus["takeover"].as<bool>();
+            auto result = util::FrameBusWriter::open(name, bus["slots"].as<std::uint32_t>(),
+                                                     bus["slot_bytes"].as<std::size_t>(), takeover);
+            if (!result) {
+                return std::unexpected{std::format("Frame bus: {}", result.error())};
+            }
+            frame_bus.emplace(std::move(*result));
+            spdlog::info("Publishing camera frames to shared memory {}", name);
+        }
+
         runtime_thread = std::jthread{
             [this](const auto& t) { runtime_task(t); },
         };
@@ -87,24 +135,61 @@ struct Capturer::Impl {
     }
 
     auto fetch_image() noexcept -> ImageUnique {
-        auto raw = RawImage{nullptr};
+        auto raw  = RawImage{nullptr};
+        auto lock = std::scoped_lock{consumer_mutex};
         capture_queue.pop(raw);
         return std::unique_ptr<Image>{raw};
     }
 
+    auto fetch_latest() noexcept -> ImageUnique {
+        auto newest = ImageUnique{};
+        auto raw    = RawImage{nullptr};
+        auto lock   = std::scoped_lock{consumer_mutex};
+        while (capture_queue.pop(raw)) {
+            if (newest) {
+                skipped.add();
+            }
+            newest.reset(raw);
+        }
+        return newest;
+    }
+
+    auto publish_to_bus(const Image& image) noexcept -> void {
+        if (!frame_bus->publish(image.details().get_mat(), image.get_timestamp())) {
+            bus_rejected.add();
+            return;
+        }
+        bus_frames.add();
+
+        const auto overwritten = frame_bus->overwritten();
+        bus_overwritten.add(overwritten - std::exchange(frame_bus_overwritten, overwritten));
+    }
+
     auto runtime_task(const std::stop_token& token) noexcept -> void {
+        util::execution().apply("capturer");
         spdlog::info("[Capturer runtime thread] starts");
 
         // Success context
         auto success_callback = [&](std::unique_ptr<Image> image) {
+            captured.add();
+            if (frame_bus) {
+                publish_to_bus(*image);
+            }
+
             auto newest = image.release();
             if (!capture_queue.push(newest)) {
+                dropped.add();
+
                 // Failed to push, drop the oldest one
                 //   or else delete the newest one
+                // Popping here makes the producer a second consumer
+                auto lock   = std::scoped_lock{consumer_mutex};
                 auto oldest = RawImage{nullptr};
                 if (capture_queue.pop(oldest)) [[likely]] {
                     auto guard = std::unique_ptr<Image>(oldest);
-                    assert(capture_queue.push(newest) && "Failed to push after pop");
+                    // Kept outside assert() so release builds still push
+                    [[maybe_unused]] const auto pushed = capture_queue.push(newest);
+                    assert(pushed && "Failed to push after pop");
                 } else [[unlikely]] {
                     auto guard = std::unique_ptr<Image>(newest);
                     spdlog::error("Pop failed when images queue is full");
@@ -117,12 +202,14 @@ struct Capturer::Impl {
                     }
                 }
             }
+            queue_depth.set(static_cast<double>(capture_queue.read_available()));
         };
 
         // Failed context
         auto capture_failed_limit = util::TimesLimit{3};
 
         auto failed_callback = [&](const std::string& msg) {
+            failures.add();
             if (capture_failed_limit.tick() == false) {
                 interface->disconnect();
 
@@ -139,6 +226,7 @@ struct Capturer::Impl {
         auto error_limit = util::TimesLimit{3};
 
         auto reconnect = [&] {
+            reconnects.add();
             if (auto result = interface->connect()) {
                 spdlog::info("Connect to capturer successfully");
                 error_limit.reset();
@@ -185,6 +273,10 @@ auto Capturer::fetch_image() noexcept -> ImageUnique {
     return pimpl_->fetch_image();
 }
 
+auto Capturer::fetch_latest() noexcept -> ImageUnique {
+    return pimpl_->fetch_latest();
+}
+
 Capturer::Capturer() noexcept : pimpl_{std::make_unique<Impl>()} {
 }
 
@@ -1,10 +1,14 @@
 #pragma once
 #include <yaml-cpp/yaml.h>
 
+#include <chrono>
+#include <coroutine>
 #include <expected>
 
+#include "utility/coroutine/executor.hpp"
 #include "utility/image/image.hpp"
 #include "utility/pimpl.hpp"
+#include "utility/singleton/running.hpp"
 
 namespace pingpong_tracker::kernel {
 
@@ -25,10 +29,63 @@ public:
     ///   Fetches an image from the background worker thread.
     /// @note
     ///   - Non-blocking: returns immediately with either a valid image or nullptr.
-    ///   - Thread-safe: safe to call from multiple threads, but only one thread
-    ///     should fetch at a time.
+    ///   - Thread-safe: concurrent consumers are serialized internally.
     auto fetch_image() noexcept -> ImageUnique;
 
+    /// @brief
+    ///   Fetches the newest queued image and drops the older ones.
+    /// @note
+    ///   - Non-blocking like `fetch_image`, dropped frames count into
+    ///     `pingpong_capture_skipped_total`.
+    ///   - For consumers that only care about the present, so a slow consumer never works
+    ///     through a backlog.
+    auto fetch_latest() noexcept -> ImageUnique;
+
+    /// @brief
+    ///   Awaitable fetch, the continuation resumes on `executor` once a frame is available.
+    /// @note
+    ///   - Takes the newest frame through `fetch_latest`, older queued frames are dropped.
+    ///   - Polls the capture queue every `poll_interval` through the executor's timers, which
+    ///     mirrors the 1ms sleep of the serial loop without blocking a worker.
+    ///   - Resumes with nullptr when the global running flag is cleared.
+    struct ImageAwaiter : util::Executor::Operation {
+        Capturer& capturer;
+        util::Executor& executor;
+        std::chrono::milliseconds poll_interval;
+        std::coroutine_handle<> continuation{};
+        ImageUnique image{};
+
+        auto await_ready() noexcept -> bool {
+            // Already on the requested executor, skip the round trip when a frame is waiting
+            if (executor.in_this_thread()) {
+                image = capturer.fetch_latest();
+            }
+            return image != nullptr;
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> void {
+            continuation = awaiting;
+            function     = [](Operation* self) noexcept {
+                auto* awaiter  = static_cast<ImageAwaiter*>(self);
+                awaiter->image = awaiter->capturer.fetch_latest();
+                if (awaiter->image || !util::get_running()) {
+                    awaiter->continuation.resume();
+                    return;
+                }
+                awaiter->executor.post_at(self, util::Clock::now() + awaiter->poll_interval);
+            };
+            executor.post(this);
+        }
+        auto await_resume() noexcept -> ImageUnique {
+            return std::move(image);
+        }
+    };
+
+    [[nodiscard]] auto await_image(util::Executor& executor,
+                                   std::chrono::milliseconds poll_interval =
+                                       std::chrono::milliseconds{1}) noexcept -> ImageAwaiter {
+        return ImageAwaiter{{}, *this, executor, poll_interval};
+    }
+
     static constexpr auto get_prefix() noexcept {
         return "capturer";
     }
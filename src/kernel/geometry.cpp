@@ -0,0 +1,322 @@
+#include "geometry.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <optional>
+
+#include "module/geometry/camera_model.hpp"
+#include "module/geometry/monocular.hpp"
+#include "module/geometry/stereo.hpp"
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::kernel {
+
+struct Geometry::Impl {
+    struct CameraConfig : util::SerializableMixin {
+        double fx = 0.0;
+        double fy = 0.0;
+        double cx = 0.0;
+        double cy = 0.0;
+        // k1, k2, p1, p2, k3
+        std::vector<double> distortion{};
+        // World (table frame) to camera, row-major 3x3
+        std::vector<double> rotation{};
+        // World to camera, metres
+        std::vector<double> translation{};
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "fx",                       &CameraConfig::fx,
+            "fy",                       &CameraConfig::fy,
+            "cx",                       &CameraConfig::cx,
+            "cy",                       &CameraConfig::cy,
+            "distortion",               &CameraConfig::distortion,
+            "rotation",                 &CameraConfig::rotation,
+            "translation",              &CameraConfig::translation,
+            // clang-format on
+        };
+
+        auto make_intrinsics() const
+            -> std::expected<geometry::CameraModel::Intrinsics, std::string> {
+            if (distortion.size() != 5) {
+                return std::unexpected{"Camera distortion must have 5 coefficients"};
+            }
+
+            auto intrinsics = geometry::CameraModel::Intrinsics{
+                .fx = fx,
+                .fy = fy,
+                .cx = cx,
+                .cy = cy,
+            };
+            std::ranges::copy(distortion, intrinsics.distortion.begin());
+            return intrinsics;
+        }
+
+        auto make_camera() const -> std::expected<geometry::CameraModel, std::string> {
+            auto intrinsics = make_intrinsics();
+            if (!intrinsics.has_value()) {
+                return std::unexpected{intrinsics.error()};
+            }
+            if (rotation.size() != 9 || translation.size() != 3) {
+                return std::unexpected{"Camera rotation must be 3x3 and translation 3"};
+            }
+
+            auto pose = geometry::CameraModel::Pose{};
+            for (int i = 0; i < 9; ++i) {
+                pose.rotation(i / 3, i % 3) = rotation[static_cast<std::size_t>(i)];
+            }
+            pose.translation = {translation[0], translation[1], translation[2]};
+
+            return geometry::CameraModel{*intrinsics, pose};
+        }
+    };
+
+    struct StereoConfig : util::SerializableMixin {
+        double pixel_noise    = 1.0;
+        double gate_threshold = 9.0;
+        double min_depth      = 0.1;
+        int greedy_limit      = 4;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "pixel_noise",              &StereoConfig::pixel_noise,
+            "gate_threshold",           &StereoConfig::gate_threshold,
+            "min_depth",                &StereoConfig::min_depth,
+            "greedy_limit",             &StereoConfig::greedy_limit,
+            // clang-format on
+        };
+    };
+
+    struct MonocularConfig : util::SerializableMixin {
+        // Which entry of `cameras` to use, its rotation and translation are ignored
+        std::string camera{"left"};
+        // Pixels of the table corners, see `MonocularLocator::estimate_pose` for the order
+        std::vector<double> table_corners{};
+        double pixel_noise  = 1.0;
+        double radius_noise = 0.5;
+        int lut_step        = 4;
+        int image_cols      = 1440;
+        int image_rows      = 1080;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "camera",                   &MonocularConfig::camera,
+            "table_corners",            &MonocularConfig::table_corners,
+            "pixel_noise",              &MonocularConfig::pixel_noise,
+            "radius_noise",             &MonocularConfig::radius_noise,
+            "lut_step",                 &MonocularConfig::lut_step,
+            "image_cols",               &MonocularConfig::image_cols,
+            "image_rows",               &MonocularConfig::image_rows,
+            // clang-format on
+        };
+    };
+
+    struct TableConfig : util::SerializableMixin {
+        double length        = 2.74;
+        double width         = 1.525;
+        double ball_diameter = 0.04;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "length",                   &TableConfig::length,
+            "width",                    &TableConfig::width,
+            "ball_diameter",            &TableConfig::ball_diameter,
+            // clang-format on
+        };
+    };
+
+    mutable std::mutex mutex;
+    std::optional<geometry::StereoTriangulator> stereo;
+    std::optional<geometry::MonocularLocator> monocular;
+
+    std::vector<geometry::StereoTriangulator::Vec2> left_pixels;
+    std::vector<geometry::StereoTriangulator::Vec2> right_pixels;
+    std::vector<geometry::StereoTriangulator::Point> points;
+
+    static auto load_camera(const YAML::Node& yaml)
+        -> std::expected<geometry::CameraModel, std::string> {
+        auto config = CameraConfig{};
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        return config.make_camera();
+    }
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> try {
+        const auto mode = yaml["mode"].as<std::string>();
+        if (mode == "none") {
+            return {};
+        }
+        if (mode == "monocular") {
+            return initialize_monocular(yaml);
+        }
+        if (mode != "stereo") {
+            return std::unexpected{"Unknown geometry mode: " + mode};
+        }
+
+        auto left = load_camera(yaml["cameras"]["left"]);
+        if (!left.has_value()) {
+            return std::unexpected{"Left camera: " + left.error()};
+        }
+        auto right = load_camera(yaml["cameras"]["right"]);
+        if (!right.has_value()) {
+            return std::unexpected{"Right camera: " + right.error()};
+        }
+
+        auto config = StereoConfig{};
+        if (auto result = config.serialize(yaml["stereo"]); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+
+        auto stereo_config           = geometry::StereoTriangulator::Config{};
+        stereo_config.pixel_noise    = config.pixel_noise;
+        stereo_config.gate_threshold = config.gate_threshold;
+        stereo_config.min_depth      = config.min_depth;
+        stereo_config.greedy_limit   = static_cast<std::size_t>(std::max(config.greedy_limit, 0));
+
+        auto lock = std::scoped_lock{mutex};
+        stereo.emplace(std::move(*left), std::move(*right), stereo_config);
+        return {};
+
+    } catch (const std::exception& e) {
+        return std::unexpected{e.what()};
+    }
+
+    auto initialize_monocular(const YAML::Node& yaml) -> std::expected<void, std::string> {
+        auto config = MonocularConfig{};
+        if (auto result = config.serialize(yaml["monocular"]); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        auto table = TableConfig{};
+        if (auto result = table.serialize(yaml["table"]); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        if (config.table_corners.size() != 8) {
+            return std::unexpected{"Monocular table_corners must hold 4 pixels"};
+        }
+
+        auto camera = CameraConfig{};
+        if (auto result = camera.serialize(yaml["cameras"][config.camera]); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        auto intrinsics = camera.make_intrinsics();
+        if (!intrinsics.has_value()) {
+            return std::unexpected{intrinsics.error()};
+        }
+
+        auto corners = std::array<geometry::MonocularLocator::Vec2, 4>{};
+        for (std::size_t i = 0; i < 4; ++i) {
+            corners[i] = {config.table_corners[2 * i], config.table_corners[2 * i + 1]};
+        }
+
+        // Once at startup, the camera is assumed fixed relative to the table
+        auto pose = geometry::MonocularLocator::estimate_pose(*intrinsics, corners, table.length,
+                                                              table.width);
+        if (!pose.has_value()) {
+            return std::unexpected{pose.error()};
+        }
+
+        auto locator_config          = geometry::MonocularLocator::Config{};
+        locator_config.ball_diameter = table.ball_diameter;
+        locator_config.pixel_noise   = config.pixel_noise;
+        locator_config.radius_noise  = config.radius_noise;
+        locator_config.lut_step      = config.lut_step;
+        locator_config.image_cols    = config.image_cols;
+        locator_config.image_rows    = config.image_rows;
+
+        auto lock = std::scoped_lock{mutex};
+        monocular.emplace(geometry::CameraModel{*intrinsics, *pose}, locator_config);
+        return {};
+    }
+
+    auto initialized() const noexcept -> bool {
+        auto lock = std::scoped_lock{mutex};
+        return stereo.has_value() || monocular.has_value();
+    }
+
+    auto locate(const std::vector<Ball2D>& balls) noexcept -> std::vector<Ball3D> {
+        auto lock = std::scoped_lock{mutex};
+        if (!monocular) {
+            return {};
+        }
+
+        auto result = std::vector<Ball3D>{};
+        result.reserve(balls.size());
+        for (const auto& ball : balls) {
+            const auto pixel    = geometry::MonocularLocator::Vec2{ball.center.x, ball.center.y};
+            const auto estimate = monocular->locate(pixel, ball.radius);
+            if (!estimate) {
+                continue;
+            }
+            result.push_back(make_ball(estimate->position, estimate->covariance, ball.confidence));
+        }
+        return result;
+    }
+
+    static auto make_ball(const Eigen::Vector3d& position, const Eigen::Matrix3d& covariance,
+                          float confidence) noexcept -> Ball3D {
+        auto ball   = Ball3D{};
+        ball.center = {static_cast<float>(position.x()), static_cast<float>(position.y()),
+                       static_cast<float>(position.z())};
+        for (int i = 0; i < 9; ++i) {
+            ball.covariance.val[i] = static_cast<float>(covariance(i / 3, i % 3));
+        }
+        ball.confidence = confidence;
+        return ball;
+    }
+
+    auto triangulate(const std::vector<Ball2D>& left, const std::vector<Ball2D>& right) noexcept
+        -> std::vector<Ball3D> {
+        auto lock = std::scoped_lock{mutex};
+        if (!stereo) {
+            return {};
+        }
+
+        left_pixels.clear();
+        for (const auto& ball : left) {
+            left_pixels.emplace_back(ball.center.x, ball.center.y);
+        }
+        right_pixels.clear();
+        for (const auto& ball : right) {
+            right_pixels.emplace_back(ball.center.x, ball.center.y);
+        }
+
+        stereo->match(left_pixels, right_pixels, points);
+
+        auto result = std::vector<Ball3D>{};
+        result.reserve(points.size());
+        for (const auto& point : points) {
+            const auto confidence =
+                std::min(left[point.left].confidence, right[point.right].confidence);
+            result.push_back(make_ball(point.position, point.covariance, confidence));
+        }
+        return result;
+    }
+};
+
+Geometry::Geometry() : pimpl_{std::make_unique<Impl>()} {
+}
+
+Geometry::~Geometry() noexcept                     = default;
+Geometry::Geometry(Geometry&&) noexcept            = default;
+Geometry& Geometry::operator=(Geometry&&) noexcept = default;
+
+auto Geometry::initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+auto Geometry::initialized() const noexcept -> bool {
+    return pimpl_->initialized();
+}
+
+auto Geometry::locate(const std::vector<Ball2D>& balls) noexcept -> std::vector<Ball3D> {
+    return pimpl_->locate(balls);
+}
+
+auto Geometry::triangulate(const std::vector<Ball2D>& left,
+                           const std::vector<Ball2D>& right) noexcept -> std::vector<Ball3D> {
+    return pimpl_->triangulate(left, right);
+}
+
+}  // namespace pingpong_tracker::kernel
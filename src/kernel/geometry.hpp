@@ -0,0 +1,36 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+class Geometry {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Geometry)
+
+public:
+    Geometry();
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto initialized() const noexcept -> bool;
+
+    /// @brief
+    ///   Estimates the 3D position of every detection of a single camera.
+    /// @note
+    ///   - Needs `mode: monocular`, returns nothing otherwise.
+    auto locate(const std::vector<Ball2D>&) noexcept -> std::vector<Ball3D>;
+
+    /// @brief
+    ///   Matches detections of a synchronised camera pair and triangulates them.
+    /// @note
+    ///   - Needs `mode: stereo`, returns nothing otherwise.
+    auto triangulate(const std::vector<Ball2D>& left, const std::vector<Ball2D>& right) noexcept
+        -> std::vector<Ball3D>;
+};
+
+}  // namespace pingpong_tracker::kernel
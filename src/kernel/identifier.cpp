@@ -15,6 +15,11 @@ struct Identifier::Impl {
     auto identify(const Image& src) noexcept -> std::expected<std::vector<Ball2D>, std::string> {
         return ball_detection.sync_detect(src);
     }
+
+    auto await_identify(const Image& src, util::Executor& executor) noexcept
+        -> identifier::BallDetection::DetectAwaiter {
+        return ball_detection.await_detect(src, executor);
+    }
 };
 
 Identifier::Identifier() : pimpl_{std::make_unique<Impl>()} {
@@ -33,4 +38,9 @@ auto Identifier::sync_identify(const Image& src) noexcept
     return pimpl_->identify(src);
 }
 
+auto Identifier::await_identify(const Image& src, util::Executor& executor) noexcept
+    -> identifier::BallDetection::DetectAwaiter {
+    return pimpl_->await_identify(src, executor);
+}
+
 }  // namespace pingpong_tracker::kernel
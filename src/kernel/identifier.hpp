@@ -5,7 +5,9 @@
 #include <expected>
 #include <vector>
 
+#include "module/identifier/ball_detection.hpp"
 #include "utility/ball/ball.hpp"
+#include "utility/coroutine/executor.hpp"
 #include "utility/image/image.hpp"
 #include "utility/pimpl.hpp"
 
@@ -19,6 +21,10 @@ public:
     auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
 
     auto sync_identify(const Image&) noexcept -> std::expected<std::vector<Ball2D>, std::string>;
+
+    /// @brief Asynchronous identify, `co_await` resumes on `executor` with the detections
+    [[nodiscard]] auto await_identify(const Image&, util::Executor&) noexcept
+        -> identifier::BallDetection::DetectAwaiter;
 };
 
 }  // namespace pingpong_tracker::kernel
@@ -0,0 +1,223 @@
+#include "metrics.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <thread>
+
+#include "utility/clock.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/posix.hpp"
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::kernel {
+
+namespace {
+
+using util::FileDescriptor;
+
+auto send_all(int fd, std::string_view data) noexcept -> void {
+    while (!data.empty()) {
+        const auto sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data.remove_prefix(static_cast<std::size_t>(sent));
+    }
+}
+
+}  // namespace
+
+struct MetricsExporter::Impl {
+    struct Config : util::SerializableMixin {
+        std::string host = "127.0.0.1";
+        // Zero disables the HTTP endpoint
+        int port = 9464;
+        // Written when the HTTP endpoint is not serving
+        std::string dump_path = "/tmp/pingpong_tracker.prom";
+        // seconds
+        double dump_interval = 5.0;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "host",                     &Config::host,
+            "port",                     &Config::port,
+            "dump_path",                &Config::dump_path,
+            "dump_interval",            &Config::dump_interval,
+            // clang-format on
+        };
+    };
+
+    static constexpr auto kPollInterval = std::chrono::milliseconds{200};
+
+    Config config;
+    FileDescriptor listener;
+    std::jthread thread;
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        if (config.port < 0 || config.port > 65535) {
+            return std::unexpected{std::format("Invalid metrics port {}", config.port)};
+        }
+
+        if (config.port != 0) {
+            if (auto result = listen(); result.has_value()) {
+                spdlog::info("Metrics are served at http://{}:{}/metrics", config.host,
+                             config.port);
+            } else {
+                spdlog::warn("Metrics endpoint unavailable, {}", result.error());
+            }
+        }
+        if (listener.fd < 0) {
+            if (config.dump_path.empty()) {
+                return std::unexpected{"Metrics need either a port or a dump_path"};
+            }
+            spdlog::info("Metrics are written to {}", config.dump_path);
+        }
+
+        thread = std::jthread{[this](const std::stop_token& token) { serve(token); }};
+        return {};
+    }
+
+    auto listen() noexcept -> std::expected<void, std::string> {
+        auto socket = FileDescriptor{::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        if (socket.fd < 0) {
+            return std::unexpected{std::format("socket: {}", std::strerror(errno))};
+        }
+        const auto reuse = 1;
+        ::setsockopt(socket.fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        auto address       = sockaddr_in{};
+        address.sin_family = AF_INET;
+        address.sin_port   = htons(static_cast<std::uint16_t>(config.port));
+        if (::inet_pton(AF_INET, config.host.c_str(), &address.sin_addr) != 1) {
+            return std::unexpected{std::format("invalid host '{}'", config.host)};
+        }
+        if (::bind(socket.fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            return std::unexpected{
+                std::format("bind {}:{}: {}", config.host, config.port, std::strerror(errno))};
+        }
+        if (::listen(socket.fd, 8) != 0) {
+            return std::unexpected{std::format("listen: {}", std::strerror(errno))};
+        }
+        listener = std::move(socket);
+        return {};
+    }
+
+    auto serve(const std::stop_token& token) noexcept -> void {
+        auto& registry = util::metrics::registry();
+
+        const auto dump_interval = std::chrono::duration_cast<util::Clock::duration>(
+            std::chrono::duration<double>{config.dump_interval});
+        auto dumped = util::Clock::now();
+
+        while (!token.stop_requested()) {
+            registry.update_rates();
+
+            if (listener.fd < 0) {
+                std::this_thread::sleep_for(kPollInterval);
+                if (util::Clock::now() - dumped >= dump_interval) {
+                    dump(registry.render());
+                    dumped = util::Clock::now();
+                }
+                continue;
+            }
+
+            auto poll_fd = pollfd{.fd = listener.fd, .events = POLLIN, .revents = 0};
+            const auto ready =
+                ::poll(&poll_fd, 1, static_cast<int>(kPollInterval.count()));
+            if (ready > 0 && (poll_fd.revents & POLLIN) != 0) {
+                answer(FileDescriptor{::accept4(listener.fd, nullptr, nullptr, SOCK_CLOEXEC)});
+            }
+        }
+
+        if (listener.fd < 0) {
+            dump(registry.render());
+        }
+    }
+
+    static auto answer(FileDescriptor client) noexcept -> void {
+        if (client.fd < 0) {
+            return;
+        }
+        // A scraper that stalls must not hold the loop for long
+        const auto timeout = timeval{.tv_sec = 0, .tv_usec = 500'000};
+        ::setsockopt(client.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        auto request = std::string{};
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            const auto received = ::recv(client.fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            request.append(buffer, static_cast<std::size_t>(received));
+        }
+
+        const auto line = std::string_view{request}.substr(0, request.find("\r\n"));
+        const auto path = line.starts_with("GET ") ? line.substr(4, line.find(' ', 4) - 4)
+                                                   : std::string_view{};
+
+        if (path == "/metrics" || path.starts_with("/metrics?")) {
+            const auto body = util::metrics::registry().render();
+            send_all(client.fd, std::format("HTTP/1.1 200 OK\r\n"
+                                            "Content-Type: text/plain; version=0.0.4\r\n"
+                                            "Content-Length: {}\r\n"
+                                            "Connection: close\r\n\r\n",
+                                            body.size()));
+            send_all(client.fd, body);
+        } else {
+            constexpr auto kNotFound = std::string_view{"HTTP/1.1 404 Not Found\r\n"
+                                                        "Content-Length: 0\r\n"
+                                                        "Connection: close\r\n\r\n"};
+            send_all(client.fd, kNotFound);
+        }
+    }
+
+    auto dump(const std::string& text) const noexcept -> void {
+        // Written aside and renamed, a reader never sees a partial file
+        const auto temporary = config.dump_path + ".tmp";
+        {
+            auto file = std::ofstream{temporary, std::ios::trunc};
+            if (!file || !(file << text)) {
+                spdlog::warn("Failed to write metrics to {}", temporary);
+                return;
+            }
+        }
+        auto error = std::error_code{};
+        std::filesystem::rename(temporary, config.dump_path, error);
+        if (error) {
+            spdlog::warn("Failed to replace {}: {}", config.dump_path, error.message());
+        }
+    }
+};
+
+MetricsExporter::MetricsExporter() : pimpl_{std::make_unique<Impl>()} {
+}
+
+MetricsExporter::~MetricsExporter() noexcept                            = default;
+MetricsExporter::MetricsExporter(MetricsExporter&&) noexcept            = default;
+MetricsExporter& MetricsExporter::operator=(MetricsExporter&&) noexcept = default;
+
+auto MetricsExporter::initialize(const YAML::Node& yaml) noexcept
+    -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <string>
+
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+/// @brief
+///   Serves the process-wide metrics registry, see `util::metrics::registry()`.
+/// @note
+///   - `GET /metrics` on a local HTTP port answers in the Prometheus text format.
+///   - Without a port, or when it cannot be bound, the same text is written to a file instead,
+///     replaced atomically every `dump_interval`.
+///   - The serving thread also refreshes the rate gauges, such as fps.
+class MetricsExporter {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(MetricsExporter)
+
+public:
+    MetricsExporter();
+
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    static constexpr auto get_prefix() noexcept {
+        return "metrics";
+    }
+};
+
+}  // namespace pingpong_tracker::kernel
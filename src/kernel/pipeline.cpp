@@ -0,0 +1,324 @@
+#include "pipeline.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <format>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+#include "utility/metrics/metrics.hpp"
+#include "utility/serializable.hpp"
+#include "utility/singleton/running.hpp"
+#include "utility/thread/execution.hpp"
+#include "utility/thread/staged_pipeline.hpp"
+
+namespace pingpong_tracker::kernel {
+
+struct Pipeline::Impl {
+    using Stages = util::StagedPipeline<Frame>;
+
+    struct Config : util::SerializableMixin {
+        // seconds
+        double report_interval = 5.0;
+        // milliseconds, the first stage waits this long when no frame is available
+        double idle_backoff = 1.0;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "report_interval",          &Config::report_interval,
+            "idle_backoff",             &Config::idle_backoff,
+            // clang-format on
+        };
+    };
+
+    struct StageConfig : util::SerializableMixin {
+        std::string name;
+        std::vector<std::string> steps;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "name",                     &StageConfig::name,
+            "steps",                    &StageConfig::steps,
+            // clang-format on
+        };
+    };
+
+    // In front of every stage but the first
+    struct QueueConfig : util::SerializableMixin {
+        int queue = 4;
+        // "block" or "drop"
+        std::string backpressure = "block";
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "queue",                    &QueueConfig::queue,
+            "backpressure",             &QueueConfig::backpressure,
+            // clang-format on
+        };
+    };
+
+    // Optional, for stages with a latency budget
+    struct DeadlineConfig : util::SerializableMixin {
+        // milliseconds since capture
+        double budget = 0.0;
+        // "drop" or "degrade", what happens to frames over budget
+        std::string late = "drop";
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "budget",                   &DeadlineConfig::budget,
+            "late",                     &DeadlineConfig::late,
+            // clang-format on
+        };
+    };
+
+    std::unordered_map<std::string, Step> steps;
+
+    Config config;
+    std::optional<Stages> stages;
+
+    struct StageGauges {
+        util::metrics::Gauge* depth;
+        util::metrics::Gauge* limit;
+        util::metrics::Counter* processed;
+        util::metrics::Counter* dropped;
+        util::metrics::Counter* late;
+        util::metrics::Counter* degraded;
+    };
+    std::vector<StageGauges> stage_gauges;
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+
+        const auto& stages_yaml = yaml["stages"];
+        if (!stages_yaml || !stages_yaml.IsSequence() || stages_yaml.size() == 0) {
+            return std::unexpected{"Pipeline needs a non-empty 'stages' list"};
+        }
+
+        auto stage_configs = std::vector<Stages::StageConfig>{};
+        for (std::size_t i = 0; i < stages_yaml.size(); ++i) {
+            const auto& stage_yaml = stages_yaml[i];
+
+            auto stage = StageConfig{};
+            if (auto result = stage.serialize(stage_yaml); !result.has_value()) {
+                return std::unexpected{std::format("Stage {}: {}", i, result.error())};
+            }
+            if (stage.steps.empty()) {
+                return std::unexpected{std::format("Stage '{}' has no steps", stage.name)};
+            }
+
+            auto& stage_config    = stage_configs.emplace_back();
+            stage_config.name     = stage.name;
+            stage_config.on_start = [name = stage.name] { util::execution().apply(name); };
+            if (auto result = resolve(stage.name, stage.steps, stage_config.steps); !result) {
+                return std::unexpected{result.error()};
+            }
+
+            if (i == 0) {
+                continue;
+            }
+            auto queue = QueueConfig{};
+            if (auto result = queue.serialize(stage_yaml); !result.has_value()) {
+                return std::unexpected{std::format("Stage '{}': {}", stage.name, result.error())};
+            }
+            if (queue.queue < 1) {
+                return std::unexpected{std::format("Stage '{}' queue must be positive", stage.name)};
+            }
+            if (queue.backpressure != "block" && queue.backpressure != "drop") {
+                return std::unexpected{std::format(
+                    "Stage '{}' backpressure must be 'block' or 'drop'", stage.name)};
+            }
+            stage_config.capacity     = static_cast<std::size_t>(queue.queue);
+            stage_config.backpressure = queue.backpressure == "drop" ? util::Backpressure::DROP
+                                                                     : util::Backpressure::BLOCK;
+
+            if (!stage_yaml["budget"]) {
+                continue;
+            }
+            auto deadline = DeadlineConfig{};
+            if (auto result = deadline.serialize(stage_yaml); !result.has_value()) {
+                return std::unexpected{std::format("Stage '{}': {}", stage.name, result.error())};
+            }
+            if (deadline.budget < 0.0) {
+                return std::unexpected{std::format("Stage '{}' budget is negative", stage.name)};
+            }
+            if (deadline.late != "drop" && deadline.late != "degrade") {
+                return std::unexpected{
+                    std::format("Stage '{}' late must be 'drop' or 'degrade'", stage.name)};
+            }
+            stage_config.budget = std::chrono::duration_cast<util::Clock::duration>(
+                std::chrono::duration<double, std::milli>{deadline.budget});
+            if (deadline.late == "drop") {
+                continue;
+            }
+
+            // The cheaper path marks the frame first, later stages see it skipped work
+            stage_config.late = util::LatePolicy::DEGRADE;
+            stage_config.late_steps.emplace_back([](Frame& frame) {
+                frame.late = true;
+                return true;
+            });
+            const auto& late_steps = stage_yaml["late_steps"];
+            if (!late_steps || !late_steps.IsSequence()) {
+                return std::unexpected{
+                    std::format("Stage '{}' degrades late frames but has no 'late_steps' list",
+                                stage.name)};
+            }
+            auto names = std::vector<std::string>{};
+            try {
+                names = late_steps.as<std::vector<std::string>>();
+            } catch (const std::exception& e) {
+                return std::unexpected{
+                    std::format("Stage '{}' late_steps: {}", stage.name, e.what())};
+            }
+            if (auto result = resolve(stage.name, names, stage_config.late_steps); !result) {
+                return std::unexpected{result.error()};
+            }
+        }
+
+        const auto idle = std::chrono::duration_cast<util::Clock::duration>(
+            std::chrono::duration<double, std::milli>{config.idle_backoff});
+        auto& registry = util::metrics::registry();
+        stage_gauges.clear();
+        for (auto& stage : stage_configs) {
+            const auto labels = util::metrics::Registry::Labels{{"stage", stage.name}};
+            stage_gauges.push_back(StageGauges{
+                .depth     = &registry.gauge("pingpong_stage_queue_depth",
+                                             "Frames waiting in front of the stage", labels),
+                .limit     = &registry.gauge("pingpong_stage_queue_limit",
+                                             "Depth the stage's queue is held to", labels),
+                .processed = &registry.counter("pingpong_stage_processed_total",
+                                               "Frames through every step of the stage", labels),
+                .dropped   = &registry.counter("pingpong_stage_dropped_total",
+                                               "Frames dropped in front of the stage", labels),
+                .late      = &registry.counter("pingpong_stage_late_total",
+                                               "Frames over the stage's budget and dropped",
+                                               labels),
+                .degraded  = &registry.counter("pingpong_stage_degraded_total",
+                                               "Frames over the stage's budget and degraded",
+                                               labels),
+            });
+
+            if (stage.budget <= util::Clock::duration::zero()) {
+                continue;
+            }
+            auto& age = registry.histogram("pingpong_stage_frame_age_seconds",
+                                           "Frame age since capture when the stage picks it up",
+                                           util::metrics::Histogram::latency_bounds(), labels);
+            stage.observe_age = [&age](util::Clock::duration value) { age.observe(value); };
+        }
+
+        const auto captured_at = [](const Frame& frame) {
+            return frame.image ? frame.image->get_timestamp() : util::Clock::time_point{};
+        };
+        stages.emplace(std::move(stage_configs), idle, captured_at);
+        return {};
+    }
+
+    auto resolve(const std::string& stage, const std::vector<std::string>& names,
+                 std::vector<Stages::Step>& resolved) const -> std::expected<void, std::string> {
+        for (const auto& name : names) {
+            const auto step = steps.find(name);
+            if (step == steps.end()) {
+                return std::unexpected{
+                    std::format("Stage '{}' uses unknown step '{}'", stage, name)};
+            }
+            resolved.push_back(step->second);
+        }
+        return {};
+    }
+
+    auto run() noexcept -> void {
+        if (!stages) {
+            spdlog::error("Pipeline is not initialized");
+            return;
+        }
+
+        const auto interval = std::chrono::duration_cast<util::Clock::duration>(
+            std::chrono::duration<double>{config.report_interval});
+
+        stages->start();
+        auto previous = stages->collect();
+        auto reported = util::Clock::now();
+        while (util::get_running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+            for (std::size_t i = 0; i < stage_gauges.size(); ++i) {
+                stage_gauges[i].depth->set(static_cast<double>(stages->depth(i)));
+                stage_gauges[i].limit->set(static_cast<double>(stages->limit(i)));
+            }
+
+            const auto now = util::Clock::now();
+            if (now - reported < interval) {
+                continue;
+            }
+            auto metrics = stages->collect();
+            report(previous, metrics, now - reported);
+            publish(previous, metrics);
+            previous = std::move(metrics);
+            reported = now;
+        }
+        stages->stop();
+    }
+
+    auto publish(const Stages::Metrics& previous, const Stages::Metrics& current) noexcept
+        -> void {
+        for (std::size_t i = 0; i < current.stages.size(); ++i) {
+            stage_gauges[i].processed->add(current.stages[i].processed
+                                           - previous.stages[i].processed);
+            stage_gauges[i].dropped->add(current.stages[i].dropped - previous.stages[i].dropped);
+            stage_gauges[i].late->add(current.stages[i].late - previous.stages[i].late);
+            stage_gauges[i].degraded->add(current.stages[i].degraded
+                                          - previous.stages[i].degraded);
+        }
+    }
+
+    static auto report(const Stages::Metrics& previous, const Stages::Metrics& current,
+                       util::Clock::duration elapsed) -> void {
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+
+        const auto seconds = std::chrono::duration<double>{elapsed}.count();
+        spdlog::info("Pipeline: {:.1f} fps, latency mean {:.2f}ms max {:.2f}ms",
+                     static_cast<double>(current.completed - previous.completed) / seconds,
+                     Milliseconds{current.mean_latency}.count(),
+                     Milliseconds{current.max_latency}.count());
+
+        for (std::size_t i = 0; i < current.stages.size(); ++i) {
+            const auto& now    = current.stages[i];
+            const auto& before = previous.stages[i];
+            spdlog::info("  {}: {} processed, {} rejected, {} dropped, {} late, {} degraded, "
+                         "depth {}/{}, busy {:.0f}%, max {:.2f}ms",
+                         now.name, now.processed - before.processed,
+                         now.rejected - before.rejected, now.dropped - before.dropped,
+                         now.late - before.late, now.degraded - before.degraded, now.depth,
+                         now.limit,
+                         100.0 * std::chrono::duration<double>{now.busy - before.busy}.count()
+                             / seconds,
+                         Milliseconds{now.max_service}.count());
+        }
+    }
+};
+
+Pipeline::Pipeline() : pimpl_{std::make_unique<Impl>()} {
+}
+
+Pipeline::~Pipeline() noexcept                      = default;
+Pipeline::Pipeline(Pipeline&&) noexcept             = default;
+Pipeline& Pipeline::operator=(Pipeline&&) noexcept = default;
+
+auto Pipeline::register_step(std::string name, Step step) noexcept -> void {
+    pimpl_->steps.insert_or_assign(std::move(name), std::move(step));
+}
+
+auto Pipeline::initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+auto Pipeline::run() noexcept -> void {
+    pimpl_->run();
+}
+
+}  // namespace pingpong_tracker::kernel
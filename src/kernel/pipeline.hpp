@@ -0,0 +1,61 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/image/image.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+/// @brief One frame travelling through the pipeline, recycled between frames
+struct Frame {
+    std::unique_ptr<Image> image;
+    std::vector<Ball2D> balls;
+    std::vector<BallTrack2D> tracks;
+    std::optional<BallTrack3D> prediction;
+    // Over a stage's latency budget and sent down its cheaper path, later steps may skip work
+    bool late = false;
+};
+
+/// @brief
+///   Staged runtime, the configuration groups named steps into stages on dedicated threads.
+/// @note
+///   - Stages are linked by bounded lock-free queues, each with its own backpressure policy,
+///     see `util::StagedPipeline`.
+///   - Steps are registered by the caller before `initialize`, which resolves the names.
+///   - A stage may set a latency budget on the capture timestamp. Frames older than that when
+///     the stage picks them up are dropped or run its `late_steps` marked `late`, and the queue
+///     in front of it shrinks until frames arrive in time.
+///   - Every step of a single stage is the serial loop.
+class Pipeline {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Pipeline)
+
+public:
+    /// @note Returning false discards the frame, the first step of the first stage returns false
+    ///       while no frame is available
+    using Step = std::function<bool(Frame&)>;
+
+    Pipeline();
+
+    auto register_step(std::string name, Step step) noexcept -> void;
+
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    /// @brief Runs the stages until the global running flag clears, logging stage metrics
+    auto run() noexcept -> void;
+
+    static constexpr auto get_prefix() noexcept {
+        return "pipeline";
+    }
+};
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,290 @@
+#include "predictor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <variant>
+
+#include "module/tracker/ball_tracker.hpp"
+#include "module/tracker/imm_tracker.hpp"
+#include "module/tracker/trajectory_predictor.hpp"
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::kernel {
+
+struct Predictor::Impl {
+    using BallTracker = tracker::BallTracker<3>;
+    using ImmTracker  = tracker::ImmTracker<3>;
+
+    struct Config : util::SerializableMixin {
+        // metre / s^2, table frame z up
+        std::vector<double> gravity{0.0, 0.0, -9.81};
+        // 1 / metre
+        double drag                 = 0.14;
+        double process_noise        = 50.0;
+        double initial_velocity_std = 10.0;
+        double gate_threshold       = 11.34;
+        int max_coast_frames        = 10;
+
+        // "ballistic" for a single flight model, "imm" for flight, bounce and roll modes
+        std::string motion_model{"imm"};
+        // metre / s
+        double bounce_velocity_std = 3.0;
+        double roll_process_noise  = 1.0;
+        // 1 / s
+        double roll_damping = 30.0;
+        // Row-major 3x3, from flight, bounce, roll to the same
+        std::vector<double> mode_transition{0.94, 0.05, 0.01, 0.90, 0.05, 0.05, 0.02, 0.01, 0.97};
+
+        double restitution        = 0.9;
+        double friction           = 0.2;
+        double step               = 0.002;
+        double horizon            = 1.0;
+        int max_steps_per_update  = 128;
+        double position_tolerance = 0.01;
+        double velocity_tolerance = 0.15;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "gravity",                  &Config::gravity,
+            "drag",                     &Config::drag,
+            "process_noise",            &Config::process_noise,
+            "initial_velocity_std",     &Config::initial_velocity_std,
+            "gate_threshold",           &Config::gate_threshold,
+            "max_coast_frames",         &Config::max_coast_frames,
+            "motion_model",             &Config::motion_model,
+            "bounce_velocity_std",      &Config::bounce_velocity_std,
+            "roll_process_noise",       &Config::roll_process_noise,
+            "roll_damping",             &Config::roll_damping,
+            "mode_transition",          &Config::mode_transition,
+            "restitution",              &Config::restitution,
+            "friction",                 &Config::friction,
+            "step",                     &Config::step,
+            "horizon",                  &Config::horizon,
+            "max_steps_per_update",     &Config::max_steps_per_update,
+            "position_tolerance",       &Config::position_tolerance,
+            "velocity_tolerance",       &Config::velocity_tolerance,
+            // clang-format on
+        };
+    };
+
+    struct TableConfig : util::SerializableMixin {
+        double length        = 2.74;
+        double width         = 1.525;
+        double height        = 0.76;
+        double ball_diameter = 0.04;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "length",                   &TableConfig::length,
+            "width",                    &TableConfig::width,
+            "height",                   &TableConfig::height,
+            "ball_diameter",            &TableConfig::ball_diameter,
+            // clang-format on
+        };
+    };
+
+    // Slack for transition rows written as rounded decimals in the configuration
+    static constexpr auto kTransitionTolerance = 1e-6;
+
+    mutable std::mutex mutex;
+
+    std::variant<BallTracker, ImmTracker> ball_tracker;
+    std::optional<tracker::TrajectoryPredictor> trajectory;
+    std::uint32_t track_id = 0;
+
+    std::vector<BallTracker::ZVec> candidates;
+    std::vector<BallTracker::RMat> noises;
+    std::vector<const Ball3D*> ordered;
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        auto config = Config{};
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        auto table = TableConfig{};
+        if (auto result = table.serialize(yaml["table"]); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        if (config.gravity.size() != 3) {
+            return std::unexpected{"Predictor gravity must have 3 components"};
+        }
+        if (config.motion_model != "ballistic" && config.motion_model != "imm") {
+            return std::unexpected{"Unknown predictor motion model: " + config.motion_model};
+        }
+        if (config.mode_transition.size() != ImmTracker::kModes * ImmTracker::kModes) {
+            return std::unexpected{"Predictor mode_transition must be 3x3"};
+        }
+        // Row i holds the probabilities of moving from mode i to every mode
+        for (std::size_t row = 0; row < ImmTracker::kModes; ++row) {
+            const auto begin = config.mode_transition.begin()
+                             + static_cast<std::ptrdiff_t>(row * ImmTracker::kModes);
+            const auto probabilities = std::ranges::subrange{begin, begin + ImmTracker::kModes};
+            if (!std::ranges::all_of(probabilities, [](double p) { return p >= 0.0; })) {
+                return std::unexpected{"Predictor mode_transition entries must not be negative"};
+            }
+            const auto sum = std::accumulate(probabilities.begin(), probabilities.end(), 0.0);
+            if (std::abs(sum - 1.0) > kTransitionTolerance) {
+                return std::unexpected{"Predictor mode_transition rows must sum to 1"};
+            }
+        }
+
+        auto model    = util::BallisticModel<3>{};
+        model.gravity = {config.gravity[0], config.gravity[1], config.gravity[2]};
+        model.drag    = config.drag;
+
+        auto tracker_config                 = BallTracker::Config{};
+        tracker_config.model                = model;
+        tracker_config.process_noise        = config.process_noise;
+        tracker_config.initial_velocity_std = config.initial_velocity_std;
+        tracker_config.gate_threshold       = config.gate_threshold;
+        tracker_config.max_coast = static_cast<std::size_t>(std::max(config.max_coast_frames, 0));
+
+        auto trajectory_config                 = tracker::TrajectoryPredictor::Config{};
+        trajectory_config.model                = model;
+        trajectory_config.ball_radius          = 0.5 * table.ball_diameter;
+        trajectory_config.table_length         = table.length;
+        trajectory_config.table_width          = table.width;
+        trajectory_config.table_height         = table.height;
+        trajectory_config.restitution          = config.restitution;
+        trajectory_config.friction             = config.friction;
+        trajectory_config.step                 = config.step;
+        trajectory_config.horizon              = config.horizon;
+        trajectory_config.position_tolerance   = config.position_tolerance;
+        trajectory_config.velocity_tolerance   = config.velocity_tolerance;
+        trajectory_config.max_steps_per_update =
+            static_cast<std::size_t>(std::max(config.max_steps_per_update, 1));
+
+        auto lock = std::scoped_lock{mutex};
+        if (config.motion_model == "imm") {
+            auto imm_config                 = ImmTracker::Config{};
+            imm_config.model                = model;
+            imm_config.process_noise        = config.process_noise;
+            imm_config.bounce_velocity_std  = config.bounce_velocity_std;
+            imm_config.roll_process_noise   = config.roll_process_noise;
+            imm_config.roll_damping         = config.roll_damping;
+            imm_config.initial_velocity_std = config.initial_velocity_std;
+            imm_config.gate_threshold       = config.gate_threshold;
+            imm_config.max_coast            = tracker_config.max_coast;
+            std::ranges::copy(config.mode_transition, imm_config.transition.begin());
+
+            ball_tracker.emplace<ImmTracker>(imm_config);
+        } else {
+            ball_tracker.emplace<BallTracker>(tracker_config);
+        }
+        trajectory.emplace(trajectory_config);
+        return {};
+    }
+
+    auto update(const Image& image, const std::vector<Ball3D>& balls) noexcept
+        -> std::optional<BallTrack3D> {
+        auto lock = std::scoped_lock{mutex};
+        if (!trajectory) {
+            return std::nullopt;
+        }
+
+        // Most confident first, a new track starts from the best detection
+        ordered.clear();
+        for (const auto& ball : balls) {
+            ordered.push_back(&ball);
+        }
+        std::ranges::sort(ordered, std::greater{}, &Ball3D::confidence);
+
+        candidates.clear();
+        noises.clear();
+        for (const auto* ball : ordered) {
+            candidates.emplace_back(ball->center.x, ball->center.y, ball->center.z);
+
+            auto& noise = noises.emplace_back();
+            for (int i = 0; i < 9; ++i) {
+                noise(i / 3, i % 3) = ball->covariance.val[i];
+            }
+        }
+
+        return std::visit([&](auto& active) { return update(active, image.get_timestamp()); },
+                          ball_tracker);
+    }
+
+    template <class Tracker>
+    auto update(Tracker& active, util::Clock::time_point timestamp) noexcept
+        -> std::optional<BallTrack3D> {
+        const auto was_lost = active.snapshot().state == tracker::TrackState::LOST;
+        active.update(timestamp, candidates, noises);
+
+        const auto& snapshot = active.snapshot();
+        if (snapshot.state == tracker::TrackState::LOST) {
+            trajectory->reset();
+            return std::nullopt;
+        }
+        if (was_lost) {
+            ++track_id;
+        }
+
+        const auto state = tracker::TrajectoryPredictor::State{
+            .position = snapshot.x.template head<3>(),
+            .velocity = snapshot.x.template tail<3>(),
+        };
+        trajectory->update(snapshot.timestamp, state);
+
+        auto track      = BallTrack3D{};
+        track.id        = track_id;
+        track.center    = to_point(state.position);
+        track.velocity  = to_point(state.velocity);
+        track.coasting  = snapshot.state == tracker::TrackState::COASTING;
+        track.timestamp = snapshot.timestamp;
+        if constexpr (requires { snapshot.probabilities; }) {
+            std::ranges::transform(snapshot.probabilities, track.mode_probabilities.begin(),
+                                   [](double p) { return static_cast<float>(p); });
+        }
+        if (const auto landing = trajectory->landing()) {
+            track.landing = BallLanding{
+                .position   = to_point(landing->position),
+                .timestamp  = landing->timestamp,
+                .confidence = track.mode_probabilities[0],
+            };
+        }
+        return track;
+    }
+
+    auto predict(util::Clock::time_point timestamp) const noexcept -> std::optional<cv::Point3f> {
+        auto lock = std::scoped_lock{mutex};
+        if (!trajectory) {
+            return std::nullopt;
+        }
+        if (const auto state = trajectory->predict(timestamp)) {
+            return to_point(state->position);
+        }
+        return std::nullopt;
+    }
+
+    static auto to_point(Eigen::Vector3d const& vector) noexcept -> cv::Point3f {
+        return {static_cast<float>(vector.x()), static_cast<float>(vector.y()),
+                static_cast<float>(vector.z())};
+    }
+};
+
+Predictor::Predictor() : pimpl_{std::make_unique<Impl>()} {
+}
+
+Predictor::~Predictor() noexcept                      = default;
+Predictor::Predictor(Predictor&&) noexcept            = default;
+Predictor& Predictor::operator=(Predictor&&) noexcept = default;
+
+auto Predictor::initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+auto Predictor::update(const Image& image, const std::vector<Ball3D>& balls) noexcept
+    -> std::optional<BallTrack3D> {
+    return pimpl_->update(image, balls);
+}
+
+auto Predictor::predict(util::Clock::time_point timestamp) const noexcept
+    -> std::optional<cv::Point3f> {
+    return pimpl_->predict(timestamp);
+}
+
+}  // namespace pingpong_tracker::kernel
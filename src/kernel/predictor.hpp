@@ -0,0 +1,37 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <optional>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/clock.hpp"
+#include "utility/image/image.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+class Predictor {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Predictor)
+
+public:
+    Predictor();
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    /// @brief
+    ///   Tracks the ball in the table frame and refreshes its predicted flight.
+    /// @note
+    ///   - Thread-safe, frames older than the current estimate are ignored.
+    ///   - The prediction work per call is bounded, see `max_steps_per_update`.
+    /// @return The tracked ball with its next landing, or nullopt while no track is alive
+    auto update(const Image&, const std::vector<Ball3D>&) noexcept -> std::optional<BallTrack3D>;
+
+    /// @brief Predicted ball centre at `timestamp`, nullopt outside the predicted span
+    [[nodiscard]] auto predict(util::Clock::time_point timestamp) const noexcept
+        -> std::optional<cv::Point3f>;
+};
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,210 @@
+#include "publisher.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <mutex>
+
+#include "utility/clock.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/publish/ball_message.hpp"
+#include "utility/publish/shm_channel.hpp"
+#include "utility/publish/udp_channel.hpp"
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::kernel {
+
+namespace {
+
+auto to_nanoseconds(util::Clock::time_point time) noexcept -> std::int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+}  // namespace
+
+struct Publisher::Impl {
+    struct Config : util::SerializableMixin {
+        bool udp = false;
+        // "host:port"
+        std::vector<std::string> udp_targets{"127.0.0.1:9870"};
+
+        bool shm = false;
+        std::string shm_name = "/pingpong_tracker";
+        // Messages kept for readers that fall behind
+        int shm_capacity = 256;
+        // Replace an existing segment of the same name instead of failing
+        bool shm_takeover = false;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "udp",                      &Config::udp,
+            "udp_targets",              &Config::udp_targets,
+            "shm",                      &Config::shm,
+            "shm_name",                 &Config::shm_name,
+            "shm_capacity",             &Config::shm_capacity,
+            "shm_takeover",             &Config::shm_takeover,
+            // clang-format on
+        };
+    };
+
+    std::optional<util::UdpPublisher> udp;
+    std::optional<util::ShmPublisher> shm;
+
+    std::mutex mutex;
+    std::uint64_t sequence = 0;
+    util::Clock::time_point last_capture{};
+    std::uint64_t udp_dropped = 0;
+
+    util::metrics::Counter& published = util::metrics::registry().counter(
+        "pingpong_publish_messages_total", "Result messages published");
+    util::metrics::Counter& stale = util::metrics::registry().counter(
+        "pingpong_publish_stale_total", "Results dropped because a newer frame was published");
+    util::metrics::Counter& dropped = util::metrics::registry().counter(
+        "pingpong_publish_udp_dropped_total", "UDP datagrams the socket could not take");
+    util::metrics::Histogram& latency = util::metrics::registry().histogram(
+        "pingpong_publish_latency_seconds", "From capture to publishing the result");
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        auto config = Config{};
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+
+        if (config.udp) {
+            auto result = util::UdpPublisher::open(config.udp_targets);
+            if (!result) {
+                return std::unexpected{std::format("UDP: {}", result.error())};
+            }
+            udp.emplace(std::move(*result));
+            spdlog::info("Publishing results over UDP to {}", config.udp_targets.size() == 1
+                                                                  ? config.udp_targets.front()
+                                                                  : "several targets");
+        }
+        if (config.shm) {
+            if (config.shm_capacity < 1) {
+                return std::unexpected{"shm_capacity must be positive"};
+            }
+            auto result = util::ShmPublisher::open(
+                config.shm_name, static_cast<std::uint32_t>(config.shm_capacity),
+                config.shm_takeover);
+            if (!result) {
+                return std::unexpected{std::format("Shared memory: {}", result.error())};
+            }
+            shm.emplace(std::move(*result));
+            spdlog::info("Publishing results to shared memory {}", config.shm_name);
+        }
+        return {};
+    }
+
+    static auto fill(util::BallMessage& message, const std::vector<Ball2D>& balls,
+                     const std::vector<BallTrack2D>& tracks,
+                     const std::optional<BallTrack3D>& prediction) noexcept -> void {
+        using Message = util::BallMessage;
+
+        message.ball_count = static_cast<std::uint16_t>(std::min(balls.size(), Message::kMaxBalls));
+        for (std::size_t i = 0; i < message.ball_count; ++i) {
+            const auto& ball  = balls[i];
+            message.balls[i] = {ball.center.x, ball.center.y, ball.radius, ball.confidence};
+        }
+
+        message.track_count =
+            static_cast<std::uint16_t>(std::min(tracks.size(), Message::kMaxTracks));
+        for (std::size_t i = 0; i < message.track_count; ++i) {
+            const auto& track = tracks[i];
+            message.tracks[i] = Message::Track{
+                .id       = track.id,
+                .flags    = track.coasting ? Message::Track::kCoasting : 0U,
+                .x        = track.center.x,
+                .y        = track.center.y,
+                .vx       = track.velocity.x,
+                .vy       = track.velocity.y,
+                .radius   = track.radius,
+                .reserved = 0,
+            };
+        }
+
+        if (!prediction) {
+            return;
+        }
+        auto& out = message.prediction;
+        out.id    = prediction->id;
+        out.flags = Message::Prediction::kValid
+                  | (prediction->coasting ? Message::Prediction::kCoasting : 0U);
+        out.x  = prediction->center.x;
+        out.y  = prediction->center.y;
+        out.z  = prediction->center.z;
+        out.vx = prediction->velocity.x;
+        out.vy = prediction->velocity.y;
+        out.vz = prediction->velocity.z;
+        if (const auto& landing = prediction->landing) {
+            out.flags |= Message::Prediction::kLanding;
+            out.landing_x          = landing->position.x;
+            out.landing_y          = landing->position.y;
+            out.landing_z          = landing->position.z;
+            out.landing_confidence = landing->confidence;
+            out.landing_ns         = to_nanoseconds(landing->timestamp);
+        }
+    }
+
+    auto publish(const Image& image, const std::vector<Ball2D>& balls,
+                 const std::vector<BallTrack2D>& tracks,
+                 const std::optional<BallTrack3D>& prediction) noexcept -> void {
+        if (!udp && !shm) {
+            return;
+        }
+
+        const auto capture = image.get_timestamp();
+        auto message       = util::BallMessage{};
+        message.magic      = util::BallMessage::kMagic;
+        message.version    = util::BallMessage::kVersion;
+        message.size       = sizeof(util::BallMessage);
+        message.capture_ns = to_nanoseconds(capture);
+        fill(message, balls, tracks, prediction);
+
+        auto lock = std::scoped_lock{mutex};
+        if (capture < last_capture) {
+            stale.add();
+            return;
+        }
+        last_capture = capture;
+
+        message.sequence   = sequence++;
+        const auto now     = util::Clock::now();
+        message.publish_ns = to_nanoseconds(now);
+
+        if (shm) {
+            shm->publish(message);
+        }
+        if (udp) {
+            udp->publish({&message, 1});
+            dropped.add(udp->dropped() - std::exchange(udp_dropped, udp->dropped()));
+        }
+        published.add();
+        latency.observe(now - capture);
+    }
+};
+
+Publisher::Publisher() : pimpl_{std::make_unique<Impl>()} {
+}
+
+Publisher::~Publisher() noexcept                       = default;
+Publisher::Publisher(Publisher&&) noexcept             = default;
+Publisher& Publisher::operator=(Publisher&&) noexcept = default;
+
+auto Publisher::initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+auto Publisher::initialized() const noexcept -> bool {
+    return pimpl_->udp || pimpl_->shm;
+}
+
+auto Publisher::publish(const Image& image, const std::vector<Ball2D>& balls,
+                        const std::vector<BallTrack2D>& tracks,
+                        const std::optional<BallTrack3D>& prediction) noexcept -> void {
+    pimpl_->publish(image, balls, tracks, prediction);
+}
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/image/image.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+/// @brief
+///   Sends every frame's detections, tracks and prediction to external consumers as a
+///   `util::BallMessage`, over UDP and a shared-memory ring.
+/// @note
+///   - Thread-safe. Frames finishing out of order are dropped rather than sent after a newer
+///     one, so consumers see capture times only move forward.
+///   - Messages are numbered in publication order and stamped with the capture time.
+class Publisher {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Publisher)
+
+public:
+    Publisher();
+
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto initialized() const noexcept -> bool;
+
+    auto publish(const Image&, const std::vector<Ball2D>&, const std::vector<BallTrack2D>&,
+                 const std::optional<BallTrack3D>& prediction) noexcept -> void;
+
+    static constexpr auto get_prefix() noexcept {
+        return "publisher";
+    }
+};
+
+}  // namespace pingpong_tracker::kernel
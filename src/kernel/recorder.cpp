@@ -0,0 +1,241 @@
+#include "recorder.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+#include "utility/clock.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/record/detection_file.hpp"
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::kernel {
+
+namespace {
+
+// Local wall time, "20240131-184502"
+auto start_stamp() -> std::string {
+    const auto now = std::time(nullptr);
+    auto local     = std::tm{};
+    ::localtime_r(&now, &local);
+    char text[32]{};
+    std::strftime(text, sizeof(text), "%Y%m%d-%H%M%S", &local);
+    return text;
+}
+
+}  // namespace
+
+struct Recorder::Impl {
+    struct Config : util::SerializableMixin {
+        bool enable = false;
+        // "{}" is replaced by the start time, every run gets its own file
+        std::string path = "/tmp/pingpong_detections_{}.bin";
+        int block_frames = 256;
+        bool sync        = false;
+        // Frames waiting for the writer thread, more are dropped
+        int queue = 256;
+        // Frames held back to restore capture order, concurrent pipelines finish out of order
+        int reorder_window = 8;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "enable",                   &Config::enable,
+            "path",                     &Config::path,
+            "block_frames",             &Config::block_frames,
+            "sync",                     &Config::sync,
+            "queue",                    &Config::queue,
+            "reorder_window",           &Config::reorder_window,
+            // clang-format on
+        };
+    };
+
+    struct Record {
+        util::Clock::time_point capture;
+        std::vector<Ball2D> balls;
+        std::vector<BallTrack2D> tracks;
+    };
+
+    static constexpr auto kLater = [](const Record& lhs, const Record& rhs) {
+        return lhs.capture > rhs.capture;
+    };
+
+    // Handed over by the tracking threads
+    std::mutex mutex;
+    std::condition_variable_any ready;
+    std::deque<Record> queue;
+    std::size_t capacity = 0;
+    std::atomic<bool> recording{false};
+
+    // Owned by the writer thread
+    std::optional<util::DetectionFileWriter> writer;
+    std::string path;
+    std::size_t reorder_window = 0;
+    // Min-heap on the capture timestamp
+    std::vector<Record> pending;
+    std::uint64_t next_frame = 0;
+    std::optional<util::Clock::time_point> origin;
+    util::Clock::time_point last_capture{};
+
+    util::metrics::Counter& recorded = util::metrics::registry().counter(
+        "pingpong_record_frames_total", "Frames logged to the detection file");
+    util::metrics::Counter& dropped = util::metrics::registry().counter(
+        "pingpong_record_dropped_total", "Frames not logged, the writer thread fell behind");
+    util::metrics::Counter& out_of_order = util::metrics::registry().counter(
+        "pingpong_record_out_of_order_total",
+        "Frames not logged, captured before frames already written");
+
+    // Last, stopped and joined first on destruction
+    std::jthread thread;
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        auto config = Config{};
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        if (!config.enable) {
+            return {};
+        }
+        if (config.queue < 1 || config.reorder_window < 0) {
+            return std::unexpected{"Recorder queue must be positive, reorder_window non-negative"};
+        }
+
+        path = config.path;
+        if (const auto at = path.find("{}"); at != std::string::npos) {
+            path.replace(at, 2, start_stamp());
+        }
+        auto result = util::DetectionFileWriter::open({
+            .path         = path,
+            .source       = "live",
+            .frame_rate   = 0.0,
+            .block_frames = static_cast<std::size_t>(std::max(config.block_frames, 1)),
+            .sync         = config.sync,
+        });
+        if (!result) {
+            return std::unexpected{result.error()};
+        }
+        if (result->next_frame() != 0) {
+            return std::unexpected{std::format("'{}' already holds a recording", path)};
+        }
+        writer.emplace(std::move(*result));
+        capacity       = static_cast<std::size_t>(config.queue);
+        reorder_window = static_cast<std::size_t>(config.reorder_window);
+        pending.reserve(reorder_window + 1);
+
+        recording.store(true, std::memory_order_release);
+        thread = std::jthread{[this](const std::stop_token& token) { run(token); }};
+        spdlog::info("Recording detections to '{}'", path);
+        return {};
+    }
+
+    auto record(const Image& image, const std::vector<Ball2D>& balls,
+                const std::vector<BallTrack2D>& tracks) noexcept -> void {
+        if (!recording.load(std::memory_order_acquire)) {
+            return;
+        }
+        {
+            auto lock = std::scoped_lock{mutex};
+            if (queue.size() >= capacity) {
+                dropped.add();
+                return;
+            }
+            queue.push_back({.capture = image.get_timestamp(), .balls = balls, .tracks = tracks});
+        }
+        ready.notify_one();
+    }
+
+    auto run(const std::stop_token& token) noexcept -> void {
+        auto batch = std::deque<Record>{};
+        for (;;) {
+            {
+                auto lock = std::unique_lock{mutex};
+                ready.wait(lock, token, [this] { return !queue.empty(); });
+                batch.swap(queue);
+            }
+            if (batch.empty()) {
+                break;
+            }
+
+            for (auto& record : batch) {
+                pending.push_back(std::move(record));
+                std::ranges::push_heap(pending, kLater);
+                if (pending.size() > reorder_window) {
+                    write_oldest();
+                }
+            }
+            batch.clear();
+        }
+
+        while (!pending.empty()) {
+            write_oldest();
+        }
+        if (writer) {
+            if (auto result = writer->flush(); !result) {
+                spdlog::error("Recording to '{}' lost its last frames: {}", path, result.error());
+            }
+        }
+    }
+
+    auto write_oldest() noexcept -> void {
+        std::ranges::pop_heap(pending, kLater);
+        const auto record = std::move(pending.back());
+        pending.pop_back();
+        if (!writer) {
+            return;
+        }
+
+        // Came in after a later capture was written, the reorder window was too small for it
+        if (origin && record.capture < last_capture) {
+            out_of_order.add();
+            return;
+        }
+        if (!origin) {
+            origin = record.capture;
+        }
+        last_capture = record.capture;
+        const auto timestamp =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(record.capture - *origin).count();
+
+        if (auto result = writer->append(next_frame, timestamp, record.balls, record.tracks);
+            !result) {
+            spdlog::error("Recording to '{}' stopped: {}", path, result.error());
+            recording.store(false, std::memory_order_release);
+            writer.reset();
+            return;
+        }
+        ++next_frame;
+        recorded.add();
+    }
+};
+
+Recorder::Recorder() : pimpl_{std::make_unique<Impl>()} {
+}
+
+Recorder::~Recorder() noexcept                      = default;
+Recorder::Recorder(Recorder&&) noexcept             = default;
+Recorder& Recorder::operator=(Recorder&&) noexcept = default;
+
+auto Recorder::initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+auto Recorder::initialized() const noexcept -> bool {
+    return pimpl_->recording.load(std::memory_order_acquire);
+}
+
+auto Recorder::record(const Image& image, const std::vector<Ball2D>& balls,
+                      const std::vector<BallTrack2D>& tracks) noexcept -> void {
+    pimpl_->record(image, balls, tracks);
+}
+
+}  // namespace pingpong_tracker::kernel
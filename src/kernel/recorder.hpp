@@ -0,0 +1,46 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <string>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/image/image.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+/// @brief
+///   Logs every frame's detections and tracks into a detection file, the format the offline
+///   analyzer writes, so tracking can be replayed and tuned without the camera or the model.
+/// @note
+///   - Thread-safe. `record` only copies the frame into a bounded queue, a background thread
+///     does the writing and syncing. A frame finding the queue full is dropped and counted.
+///   - Frames are written in capture order. The writer holds back `reorder_window` frames to
+///     sort the ones concurrent pipelines finish out of order, a frame arriving after a later
+///     capture was written is dropped and counted.
+///   - Timestamps are nanoseconds from the first written capture, each run writes a new file.
+///   - A write error is logged once and stops the recording, tracking goes on. Destruction
+///     writes what is still queued.
+class Recorder {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Recorder)
+
+public:
+    Recorder();
+
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto initialized() const noexcept -> bool;
+
+    auto record(const Image&, const std::vector<Ball2D>&, const std::vector<BallTrack2D>&) noexcept
+        -> void;
+
+    static constexpr auto get_prefix() noexcept {
+        return "recorder";
+    }
+};
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,147 @@
+#include "replay.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <numeric>
+#include <set>
+#include <tuple>
+
+#include "kernel/tracker.hpp"
+
+namespace pingpong_tracker::kernel {
+
+auto expand_sweep(const YAML::Node& tracker, const YAML::Node& sweep)
+    -> std::expected<std::vector<ReplayVariant>, std::string> {
+    auto variants = std::vector<ReplayVariant>{{.label = "", .config = YAML::Clone(tracker)}};
+    if (!sweep || sweep.IsNull()) {
+        return variants;
+    }
+    if (!sweep.IsMap()) {
+        return std::unexpected{"replay.sweep must map tracker keys to lists of values"};
+    }
+
+    for (const auto& entry : sweep) {
+        const auto key = entry.first.as<std::string>();
+        if (!tracker[key]) {
+            return std::unexpected{std::format("Unknown tracker key '{}' in the sweep", key)};
+        }
+        if (!entry.second.IsSequence() || entry.second.size() == 0) {
+            return std::unexpected{std::format("Sweep of '{}' needs a non-empty list", key)};
+        }
+
+        auto expanded = std::vector<ReplayVariant>{};
+        for (const auto& variant : variants) {
+            for (const auto& value : entry.second) {
+                auto config = YAML::Clone(variant.config);
+                config[key] = YAML::Clone(value);
+
+                auto text = YAML::Emitter{};
+                text << YAML::Flow << value;
+                expanded.push_back({
+                    .label = std::format("{}{}{}={}", variant.label,
+                                         variant.label.empty() ? "" : " ", key, text.c_str()),
+                    .config = std::move(config),
+                });
+            }
+        }
+        variants = std::move(expanded);
+    }
+    return variants;
+}
+
+auto replay(const util::DetectionFile& file, const YAML::Node& config) -> ReplayResult {
+    auto tracker = Tracker{};
+    if (auto result = tracker.initialize(config); !result) {
+        return std::unexpected{result.error()};
+    }
+
+    auto score         = ReplayScore{};
+    const auto started = util::Clock::now();
+    auto image         = Image{};
+    auto balls         = std::vector<Ball2D>{};
+    auto ids           = std::set<std::uint32_t>{};
+    auto errors        = std::vector<double>{};
+
+    for (const auto& block : file.blocks()) {
+        for (std::size_t row = 0; row < block.frame_index.size(); ++row) {
+            const auto time = util::Clock::time_point{std::chrono::duration_cast<
+                util::Clock::duration>(std::chrono::nanoseconds{block.timestamp[row]})};
+
+            balls.clear();
+            for (auto i = block.ball_offset[row]; i < block.ball_offset[row + 1]; ++i) {
+                balls.push_back(Ball2D{
+                    .center     = {block.ball_x[i], block.ball_y[i]},
+                    .radius     = block.ball_radius[i],
+                    .confidence = block.ball_confidence[i],
+                });
+            }
+
+            if (const auto predicted = tracker.predict(time); predicted && !balls.empty()) {
+                auto nearest = std::numeric_limits<double>::infinity();
+                for (const auto& ball : balls) {
+                    const auto dx = static_cast<double>(ball.center.x - predicted->center.x);
+                    const auto dy = static_cast<double>(ball.center.y - predicted->center.y);
+                    nearest       = std::min(nearest, std::hypot(dx, dy));
+                }
+                errors.push_back(nearest);
+            }
+
+            image.set_timestamp(time);
+            const auto tracks = tracker.update(image, balls);
+
+            ++score.frames;
+            if (!balls.empty()) {
+                ++score.detected;
+                score.tracked += tracks.empty() ? 0 : 1;
+            }
+            for (const auto& track : tracks) {
+                score.coasting += track.coasting ? 1 : 0;
+                ids.insert(track.id);
+            }
+        }
+    }
+
+    score.tracks  = ids.size();
+    score.elapsed = util::Clock::now() - started;
+
+    score.predictions = errors.size();
+    if (!errors.empty()) {
+        const auto quantile = [&](double q) {
+            const auto at = errors.begin()
+                          + static_cast<std::ptrdiff_t>(q * static_cast<double>(errors.size() - 1));
+            std::ranges::nth_element(errors, at);
+            return *at;
+        };
+        score.median_error = quantile(0.5);
+        score.p95_error    = quantile(0.95);
+        score.mean_error   = std::accumulate(errors.begin(), errors.end(), 0.0)
+                           / static_cast<double>(errors.size());
+    }
+    return score;
+}
+
+auto rank_variants(std::span<const ReplayResult> results, double min_coverage)
+    -> std::vector<std::size_t> {
+    auto order = std::vector<std::size_t>(results.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+
+    // Smaller is better on every field
+    const auto key = [&](std::size_t i) {
+        const auto& result = results[i];
+        if (!result) {
+            return std::tuple{2, 0.0, 0.0};
+        }
+        if (result->coverage() < min_coverage) {
+            return std::tuple{1, -result->coverage(), result->median_error};
+        }
+        return std::tuple{0, result->median_error, -result->coverage()};
+    };
+    std::ranges::stable_sort(order, {}, key);
+    return order;
+}
+
+}  // namespace pingpong_tracker::kernel
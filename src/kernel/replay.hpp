@@ -0,0 +1,68 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/record/detection_file.hpp"
+
+namespace pingpong_tracker::kernel {
+
+/// @brief A tracker configuration of a parameter sweep
+struct ReplayVariant {
+    // "key=value" of every swept key, empty for the configured tracker
+    std::string label;
+    YAML::Node config;
+};
+
+/// @brief How one variant tracked a recording
+struct ReplayScore {
+    std::uint64_t frames = 0;
+    // Frames with a detection, and those the tracker also had a track for
+    std::uint64_t detected = 0;
+    std::uint64_t tracked  = 0;
+    std::uint64_t coasting = 0;
+    // Distinct track ids, fewer for the same detections means less fragmentation
+    std::uint64_t tracks = 0;
+
+    // One-step prediction: the track carried to the next frame against its nearest detection,
+    // pixels. Lost tracks coast far from the ball, the median is what ranks the variants
+    std::uint64_t predictions = 0;
+    double median_error       = std::numeric_limits<double>::infinity();
+    double p95_error          = std::numeric_limits<double>::infinity();
+    double mean_error         = std::numeric_limits<double>::infinity();
+
+    util::Clock::duration elapsed{};
+
+    [[nodiscard]] auto coverage() const noexcept -> double {
+        return detected == 0 ? 0.0 : static_cast<double>(tracked) / static_cast<double>(detected);
+    }
+};
+
+using ReplayResult = std::expected<ReplayScore, std::string>;
+
+/// @brief Every combination of the swept values over the configured tracker
+/// @param sweep Tracker keys mapped to lists of candidate values, null for no sweep
+auto expand_sweep(const YAML::Node& tracker, const YAML::Node& sweep)
+    -> std::expected<std::vector<ReplayVariant>, std::string>;
+
+/// @brief Feeds the recording to a fresh tracker, unpaced, stamped with the recorded timestamps
+/// @return The score, or why the tracker could not be set up
+auto replay(const util::DetectionFile& file, const YAML::Node& tracker) -> ReplayResult;
+
+/// @brief
+///   Indices of `results` from best to worst.
+/// @note
+///   - Variants tracking at least `min_coverage` of the detected frames rank by median error.
+///   - The others follow by coverage, a variant that drops the ball keeps its few easy
+///     predictions and would otherwise look the most accurate. Failed replays come last.
+auto rank_variants(std::span<const ReplayResult> results, double min_coverage)
+    -> std::vector<std::size_t>;
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,337 @@
+#include "tracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "module/tracker/multi_tracker.hpp"
+#include "module/tracker/oosm_tracker.hpp"
+#include "utility/math/ballistic.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/serializable.hpp"
+#include "utility/thread/latest_value.hpp"
+
+namespace pingpong_tracker::kernel {
+
+struct Tracker::Impl {
+    using BallTracker = tracker::OosmTracker<2>;
+
+    struct Config : util::SerializableMixin {
+        // pixel / s^2, image y axis points down
+        std::vector<double> gravity{0.0, 0.0};
+        // 1 / pixel, single target only
+        double drag                 = 0.0;
+        double process_noise        = 1e4;
+        double measurement_noise    = 2.0;
+        double initial_velocity_std = 1e3;
+        double gate_threshold       = 9.21;
+        int max_coast_frames        = 10;
+
+        // Out-of-sequence frames, single target only
+        int history_frames     = 16;
+        int history_candidates = 4;
+        // seconds
+        double max_lag = BallTracker::Config{}.max_lag;
+
+        bool multi_target = false;
+        int confirm_hits  = 3;
+        int greedy_limit  = 4;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "gravity",                  &Config::gravity,
+            "drag",                     &Config::drag,
+            "process_noise",            &Config::process_noise,
+            "measurement_noise",        &Config::measurement_noise,
+            "initial_velocity_std",     &Config::initial_velocity_std,
+            "gate_threshold",           &Config::gate_threshold,
+            "max_coast_frames",         &Config::max_coast_frames,
+            "history_frames",           &Config::history_frames,
+            "history_candidates",       &Config::history_candidates,
+            "max_lag",                  &Config::max_lag,
+            "multi_target",             &Config::multi_target,
+            "confirm_hits",             &Config::confirm_hits,
+            "greedy_limit",             &Config::greedy_limit,
+            // clang-format on
+        };
+    };
+
+    // Primary track for lock-free readers, the flight model travels with it so that
+    // extrapolating never reads state guarded by the mutex
+    struct Publication {
+        bool alive = false;
+        std::uint32_t id = 0;
+        std::array<float, 2> center{};
+        std::array<float, 2> velocity{};
+        float radius  = 0.0F;
+        bool coasting = false;
+        util::Clock::duration timestamp{};
+        std::array<double, 2> gravity{};
+        double drag = 0.0;
+    };
+
+    static constexpr auto kRadiusSmoothing = 0.3F;
+
+    std::mutex mutex;
+
+    // Written under the mutex, read from anywhere
+    util::LatestValue<Publication> published;
+    std::array<double, 2> gravity{};
+    double drag = 0.0;
+
+    // Single target
+    BallTracker ball_tracker;
+    std::uint32_t track_id = 0;
+    float radius           = 0.0F;
+
+    std::vector<BallTracker::ZVec> candidates;
+    std::vector<const Ball2D*> ordered;
+
+    util::metrics::Counter& truncated = util::metrics::registry().counter(
+        "pingpong_tracker_truncated_total",
+        "Frames kept for out-of-sequence replay with fewer candidates than detected");
+    util::metrics::Counter& late_dropped = util::metrics::registry().counter(
+        "pingpong_tracker_late_dropped_total",
+        "Frames dropped as older than the out-of-sequence lag window");
+
+    // Multi target
+    std::optional<tracker::MultiTracker> multi_tracker;
+    std::vector<tracker::MultiTracker::Measurement> measurements;
+    std::unordered_map<std::uint32_t, float> radii;
+
+    static auto to_size(int value) noexcept -> std::size_t {
+        return static_cast<std::size_t>(std::max(value, 0));
+    }
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        auto config = Config{};
+        if (auto result = config.serialize(yaml); !result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        if (config.gravity.size() != 2) {
+            return std::unexpected{"Tracker gravity must have 2 components"};
+        }
+
+        auto lock = std::scoped_lock{mutex};
+
+        gravity = {config.gravity[0], config.gravity[1]};
+        drag    = config.multi_target ? 0.0 : config.drag;
+        published.publish(Publication{.gravity = gravity, .drag = drag});
+
+        if (config.multi_target) {
+            auto multi_config                 = tracker::MultiTracker::Config{};
+            multi_config.gravity_x            = static_cast<float>(config.gravity[0]);
+            multi_config.gravity_y            = static_cast<float>(config.gravity[1]);
+            multi_config.process_noise        = static_cast<float>(config.process_noise);
+            multi_config.measurement_noise    = static_cast<float>(config.measurement_noise);
+            multi_config.initial_velocity_std = static_cast<float>(config.initial_velocity_std);
+            multi_config.gate_threshold       = static_cast<float>(config.gate_threshold);
+            multi_config.confirm_hits         = to_size(config.confirm_hits);
+            multi_config.max_coast            = to_size(config.max_coast_frames);
+            multi_config.greedy_limit         = to_size(config.greedy_limit);
+
+            multi_tracker.emplace(multi_config);
+            return {};
+        }
+
+        auto tracker_config                         = BallTracker::Config{};
+        tracker_config.tracker.model.gravity        = {config.gravity[0], config.gravity[1]};
+        tracker_config.tracker.model.drag           = config.drag;
+        tracker_config.tracker.process_noise        = config.process_noise;
+        tracker_config.tracker.measurement_noise    = config.measurement_noise;
+        tracker_config.tracker.initial_velocity_std = config.initial_velocity_std;
+        tracker_config.tracker.gate_threshold       = config.gate_threshold;
+        tracker_config.tracker.max_coast            = to_size(config.max_coast_frames);
+        tracker_config.history                      = to_size(config.history_frames);
+        tracker_config.max_candidates               = to_size(config.history_candidates);
+        tracker_config.max_lag                      = config.max_lag;
+
+        multi_tracker.reset();
+        ball_tracker = BallTracker{tracker_config};
+        return {};
+    }
+
+    auto update(const Image& image, const std::vector<Ball2D>& balls) noexcept
+        -> std::vector<BallTrack2D> {
+        auto lock   = std::scoped_lock{mutex};
+        auto tracks = multi_tracker ? update_multi(image, balls) : update_single(image, balls);
+        publish(tracks);
+        return tracks;
+    }
+
+    auto latest() const noexcept -> std::optional<BallTrack2D> {
+        const auto publication = published.load();
+        if (!publication || !publication->alive) {
+            return std::nullopt;
+        }
+        return BallTrack2D{
+            .id        = publication->id,
+            .center    = {publication->center[0], publication->center[1]},
+            .velocity  = {publication->velocity[0], publication->velocity[1]},
+            .radius    = publication->radius,
+            .coasting  = publication->coasting,
+            .timestamp = util::Clock::time_point{publication->timestamp},
+        };
+    }
+
+    auto predict(util::Clock::time_point now) const noexcept -> std::optional<BallTrack2D> {
+        const auto publication = published.load();
+        if (!publication || !publication->alive) {
+            return std::nullopt;
+        }
+
+        const auto model = util::BallisticModel<2>{
+            .gravity = {publication->gravity[0], publication->gravity[1]},
+            .drag    = publication->drag,
+        };
+        const auto x0 = util::BallisticModel<2>::XVec{
+            publication->center[0], publication->center[1],
+            publication->velocity[0], publication->velocity[1]};
+        const auto dt =
+            std::chrono::duration<double>(now - util::Clock::time_point{publication->timestamp});
+        const auto x = model.transition(x0, dt.count());
+
+        return BallTrack2D{
+            .id        = publication->id,
+            .center    = {static_cast<float>(x[0]), static_cast<float>(x[1])},
+            .velocity  = {static_cast<float>(x[2]), static_cast<float>(x[3])},
+            .radius    = publication->radius,
+            .coasting  = publication->coasting,
+            .timestamp = now,
+        };
+    }
+
+    auto publish(const std::vector<BallTrack2D>& tracks) noexcept -> void {
+        auto publication = Publication{.gravity = gravity, .drag = drag};
+
+        const auto primary = std::ranges::min_element(tracks, {}, &BallTrack2D::id);
+        if (primary != tracks.end()) {
+            publication.alive     = true;
+            publication.id        = primary->id;
+            publication.center    = {primary->center.x, primary->center.y};
+            publication.velocity  = {primary->velocity.x, primary->velocity.y};
+            publication.radius    = primary->radius;
+            publication.coasting  = primary->coasting;
+            publication.timestamp = primary->timestamp.time_since_epoch();
+        }
+        published.publish(publication);
+    }
+
+    auto update_single(const Image& image, const std::vector<Ball2D>& balls) noexcept
+        -> std::vector<BallTrack2D> {
+        // Most confident first, a new track starts from the best detection
+        ordered.clear();
+        for (const auto& ball : balls) {
+            ordered.push_back(&ball);
+        }
+        std::ranges::sort(ordered, std::greater{}, &Ball2D::confidence);
+
+        candidates.clear();
+        for (const auto* ball : ordered) {
+            candidates.emplace_back(ball->center.x, ball->center.y);
+        }
+
+        const auto was_lost         = ball_tracker.snapshot().state == tracker::TrackState::LOST;
+        const auto truncated_before = ball_tracker.truncated();
+        const auto dropped_before   = ball_tracker.dropped();
+        const auto accepted         = ball_tracker.update(image.get_timestamp(), candidates);
+        truncated.add(ball_tracker.truncated() - truncated_before);
+        late_dropped.add(ball_tracker.dropped() - dropped_before);
+
+        const auto& snapshot = ball_tracker.snapshot();
+        if (snapshot.state == tracker::TrackState::LOST) {
+            return {};
+        }
+
+        if (was_lost) {
+            ++track_id;
+            radius = ordered.front()->radius;
+        } else if (accepted != BallTracker::npos) {
+            radius += kRadiusSmoothing * (ordered[accepted]->radius - radius);
+        }
+
+        return {BallTrack2D{
+            .id       = track_id,
+            .center   = {static_cast<float>(snapshot.x[0]), static_cast<float>(snapshot.x[1])},
+            .velocity = {static_cast<float>(snapshot.x[2]), static_cast<float>(snapshot.x[3])},
+            .radius   = radius,
+            .coasting = snapshot.state == tracker::TrackState::COASTING,
+            .timestamp = snapshot.timestamp,
+        }};
+    }
+
+    auto update_multi(const Image& image, const std::vector<Ball2D>& balls) noexcept
+        -> std::vector<BallTrack2D> {
+        measurements.clear();
+        for (const auto& ball : balls) {
+            measurements.push_back({ball.center.x, ball.center.y});
+        }
+
+        // An older frame leaves the tracks alone, they are returned as they stand
+        const auto ids = multi_tracker->update(image.get_timestamp(), measurements);
+        for (std::size_t i = 0; i < balls.size(); ++i) {
+            if (ids[i] == tracker::MultiTracker::kNoTrack) {
+                continue;
+            }
+            auto [it, inserted] = radii.try_emplace(ids[i], balls[i].radius);
+            if (!inserted) {
+                it->second += kRadiusSmoothing * (balls[i].radius - it->second);
+            }
+        }
+
+        const auto& tracks = multi_tracker->tracks();
+
+        auto result = std::vector<BallTrack2D>{};
+        for (std::size_t i = 0; i < tracks.size(); ++i) {
+            if (!multi_tracker->confirmed(i)) {
+                continue;
+            }
+            result.push_back(BallTrack2D{
+                .id        = tracks.id[i],
+                .center    = {tracks.x[i], tracks.y[i]},
+                .velocity  = {tracks.vx[i], tracks.vy[i]},
+                .radius    = radii[tracks.id[i]],
+                .coasting  = tracks.misses[i] > 0,
+                .timestamp = multi_tracker->timestamp(),
+            });
+        }
+
+        // Forget radii of tracks that died this frame
+        if (radii.size() > tracks.size()) {
+            std::erase_if(radii, [&](const auto& entry) {
+                return std::ranges::find(tracks.id, entry.first) == tracks.id.end();
+            });
+        }
+        return result;
+    }
+};
+
+Tracker::Tracker() : pimpl_{std::make_unique<Impl>()} {
+}
+
+Tracker::~Tracker() noexcept                    = default;
+Tracker::Tracker(Tracker&&) noexcept            = default;
+Tracker& Tracker::operator=(Tracker&&) noexcept = default;
+
+auto Tracker::initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->initialize(yaml);
+}
+
+auto Tracker::update(const Image& image, const std::vector<Ball2D>& balls) noexcept
+    -> std::vector<BallTrack2D> {
+    return pimpl_->update(image, balls);
+}
+
+auto Tracker::latest() const noexcept -> std::optional<BallTrack2D> {
+    return pimpl_->latest();
+}
+
+auto Tracker::predict(util::Clock::time_point now) const noexcept -> std::optional<BallTrack2D> {
+    return pimpl_->predict(now);
+}
+
+}  // namespace pingpong_tracker::kernel
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <yaml-cpp/node/node.h>
+
+#include <expected>
+#include <optional>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/clock.hpp"
+#include "utility/image/image.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::kernel {
+
+class Tracker {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Tracker)
+
+public:
+    Tracker();
+    auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+
+    /// @brief
+    ///   Feeds one frame of detections, timed by the image's capture timestamp.
+    /// @note
+    ///   - Thread-safe, frames may arrive out of capture order from concurrent pipelines.
+    ///   - A single target takes a frame older than the current estimate by inserting it in
+    ///     timestamp order and fusing the frames after it again, as long as it is at most
+    ///     `max_lag` seconds behind the newest and within the last `history_frames`. Older ones
+    ///     are dropped and counted in `pingpong_tracker_late_dropped_total`.
+    ///   - With `multi_target` every confirmed track is returned, otherwise at most one. The
+    ///     multi-target tracker ignores older frames and returns its tracks unchanged.
+    /// @return The tracked balls, empty while no track is alive
+    auto update(const Image&, const std::vector<Ball2D>&) noexcept -> std::vector<BallTrack2D>;
+
+    /// @brief
+    ///   The primary track as published by the last update.
+    /// @note
+    ///   - Lock-free from any number of threads, readers never touch the tracker's lock. Not
+    ///     wait-free: a read retries when the updates lap the slot it is copying.
+    ///   - With `multi_target` the primary track is the oldest confirmed one.
+    /// @return The track stamped with its capture timestamp, or nullopt while none is alive
+    [[nodiscard]] auto latest() const noexcept -> std::optional<BallTrack2D>;
+
+    /// @brief
+    ///   `latest()` carried from its capture timestamp to `now` on the flight model, which
+    ///   compensates the capture, inference and tracking latency of the pipeline.
+    /// @note Lock-free as `latest()`, the returned track is stamped with `now`
+    [[nodiscard]] auto predict(util::Clock::time_point now) const noexcept
+        -> std::optional<BallTrack2D>;
+};
+
+}  // namespace pingpong_tracker::kernel
@@ -2,10 +2,14 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 #include "module/debug/visualization/stream_session.hpp"
+#include "utility/image/ball.hpp"
 #include "utility/image/image.details.hpp"
+#include "utility/metrics/metrics.hpp"
 #include "utility/serializable.hpp"
 
 using namespace pingpong_tracker::kernel;
@@ -21,25 +25,53 @@ struct Visualization::Impl {
     using NormalResult  = std::expected<void, std::string>;
 
     struct Config : util::SerializableMixin {
-        int framerate = 80;
+        // Cap of the preview, frames coming in faster are not sent
+        int framerate = 30;
 
         std::string monitor_host = "localhost";
         std::string monitor_port = "5000";
 
         std::string stream_type = "RTP_JPEG";
 
+        // Preview size, independent of the capture, a height of zero follows its aspect ratio
+        int width  = 640;
+        int height = 0;
+
+        // JPEG quality 1-100, H.264 bitrate in kbit/s
+        int quality = 80;
+        int bitrate = 600;
+
+        // Lowers quality or bitrate down to the minimum while the encoder falls behind
+        bool adaptive         = true;
+        int min_quality       = 30;
+        int min_bitrate       = 200;
+        double adapt_cooldown = 3.0;
+
         static constexpr auto kMetas = std::tuple{
-            "framerate",    &Config::framerate,    "monitor_host", &Config::monitor_host,
-            "monitor_port", &Config::monitor_port, "stream_type",  &Config::stream_type,
+            "framerate",    &Config::framerate,    "monitor_host",   &Config::monitor_host,
+            "monitor_port", &Config::monitor_port, "stream_type",    &Config::stream_type,
+            "width",        &Config::width,        "height",         &Config::height,
+            "quality",      &Config::quality,      "bitrate",        &Config::bitrate,
+            "adaptive",     &Config::adaptive,     "adapt_cooldown", &Config::adapt_cooldown,
+            "min_quality",  &Config::min_quality,  "min_bitrate",    &Config::min_bitrate,
         };
     };
 
     std::unique_ptr<debug::StreamSession> session;
     SessionConfig session_config;
 
+    int width  = 640;
+    int height = 0;
+
+    util::Clock::duration period{};
+    util::Clock::time_point next_due{};
+
     bool is_initialized  = false;
     bool size_determined = false;
 
+    util::metrics::Counter& capped = util::metrics::registry().counter(
+        "pingpong_stream_capped_total", "Frames not sent because of the preview frame rate cap");
+
     Impl() noexcept {
         session = std::make_unique<debug::StreamSession>();
     }
@@ -53,7 +85,7 @@ struct Visualization::Impl {
 
         session_config.target.host = config.monitor_host;
         session_config.target.port = config.monitor_port;
-        session_config.format.hz   = static_cast<int>(config.framerate);
+        session_config.format.hz   = config.framerate;
 
         if (config.stream_type == kVideoTypes[0]) {
             session_config.type = debug::StreamType::RTP_JPEG;
@@ -63,6 +95,43 @@ struct Visualization::Impl {
             return std::unexpected{"Unknown video type: " + config.stream_type};
         }
 
+        if (config.framerate <= 0) {
+            return std::unexpected{std::format("Frame rate must be positive, got {}",
+                                               config.framerate)};
+        }
+        if (config.width <= 0 || config.height < 0) {
+            return std::unexpected{
+                std::format("Invalid preview size {}x{}", config.width, config.height)};
+        }
+        if (config.quality < 1 || config.quality > 100 || config.min_quality < 1
+            || config.min_quality > config.quality) {
+            return std::unexpected{std::format("Need 1 <= min_quality <= quality <= 100, got {} "
+                                               "and {}",
+                                               config.min_quality, config.quality)};
+        }
+        if (config.min_bitrate <= 0 || config.min_bitrate > config.bitrate) {
+            return std::unexpected{std::format("Need 0 < min_bitrate <= bitrate, got {} and {}",
+                                               config.min_bitrate, config.bitrate)};
+        }
+        if (config.adapt_cooldown < 0.0) {
+            return std::unexpected{"Adapt cooldown must not be negative"};
+        }
+
+        width  = config.width;
+        height = config.height;
+        period = std::chrono::duration_cast<util::Clock::duration>(
+            std::chrono::duration<double>{1.0 / config.framerate});
+
+        session_config.format.quality = config.quality;
+        session_config.format.bitrate = config.bitrate;
+        session_config.adaptation     = {
+            .enable      = config.adaptive,
+            .min_quality = config.min_quality,
+            .min_bitrate = config.min_bitrate,
+            .cooldown    = std::chrono::duration_cast<util::Clock::duration>(
+                std::chrono::duration<double>{config.adapt_cooldown}),
+        };
+
         is_initialized = true;
         return {};
     }
@@ -71,10 +140,36 @@ struct Visualization::Impl {
         return is_initialized;
     }
 
-    auto send_image(const Image& image) noexcept -> bool {
+    // Even sizes, the H.264 encoder works on 2x2 chroma blocks
+    auto preview_size(const cv::Mat& capture) const noexcept -> cv::Size {
+        const auto even = [](double length) {
+            return std::max(2, static_cast<int>(std::lround(length / 2.0)) * 2);
+        };
+        const auto rows = height > 0 ? static_cast<double>(height)
+                                     : static_cast<double>(width) * capture.rows / capture.cols;
+        return {even(width), even(rows)};
+    }
+
+    auto due(util::Clock::time_point now) noexcept -> bool {
+        const auto next = Visualization::pace(now, next_due, period);
+        if (!next) {
+            return false;
+        }
+        next_due = *next;
+        return true;
+    }
+
+    auto send_image(const Image& image, const std::vector<Ball2D>& balls,
+                    const std::vector<BallTrack2D>& tracks) noexcept -> bool {
         if (!is_initialized)
             return false;
 
+        // Turned away before anything is copied or allocated
+        if (!due(util::Clock::now())) {
+            capped.add();
+            return false;
+        }
+
         const auto& mat = image.details().get_mat();
         if (mat.empty()) {
             spdlog::error("Visualization input frame is empty");
@@ -82,8 +177,9 @@ struct Visualization::Impl {
         }
 
         if (!size_determined) {
-            session_config.format.w = mat.cols;
-            session_config.format.h = mat.rows;
+            const auto size         = preview_size(mat);
+            session_config.format.w = size.width;
+            session_config.format.h = size.height;
 
             {  // open session
                 auto ret = session->open(session_config);
@@ -116,7 +212,21 @@ struct Visualization::Impl {
         if (!session->opened())
             return false;
 
-        return session->push_frame(mat);
+        if (balls.empty() && tracks.empty()) {
+            return session->push_frame(mat);
+        }
+        // Copied only now the frame is going out. Runs on the streaming thread, the canvas is
+        // already at the preview size
+        return session->push_frame(
+            mat, [balls = balls, tracks = tracks, width = mat.cols](cv::Mat& canvas) {
+                const auto ratio = static_cast<float>(canvas.cols) / static_cast<float>(width);
+                for (const auto& ball : balls) {
+                    util::draw(canvas, ball, ratio);
+                }
+                for (const auto& track : tracks) {
+                    util::draw(canvas, track, ratio);
+                }
+            });
     }
 };
 
@@ -129,8 +239,19 @@ auto Visualization::initialized() const noexcept -> bool {
     return pimpl_->initialized();
 }
 
-auto Visualization::send_image(const Image& image) noexcept -> bool {
-    return pimpl_->send_image(image);
+auto Visualization::send_image(const Image& image, const std::vector<Ball2D>& balls,
+                               const std::vector<BallTrack2D>& tracks) noexcept -> bool {
+    return pimpl_->send_image(image, balls, tracks);
+}
+
+auto Visualization::pace(util::Clock::time_point now, util::Clock::time_point due,
+                         util::Clock::duration period) noexcept
+    -> std::optional<util::Clock::time_point> {
+    if (now + period / 4 < due) {
+        return std::nullopt;
+    }
+    // Behind by a whole period or more, the frames in between are not owed
+    return now - due < period ? due + period : now + period;
 }
 
 Visualization::Visualization() noexcept : pimpl_{std::make_unique<Impl>()} {
@@ -1,12 +1,29 @@
 #pragma once
 #include <yaml-cpp/yaml.h>
 
+#include <coroutine>
 #include <expected>
+#include <optional>
+#include <vector>
 
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/clock.hpp"
+#include "utility/coroutine/executor.hpp"
 #include "utility/image/image.hpp"
 
 namespace pingpong_tracker::kernel {
 
+/// @brief
+///   Preview stream of the frames with their detections and tracks drawn over them.
+/// @note
+///   - Sending hands over the frame and copies of the metadata, nothing is drawn on the caller's
+///     thread and the frame is never written to.
+///   - Frames over the `framerate` cap are turned away before the metadata is copied. The
+///     streaming thread resizes the ones it encodes to the preview size and draws on that copy,
+///     frames replaced before it got to them are never drawn.
+///   - Preview size, frame rate and encoder quality are set apart from the capture, the quality
+///     steps down while the encoder falls behind.
 class Visualization {
     PINGPONG_TRACKER_PIMPL_DEFINITION(Visualization)
 
@@ -25,7 +42,57 @@ public:
 
     auto initialized() const noexcept -> bool;
 
-    auto send_image(const Image& image) noexcept -> bool;
+    auto send_image(const Image& image, const std::vector<Ball2D>& balls = {},
+                    const std::vector<BallTrack2D>& tracks = {}) noexcept -> bool;
+
+    /// @brief
+    ///   Paces the preview on a schedule rather than on the last frame sent.
+    /// @return The next due time when a frame arriving at `now` is sent, nullopt when turned away
+    /// @note
+    ///   - A frame up to a quarter period early still counts, so a source faster than the cap
+    ///     holds it instead of rounding down to a divisor of its own rate: 120 Hz input gives 30,
+    ///     60 and 100 fps.
+    ///   - After a pause the schedule restarts from `now` rather than bursting to catch up.
+    static auto pace(util::Clock::time_point now, util::Clock::time_point due,
+                     util::Clock::duration period) noexcept
+        -> std::optional<util::Clock::time_point>;
+
+    /// @brief
+    ///   Awaitable push, `send_image` runs on `executor` and the continuation stays there.
+    /// @note
+    ///   - Pass a single-threaded executor, the underlying stream session has one producer.
+    struct SendAwaiter : util::Executor::Operation {
+        Visualization& visualization;
+        const Image& image;
+        const std::vector<Ball2D>& balls;
+        const std::vector<BallTrack2D>& tracks;
+        util::Executor& executor;
+        std::coroutine_handle<> continuation{};
+        bool sent = false;
+
+        static constexpr auto await_ready() noexcept {
+            return false;
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> void {
+            continuation = awaiting;
+            function     = [](Operation* self) noexcept {
+                auto* awaiter = static_cast<SendAwaiter*>(self);
+                awaiter->sent      = awaiter->visualization.send_image(
+                    awaiter->image, awaiter->balls, awaiter->tracks);
+                awaiter->continuation.resume();
+            };
+            executor.post(this);
+        }
+        auto await_resume() const noexcept -> bool {
+            return sent;
+        }
+    };
+
+    [[nodiscard]] auto await_send(const Image& image, const std::vector<Ball2D>& balls,
+                                  const std::vector<BallTrack2D>& tracks,
+                                  util::Executor& executor) noexcept -> SendAwaiter {
+        return SendAwaiter{{}, *this, image, balls, tracks, executor};
+    }
 };
 
 }  // namespace pingpong_tracker::kernel
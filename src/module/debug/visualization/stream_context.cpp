@@ -1,33 +1,36 @@
 #include "stream_context.hpp"
 
+#include <format>
 #include <opencv2/videoio/registry.hpp>
 
 using namespace pingpong_tracker::debug;
 
 namespace pipeline {
-constexpr auto make_rtpjpeg = [](int w, int h, int hz, std::string_view host,
+constexpr auto make_rtpjpeg = [](const StreamContext::VideoFormat& format, std::string_view host,
                                  std::string_view port) {
     constexpr auto configuration = std::string_view{
-        "appsrc "
+        "appsrc name={} "
         "! videoconvert "
         "! video/x-raw,format=YUY2,width={},height={},framerate={}/1 "
-        "! jpegenc "
+        "! jpegenc quality={} "
         "! rtpjpegpay "
         "! udpsink host={} port={}",
     };
-    return std::format(configuration, w, h, hz, host, port);
+    return std::format(configuration, StreamContext::kSourceName, format.w, format.h, format.hz,
+                       format.quality, host, port);
 };
-constexpr auto make_rtph264 = [](int w, int h, int hz, std::string_view host,
+constexpr auto make_rtph264 = [](const StreamContext::VideoFormat& format, std::string_view host,
                                  std::string_view port) {
     constexpr auto configuration = std::string_view{
-        "appsrc "
+        "appsrc name={} "
         "! videoconvert "
         "! video/x-raw,format=I420,width={},height={},framerate={}/1 "
-        "! x264enc tune=zerolatency bitrate=600 speed-preset=ultrafast "
+        "! x264enc tune=zerolatency bitrate={} speed-preset=ultrafast "
         "! rtph264pay config-interval=1 pt=96 "
         "! udpsink host={} port={}",
     };
-    return std::format(configuration, w, h, hz, host, port);
+    return std::format(configuration, StreamContext::kSourceName, format.w, format.h, format.hz,
+                       format.bitrate, host, port);
 };
 }  // namespace pipeline
 
@@ -65,39 +68,69 @@ auto StreamContext::check_support() noexcept -> std::expected<void, std::string_
     return {};
 }
 
-auto StreamContext::open() noexcept -> std::expected<void, std::string> {
+auto StreamContext::make_sender(const VideoFormat& format, std::string& pipeline) const noexcept
+    -> std::expected<std::unique_ptr<cv::VideoWriter>, std::string> {
     switch (stream_type_) {
         case StreamType::RTP_JPEG:
-            pipeline_ = pipeline::make_rtpjpeg(video_format_.w, video_format_.h, video_format_.hz,
-                                               stream_target_.host, stream_target_.port);
+            pipeline = pipeline::make_rtpjpeg(format, stream_target_.host, stream_target_.port);
             break;
         case StreamType::RTP_H264:
-            pipeline_ = pipeline::make_rtph264(video_format_.w, video_format_.h, video_format_.hz,
-                                               stream_target_.host, stream_target_.port);
+            pipeline = pipeline::make_rtph264(format, stream_target_.host, stream_target_.port);
             break;
         case StreamType::NONE:
             return std::unexpected{"Unexpected stream type"};
     }
 
-    sender_ = std::make_unique<cv::VideoWriter>(pipeline_, cv::CAP_GSTREAMER, 0, video_format_.hz,
-                                                cv::Size{video_format_.w, video_format_.h}, true);
+    auto sender = std::make_unique<cv::VideoWriter>(pipeline, cv::CAP_GSTREAMER, 0, format.hz,
+                                                    cv::Size{format.w, format.h}, true);
 
-    if (!sender_->isOpened()) {
-        sender_.reset();
+    if (!sender->isOpened()) {
         return std::unexpected{
             "\nUnable to open pipeline."
             "\nPlease install required packages or check your pipeline config"
             "\n  sudo apt install "
             "gstreamer1.0-tools gstreamer1.0-plugins-base gstreamer1.0-plugins-good"
             "\n  current pipeline:\n"
-                + pipeline_,
+                + pipeline,
         };
     }
+    return sender;
+}
+
+auto StreamContext::open() noexcept -> std::expected<void, std::string> {
+    auto released = std::unique_ptr<cv::VideoWriter>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        released  = std::move(sender_);
+    }
+    released.reset();
 
+    return reopen(video_format());
+}
+
+auto StreamContext::reopen(const VideoFormat& format) noexcept
+    -> std::expected<void, std::string> {
+    auto pipeline = std::string{};
+    auto sender   = make_sender(format, pipeline);
+    if (!sender) {
+        return std::unexpected{sender.error()};
+    }
+
+    auto previous = std::move(*sender);
+    {
+        auto lock = std::scoped_lock{mutex_};
+        std::swap(sender_, previous);
+        video_format_ = format;
+        pipeline_     = std::move(pipeline);
+    }
+    // The old pipeline flushes as it is released, outside the lock, the new one is already
+    // taking frames
+    previous.reset();
     return {};
 }
 
 auto StreamContext::opened() const noexcept -> bool {
+    auto lock = std::scoped_lock{mutex_};
     return sender_ && sender_->isOpened();
 }
 
@@ -118,7 +151,8 @@ auto StreamContext::session_description_protocol(const std::string_view& local_i
     return std::unexpected{"unreachable"};
 }
 
+// Unlocked, `reopen` is the only other writer of the sender and runs on the same thread
 auto StreamContext::write(FrameRef frame) const noexcept -> void {
-    if (opened())
+    if (sender_ && sender_->isOpened())
         sender_->write(frame);
 }
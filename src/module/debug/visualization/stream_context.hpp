@@ -1,12 +1,20 @@
 #pragma once
 
 #include <expected>
+#include <memory>
+#include <mutex>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/videoio.hpp>
+#include <string>
+#include <string_view>
 #include <utility>
 
 namespace pingpong_tracker::debug {
 
+/// @note
+///   - `open`, `reopen` and `write` belong to the streaming thread. The accessors and the
+///     session description may be read from any thread meanwhile, they take a lock `reopen`
+///     holds while it swaps the pipeline.
 class StreamContext {
 public:
     using FrameRef = cv::Mat const&;
@@ -20,7 +28,13 @@ public:
         int w;
         int h;
         int hz;
+        // JPEG quality 1-100, H.264 bitrate in kbit/s, each read by its own encoder
+        int quality = 80;
+        int bitrate = 600;
     };
+
+    /// @brief GStreamer names the threads of the pipeline after its source, "preview:src"
+    static constexpr auto kSourceName = std::string_view{"preview"};
     struct StreamTarget {
         std::string host;
         std::string port;
@@ -29,15 +43,19 @@ public:
 public:
     explicit StreamContext(StreamType stream_type, const VideoFormat& video_format,
                            StreamTarget stream_target) noexcept
-        : video_format_{video_format},
-          stream_type_{stream_type},
-          stream_target_{std::move(stream_target)} {
+        : stream_type_{stream_type},
+          stream_target_{std::move(stream_target)},
+          video_format_{video_format} {
     }
 
     static auto check_support() noexcept -> std::expected<void, std::string_view>;
 
     auto open() noexcept -> std::expected<void, std::string>;
 
+    /// @brief
+    ///   Restarts the pipeline with another format, the running one is kept if that fails.
+    auto reopen(const VideoFormat&) noexcept -> std::expected<void, std::string>;
+
     auto opened() const noexcept -> bool;
 
     auto session_description_protocol(const std::string_view& local_ip) const noexcept
@@ -46,6 +64,7 @@ public:
     auto write(FrameRef frame) const noexcept -> void;
 
     auto video_format() const noexcept {
+        auto lock = std::scoped_lock{mutex_};
         return video_format_;
     }
 
@@ -58,14 +77,21 @@ public:
     }
 
     auto pipeline() const noexcept {
+        auto lock = std::scoped_lock{mutex_};
         return pipeline_;
     }
 
 private:
-    VideoFormat video_format_;
-    StreamType stream_type_;
-    StreamTarget stream_target_;
+    auto make_sender(const VideoFormat&, std::string& pipeline) const noexcept
+        -> std::expected<std::unique_ptr<cv::VideoWriter>, std::string>;
 
+    // Fixed for the lifetime of the context
+    const StreamType stream_type_;
+    const StreamTarget stream_target_;
+
+    // Swapped by `reopen`, guarded for the readers on other threads
+    mutable std::mutex mutex_;
+    VideoFormat video_format_;
     std::unique_ptr<cv::VideoWriter> sender_;
     std::string pipeline_;
 };
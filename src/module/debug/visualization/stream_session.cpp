@@ -4,17 +4,110 @@
 #include <ifaddrs.h>
 #include <netinet/in.h>
 
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <atomic>
-#include <boost/lockfree/spsc_queue.hpp>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <opencv2/core/mat.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sstream>
 #include <stop_token>
 #include <string>
 #include <thread>
+#include <unordered_map>
+
+#include "utility/clock.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/thread/execution.hpp"
+#include "utility/thread/mailbox.hpp"
 
 using namespace pingpong_tracker::debug;
 
+namespace {
+
+using CpuTime = std::chrono::nanoseconds;
+
+auto thread_cpu_time() noexcept -> CpuTime {
+    auto spec = timespec{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &spec);
+    return std::chrono::seconds{spec.tv_sec} + std::chrono::nanoseconds{spec.tv_nsec};
+}
+
+// CPU time of the encoder threads by thread id, GStreamer names its streaming thread after the
+// pipeline source and the threads an encoder starts from there inherit the name
+auto encoder_cpu_times() noexcept -> std::unordered_map<pid_t, CpuTime> {
+    static const auto tick = CpuTime{std::chrono::seconds{1}} / ::sysconf(_SC_CLK_TCK);
+    const auto prefix      = std::format("{}:", StreamContext::kSourceName);
+
+    auto times = std::unordered_map<pid_t, CpuTime>{};
+    auto error = std::error_code{};
+    auto tasks = std::filesystem::directory_iterator{"/proc/self/task", error};
+    for (; !error && tasks != std::filesystem::directory_iterator{}; tasks.increment(error)) {
+        const auto& task = *tasks;
+        const auto tid   = task.path().filename().string();
+        auto id          = pid_t{};
+        if (std::from_chars(tid.data(), tid.data() + tid.size(), id).ec != std::errc{}) {
+            continue;
+        }
+
+        auto name = std::string{};
+        std::getline(std::ifstream{task.path() / "comm"}, name);
+        if (!name.starts_with(prefix)) {
+            continue;
+        }
+
+        // utime and stime are the 12th and 13th fields after the parenthesized name
+        auto stat = std::string{};
+        std::getline(std::ifstream{task.path() / "stat"}, stat);
+        const auto fields = stat.rfind(')');
+        if (fields == std::string::npos) {
+            continue;
+        }
+        auto stream = std::istringstream{stat.substr(fields + 1)};
+        auto field  = std::string{};
+        for (int i = 0; i < 11; ++i) {
+            stream >> field;
+        }
+        auto user = 0L, system = 0L;
+        if (stream >> user >> system) {
+            times[id] = tick * (user + system);
+        }
+    }
+    return times;
+}
+
+// The encoder threads are sampled at most this often, and at least this often while idle
+constexpr auto kCpuInterval = std::chrono::seconds{1};
+
+}  // namespace
+
+auto StreamSession::Adaptation::smooth(double load, util::Clock::duration encoding,
+                                       int hz) noexcept -> double {
+    const auto period = 1.0 / std::max(hz, 1);
+    return load + kSmoothing * (std::chrono::duration<double>{encoding}.count() / period - load);
+}
+
+auto StreamSession::Adaptation::step(const VideoFormat& current, const VideoFormat& configured,
+                                     double load) const noexcept -> VideoFormat {
+    auto next = current;
+    if (load >= kBehind) {
+        next.quality = std::max(min_quality, current.quality - 10);
+        next.bitrate = std::max(min_bitrate, current.bitrate * 3 / 4);
+    } else if (load <= kAhead) {
+        next.quality = std::min(configured.quality, current.quality + 5);
+        next.bitrate = std::min(configured.bitrate, current.bitrate * 5 / 4);
+    }
+    return next;
+}
+
 struct StreamSession::Impl final {
 public:
     auto session_description_protocol() const noexcept -> std::expected<std::string, std::string> {
@@ -35,8 +128,7 @@ public:
         return *result;
     }
 
-    auto initialize(StreamType type, const StreamTarget& target, const VideoFormat& format) noexcept
-        -> std::expected<void, std::string> {
+    auto initialize(const Config& config) noexcept -> std::expected<void, std::string> {
         if (thread) {
             thread->request_stop();
             if (thread->joinable()) {
@@ -45,26 +137,36 @@ public:
             thread.reset();
         }
 
-        buffer.consume_all([](const cv::Mat&) {});
+        mailbox.clear();
+        is_opened.store(false);
 
-        context = std::make_unique<StreamContext>(type, format, target);
+        configured = config.format;
+        adaptation = config.adaptation;
+        context    = std::make_unique<StreamContext>(config.type, config.format, config.target);
 
         if (auto result = context->open(); !result) {
             return std::unexpected{result.error()};
         }
+        is_opened.store(true);
+        quality.set(encoder_setting(configured));
 
         thread = std::make_unique<std::jthread>(
             [this](const std::stop_token& token) { streaming_thread(token); });
         return {};
     }
 
+    // The streaming thread swaps the pipeline while adapting, callers only see this flag
     auto opened() const noexcept {
-        return context && context->opened();
+        return is_opened.load();
     }
 
-    auto push_frame(FrameRef frame) noexcept -> bool {
+    auto push_frame(FrameRef frame, Overlay overlay) noexcept -> bool {
         // Safe: cv::Mat refcount ensures data lifetime across threads
-        return buffer.push(frame);
+        // The new frame always goes in, it is the older pending one that gets skipped
+        if (!mailbox.put({frame, std::move(overlay), util::Clock::now()})) {
+            skipped.add();
+        }
+        return true;
     }
 
     void set_notifier(std::function<void(const std::string&)> f) {
@@ -72,28 +174,127 @@ public:
     }
 
 private:
+    struct Pending {
+        cv::Mat frame;
+        Overlay overlay;
+        util::Clock::time_point pushed;
+    };
+
+    auto notify(const std::string& msg) const -> void {
+        auto ptr = notifier.load();
+        if (ptr && *ptr) {
+            (*ptr)(msg);
+        }
+    }
+
     auto streaming_thread(const std::stop_token& token) noexcept -> void {
-        auto notify = [this](const std::string& msg) {
-            auto ptr = notifier.load();
-            if (ptr && *ptr) {
-                (*ptr)(msg);
-            }
-        };
+        util::execution().apply("streaming");
 
         notify("Streaming thread starts");
 
+        load        = 0.0;
+        last_change = util::Clock::now();
+        cpu_sample  = {.time = util::Clock::now(), .own = thread_cpu_time(), .encoders = {}};
+
+        // Sleeps until a frame arrives, a frame pushed meanwhile replaces the pending one. Wakes
+        // up for the CPU sample too, so an idle stream reports its usage going back to zero
         while (!token.stop_requested()) {
-            auto current_frame = cv::Mat{};
-            if (buffer.pop(current_frame)) {
-                if (context) {
-                    context->write(current_frame);
-                }
+            auto pending = mailbox.take_until(token, cpu_sample.time + kCpuInterval);
+            if (!pending) {
+                sample_cpu(util::Clock::now());
+                continue;
+            }
+            if (!context) {
+                continue;
             }
-            std::this_thread::yield();
+            const auto begin = util::Clock::now();
+            wait_latency.observe(begin - pending->pushed);
+
+            const auto& canvas = render(*pending);
+            const auto encode  = util::Clock::now();
+            render_latency.observe(encode - begin);
+
+            context->write(canvas);
+            const auto written = util::Clock::now();
+            write_latency.observe(written - encode);
+            streamed.add();
+
+            adapt(written - encode, written);
+            sample_cpu(written);
         }
         notify("Streaming thread stops");
     }
 
+    // The frame as it is encoded: at the stream size, overlays on a copy of the pushed pixels
+    auto render(const Pending& pending) noexcept -> const cv::Mat& {
+        const auto format = context->video_format();
+        const auto size   = cv::Size{format.w, format.h};
+        if (pending.frame.size() == size && !pending.overlay) {
+            return pending.frame;
+        }
+
+        if (pending.frame.size() == size) {
+            pending.frame.copyTo(canvas);
+        } else {
+            cv::resize(pending.frame, canvas, size, 0, 0, cv::INTER_AREA);
+        }
+        if (pending.overlay) {
+            pending.overlay(canvas);
+        }
+        return canvas;
+    }
+
+    // JPEG quality or H.264 bitrate, whichever the stream type encodes with
+    auto encoder_setting(const VideoFormat& format) const noexcept -> double {
+        return context->stream_type() == StreamType::RTP_H264 ? format.bitrate : format.quality;
+    }
+
+    auto adapt(util::Clock::duration encoding, util::Clock::time_point now) noexcept -> void {
+        if (!adaptation.enable) {
+            return;
+        }
+
+        const auto current = context->video_format();
+        load = Adaptation::smooth(load, encoding, current.hz);
+        if (now - last_change < adaptation.cooldown) {
+            return;
+        }
+
+        const auto next = adaptation.step(current, configured, load);
+        if (encoder_setting(next) == encoder_setting(current)) {
+            return;
+        }
+
+        last_change = now;
+        if (auto result = context->reopen(next); !result) {
+            notify(std::format("Failed to adapt the stream encoder: {}", result.error()));
+            return;
+        }
+        quality.set(encoder_setting(next));
+        notify(std::format("Stream encoder {} from {} to {}, encoding takes {:.0f}% of a frame",
+                           encoder_setting(next) < encoder_setting(current) ? "lowered" : "raised",
+                           encoder_setting(current), encoder_setting(next), 100.0 * load));
+    }
+
+    auto sample_cpu(util::Clock::time_point now) noexcept -> void {
+        if (now - cpu_sample.time < kCpuInterval) {
+            return;
+        }
+
+        auto sample =
+            CpuSample{.time = now, .own = thread_cpu_time(), .encoders = encoder_cpu_times()};
+
+        // A thread not seen before started within the interval, all of its time counts
+        auto spent = sample.own - cpu_sample.own;
+        for (const auto& [id, time] : sample.encoders) {
+            const auto previous = cpu_sample.encoders.find(id);
+            spent += time - (previous == cpu_sample.encoders.end() ? CpuTime{} : previous->second);
+        }
+        cpu.set(std::chrono::duration<double>{spent}.count()
+                / std::chrono::duration<double>{now - cpu_sample.time}.count());
+        cpu_sample = std::move(sample);
+    }
+
     struct NetworkInfo {
         in_addr_t address;
         in_addr_t netmask;
@@ -148,9 +349,41 @@ private:
 
 private:
     std::unique_ptr<StreamContext> context;
-
-    static constexpr auto buffer_capacity = std::size_t{100};
-    boost::lockfree::spsc_queue<cv::Mat, boost::lockfree::capacity<buffer_capacity>> buffer;
+    std::atomic<bool> is_opened{false};
+
+    // The format asked for, adaptation never goes above it
+    VideoFormat configured{};
+    Adaptation adaptation{};
+    double load = 0.0;
+    util::Clock::time_point last_change{};
+
+    struct CpuSample {
+        util::Clock::time_point time;
+        CpuTime own;
+        std::unordered_map<pid_t, CpuTime> encoders;
+    };
+    CpuSample cpu_sample{};
+
+    // Only the newest frame waits, a slow encoder skips frames instead of queueing them
+    util::Mailbox<Pending> mailbox;
+    // Reused by the streaming thread, the resize and overlays land here
+    cv::Mat canvas;
+
+    util::metrics::Counter& streamed = util::metrics::registry().counter(
+        "pingpong_stream_frames_total", "Frames written to the stream");
+    util::metrics::Counter& skipped = util::metrics::registry().counter(
+        "pingpong_stream_skipped_total", "Frames replaced by a newer one before being encoded");
+    util::metrics::Histogram& wait_latency = util::metrics::registry().histogram(
+        "pingpong_stream_wait_seconds", "From pushing a frame to the encoder taking it");
+    util::metrics::Histogram& render_latency = util::metrics::registry().histogram(
+        "pingpong_stream_render_seconds", "Time to resize a frame and draw its overlays");
+    util::metrics::Histogram& write_latency = util::metrics::registry().histogram(
+        "pingpong_stream_write_seconds", "Time to encode and send one frame");
+    util::metrics::Gauge& quality = util::metrics::registry().gauge(
+        "pingpong_stream_quality", "JPEG quality or H.264 bitrate the preview is encoded with");
+    util::metrics::Gauge& cpu = util::metrics::registry().gauge(
+        "pingpong_stream_cpu_cores",
+        "CPU time of the preview per second: resize, overlays and the encoder threads");
 
     std::atomic<std::shared_ptr<std::function<void(const std::string&)>>> notifier{
         std::make_shared<std::function<void(const std::string&)>>([](const std::string&) {})};
@@ -167,14 +400,14 @@ auto StreamSession::set_notifier(std::function<void(const std::string&)> f) noex
     pimpl->set_notifier(std::move(f));
 }
 auto StreamSession::open(const Config& config) noexcept -> std::expected<void, std::string> {
-    return pimpl->initialize(config.type, config.target, config.format);
+    return pimpl->initialize(config);
 }
 auto StreamSession::opened() const noexcept -> bool {
     return pimpl->opened();
 }
 
-auto StreamSession::push_frame(FrameRef frame) noexcept -> bool {
-    return pimpl->push_frame(frame);
+auto StreamSession::push_frame(FrameRef frame, Overlay overlay) noexcept -> bool {
+    return pimpl->push_frame(frame, std::move(overlay));
 }
 
 auto StreamSession::session_description_protocol() const noexcept
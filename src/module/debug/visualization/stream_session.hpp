@@ -1,6 +1,8 @@
 #pragma once
 #include <functional>
 
+#include "utility/clock.hpp"
+
 #include "stream_context.hpp"
 
 namespace pingpong_tracker::debug {
@@ -12,12 +14,48 @@ using FrameRef     = StreamContext::FrameRef;
 
 class StreamSession {
 public:
+    /// @brief
+    ///   Steps the encoder quality down while encoding a frame takes most of the frame period,
+    ///   and back up towards the configured one once it has room again.
+    /// @note
+    ///   - The load is the share of the frame period spent handing a frame to the encoder, it
+    ///     blocks once the encoder has fallen behind.
+    ///   - A change restarts the pipeline, `cooldown` keeps it from flapping.
+    struct Adaptation {
+        // Smoothed over about ten frames, lowered at 80% of a frame and raised below 40%
+        static constexpr auto kSmoothing = 0.1;
+        static constexpr auto kBehind    = 0.8;
+        static constexpr auto kAhead     = 0.4;
+
+        bool enable     = false;
+        int min_quality = 30;
+        int min_bitrate = 200;
+        util::Clock::duration cooldown{std::chrono::seconds{3}};
+
+        /// @brief The load after one more frame took `encoding` at `hz`
+        static auto smooth(double load, util::Clock::duration encoding, int hz) noexcept
+            -> double;
+
+        /// @brief
+        ///   The format to encode with at `load`, `current` itself while the load is within
+        ///   bounds.
+        /// @note
+        ///   - Behind: quality down by 10 and bitrate by a quarter, not below the minimums.
+        ///   - Ahead: quality up by 5 and bitrate by a quarter, not above `configured`.
+        auto step(const VideoFormat& current, const VideoFormat& configured,
+                  double load) const noexcept -> VideoFormat;
+    };
+
     struct Config {
         StreamTarget target;
         StreamType type;
         VideoFormat format;
+        Adaptation adaptation{};
     };
 
+    /// @brief Draws on the canvas about to be encoded, already at the stream size
+    using Overlay = std::function<void(cv::Mat& canvas)>;
+
 public:
     StreamSession() noexcept;
     ~StreamSession() noexcept;
@@ -33,7 +71,13 @@ public:
     auto open(const Config&) noexcept -> std::expected<void, std::string>;
     auto opened() const noexcept -> bool;
 
-    auto push_frame(FrameRef) noexcept -> bool;
+    /// @brief
+    ///   Hands the frame over to the streaming thread, the caller only pays a refcount.
+    /// @note
+    ///   - Frames of another size are resized to the stream format on the streaming thread.
+    ///   - The overlay runs there too, on a copy, and only for a frame that is encoded. The
+    ///     pushed frame itself is never written to.
+    auto push_frame(FrameRef, Overlay = {}) noexcept -> bool;
 
     auto session_description_protocol() const noexcept -> std::expected<std::string, std::string>;
 
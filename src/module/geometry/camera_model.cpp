@@ -0,0 +1,59 @@
+#include "camera_model.hpp"
+
+using namespace pingpong_tracker::geometry;
+
+CameraModel::CameraModel(Intrinsics intrinsics, Pose pose) noexcept
+    : intrinsics_{intrinsics}
+    , pose_{std::move(pose)} {
+    rotation_t_ = pose_.rotation.transpose();
+    center_     = -rotation_t_ * pose_.translation;
+}
+
+auto CameraModel::project(Vec3 const& world) const noexcept -> std::optional<Vec2> {
+    const Vec3 camera = pose_.rotation * world + pose_.translation;
+    if (camera.z() <= 0.0) {
+        return std::nullopt;
+    }
+    return distort(camera.head<2>() / camera.z());
+}
+
+auto CameraModel::distort(Vec2 const& normalized) const noexcept -> Vec2 {
+    const auto& [k1, k2, p1, p2, k3] = intrinsics_.distortion;
+
+    const auto x  = normalized.x();
+    const auto y  = normalized.y();
+    const auto r2 = x * x + y * y;
+
+    const auto radial = 1.0 + r2 * (k1 + r2 * (k2 + r2 * k3));
+    const auto xd     = x * radial + 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+    const auto yd     = y * radial + p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
+
+    return {intrinsics_.fx * xd + intrinsics_.cx, intrinsics_.fy * yd + intrinsics_.cy};
+}
+
+auto CameraModel::undistort(Vec2 const& pixel) const noexcept -> Vec2 {
+    const auto& [k1, k2, p1, p2, k3] = intrinsics_.distortion;
+
+    const auto xd = (pixel.x() - intrinsics_.cx) / intrinsics_.fx;
+    const auto yd = (pixel.y() - intrinsics_.cy) / intrinsics_.fy;
+
+    // Converges in a handful of iterations for the mild distortion of machine vision lenses
+    constexpr auto kIterations = 8;
+
+    auto x = xd;
+    auto y = yd;
+    for (int i = 0; i < kIterations; ++i) {
+        const auto r2     = x * x + y * y;
+        const auto radial = 1.0 + r2 * (k1 + r2 * (k2 + r2 * k3));
+        const auto dx     = 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+        const auto dy     = p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
+        x                 = (xd - dx) / radial;
+        y                 = (yd - dy) / radial;
+    }
+    return {x, y};
+}
+
+auto CameraModel::ray(Vec2 const& normalized) const noexcept -> Ray {
+    const Vec3 direction = rotation_t_ * Vec3{normalized.x(), normalized.y(), 1.0};
+    return Ray{.origin = center_, .direction = direction.normalized()};
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <optional>
+
+#include <eigen3/Eigen/Core>
+
+namespace pingpong_tracker::geometry {
+
+/// @brief
+///   Calibrated pinhole camera with Brown-Conrady distortion, the same model and coefficient
+///   order as OpenCV: [k1, k2, p1, p2, k3].
+/// @note
+///   - The pose maps world (table frame) points into the camera, X_c = R * X_w + t.
+///   - Only points are undistorted, frames are never remapped.
+class CameraModel {
+public:
+    using Vec2 = Eigen::Vector2d;
+    using Vec3 = Eigen::Vector3d;
+    using Mat3 = Eigen::Matrix3d;
+
+    struct Intrinsics {
+        double fx = 1.0;
+        double fy = 1.0;
+        double cx = 0.0;
+        double cy = 0.0;
+        std::array<double, 5> distortion{};
+    };
+
+    struct Pose {
+        Mat3 rotation    = Mat3::Identity();
+        Vec3 translation = Vec3::Zero();
+    };
+
+    struct Ray {
+        Vec3 origin;
+        // Unit length
+        Vec3 direction;
+    };
+
+    CameraModel() noexcept = default;
+    CameraModel(Intrinsics intrinsics, Pose pose) noexcept;
+
+    /// @brief Pixel of a world point, nullopt behind the camera
+    [[nodiscard]] auto project(Vec3 const& world) const noexcept -> std::optional<Vec2>;
+
+    /// @brief Normalised image coordinates (z = 1) of a distorted pixel
+    /// @note Fixed-point inversion of the distortion, the same scheme as cv::undistortPoints
+    [[nodiscard]] auto undistort(Vec2 const& pixel) const noexcept -> Vec2;
+
+    /// @brief Distorted pixel of normalised image coordinates
+    [[nodiscard]] auto distort(Vec2 const& normalized) const noexcept -> Vec2;
+
+    /// @brief World ray through normalised image coordinates
+    [[nodiscard]] auto ray(Vec2 const& normalized) const noexcept -> Ray;
+
+    [[nodiscard]] auto intrinsics() const noexcept -> Intrinsics const& {
+        return intrinsics_;
+    }
+    [[nodiscard]] auto pose() const noexcept -> Pose const& {
+        return pose_;
+    }
+    /// Camera centre in the world frame
+    [[nodiscard]] auto center() const noexcept -> Vec3 const& {
+        return center_;
+    }
+
+private:
+    Intrinsics intrinsics_{};
+    Pose pose_{};
+
+    // Cached inverse pose, R^T and -R^T * t
+    Mat3 rotation_t_ = Mat3::Identity();
+    Vec3 center_     = Vec3::Zero();
+};
+
+}  // namespace pingpong_tracker::geometry
@@ -0,0 +1,144 @@
+#include "monocular.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <eigen3/Eigen/Geometry>
+#include <eigen3/Eigen/SVD>
+
+using namespace pingpong_tracker::geometry;
+
+auto MonocularLocator::estimate_pose(CameraModel::Intrinsics const& intrinsics,
+                                     std::array<Vec2, 4> const& corners, double table_length,
+                                     double table_width)
+    -> std::expected<CameraModel::Pose, std::string> {
+    const auto half_length = 0.5 * table_length;
+    const auto half_width  = 0.5 * table_width;
+    const auto plane       = std::array<Vec2, 4>{
+        Vec2{-half_length, -half_width},
+        Vec2{half_length, -half_width},
+        Vec2{half_length, half_width},
+        Vec2{-half_length, half_width},
+    };
+
+    // Homography from the table plane to normalised image coordinates, by DLT
+    const auto camera = CameraModel{intrinsics, {}};
+
+    Eigen::Matrix<double, 8, 9> A;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const auto image = camera.undistort(corners[i]);
+        const auto X     = plane[i].x();
+        const auto Y     = plane[i].y();
+        const auto x     = image.x();
+        const auto y     = image.y();
+
+        const auto row = static_cast<Eigen::Index>(2 * i);
+        A.row(row) << X, Y, 1.0, 0.0, 0.0, 0.0, -x * X, -x * Y, -x;
+        A.row(row + 1) << 0.0, 0.0, 0.0, X, Y, 1.0, -y * X, -y * Y, -y;
+    }
+
+    const auto svd = Eigen::JacobiSVD<Eigen::Matrix<double, 8, 9>>{A, Eigen::ComputeFullV};
+    const Eigen::Matrix<double, 9, 1> h = svd.matrixV().col(8);
+
+    Mat3 H;
+    H << h(0), h(1), h(2), h(3), h(4), h(5), h(6), h(7), h(8);
+
+    // H ~ [r1 r2 t], the scale makes the rotation columns unit length
+    const auto norm1 = H.col(0).norm();
+    const auto norm2 = H.col(1).norm();
+    if (norm1 < 1e-12 || norm2 < 1e-12) {
+        return std::unexpected{"Degenerate table corners"};
+    }
+    auto scale = 2.0 / (norm1 + norm2);
+    if (H(2, 2) * scale < 0.0) {
+        // The table must be in front of the camera
+        scale = -scale;
+    }
+
+    Mat3 R;
+    R.col(0) = H.col(0) * scale;
+    R.col(1) = H.col(1) * scale;
+    R.col(2) = R.col(0).cross(R.col(1));
+
+    // Closest rotation to the noisy estimate
+    const auto polar = Eigen::JacobiSVD<Mat3>{R, Eigen::ComputeFullU | Eigen::ComputeFullV};
+    R                = polar.matrixU() * polar.matrixV().transpose();
+    if (R.determinant() < 0.0) {
+        return std::unexpected{"Table corners are mirrored, check their order"};
+    }
+
+    auto pose        = CameraModel::Pose{};
+    pose.rotation    = R;
+    pose.translation = H.col(2) * scale;
+    return pose;
+}
+
+MonocularLocator::MonocularLocator(CameraModel camera, Config config)
+    : camera_{std::move(camera)}
+    , config_{config} {
+    const auto& intrinsics = camera_.intrinsics();
+    focal_                 = 0.5 * (intrinsics.fx + intrinsics.fy);
+
+    const auto step = std::max(config_.lut_step, 1);
+    config_.lut_step = step;
+    lut_cols_        = config_.image_cols / step + 2;
+    lut_rows_        = config_.image_rows / step + 2;
+
+    lut_.resize(static_cast<std::size_t>(lut_cols_) * static_cast<std::size_t>(lut_rows_));
+    for (int row = 0; row < lut_rows_; ++row) {
+        for (int col = 0; col < lut_cols_; ++col) {
+            const auto pixel      = Vec2{static_cast<double>(col * step),
+                                              static_cast<double>(row * step)};
+            const auto normalized = camera_.undistort(pixel);
+            const auto direction  = camera_.ray(normalized).direction;
+
+            lut_[static_cast<std::size_t>(row * lut_cols_ + col)] = direction.cast<float>();
+        }
+    }
+}
+
+auto MonocularLocator::ray(Vec2 const& pixel) const noexcept -> Eigen::Vector3f {
+    const auto inverse_step = 1.0F / static_cast<float>(config_.lut_step);
+
+    const auto u = std::clamp(static_cast<float>(pixel.x()) * inverse_step, 0.0F,
+                              static_cast<float>(lut_cols_ - 2));
+    const auto v = std::clamp(static_cast<float>(pixel.y()) * inverse_step, 0.0F,
+                              static_cast<float>(lut_rows_ - 2));
+
+    const auto col = std::min(static_cast<int>(u), lut_cols_ - 2);
+    const auto row = std::min(static_cast<int>(v), lut_rows_ - 2);
+    const auto fu  = u - static_cast<float>(col);
+    const auto fv  = v - static_cast<float>(row);
+
+    const auto* top    = &lut_[static_cast<std::size_t>(row * lut_cols_ + col)];
+    const auto* bottom = top + lut_cols_;
+
+    // Unit vectors a few pixels apart, the blend stays unit length to ~1e-6
+    return (1.0F - fv) * ((1.0F - fu) * top[0] + fu * top[1])
+         + fv * ((1.0F - fu) * bottom[0] + fu * bottom[1]);
+}
+
+auto MonocularLocator::locate(Vec2 const& pixel, double radius) const noexcept
+    -> std::optional<Estimate> {
+    if (radius <= 0.0) {
+        return std::nullopt;
+    }
+
+    // A sphere of radius R at distance d has an angular radius asin(R / d), its image radius
+    // is f * tan of that, so d = R * sqrt(r^2 + f^2) / r
+    const auto ball_radius = 0.5 * config_.ball_diameter;
+    const auto distance    = ball_radius * std::sqrt(radius * radius + focal_ * focal_) / radius;
+
+    const Vec3 direction = ray(pixel).cast<double>();
+
+    auto estimate     = Estimate{};
+    estimate.position = camera_.center() + distance * direction;
+
+    // d ~ f R / r, so a radius error scales like d^2 / (f R), lateral errors like d / f
+    const auto radial  = distance * distance / (focal_ * ball_radius) * config_.radius_noise;
+    const auto lateral = distance / focal_ * config_.pixel_noise;
+
+    const Mat3 along    = direction * direction.transpose();
+    estimate.covariance = radial * radial * along + lateral * lateral * (Mat3::Identity() - along);
+    return estimate;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <expected>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <eigen3/Eigen/Core>
+
+#include "module/geometry/camera_model.hpp"
+
+namespace pingpong_tracker::geometry {
+
+/// @brief
+///   Approximate 3D ball positions from a single calibrated camera.
+/// @note
+///   - The camera pose comes from the homography between the table surface and its four
+///     corners in the image, computed once at startup.
+///   - The direction of a detection is read from a precomputed ray table in the table frame,
+///     its distance from the apparent radius and the known ball diameter. A lookup is a
+///     bilinear blend of four table entries plus a handful of multiply-adds.
+///   - Depth from radius is coarse, the covariance is accordingly stretched along the ray.
+class MonocularLocator {
+public:
+    using Vec2 = CameraModel::Vec2;
+    using Vec3 = CameraModel::Vec3;
+    using Mat3 = CameraModel::Mat3;
+
+    struct Config {
+        double ball_diameter = 0.04;
+
+        // Standard deviations of the detected centre and radius, pixels
+        double pixel_noise  = 1.0;
+        double radius_noise = 0.5;
+
+        // Spacing of the ray table, pixels
+        int lut_step   = 4;
+        int image_cols = 1440;
+        int image_rows = 1080;
+    };
+
+    struct Estimate {
+        Vec3 position;
+        Mat3 covariance;
+    };
+
+    /// @brief
+    ///   Camera pose from the pixels of the table corners.
+    /// @note
+    ///   - Corners in the order (-L/2, -W/2), (L/2, -W/2), (L/2, W/2), (-L/2, W/2) of the table
+    ///     frame, x along the length, y across, z up.
+    static auto estimate_pose(CameraModel::Intrinsics const& intrinsics,
+                              std::array<Vec2, 4> const& corners, double table_length,
+                              double table_width)
+        -> std::expected<CameraModel::Pose, std::string>;
+
+    MonocularLocator(CameraModel camera, Config config);
+
+    /// @brief Ball centre in the table frame, nullopt for a degenerate radius
+    [[nodiscard]] auto locate(Vec2 const& pixel, double radius) const noexcept
+        -> std::optional<Estimate>;
+
+    [[nodiscard]] auto camera() const noexcept -> CameraModel const& {
+        return camera_;
+    }
+
+private:
+    auto ray(Vec2 const& pixel) const noexcept -> Eigen::Vector3f;
+
+    CameraModel camera_;
+    Config config_;
+
+    double focal_ = 1.0;
+
+    int lut_cols_ = 0;
+    int lut_rows_ = 0;
+    // Unit rays in the table frame on a grid of `lut_step` pixels
+    std::vector<Eigen::Vector3f> lut_;
+};
+
+}  // namespace pingpong_tracker::geometry
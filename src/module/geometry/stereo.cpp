@@ -0,0 +1,145 @@
+#include "stereo.hpp"
+
+#include <cmath>
+#include <limits>
+
+using namespace pingpong_tracker::geometry;
+
+StereoTriangulator::StereoTriangulator(CameraModel left, CameraModel right, Config config) noexcept
+    : left_{std::move(left)}
+    , right_{std::move(right)}
+    , config_{config} {
+}
+
+auto StereoTriangulator::triangulate(Vec2 const& left, Vec2 const& right) const noexcept
+    -> std::optional<Point> {
+    const auto left_normalized  = left_.undistort(left);
+    const auto right_normalized = right_.undistort(right);
+
+    const auto point = midpoint(left_normalized, right_normalized);
+    if (!point) {
+        return std::nullopt;
+    }
+    return Point{
+        .position   = point->position,
+        .covariance = covariance(left_normalized, right_normalized, point->position),
+        .left       = 0,
+        .right      = 0,
+        .cost       = score(*point),
+    };
+}
+
+auto StereoTriangulator::match(std::span<const Vec2> left, std::span<const Vec2> right,
+                               std::vector<Point>& output) -> void {
+    output.clear();
+
+    left_normalized_.clear();
+    for (const auto& pixel : left) {
+        left_normalized_.push_back(left_.undistort(pixel));
+    }
+    right_normalized_.clear();
+    for (const auto& pixel : right) {
+        right_normalized_.push_back(right_.undistort(pixel));
+    }
+
+    const auto rows = left.size();
+    const auto cols = right.size();
+
+    constexpr auto kRejected = std::numeric_limits<double>::infinity();
+    cost_.resize(rows * cols);
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            const auto point   = midpoint(left_normalized_[r], right_normalized_[c]);
+            cost_[r * cols + c] = point ? score(*point) : kRejected;
+        }
+    }
+
+    const auto row_to_col =
+        assignment_.solve(cost_, rows, cols, config_.gate_threshold, config_.greedy_limit);
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        const auto c = row_to_col[r];
+        if (c == util::Assignment::npos) {
+            continue;
+        }
+        const auto point = midpoint(left_normalized_[r], right_normalized_[c]);
+        output.push_back(Point{
+            .position   = point->position,
+            .covariance = covariance(left_normalized_[r], right_normalized_[c], point->position),
+            .left       = r,
+            .right      = c,
+            .cost       = cost_[r * cols + c],
+        });
+    }
+}
+
+auto StereoTriangulator::midpoint(Vec2 const& left, Vec2 const& right) const noexcept
+    -> std::optional<Midpoint> {
+    const auto l = left_.ray(left);
+    const auto r = right_.ray(right);
+
+    // Closest points o_l + s d_l and o_r + t d_r of two lines with unit directions
+    const Vec3 w     = l.origin - r.origin;
+    const auto b     = l.direction.dot(r.direction);
+    const auto d     = l.direction.dot(w);
+    const auto e     = r.direction.dot(w);
+    const auto denom = 1.0 - b * b;
+    if (denom < 1e-12) {
+        // Parallel rays
+        return std::nullopt;
+    }
+
+    const auto s = (b * e - d) / denom;
+    const auto t = (e - b * d) / denom;
+    if (s < config_.min_depth || t < config_.min_depth) {
+        return std::nullopt;
+    }
+
+    const Vec3 p = l.origin + s * l.direction;
+    const Vec3 q = r.origin + t * r.direction;
+    return Midpoint{
+        .position    = 0.5 * (p + q),
+        .gap         = (p - q).norm(),
+        .depth_left  = s,
+        .depth_right = t,
+    };
+}
+
+auto StereoTriangulator::score(Midpoint const& point) const noexcept -> double {
+    // A pixel of noise moves a ray by about depth / f metres at the point
+    const auto left_sigma  = point.depth_left / left_.intrinsics().fx;
+    const auto right_sigma = point.depth_right / right_.intrinsics().fx;
+    const auto variance =
+        config_.pixel_noise * config_.pixel_noise
+        * (left_sigma * left_sigma + right_sigma * right_sigma);
+    return point.gap * point.gap / variance;
+}
+
+auto StereoTriangulator::covariance(Vec2 const& left, Vec2 const& right,
+                                    Vec3 const& position) const noexcept -> Mat3 {
+    constexpr auto kDelta = 1e-6;
+
+    // Pixel noise in normalised coordinates of each input
+    const auto noise   = config_.pixel_noise;
+    const double sigma[4]{
+        noise / left_.intrinsics().fx,
+        noise / left_.intrinsics().fy,
+        noise / right_.intrinsics().fx,
+        noise / right_.intrinsics().fy,
+    };
+
+    Mat3 result = Mat3::Zero();
+    for (int i = 0; i < 4; ++i) {
+        Vec2 l = left;
+        Vec2 r = right;
+        (i < 2 ? l : r)[i % 2] += kDelta;
+
+        const auto moved = midpoint(l, r);
+        if (!moved) {
+            continue;
+        }
+        const Vec3 column = (moved->position - position) * (sigma[i] / kDelta);
+        result += column * column.transpose();
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <eigen3/Eigen/Core>
+
+#include "module/geometry/camera_model.hpp"
+#include "utility/math/assignment.hpp"
+
+namespace pingpong_tracker::geometry {
+
+/// @brief
+///   Triangulates detections of two synchronised, calibrated cameras into world points.
+/// @note
+///   - Closed-form midpoint of the two viewing rays, the gap between them is the epipolar
+///     residual in metres.
+///   - The covariance propagates isotropic pixel noise through the Jacobian of the midpoint,
+///     taken by finite differences on the normalised coordinates.
+///   - With several candidates per view, every pair is scored by its gap normalised by the
+///     gap pixel noise alone would cause, and the gated pairs go through `util::Assignment`.
+class StereoTriangulator {
+public:
+    using Vec2 = CameraModel::Vec2;
+    using Vec3 = CameraModel::Vec3;
+    using Mat3 = CameraModel::Mat3;
+
+    struct Config {
+        // Standard deviation of a detected centre, pixels
+        double pixel_noise = 1.0;
+        // Squared normalised ray gap, chi-square quantile for 1 degree of freedom
+        double gate_threshold = 9.0;
+        // Points closer than this to either camera are rejected, metres
+        double min_depth = 0.1;
+
+        std::size_t greedy_limit = 4;
+    };
+
+    struct Point {
+        Vec3 position;
+        Mat3 covariance;
+        std::size_t left;
+        std::size_t right;
+        // Squared normalised ray gap
+        double cost;
+    };
+
+    StereoTriangulator(CameraModel left, CameraModel right, Config config) noexcept;
+
+    /// @brief Triangulates a single pair of distorted pixels
+    [[nodiscard]] auto triangulate(Vec2 const& left, Vec2 const& right) const noexcept
+        -> std::optional<Point>;
+
+    /// @brief Matches candidates of both views and triangulates the accepted pairs
+    auto match(std::span<const Vec2> left, std::span<const Vec2> right,
+               std::vector<Point>& output) -> void;
+
+    [[nodiscard]] auto left() const noexcept -> CameraModel const& {
+        return left_;
+    }
+    [[nodiscard]] auto right() const noexcept -> CameraModel const& {
+        return right_;
+    }
+
+private:
+    struct Midpoint {
+        Vec3 position;
+        double gap;
+        double depth_left;
+        double depth_right;
+    };
+
+    auto midpoint(Vec2 const& left, Vec2 const& right) const noexcept -> std::optional<Midpoint>;
+    auto score(Midpoint const& point) const noexcept -> double;
+    auto covariance(Vec2 const& left, Vec2 const& right, Vec3 const& position) const noexcept
+        -> Mat3;
+
+    CameraModel left_;
+    CameraModel right_;
+    Config config_;
+
+    std::vector<Vec2> left_normalized_;
+    std::vector<Vec2> right_normalized_;
+    std::vector<double> cost_;
+    util::Assignment assignment_;
+};
+
+}  // namespace pingpong_tracker::geometry
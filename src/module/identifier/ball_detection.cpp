@@ -1,19 +1,86 @@
 #include "ball_detection.hpp"
 
+#include <cstdint>
+
+#include "module/identifier/heatmap_net.hpp"
 #include "module/identifier/model.hpp"
+#include "utility/clock.hpp"
+#include "utility/metrics/metrics.hpp"
 
 namespace pingpong_tracker::identifier {
 
 struct BallDetection::Impl {
+    enum class Backend : std::uint8_t {
+        YOLO,
+        HEATMAP,
+    };
+
+    Backend backend = Backend::YOLO;
+
     OpenVinoNet openvino_net;
+    HeatmapNet heatmap_net;
+
+    util::metrics::Histogram& latency = util::metrics::registry().histogram(
+        "pingpong_identify_latency_seconds", "From submitting a frame to its detections");
+    util::metrics::Counter& detections = util::metrics::registry().counter(
+        "pingpong_identify_detections_total", "Balls detected");
+    util::metrics::Counter& errors = util::metrics::registry().counter(
+        "pingpong_identify_errors_total", "Frames the detector failed on");
+
+    auto record(util::Clock::time_point begin, const Result& result) noexcept -> void {
+        latency.observe(util::Clock::now() - begin);
+        if (result.has_value()) {
+            detections.add(result->size());
+        } else {
+            errors.add();
+        }
+    }
+
+    auto initialize(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> try {
+        auto backend_name = std::string{"yolo"};
+        if (yaml["backend"]) {
+            backend_name = yaml["backend"].as<std::string>();
+        }
+
+        /*  */ if (backend_name == "yolo") {
+            backend = Backend::YOLO;
+            return openvino_net.configure(yaml);
+        } else if (backend_name == "heatmap") {
+            backend = Backend::HEATMAP;
+            return heatmap_net.configure(yaml["heatmap"]);
+        }
+        return std::unexpected{"Unknown identifier backend: " + backend_name};
 
-    auto initialize(const YAML::Node& yaml) noexcept {
-        return openvino_net.configure(yaml);
+    } catch (const std::exception& e) {
+        return std::unexpected{e.what()};
     }
 
-    auto sync_detect(const Image& image) noexcept
-        -> std::expected<std::vector<Ball2D>, std::string> {
-        return openvino_net.sync_infer(image);
+    auto sync_detect(const Image& image) noexcept -> Result {
+        const auto begin = util::Clock::now();
+        auto result      = infer(image);
+        record(begin, result);
+        return result;
+    }
+
+    auto infer(const Image& image) noexcept -> Result {
+        switch (backend) {
+            case Backend::YOLO:
+                return openvino_net.sync_infer(image);
+            case Backend::HEATMAP:
+                return heatmap_net.sync_infer(image);
+        }
+        return std::unexpected{"unreachable"};
+    }
+
+    auto async_detect(const Image& image, Callback callback) noexcept -> void {
+        switch (backend) {
+            case Backend::YOLO:
+                openvino_net.async_infer(image, std::move(callback));
+                return;
+            case Backend::HEATMAP:
+                heatmap_net.async_infer(image, std::move(callback));
+                return;
+        }
     }
 };
 
@@ -29,9 +96,17 @@ auto BallDetection::initialize(const YAML::Node& yaml) noexcept
     return pimpl_->initialize(yaml);
 }
 
-auto BallDetection::sync_detect(const Image& image) noexcept
-    -> std::expected<std::vector<Ball2D>, std::string> {
+auto BallDetection::sync_detect(const Image& image) noexcept -> Result {
     return pimpl_->sync_detect(image);
 }
 
+auto BallDetection::async_detect(const Image& image, Callback callback) noexcept -> void {
+    pimpl_->async_detect(image, std::move(callback));
+}
+
+auto BallDetection::record(util::Clock::time_point submitted, const Result& result) noexcept
+    -> void {
+    pimpl_->record(submitted, result);
+}
+
 }  // namespace pingpong_tracker::identifier
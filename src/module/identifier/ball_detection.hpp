@@ -2,22 +2,75 @@
 
 #include <yaml-cpp/node/node.h>
 
+#include <coroutine>
 #include <expected>
+#include <functional>
 #include <vector>
 
 #include "utility/ball/ball.hpp"
+#include "utility/clock.hpp"
+#include "utility/coroutine/executor.hpp"
 #include "utility/image/image.hpp"
 #include "utility/pimpl.hpp"
 
 namespace pingpong_tracker::identifier {
 
+/// @brief
+///   Ball detector facade, the backend is picked by the `backend` key:
+///   - "yolo": box regression through `OpenVinoNet`, configured by the node itself.
+///   - "heatmap": multi-frame keypoint model through `HeatmapNet`, configured by `heatmap`.
 class BallDetection {
     PINGPONG_TRACKER_PIMPL_DEFINITION(BallDetection)
 
 public:
+    using Result   = std::expected<std::vector<Ball2D>, std::string>;
+    using Callback = std::function<void(Result)>;
+
     BallDetection();
     auto initialize(const YAML::Node&) noexcept -> std::expected<void, std::string>;
-    auto sync_detect(const Image&) noexcept -> std::expected<std::vector<Ball2D>, std::string>;
+    auto sync_detect(const Image&) noexcept -> Result;
+
+    /// @note
+    ///   - `callback` runs on an inference thread, heatmap frames complete in submission order.
+    ///   - `callback` is handed to the backend as is, it reports the frame to `record` itself.
+    auto async_detect(const Image&, Callback) noexcept -> void;
+
+    /// @brief Feeds the detector metrics with a frame submitted at `submitted` that just completed
+    auto record(util::Clock::time_point submitted, const Result&) noexcept -> void;
+
+    struct DetectAwaiter : util::Executor::Operation {
+        BallDetection& detection;
+        const Image& image;
+        util::Executor& executor;
+        std::coroutine_handle<> continuation{};
+        Result result{std::unexpected{"Nothing here"}};
+        util::Clock::time_point submitted{};
+
+        static constexpr auto await_ready() noexcept {
+            return false;
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> void {
+            continuation = awaiting;
+            function     = [](Operation* self) noexcept {
+                static_cast<DetectAwaiter*>(self)->continuation.resume();
+            };
+            // Capturing only `this` keeps the callback in std::function's inline storage
+            submitted = util::Clock::now();
+            detection.async_detect(image, [this](Result detected) {
+                detection.record(submitted, detected);
+                result = std::move(detected);
+                executor.post(this);
+            });
+        }
+        auto await_resume() noexcept -> Result {
+            return std::move(result);
+        }
+    };
+
+    [[nodiscard]] auto await_detect(const Image& image, util::Executor& executor) noexcept
+        -> DetectAwaiter {
+        return DetectAwaiter{{}, *this, image, executor};
+    }
 };
 
 }  // namespace pingpong_tracker::identifier
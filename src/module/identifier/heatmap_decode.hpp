@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace pingpong_tracker::identifier {
+
+struct HeatmapPeak {
+    float x{0};
+    float y{0};
+    float score{0};
+};
+
+/// @brief
+///   Local-maximum peak decoder for single-channel heatmaps.
+/// @note
+///   - Rows are processed through a rolling window of three horizontal 3-tap maxima, so every
+///     inner loop is a branch-free element-wise max/compare that the compiler vectorizes.
+///   - Candidates are counted per block first, only blocks holding a peak are scanned again and
+///     only the peaks themselves pay for sub-pixel refinement.
+///   - Scratch buffers are kept between calls, decoding does not allocate in steady state.
+class HeatmapDecoder {
+public:
+    struct Options {
+        float threshold        = 0.5F;
+        float min_distance     = 4.0F;
+        std::size_t max_peaks  = 16;
+    };
+
+    auto decode(std::span<const float> heatmap, int rows, int cols, const Options& options,
+                std::vector<HeatmapPeak>& peaks) -> void {
+        assert(heatmap.size() >= static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols));
+        peaks.clear();
+        if (rows <= 0 || cols <= 0) {
+            return;
+        }
+
+        const auto width = static_cast<std::size_t>(cols);
+        prepare(width);
+
+        auto row_at = [&](int r) { return heatmap.data() + static_cast<std::size_t>(r) * width; };
+
+        // Rolling horizontal maxima of rows r-1, r and r+1
+        auto* above  = horizontal_[0].data();
+        auto* center = horizontal_[1].data();
+        auto* below  = horizontal_[2].data();
+
+        std::fill_n(above, width, kLowest);
+        horizontal_max(row_at(0), center, width);
+
+        for (int r = 0; r < rows; ++r) {
+            if (r + 1 < rows) {
+                horizontal_max(row_at(r + 1), below, width);
+            } else {
+                std::fill_n(below, width, kLowest);
+            }
+
+            const auto* values   = row_at(r);
+            const auto threshold = options.threshold;
+
+            // Block-wise candidate count is a pure reduction, it vectorizes and stays branch-free,
+            // only blocks containing a peak are rescanned
+            for (std::size_t begin = 0; begin < width; begin += kBlock) {
+                const auto end = std::min(begin + kBlock, width);
+
+                auto hits = 0;
+                for (std::size_t c = begin; c < end; ++c) {
+                    const auto neighborhood = std::max(std::max(above[c], center[c]), below[c]);
+                    hits += static_cast<int>(values[c] >= neighborhood)
+                          & static_cast<int>(values[c] >= threshold);
+                }
+                if (hits == 0) [[likely]] {
+                    continue;
+                }
+
+                for (std::size_t c = begin; c < end; ++c) {
+                    const auto neighborhood = std::max(std::max(above[c], center[c]), below[c]);
+                    if (values[c] >= neighborhood && values[c] >= threshold) {
+                        peaks.push_back(refine(heatmap, rows, cols, r, static_cast<int>(c)));
+                    }
+                }
+            }
+
+            // Rotate without copying
+            auto* recycled = above;
+            above          = center;
+            center         = below;
+            below          = recycled;
+        }
+
+        suppress(options, peaks);
+    }
+
+private:
+    static constexpr auto kLowest = std::numeric_limits<float>::lowest();
+    static constexpr auto kBlock  = std::size_t{64};
+
+    std::vector<float> horizontal_[3];
+
+    auto prepare(std::size_t width) -> void {
+        for (auto& buffer : horizontal_) {
+            buffer.resize(width);
+        }
+    }
+
+    static auto horizontal_max(const float* row, float* out, std::size_t width) noexcept -> void {
+        if (width == 1) {
+            out[0] = row[0];
+            return;
+        }
+        out[0] = std::max(row[0], row[1]);
+        for (std::size_t c = 1; c + 1 < width; ++c) {
+            out[c] = std::max(std::max(row[c - 1], row[c]), row[c + 1]);
+        }
+        out[width - 1] = std::max(row[width - 2], row[width - 1]);
+    }
+
+    /// Parabola through the log-values, exact for Gaussian-shaped peaks
+    static auto subpixel_offset(float prev, float peak, float next) noexcept -> float {
+        constexpr auto kFloor = 1e-6F;
+        const auto l = std::log(std::max(prev, kFloor));
+        const auto c = std::log(std::max(peak, kFloor));
+        const auto r = std::log(std::max(next, kFloor));
+
+        const auto curvature = l - 2.0F * c + r;
+        if (curvature >= 0.0F) {
+            return 0.0F;
+        }
+        return std::clamp(0.5F * (l - r) / curvature, -0.5F, 0.5F);
+    }
+
+    static auto refine(std::span<const float> heatmap, int rows, int cols, int r, int c) noexcept
+        -> HeatmapPeak {
+        auto at = [&](int y, int x) {
+            y = std::clamp(y, 0, rows - 1);
+            x = std::clamp(x, 0, cols - 1);
+            return heatmap[static_cast<std::size_t>(y) * static_cast<std::size_t>(cols)
+                           + static_cast<std::size_t>(x)];
+        };
+
+        // Peaks on the border have only one neighbour per axis, they are not refined
+        const auto peak = at(r, c);
+        const auto dx   = (c > 0 && c + 1 < cols)
+                            ? subpixel_offset(at(r, c - 1), peak, at(r, c + 1))
+                            : 0.0F;
+        const auto dy   = (r > 0 && r + 1 < rows)
+                            ? subpixel_offset(at(r - 1, c), peak, at(r + 1, c))
+                            : 0.0F;
+
+        return HeatmapPeak{
+            .x     = static_cast<float>(c) + dx,
+            .y     = static_cast<float>(r) + dy,
+            .score = peak,
+        };
+    }
+
+    /// Plateaus and neighbouring maxima are merged, strongest first
+    static auto suppress(const Options& options, std::vector<HeatmapPeak>& peaks) -> void {
+        std::sort(peaks.begin(), peaks.end(),
+                  [](const auto& a, const auto& b) { return a.score > b.score; });
+
+        const auto min_distance_sq = options.min_distance * options.min_distance;
+
+        auto kept = std::size_t{0};
+        for (std::size_t i = 0; i < peaks.size() && kept < options.max_peaks; ++i) {
+            auto duplicated = false;
+            for (std::size_t j = 0; j < kept; ++j) {
+                const auto dx = peaks[i].x - peaks[j].x;
+                const auto dy = peaks[i].y - peaks[j].y;
+                if (dx * dx + dy * dy < min_distance_sq) {
+                    duplicated = true;
+                    break;
+                }
+            }
+            if (!duplicated) {
+                peaks[kept++] = peaks[i];
+            }
+        }
+        peaks.resize(kept);
+    }
+};
+
+}  // namespace pingpong_tracker::identifier
@@ -0,0 +1,379 @@
+#include "heatmap_net.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <opencv2/imgproc.hpp>
+#include <openvino/runtime/compiled_model.hpp>
+#include <openvino/runtime/core.hpp>
+#include <span>
+#include <tuple>
+
+#include "module/identifier/heatmap_decode.hpp"
+#include "utility/image/image.details.hpp"
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::identifier {
+
+namespace util = pingpong_tracker::util;
+
+struct HeatmapNet::Impl {
+    static constexpr int kChannels = 3;
+
+    struct Config : util::SerializableMixin {
+        std::string model_location{"models/tracknet.onnx"};
+        std::string infer_device{"AUTO"};
+
+        int input_rows = 288;
+        int input_cols = 512;
+        int frames     = 3;
+
+        float score_threshold = 0.5F;
+        float min_distance    = 8.0F;
+        // Heatmaps carry no size, reported radius in source pixels
+        float ball_radius     = 8.0F;
+
+        constexpr static std::tuple kMetas{
+            // clang-format off
+            "model_location",           &Config::model_location,
+            "infer_device",             &Config::infer_device,
+            "input_rows",               &Config::input_rows,
+            "input_cols",               &Config::input_cols,
+            "frames",                   &Config::frames,
+            "score_threshold",          &Config::score_threshold,
+            "min_distance",             &Config::min_distance,
+            "ball_radius",              &Config::ball_radius,
+            // clang-format on
+        };
+    } config;
+
+    struct PreprocessInfo {
+        float scale;
+        float pad_x;
+        float pad_y;
+    };
+
+    ov::Core openvino_core;
+    ov::CompiledModel openvino_model;
+    ov::InferRequest request;
+
+    // Mirrored ring of 2N frame slots: a frame written into slot k is also written into slot
+    // k + N, so the newest N frames are always contiguous starting at `head`
+    std::vector<float> ring;
+    std::size_t head    = 0;
+    std::size_t written = 0;
+
+    cv::Mat resized;
+    cv::Mat letterboxed;
+    cv::Mat normalized;
+
+    HeatmapDecoder decoder;
+    std::vector<HeatmapPeak> peaks;
+
+    // Frames waiting for the request, the pixels are held until they are preprocessed
+    struct Pending {
+        cv::Mat frame;
+        Callback callback;
+    };
+    std::deque<Pending> queue;
+    PreprocessInfo running_info{};
+    Callback running_callback;
+    bool busy     = false;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable idle;
+
+    Impl() = default;
+    Impl(const Impl&)            = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    // The request must not outlive its owner while OpenVINO still runs it
+    ~Impl() noexcept {
+        auto lock = std::unique_lock{mutex};
+        stopping  = true;
+        queue.clear();
+        idle.wait(lock, [this] { return !busy; });
+    }
+
+    auto slot_size() const noexcept -> std::size_t {
+        return static_cast<std::size_t>(kChannels) * static_cast<std::size_t>(config.input_rows)
+             * static_cast<std::size_t>(config.input_cols);
+    }
+
+    auto slot(std::size_t index) noexcept -> float* {
+        return ring.data() + index * slot_size();
+    }
+
+    auto configure(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+        auto result = config.serialize(yaml);
+        if (!result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        if (config.frames <= 0 || config.input_rows <= 0 || config.input_cols <= 0) {
+            return std::unexpected{"Heatmap frames and input size must be positive"};
+        }
+
+        auto lock = std::scoped_lock{mutex};
+        ring.assign(2 * static_cast<std::size_t>(config.frames) * slot_size(), 0.0F);
+        head    = 0;
+        written = 0;
+
+        return compile_openvino_model();
+    }
+
+    auto compile_openvino_model() noexcept -> std::expected<void, std::string> try {
+        auto origin_model = openvino_core.read_model(config.model_location);
+        if (!origin_model) {
+            return std::unexpected{"Empty model resource was loaded from openvino core"};
+        }
+
+        const auto performance = ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY);
+        openvino_model = openvino_core.compile_model(origin_model, config.infer_device, performance);
+        request        = openvino_model.create_infer_request();
+        request.set_callback([this](const std::exception_ptr& error) { complete(error); });
+        return {};
+
+    } catch (const std::runtime_error& e) {
+        return std::unexpected{std::string{"Failed to load model | "} + e.what()};
+
+    } catch (...) {
+        return std::unexpected{"Failed to load model caused by unknown exception"};
+    }
+
+    // Frames already queued keep their place, the history restarts with the next one pushed
+    auto reset() noexcept -> void {
+        auto lock = std::scoped_lock{mutex};
+        head      = 0;
+        written   = 0;
+    }
+
+    /// Letterbox, BGR to planar RGB and [0, 1] scaling, written straight into `target`
+    auto preprocess(const cv::Mat& origin, float* target) -> PreprocessInfo {
+        const auto input_w = static_cast<float>(config.input_cols);
+        const auto input_h = static_cast<float>(config.input_rows);
+
+        const auto scale = std::min(input_w / static_cast<float>(origin.cols),
+                                    input_h / static_cast<float>(origin.rows));
+        const auto new_w = static_cast<int>(static_cast<float>(origin.cols) * scale);
+        const auto new_h = static_cast<int>(static_cast<float>(origin.rows) * scale);
+
+        const auto pad_left = (config.input_cols - new_w) / 2;
+        const auto pad_top  = (config.input_rows - new_h) / 2;
+
+        cv::resize(origin, resized, {new_w, new_h});
+        letterboxed.create(config.input_rows, config.input_cols, CV_8UC3);
+        letterboxed.setTo(cv::Scalar::all(0));
+        resized.copyTo(letterboxed(cv::Rect{pad_left, pad_top, new_w, new_h}));
+        letterboxed.convertTo(normalized, CV_32FC3, 1.0 / 255.0);
+
+        // cv::split keeps preallocated outputs, BGR lands in the R, G, B planes reversed
+        const auto plane = static_cast<std::size_t>(config.input_rows)
+                         * static_cast<std::size_t>(config.input_cols);
+        auto planes = std::array{
+            cv::Mat{config.input_rows, config.input_cols, CV_32FC1, target + 2 * plane},
+            cv::Mat{config.input_rows, config.input_cols, CV_32FC1, target + plane},
+            cv::Mat{config.input_rows, config.input_cols, CV_32FC1, target},
+        };
+        cv::split(normalized, planes.data());
+
+        return PreprocessInfo{
+            .scale = scale,
+            .pad_x = static_cast<float>(pad_left),
+            .pad_y = static_cast<float>(pad_top),
+        };
+    }
+
+    auto push_frame(const cv::Mat& origin) -> PreprocessInfo {
+        const auto frames = static_cast<std::size_t>(config.frames);
+        const auto bytes  = slot_size() * sizeof(float);
+
+        auto* primary = slot(head);
+        auto info     = preprocess(origin, primary);
+        std::memcpy(slot(head + frames), primary, bytes);
+
+        // Until the history is full, the first frame stands in for the missing ones
+        if (written == 0) {
+            for (std::size_t i = 0; i < 2 * frames; ++i) {
+                if (i != head && i != head + frames) {
+                    std::memcpy(slot(i), primary, bytes);
+                }
+            }
+        }
+
+        head = (head + 1) % frames;
+        ++written;
+        return info;
+    }
+
+    auto input_tensor() noexcept -> ov::Tensor {
+        const auto shape = ov::Shape{
+            1,
+            static_cast<std::size_t>(kChannels * config.frames),
+            static_cast<std::size_t>(config.input_rows),
+            static_cast<std::size_t>(config.input_cols),
+        };
+        return ov::Tensor{ov::element::f32, shape, slot(head)};
+    }
+
+    /// Last channel of [N, C, H, W], [N, H, W] or [H, W] outputs is the newest frame
+    static auto newest_heatmap(const ov::Tensor& tensor)
+        -> std::expected<std::tuple<std::span<const float>, int, int>, std::string> {
+        const auto& shape = tensor.get_shape();
+        if (shape.size() < 2) {
+            return std::unexpected{"Unexpected heatmap output rank"};
+        }
+        const auto rows = shape[shape.size() - 2];
+        const auto cols = shape[shape.size() - 1];
+        const auto area = rows * cols;
+
+        const auto* data = const_cast<ov::Tensor&>(tensor).data<float>();
+        const auto size  = tensor.get_size();
+        return std::tuple{
+            std::span<const float>{data + size - area, area},
+            static_cast<int>(rows),
+            static_cast<int>(cols),
+        };
+    }
+
+    auto decode(const PreprocessInfo& info) -> Result {
+        auto heatmap = newest_heatmap(request.get_output_tensor());
+        if (!heatmap.has_value()) {
+            return std::unexpected{heatmap.error()};
+        }
+        const auto [values, rows, cols] = *heatmap;
+
+        const auto options = HeatmapDecoder::Options{
+            .threshold    = config.score_threshold,
+            .min_distance = config.min_distance,
+            .max_peaks    = 16,
+        };
+        decoder.decode(values, rows, cols, options, peaks);
+
+        // Heatmaps may be produced at a lower resolution than the input
+        const auto stride_x = static_cast<float>(config.input_cols) / static_cast<float>(cols);
+        const auto stride_y = static_cast<float>(config.input_rows) / static_cast<float>(rows);
+
+        // Peaks are cell indices, cell i covers [i, i + 1) * stride of the input. Mapped through
+        // continuous coordinates, pixel centers are at +0.5 on both sides of the letterbox
+        const auto to_source = [&](float cell, float stride, float pad) {
+            return ((cell + 0.5F) * stride - pad) / info.scale - 0.5F;
+        };
+
+        auto balls = std::vector<Ball2D>{};
+        balls.reserve(peaks.size());
+        for (const auto& peak : peaks) {
+            balls.push_back(Ball2D{
+                .center     = {to_source(peak.x, stride_x, info.pad_x),
+                               to_source(peak.y, stride_y, info.pad_y)},
+                .radius     = config.ball_radius,
+                .confidence = peak.score,
+            });
+        }
+        return balls;
+    }
+
+    // Called with the lock held and the request idle, starts the oldest waiting frame. Frames
+    // failing to start are answered with the lock released, callbacks may submit again
+    auto start_next(std::unique_lock<std::mutex>& lock) noexcept -> void {
+        while (!queue.empty()) {
+            auto pending = std::move(queue.front());
+            queue.pop_front();
+            try {
+                running_info     = push_frame(pending.frame);
+                running_callback = std::move(pending.callback);
+                request.set_input_tensor(input_tensor());
+                request.start_async();
+                return;
+            } catch (const std::exception& e) {
+                lock.unlock();
+                pending.callback(
+                    std::unexpected{std::string{"Heatmap inference failed | "} + e.what()});
+                lock.lock();
+            }
+        }
+        busy = false;
+        idle.notify_all();
+    }
+
+    auto complete(const std::exception_ptr& error) noexcept -> void {
+        auto lock     = std::unique_lock{mutex};
+        auto result   = Result{std::unexpected{"Heatmap inference failed"}};
+        auto callback = std::move(running_callback);
+        try {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            result = decode(running_info);
+        } catch (const std::exception& e) {
+            result = std::unexpected{std::string{"Heatmap inference failed | "} + e.what()};
+        }
+
+        // The request stays busy so frames submitted meanwhile queue up behind this one
+        lock.unlock();
+        callback(std::move(result));
+        lock.lock();
+
+        if (stopping) {
+            queue.clear();
+        }
+        start_next(lock);
+    }
+
+    auto async_infer(const Image& image, Callback callback) noexcept -> void {
+        const auto& origin_mat = image.details().get_mat();
+        if (origin_mat.empty()) [[unlikely]] {
+            callback(std::unexpected{"Empty image mat"});
+            return;
+        }
+
+        auto lock = std::unique_lock{mutex};
+        if (ring.empty()) [[unlikely]] {
+            lock.unlock();
+            callback(std::unexpected{"Heatmap network is not configured"});
+            return;
+        }
+
+        // Holding a reference keeps the pixels alive until the frame is preprocessed
+        queue.push_back({origin_mat, std::move(callback)});
+        if (!busy) {
+            busy = true;
+            start_next(lock);
+        }
+    }
+
+    auto sync_infer(const Image& image) noexcept -> Result {
+        auto promise = std::promise<Result>{};
+        auto future  = promise.get_future();
+        async_infer(image, [&promise](Result result) { promise.set_value(std::move(result)); });
+        return future.get();
+    }
+};
+
+HeatmapNet::HeatmapNet() : pimpl_{std::make_unique<Impl>()} {
+}
+
+HeatmapNet::~HeatmapNet() noexcept                       = default;
+HeatmapNet::HeatmapNet(HeatmapNet&&) noexcept            = default;
+HeatmapNet& HeatmapNet::operator=(HeatmapNet&&) noexcept = default;
+
+auto HeatmapNet::configure(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
+    return pimpl_->configure(yaml);
+}
+
+auto HeatmapNet::sync_infer(const Image& image) noexcept -> Result {
+    return pimpl_->sync_infer(image);
+}
+
+auto HeatmapNet::async_infer(const Image& image, Callback callback) noexcept -> void {
+    pimpl_->async_infer(image, std::move(callback));
+}
+
+auto HeatmapNet::reset() noexcept -> void {
+    pimpl_->reset();
+}
+
+}  // namespace pingpong_tracker::identifier
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <yaml-cpp/yaml.h>
+
+#include <expected>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/image/image.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::identifier {
+
+/// @brief
+///   OpenVINO backend for heatmap / keypoint detectors (TrackNet-style).
+/// @note
+///   - The network sees the last `frames` images stacked along the channel axis, oldest first.
+///   - Each image is preprocessed exactly once into a rolling tensor buffer, the input tensor is
+///     a view onto that buffer, so building the stack costs no extra preprocessing.
+///   - Frames must be fed in capture order. One request runs at a time, frames submitted
+///     meanwhile wait in order and the next one is preprocessed on OpenVINO's completion thread,
+///     so the submitting thread never blocks on inference.
+class HeatmapNet {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(HeatmapNet)
+
+public:
+    using Result   = std::expected<std::vector<Ball2D>, std::string>;
+    using Callback = std::function<void(Result)>;
+
+    HeatmapNet();
+
+    auto configure(const YAML::Node&) noexcept -> std::expected<void, std::string>;
+    auto sync_infer(const Image&) noexcept -> Result;
+
+    /// @note `callback` runs on an OpenVINO thread, or inline when the frame is rejected
+    auto async_infer(const Image&, Callback) noexcept -> void;
+
+    /// @brief Forgets the stacked history, e.g. after a seek or a camera reconnect
+    auto reset() noexcept -> void;
+};
+
+}  // namespace pingpong_tracker::identifier
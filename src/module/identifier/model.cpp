@@ -6,7 +6,13 @@
 #include <openvino/runtime/compiled_model.hpp>
 #include <openvino/runtime/core.hpp>
 #include <openvino/runtime/exception.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <utility>
+#include <vector>
 
 #include "utility/ball/ball.hpp"
 #include "utility/image/image.details.hpp"
@@ -57,7 +63,7 @@ struct TensorLayout {
     }
 };
 
-struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
+struct OpenVinoNet::Impl {
     using InputLayout = TensorLayout<'N', 'H', 'W', 'C'>;
     using ModelLayout = TensorLayout<'N', 'C', 'H', 'W'>;
 
@@ -69,6 +75,9 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
     ov::CompiledModel openvino_model;
     ov::Core openvino_core;
 
+    // Requests made up front, one per frame the runtime keeps in flight
+    static constexpr std::size_t kDefaultRequests = 2;
+
     struct PreprocessInfo {
         float scale;
         float pad_x;
@@ -105,15 +114,132 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
         };
     } config;
 
+    /// @brief
+    ///   One pooled request with the state of the frame it is working on.
+    /// @note
+    ///   - The request with its output tensors, the letterbox input and the callback are made
+    ///     once, the per-frame state is written into the slot before each start.
+    ///   - On the zero-copy path the input tensor wraps the image memory directly, so
+    ///     `input_holder` keeps a reference to that cv::Mat until the request is finished.
+    struct InferSlot {
+        ov::InferRequest request;
+        ov::Tensor letterbox;
+        cv::Mat resized;
+
+        PreprocessInfo info{};
+        cv::Mat input_holder;
+        Callback callback;
+
+        // Output decoding scratch, kept at the capacity of the busiest frame so far
+        std::vector<cv::Rect> boxes;
+        std::vector<float> scores;
+        std::vector<int> indices;
+    };
+
+    std::mutex pool_mutex;
+    std::condition_variable pool_idle;
+    std::vector<std::unique_ptr<InferSlot>> slots;
+    std::vector<InferSlot*> free_slots;
+
+    Impl() = default;
+    Impl(const Impl&)            = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    // The requests must not outlive their owner while OpenVINO still runs them
+    ~Impl() noexcept {
+        drain();
+    }
+
+    auto drain() noexcept -> void {
+        auto lock = std::unique_lock{pool_mutex};
+        pool_idle.wait(lock, [this] { return free_slots.size() == slots.size(); });
+    }
+
     auto configure(const YAML::Node& yaml) noexcept -> std::expected<void, std::string> {
         auto result = config.serialize(yaml);
         if (!result.has_value()) {
             return std::unexpected{result.error()};
         }
 
-        return compile_openvino_model();
+        auto requests = kDefaultRequests;
+        if (const auto node = yaml["infer_requests"]) {
+            const auto value = node.as<int>(0);
+            if (value <= 0) {
+                return std::unexpected{"Infer requests must be positive"};
+            }
+            requests = static_cast<std::size_t>(value);
+        }
+
+        drain();
+        slots.clear();
+        free_slots.clear();
+
+        if (auto compiled = compile_openvino_model(); !compiled) {
+            return compiled;
+        }
+        return fill_pool(requests);
+    }
+
+    auto fill_pool(std::size_t requests) noexcept -> std::expected<void, std::string> try {
+        auto lock = std::scoped_lock{pool_mutex};
+        slots.reserve(requests);
+        free_slots.reserve(requests);
+        while (slots.size() < requests) {
+            slots.push_back(make_slot());
+            free_slots.push_back(slots.back().get());
+        }
+        return {};
+
+    } catch (const std::exception& e) {
+        return std::unexpected{std::string{"Failed to create infer requests | "} + e.what()};
     }
 
+    auto make_slot() -> std::unique_ptr<InferSlot> {
+        const auto dimensions = Dimensions{
+            .w = static_cast<dimension_type>(config.input_cols),
+            .h = static_cast<dimension_type>(config.input_rows),
+        };
+
+        auto slot       = std::make_unique<InferSlot>();
+        slot->request   = openvino_model.create_infer_request();
+        slot->letterbox = ov::Tensor{ov::element::u8, InputLayout::shape(dimensions)};
+        slot->request.set_callback(
+            [this, slot = slot.get()](const std::exception_ptr& error) { complete(*slot, error); });
+        created_requests.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    // A free slot, the pool only grows when more frames are in flight than it was sized for
+    auto acquire() noexcept -> std::expected<InferSlot*, std::string> try {
+        auto lock = std::scoped_lock{pool_mutex};
+        if (free_slots.empty()) {
+            if (!openvino_model) [[unlikely]] {
+                return std::unexpected{"Network is not configured"};
+            }
+            slots.push_back(make_slot());
+            free_slots.reserve(slots.size());
+            return slots.back().get();
+        }
+        auto* slot = free_slots.back();
+        free_slots.pop_back();
+        return slot;
+
+    } catch (const std::exception& e) {
+        return std::unexpected{std::string{"Failed to create an infer request | "} + e.what()};
+    }
+
+    auto release(InferSlot& slot) noexcept -> void {
+        slot.input_holder.release();
+        {
+            auto lock = std::scoped_lock{pool_mutex};
+            free_slots.push_back(&slot);
+        }
+        pool_idle.notify_all();
+    }
+
+    /// @brief Requests made so far, constant once the pool covers the frames in flight
+    std::atomic<std::size_t> created_requests{0};
+
     auto compile_openvino_model() noexcept -> std::expected<void, std::string> try {
         auto origin_model = openvino_core.read_model(config.model_location);
         if (!origin_model) {
@@ -154,11 +280,41 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
         return std::unexpected{"Failed to load model caused by unknown exception"};
     }
 
-    auto generate_openvino_request(const Image& image) noexcept
-        -> std::expected<std::pair<ov::InferRequest, PreprocessInfo>, std::string> {
-        const auto& origin_mat = image.details().get_mat();
-        if (origin_mat.empty()) [[unlikely]] {
-            return std::unexpected{"Empty image mat"};
+    auto is_zero_copy_compatible(const cv::Mat& mat) const noexcept -> bool {
+        // Strided sub-views of a larger mat qualify too, pixels inside a row are always packed
+        return mat.type() == CV_8UC3 && mat.cols == config.input_cols
+            && mat.rows == config.input_rows;
+    }
+
+    auto wrap_input_tensor(const cv::Mat& mat) const noexcept -> ov::Tensor {
+        const auto dimensions = Dimensions{
+            .w = static_cast<dimension_type>(config.input_cols),
+            .h = static_cast<dimension_type>(config.input_rows),
+        };
+        const auto shape = InputLayout::shape(dimensions);
+
+        if (mat.isContinuous()) {
+            return ov::Tensor{ov::element::u8, shape, mat.data};
+        }
+
+        // NHWC byte strides, the row stride comes from the parent mat
+        const auto row_stride = mat.step[0];
+        const auto strides    = ov::Strides{
+            row_stride * static_cast<std::size_t>(mat.rows),
+            row_stride,
+            mat.elemSize(),
+            mat.elemSize1(),
+        };
+        return ov::Tensor{ov::element::u8, shape, mat.data, strides};
+    }
+
+    // Points the slot's request at the frame, wrapped in place or letterboxed into the slot
+    auto prepare(InferSlot& slot, const cv::Mat& origin_mat) -> void {
+        if (is_zero_copy_compatible(origin_mat)) {
+            slot.request.set_input_tensor(wrap_input_tensor(origin_mat));
+            slot.info         = PreprocessInfo{.scale = 1.0F, .pad_x = 0.0F, .pad_y = 0.0F};
+            slot.input_holder = origin_mat;
+            return;
         }
 
         const auto input_w = static_cast<float>(config.input_cols);
@@ -170,48 +326,40 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
         const auto new_w = static_cast<int>(img_w * scale);
         const auto new_h = static_cast<int>(img_h * scale);
 
-        auto resized_mat = cv::Mat{};
-        cv::resize(origin_mat, resized_mat, {new_w, new_h});
+        cv::resize(origin_mat, slot.resized, {new_w, new_h});
 
         const auto pad_w    = static_cast<int>(input_w) - new_w;
         const auto pad_h    = static_cast<int>(input_h) - new_h;
         const auto pad_top  = pad_h / 2;
         const auto pad_left = pad_w / 2;
 
-        const auto dimensions = Dimensions{
-            .w = static_cast<dimension_type>(config.input_cols),
-            .h = static_cast<dimension_type>(config.input_rows),
-        };
-
-        auto input_tensor = ov::Tensor(ov::element::u8, InputLayout::shape(dimensions));
         auto tensor_mat =
-            cv::Mat{config.input_rows, config.input_cols, CV_8UC3, input_tensor.data()};
+            cv::Mat{config.input_rows, config.input_cols, CV_8UC3, slot.letterbox.data()};
 
         tensor_mat.setTo(cv::Scalar{kPaddingValue, kPaddingValue, kPaddingValue});
-        resized_mat.copyTo(tensor_mat(cv::Rect{pad_left, pad_top, new_w, new_h}));
-
-        auto request = openvino_model.create_infer_request();
-        request.set_input_tensor(input_tensor);
+        slot.resized.copyTo(tensor_mat(cv::Rect{pad_left, pad_top, new_w, new_h}));
 
-        return std::make_pair(std::move(request),
-                              PreprocessInfo{.scale = scale,
-                                             .pad_x = static_cast<float>(pad_left),
-                                             .pad_y = static_cast<float>(pad_top)});
+        slot.request.set_input_tensor(slot.letterbox);
+        slot.info = PreprocessInfo{.scale = scale,
+                                   .pad_x = static_cast<float>(pad_left),
+                                   .pad_y = static_cast<float>(pad_top)};
     }
 
-    auto explain_infer_result(ov::InferRequest& finished_request,
-                              const PreprocessInfo& info) const noexcept -> std::vector<Ball2D> {
-        auto tensor          = finished_request.get_output_tensor();
-        auto [boxes, scores] = parse_inference_output(tensor);
+    auto explain_infer_result(InferSlot& slot) const noexcept -> std::vector<Ball2D> {
+        const auto tensor = slot.request.get_output_tensor();
+        parse_inference_output(tensor, slot.boxes, slot.scores);
 
-        auto indices = std::vector<int>{};
-        cv::dnn::NMSBoxes(boxes, scores, config.score_threshold, config.nms_threshold, indices);
+        cv::dnn::NMSBoxes(slot.boxes, slot.scores, config.score_threshold, config.nms_threshold,
+                          slot.indices);
 
-        return restore_coordinates(boxes, scores, indices, info);
+        return restore_coordinates(slot.boxes, slot.scores, slot.indices, slot.info);
     }
 
-    auto parse_inference_output(const ov::Tensor& tensor) const noexcept
-        -> std::pair<std::vector<cv::Rect>, std::vector<float>> {
+    auto parse_inference_output(const ov::Tensor& tensor, std::vector<cv::Rect>& boxes,
+                                std::vector<float>& scores) const noexcept -> void {
+        boxes.clear();
+        scores.clear();
+
         const auto& shape = tensor.get_shape();
 
         // YOLOv8 output shape: [1, 5, 8400] -> [Batch, Channels, Anchors]
@@ -237,13 +385,12 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
             anchors  = shape[2];
             channels = shape[1];
         } else {
-            return {};
+            return;
         }
 
-        auto scores = std::vector<float>{};
-        auto boxes  = std::vector<cv::Rect>{};
-        scores.reserve(anchors);
+        // No-op once the scratch has grown to the anchor count
         boxes.reserve(anchors);
+        scores.reserve(anchors);
 
         const auto data = std::span<const float>{const_cast<ov::Tensor&>(tensor).data<float>(),
                                                  tensor.get_size()};
@@ -267,8 +414,6 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
                 scores.push_back(score);
             }
         }
-
-        return {std::move(boxes), std::move(scores)};
     }
 
     auto restore_coordinates(const std::vector<cv::Rect>& boxes, const std::vector<float>& scores,
@@ -297,59 +442,87 @@ struct OpenVinoNet::Impl : std::enable_shared_from_this<Impl> {
         return final_result;
     }
 
-    auto sync_infer(const Image& image) noexcept -> Result {
-        auto result = generate_openvino_request(image);
-        if (!result.has_value()) {
-            return std::unexpected{result.error()};
+    auto sync_infer(const Image& image) noexcept -> Result try {
+        const auto& origin_mat = image.details().get_mat();
+        if (origin_mat.empty()) [[unlikely]] {
+            return std::unexpected{"Empty image mat"};
         }
 
-        auto [request, info] = std::move(result.value());
-        request.infer();
+        auto acquired = acquire();
+        if (!acquired) {
+            return std::unexpected{acquired.error()};
+        }
+        auto& slot = **acquired;
+        try {
+            prepare(slot, origin_mat);
+            slot.request.infer();
+        } catch (...) {
+            release(slot);
+            throw;
+        }
+
+        auto result = explain_infer_result(slot);
+        release(slot);
+        return result;
 
-        return explain_infer_result(request, info);
+    } catch (const std::exception& e) {
+        return std::unexpected{std::string{"Inference failed | "} + e.what()};
     }
 
     auto async_infer(const Image& image, Callback callback) noexcept -> void {
-        auto result = generate_openvino_request(image);
-        if (!result.has_value()) {
-            std::invoke(callback, std::unexpected{result.error()});
+        const auto& origin_mat = image.details().get_mat();
+        if (origin_mat.empty()) [[unlikely]] {
+            std::invoke(callback, std::unexpected{"Empty image mat"});
             return;
         }
 
-        auto [request, info] = std::move(result.value());
-        auto weak_self       = weak_from_this();
+        auto acquired = acquire();
+        if (!acquired) {
+            std::invoke(callback, std::unexpected{acquired.error()});
+            return;
+        }
 
-        request.set_callback([request, callback = std::move(callback), info = info,
-                              weak_self](const auto& e) mutable {
-            auto self = weak_self.lock();
-            if (!self) {
-                // Lifecycle expired, do not execute callback logic
-                return;
+        // The frame's state rides in the slot, the request's callback was set once with it
+        auto& slot = **acquired;
+        try {
+            prepare(slot, origin_mat);
+            slot.callback = std::move(callback);
+            slot.request.start_async();
+        } catch (const std::exception& e) {
+            if (!callback) {
+                callback = std::exchange(slot.callback, nullptr);
             }
+            release(slot);
+            std::invoke(callback, std::unexpected{std::string{"Inference failed | "} + e.what()});
+        }
+    }
 
-            if (e) {
-                auto error = std::string{};
-                try {
-                    std::rethrow_exception(e);
-                } catch (const ov::Cancelled& e) {
-                    error += "Cancelled | ";
-                    error += e.what();
-                } catch (const ov::Busy& e) {
-                    error = "Busy | ";
-                    error += e.what();
-                } catch (const std::exception& e) {
-                    error = "Unknown | ";
-                    error += e.what();
-                }
-                callback(std::unexpected{error});
-            } else {
-                auto result = self->explain_infer_result(request, info);
-                callback(std::move(result));
+    // OpenVINO's callback thread. The request is ready again, the slot goes back to the pool
+    // before the frame's callback runs so a frame it resumes can take it right away
+    auto complete(InferSlot& slot, const std::exception_ptr& e) noexcept -> void {
+        auto result = Result{std::unexpected{"Nothing here"}};
+        if (e) {
+            auto error = std::string{};
+            try {
+                std::rethrow_exception(e);
+            } catch (const ov::Cancelled& e) {
+                error += "Cancelled | ";
+                error += e.what();
+            } catch (const ov::Busy& e) {
+                error = "Busy | ";
+                error += e.what();
+            } catch (const std::exception& e) {
+                error = "Unknown | ";
+                error += e.what();
             }
+            result = std::unexpected{std::move(error)};
+        } else {
+            result = explain_infer_result(slot);
+        }
 
-            request.set_callback([](const std::exception_ptr&) {});
-        });
-        request.start_async();
+        auto callback = std::exchange(slot.callback, nullptr);
+        release(slot);
+        callback(std::move(result));
     }
 };
 
@@ -374,4 +547,8 @@ auto OpenVinoNet::async_infer(
     pimpl_->async_infer(image, std::move(callback));
 }
 
+auto OpenVinoNet::infer_requests() const noexcept -> std::size_t {
+    return pimpl_->created_requests.load(std::memory_order_relaxed);
+}
+
 }  // namespace pingpong_tracker::identifier
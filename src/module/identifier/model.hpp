@@ -8,6 +8,7 @@
 #include <string>
 
 #include "utility/ball/ball.hpp"
+#include "utility/coroutine/executor.hpp"
 #include "utility/image/image.hpp"
 #include "utility/pimpl.hpp"
 
@@ -26,27 +27,51 @@ public:
     OpenVinoNet(OpenVinoNet&&) noexcept            = default;
     OpenVinoNet& operator=(OpenVinoNet&&) noexcept = default;
 
+    /// @note
+    ///   - The optional `infer_requests` sizes the request pool, one per frame kept in flight.
     auto configure(const YAML::Node&) noexcept -> std::expected<void, std::string>;
     auto sync_infer(const Image&) noexcept -> std::expected<std::vector<Ball2D>, std::string>;
+
+    /// @brief
+    ///   Runs the frame on a pooled request, `callback` is invoked on an OpenVINO thread.
+    /// @note
+    ///   - Requests, their tensors and callbacks are made at configure time. A frame only moves
+    ///     `callback` into its slot, a callback small enough for std::function's inline storage
+    ///     costs no allocation.
+    ///   - More frames in flight than requests grow the pool, once.
     auto async_infer(const Image&,
                      std::function<void(std::expected<std::vector<Ball2D>, std::string>)>) noexcept
         -> void;
 
-    struct AsyncResult final {
+    /// @brief Requests created so far, constant once the pool covers the frames in flight
+    [[nodiscard]] auto infer_requests() const noexcept -> std::size_t;
+
+    /// @brief
+    ///   Awaitable inference, the continuation is posted to `executor` once OpenVINO finishes.
+    /// @note
+    ///   - `image` must stay alive until the await completes, which holds for any lvalue owned by
+    ///     the awaiting coroutine frame.
+    struct AsyncResult final : util::Executor::Operation {
         using handle_type = std::coroutine_handle<>;
+
         OpenVinoNet& network;
-        Image image;
+        const Image& image;
+        util::Executor& executor;
+        handle_type continuation{};
         std::expected<std::vector<Ball2D>, std::string> result{std::unexpected{"Nothing here"}};
+
         auto await_resume() noexcept {
             return std::move(result);
         }
         auto await_suspend(handle_type coroutine) noexcept {
-            network.async_infer(image, [coroutine, this](auto result) {
+            continuation = coroutine;
+            function     = [](Operation* self) noexcept {
+                static_cast<AsyncResult*>(self)->continuation.resume();
+            };
+            network.async_infer(image, [this](auto result) {
                 this->result = std::move(result);
-                // coroutine.resume() executes on the OpenVINO callback thread.
-                // Callers must ensure thread-safety or marshal resume back to the original/executor
-                // thread.
-                coroutine.resume();
+                // Never resume on the OpenVINO callback thread, hop back onto the executor
+                executor.post(this);
             });
         }
         static constexpr auto await_ready() noexcept {
@@ -54,8 +79,8 @@ public:
         }
     };
 
-    [[nodiscard]] auto await_infer(Image image) -> AsyncResult {
-        return AsyncResult{.network = *this, .image = std::move(image)};
+    [[nodiscard]] auto await_infer(const Image& image, util::Executor& executor) -> AsyncResult {
+        return AsyncResult{{}, *this, image, executor};
     }
 };
 
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "utility/clock.hpp"
+#include "utility/math/ballistic.hpp"
+#include "utility/math/kalmanfilter/ekf.hpp"
+
+namespace pingpong_tracker::tracker {
+
+enum class TrackState : std::uint8_t {
+    LOST,
+    TRACKING,
+    COASTING,
+};
+
+/// @brief
+///   Single-ball tracker on `util::EKF` with a ballistic flight model.
+/// @note
+///   - The time step comes from the capture timestamps, so dropped or late frames are handled
+///     by predicting over the real interval.
+///   - Detections are gated by their squared Mahalanobis distance to the predicted measurement,
+///     the closest one inside the gate updates the filter.
+///   - Without an accepted detection the track coasts on the model, after `max_coast` such
+///     frames it is lost and the next detection starts a new one.
+///   - All matrices are fixed-size, an update never allocates.
+template <int Dim>
+class BallTracker {
+public:
+    using Model  = util::BallisticModel<Dim>;
+    using Filter = util::EKF<Model::kStateDim, Dim>;
+
+    using XVec = typename Filter::XVec;
+    using ZVec = typename Filter::ZVec;
+    using PMat = typename Filter::PMat;
+    using RMat = typename Filter::RMat;
+    using HMat = typename Filter::HMat;
+
+    struct Config {
+        Model model{};
+
+        // Variance of the acceleration held over a step, discrete white-noise model, unit^2 / s^4
+        double process_noise = 1.0;
+        // Measurement standard deviation, unit
+        double measurement_noise = 1.0;
+        // Standard deviation of the unknown velocity of a new track, unit / s
+        double initial_velocity_std = 1.0;
+
+        // Squared Mahalanobis distance, chi-square quantile for `Dim` degrees of freedom
+        double gate_threshold = 9.21;
+
+        std::size_t max_coast = 10;
+    };
+
+    struct Snapshot {
+        TrackState state = TrackState::LOST;
+        XVec x           = XVec::Zero();
+        PMat P           = PMat::Zero();
+        util::Clock::time_point timestamp{};
+        std::size_t coasted = 0;
+    };
+
+    explicit BallTracker(Config config = {}) noexcept : config_{std::move(config)} {
+        H_                                = HMat::Zero();
+        H_.template block<Dim, Dim>(0, 0) = Eigen::Matrix<double, Dim, Dim>::Identity();
+        R_ = RMat::Identity() * (config_.measurement_noise * config_.measurement_noise);
+    }
+
+    [[nodiscard]] auto config() const noexcept -> Config const& {
+        return config_;
+    }
+
+    /// @brief
+    ///   Advances the track to `timestamp` and fuses the best gated candidate.
+    /// @note
+    ///   - `candidates` should be sorted by preference, a lost track restarts from the first.
+    /// @return Index of the accepted candidate, or `npos` when the track coasted or restarted
+    auto update(util::Clock::time_point timestamp, std::span<const ZVec> candidates) noexcept
+        -> std::size_t {
+        return update(timestamp, candidates, {});
+    }
+
+    /// @brief
+    ///   Same as above with a measurement covariance per candidate.
+    /// @note
+    ///   - `noises` is either empty, then the configured measurement noise applies, or has one
+    ///     covariance per candidate.
+    auto update(util::Clock::time_point timestamp, std::span<const ZVec> candidates,
+                std::span<const RMat> noises) noexcept -> std::size_t {
+        if (snapshot_.state == TrackState::LOST) {
+            return start(timestamp, candidates, noises);
+        }
+
+        const auto dt = std::chrono::duration<double>(timestamp - snapshot_.timestamp).count();
+        if (dt < 0.0) {
+            // Older than the current estimate, this filter can only move forward, `OosmTracker`
+            // re-runs from a stored state instead
+            return npos;
+        }
+        predict(dt);
+        snapshot_.timestamp = timestamp;
+
+        const auto accepted = gate(candidates, noises);
+        if (accepted == npos) {
+            coast();
+            return npos;
+        }
+
+        auto h     = [this](XVec const& x) -> ZVec { return H_ * x; };
+        auto get_H = [this](XVec const&) -> HMat { return H_; };
+        if (!filter_.update(candidates[accepted], h, get_H, noise(noises, accepted),
+                            util::DefaultAdd, util::DefaultSubtract)) [[unlikely]] {
+            coast();
+            return npos;
+        }
+
+        snapshot_.state   = TrackState::TRACKING;
+        snapshot_.coasted = 0;
+        sync_snapshot();
+        return accepted;
+    }
+
+    /// @brief State extrapolated to `timestamp` without touching the filter
+    [[nodiscard]] auto extrapolate(util::Clock::time_point timestamp) const noexcept -> XVec {
+        const auto dt = std::chrono::duration<double>(timestamp - snapshot_.timestamp).count();
+        return config_.model.transition(snapshot_.x, dt);
+    }
+
+    [[nodiscard]] auto snapshot() const noexcept -> Snapshot const& {
+        return snapshot_;
+    }
+
+    auto reset() noexcept -> void {
+        snapshot_ = Snapshot{};
+    }
+
+    /// Squared Mahalanobis distance of `z` to the current predicted measurement
+    [[nodiscard]] auto mahalanobis_squared(ZVec const& z) const noexcept -> double {
+        const RMat S = H_ * filter_.covariance() * H_.transpose() + R_;
+        const ZVec y = z - H_ * filter_.x;
+        return y.dot(S.ldlt().solve(y));
+    }
+
+    static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+private:
+    auto start(util::Clock::time_point timestamp, std::span<const ZVec> candidates,
+               std::span<const RMat> noises) noexcept -> std::size_t {
+        if (candidates.empty()) {
+            return npos;
+        }
+
+        // Candidates come in order of preference, the first one seeds the track
+        XVec x                 = XVec::Zero();
+        x.template head<Dim>() = candidates.front();
+
+        const auto velocity_var = config_.initial_velocity_std * config_.initial_velocity_std;
+        PMat P                  = PMat::Zero();
+        P.template block<Dim, Dim>(0, 0) = noise(noises, 0);
+        P.template block<Dim, Dim>(Dim, Dim).diagonal().setConstant(velocity_var);
+
+        filter_.reset(x, P);
+        snapshot_.state     = TrackState::TRACKING;
+        snapshot_.timestamp = timestamp;
+        snapshot_.coasted   = 0;
+        sync_snapshot();
+        return 0;
+    }
+
+    auto predict(double dt) noexcept -> void {
+        if (dt <= 0.0) {
+            return;
+        }
+        auto f     = [&](XVec const& x) -> XVec { return config_.model.transition(x, dt); };
+        auto get_F = [&](XVec const& x) -> PMat { return config_.model.jacobian(x, dt); };
+        filter_.predict(f, get_F, Model::process_noise(config_.process_noise, dt));
+        sync_snapshot();
+    }
+
+    auto noise(std::span<const RMat> noises, std::size_t index) const noexcept -> RMat const& {
+        return noises.empty() ? R_ : noises[index];
+    }
+
+    auto gate(std::span<const ZVec> candidates, std::span<const RMat> noises) const noexcept
+        -> std::size_t {
+        if (candidates.empty()) {
+            return npos;
+        }
+
+        const RMat HPHt = H_ * filter_.covariance() * H_.transpose();
+        const auto ldlt = RMat{HPHt + R_}.ldlt();
+        const ZVec h    = H_ * filter_.x;
+
+        auto best          = npos;
+        auto best_distance = config_.gate_threshold;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            const ZVec y        = candidates[i] - h;
+            const auto distance = noises.empty() ? y.dot(ldlt.solve(y))
+                                                 : y.dot(RMat{HPHt + noises[i]}.ldlt().solve(y));
+            if (distance < best_distance) {
+                best          = i;
+                best_distance = distance;
+            }
+        }
+        return best;
+    }
+
+    auto coast() noexcept -> void {
+        snapshot_.state = TrackState::COASTING;
+        if (++snapshot_.coasted > config_.max_coast) {
+            snapshot_.state = TrackState::LOST;
+        }
+    }
+
+    auto sync_snapshot() noexcept -> void {
+        snapshot_.x = filter_.x;
+        snapshot_.P = filter_.covariance();
+    }
+
+    Config config_;
+    Filter filter_{};
+    Snapshot snapshot_{};
+
+    HMat H_;
+    RMat R_;
+};
+
+}  // namespace pingpong_tracker::tracker
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "module/tracker/ball_tracker.hpp"
+#include "utility/clock.hpp"
+#include "utility/math/ballistic.hpp"
+#include "utility/math/kalmanfilter/ekf.hpp"
+
+namespace pingpong_tracker::tracker {
+
+enum class MotionMode : std::uint8_t {
+    FLIGHT,
+    BOUNCE,
+    ROLL,
+};
+
+/// @brief
+///   Interacting multiple model tracker over three `util::EKF` mode filters.
+/// @note
+///   - FLIGHT is the ballistic model with drag, BOUNCE the same model with a velocity impulse
+///     of `bounce_velocity_std` per frame for table bounces and racket hits, ROLL a slowly
+///     decaying velocity without gravity for a rolling or held ball.
+///   - Each frame the mode estimates are mixed through the Markov `transition` matrix, filtered
+///     separately and reweighted by their measurement likelihoods. The combined estimate and
+///     the mode probabilities are in the snapshot.
+///   - Gating takes the smallest Mahalanobis distance over the modes, so the flight gate stays
+///     tight while a bounce is still accepted through the BOUNCE filter.
+///   - Track life cycle is the same as `BallTracker`, all types are fixed-size and an update
+///     never allocates.
+template <int Dim>
+class ImmTracker {
+public:
+    static constexpr std::size_t kModes = 3;
+
+    using Model  = util::BallisticModel<Dim>;
+    using Filter = util::EKF<Model::kStateDim, Dim>;
+
+    using XVec = typename Filter::XVec;
+    using ZVec = typename Filter::ZVec;
+    using PMat = typename Filter::PMat;
+    using RMat = typename Filter::RMat;
+    using HMat = typename Filter::HMat;
+
+    using Probabilities = std::array<double, kModes>;
+
+    struct Config {
+        Model model{};
+
+        // FLIGHT and BOUNCE acceleration variance per step, unit^2 / s^4, fed to the discrete
+        // white-noise acceleration Q of `Model::process_noise`
+        double process_noise = 1.0;
+        // BOUNCE velocity change per frame, unit / s
+        double bounce_velocity_std = 1.0;
+        // ROLL acceleration variance per step, unit^2 / s^4, same discrete form
+        double roll_process_noise = 1.0;
+        // ROLL velocity decay rate, 1 / s
+        double roll_damping = 5.0;
+
+        double measurement_noise    = 1.0;
+        double initial_velocity_std = 1.0;
+        double gate_threshold       = 9.21;
+        std::size_t max_coast       = 10;
+
+        // Per-frame mode switching, row is the previous mode, column the next, in the order
+        // FLIGHT, BOUNCE, ROLL. Rows should sum to one.
+        std::array<double, kModes * kModes> transition{
+            // clang-format off
+            0.94, 0.05, 0.01,
+            0.90, 0.05, 0.05,
+            0.02, 0.01, 0.97,
+            // clang-format on
+        };
+    };
+
+    struct Snapshot {
+        TrackState state = TrackState::LOST;
+        XVec x           = XVec::Zero();
+        PMat P           = PMat::Zero();
+        util::Clock::time_point timestamp{};
+        std::size_t coasted = 0;
+
+        Probabilities probabilities{1.0, 0.0, 0.0};
+
+        [[nodiscard]] auto mode() const noexcept -> MotionMode {
+            return static_cast<MotionMode>(std::ranges::max_element(probabilities)
+                                           - probabilities.begin());
+        }
+    };
+
+    explicit ImmTracker(Config config = {}) noexcept : config_{std::move(config)} {
+        H_                                = HMat::Zero();
+        H_.template block<Dim, Dim>(0, 0) = Eigen::Matrix<double, Dim, Dim>::Identity();
+        R_ = RMat::Identity() * (config_.measurement_noise * config_.measurement_noise);
+    }
+
+    [[nodiscard]] auto config() const noexcept -> Config const& {
+        return config_;
+    }
+
+    auto update(util::Clock::time_point timestamp, std::span<const ZVec> candidates) noexcept
+        -> std::size_t {
+        return update(timestamp, candidates, {});
+    }
+
+    /// @brief
+    ///   Advances every mode to `timestamp` and fuses the best gated candidate.
+    /// @note Same contract as `BallTracker::update`.
+    auto update(util::Clock::time_point timestamp, std::span<const ZVec> candidates,
+                std::span<const RMat> noises) noexcept -> std::size_t {
+        if (snapshot_.state == TrackState::LOST) {
+            return start(timestamp, candidates, noises);
+        }
+
+        const auto dt = std::chrono::duration<double>(timestamp - snapshot_.timestamp).count();
+        if (dt < 0.0) {
+            return npos;
+        }
+        const auto predicted = mix();
+        predict(dt);
+        snapshot_.timestamp = timestamp;
+
+        const auto accepted = gate(candidates, noises);
+        if (accepted == npos) {
+            probabilities_ = predicted;
+            combine();
+            coast();
+            return npos;
+        }
+
+        const auto& z = candidates[accepted];
+        const auto& R = noise(noises, accepted);
+
+        auto h     = [this](XVec const& x) -> ZVec { return H_ * x; };
+        auto get_H = [this](XVec const&) -> HMat { return H_; };
+
+        // Log likelihoods first, each filter's prior is needed
+        auto log_weights = Probabilities{};
+        auto best        = -std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < kModes; ++j) {
+            const auto [distance, log_det] = innovation(filters_[j], z, R);
+
+            log_weights[j] = std::log(std::max(predicted[j], 1e-300));
+            log_weights[j] -= 0.5 * (distance + log_det);
+            best = std::max(best, log_weights[j]);
+        }
+
+        auto fused = false;
+        for (std::size_t j = 0; j < kModes; ++j) {
+            if (filters_[j].update(z, h, get_H, R, util::DefaultAdd, util::DefaultSubtract)) {
+                fused = true;
+            } else {
+                log_weights[j] = -std::numeric_limits<double>::infinity();
+            }
+        }
+        if (!fused || !std::isfinite(best)) [[unlikely]] {
+            probabilities_ = predicted;
+            combine();
+            coast();
+            return npos;
+        }
+
+        auto total = 0.0;
+        for (std::size_t j = 0; j < kModes; ++j) {
+            probabilities_[j] = std::exp(log_weights[j] - best);
+            total += probabilities_[j];
+        }
+        for (auto& probability : probabilities_) {
+            probability /= total;
+        }
+
+        combine();
+        snapshot_.state   = TrackState::TRACKING;
+        snapshot_.coasted = 0;
+        return accepted;
+    }
+
+    /// @brief Combined state extrapolated to `timestamp` on the flight model
+    [[nodiscard]] auto extrapolate(util::Clock::time_point timestamp) const noexcept -> XVec {
+        const auto dt = std::chrono::duration<double>(timestamp - snapshot_.timestamp).count();
+        return config_.model.transition(snapshot_.x, dt);
+    }
+
+    [[nodiscard]] auto snapshot() const noexcept -> Snapshot const& {
+        return snapshot_;
+    }
+
+    auto reset() noexcept -> void {
+        snapshot_ = Snapshot{};
+    }
+
+    static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+private:
+    static constexpr auto kFlight = static_cast<std::size_t>(MotionMode::FLIGHT);
+    static constexpr auto kBounce = static_cast<std::size_t>(MotionMode::BOUNCE);
+    static constexpr auto kRoll   = static_cast<std::size_t>(MotionMode::ROLL);
+
+    auto start(util::Clock::time_point timestamp, std::span<const ZVec> candidates,
+               std::span<const RMat> noises) noexcept -> std::size_t {
+        if (candidates.empty()) {
+            return npos;
+        }
+
+        XVec x                 = XVec::Zero();
+        x.template head<Dim>() = candidates.front();
+
+        const auto velocity_var = config_.initial_velocity_std * config_.initial_velocity_std;
+        PMat P                  = PMat::Zero();
+        P.template block<Dim, Dim>(0, 0) = noise(noises, 0);
+        P.template block<Dim, Dim>(Dim, Dim).diagonal().setConstant(velocity_var);
+
+        for (auto& filter : filters_) {
+            filter.reset(x, P);
+        }
+        probabilities_ = {1.0, 0.0, 0.0};
+
+        combine();
+        snapshot_.state     = TrackState::TRACKING;
+        snapshot_.timestamp = timestamp;
+        snapshot_.coasted   = 0;
+        return 0;
+    }
+
+    /// Interaction step, mixes the mode estimates and returns the predicted mode probabilities
+    auto mix() noexcept -> Probabilities {
+        auto predicted = Probabilities{};
+        for (std::size_t j = 0; j < kModes; ++j) {
+            for (std::size_t i = 0; i < kModes; ++i) {
+                predicted[j] += config_.transition[i * kModes + j] * probabilities_[i];
+            }
+        }
+
+        auto mixed_x = std::array<XVec, kModes>{};
+        auto mixed_P = std::array<PMat, kModes>{};
+        for (std::size_t j = 0; j < kModes; ++j) {
+            mixed_x[j].setZero();
+            mixed_P[j].setZero();
+            if (predicted[j] <= 0.0) {
+                mixed_x[j] = filters_[j].x;
+                mixed_P[j] = filters_[j].covariance();
+                continue;
+            }
+
+            auto weights = Probabilities{};
+            for (std::size_t i = 0; i < kModes; ++i) {
+                weights[i] = config_.transition[i * kModes + j] * probabilities_[i] / predicted[j];
+                mixed_x[j] += weights[i] * filters_[i].x;
+            }
+            for (std::size_t i = 0; i < kModes; ++i) {
+                const XVec dx = filters_[i].x - mixed_x[j];
+                mixed_P[j] += weights[i] * (filters_[i].covariance() + dx * dx.transpose());
+            }
+        }
+        for (std::size_t j = 0; j < kModes; ++j) {
+            filters_[j].reset(mixed_x[j], mixed_P[j]);
+        }
+        return predicted;
+    }
+
+    auto predict(double dt) noexcept -> void {
+        if (dt <= 0.0) {
+            return;
+        }
+        const auto& model = config_.model;
+
+        auto f     = [&](XVec const& x) -> XVec { return model.transition(x, dt); };
+        auto get_F = [&](XVec const& x) -> PMat { return model.jacobian(x, dt); };
+
+        const PMat Q = Model::process_noise(config_.process_noise, dt);
+        filters_[kFlight].predict(f, get_F, Q);
+
+        // An impulse at the start of the interval, it already moves this frame's position
+        const auto impulse = config_.bounce_velocity_std * config_.bounce_velocity_std;
+        PMat bounce_Q      = Q;
+        bounce_Q.template block<Dim, Dim>(0, 0).diagonal().array() += impulse * dt * dt;
+        bounce_Q.template block<Dim, Dim>(0, Dim).diagonal().array() += impulse * dt;
+        bounce_Q.template block<Dim, Dim>(Dim, 0).diagonal().array() += impulse * dt;
+        bounce_Q.template block<Dim, Dim>(Dim, Dim).diagonal().array() += impulse;
+        filters_[kBounce].predict(f, get_F, bounce_Q);
+
+        // Rolling or held, the velocity decays towards zero and gravity is carried by the table
+        const auto damping = std::max(config_.roll_damping, 1e-9);
+        const auto decay   = std::exp(-damping * dt);
+        PMat roll_F        = PMat::Identity();
+        roll_F.template block<Dim, Dim>(0, Dim).diagonal().setConstant((1.0 - decay) / damping);
+        roll_F.template block<Dim, Dim>(Dim, Dim).diagonal().setConstant(decay);
+
+        auto roll_f     = [&](XVec const& x) -> XVec { return roll_F * x; };
+        auto roll_get_F = [&](XVec const&) -> PMat { return roll_F; };
+        filters_[kRoll].predict(roll_f, roll_get_F,
+                                Model::process_noise(config_.roll_process_noise, dt));
+    }
+
+    struct Innovation {
+        double distance;
+        double log_det;
+    };
+
+    auto innovation(Filter const& filter, ZVec const& z, RMat const& R) const noexcept
+        -> Innovation {
+        const RMat S = H_ * filter.covariance() * H_.transpose() + R;
+        const ZVec y = z - H_ * filter.x;
+
+        RMat S_inv;
+        if (!util::symmetric_inverse(S, S_inv)) [[unlikely]] {
+            return {std::numeric_limits<double>::infinity(), 0.0};
+        }
+        return {y.dot(S_inv * y), std::log(S.determinant())};
+    }
+
+    auto noise(std::span<const RMat> noises, std::size_t index) const noexcept -> RMat const& {
+        return noises.empty() ? R_ : noises[index];
+    }
+
+    auto gate(std::span<const ZVec> candidates, std::span<const RMat> noises) const noexcept
+        -> std::size_t {
+        auto best          = npos;
+        auto best_distance = config_.gate_threshold;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            for (const auto& filter : filters_) {
+                const auto distance = innovation(filter, candidates[i], noise(noises, i)).distance;
+                if (distance < best_distance) {
+                    best          = i;
+                    best_distance = distance;
+                }
+            }
+        }
+        return best;
+    }
+
+    auto combine() noexcept -> void {
+        snapshot_.x.setZero();
+        for (std::size_t j = 0; j < kModes; ++j) {
+            snapshot_.x += probabilities_[j] * filters_[j].x;
+        }
+        snapshot_.P.setZero();
+        for (std::size_t j = 0; j < kModes; ++j) {
+            const XVec dx = filters_[j].x - snapshot_.x;
+            snapshot_.P += probabilities_[j] * (filters_[j].covariance() + dx * dx.transpose());
+        }
+        snapshot_.probabilities = probabilities_;
+    }
+
+    auto coast() noexcept -> void {
+        snapshot_.state = TrackState::COASTING;
+        if (++snapshot_.coasted > config_.max_coast) {
+            snapshot_.state = TrackState::LOST;
+        }
+    }
+
+    Config config_;
+    std::array<Filter, kModes> filters_{Filter{}, Filter{}, Filter{}};
+    Probabilities probabilities_{1.0, 0.0, 0.0};
+    Snapshot snapshot_{};
+
+    HMat H_;
+    RMat R_;
+};
+
+}  // namespace pingpong_tracker::tracker
@@ -0,0 +1,206 @@
+#include "multi_tracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace pingpong_tracker::tracker;
+
+MultiTracker::MultiTracker(Config config) noexcept : config_{config} {
+}
+
+auto MultiTracker::reset() noexcept -> void {
+    tracks_  = Tracks{};
+    started_ = false;
+}
+
+auto MultiTracker::update(util::Clock::time_point timestamp,
+                          std::span<const Measurement> detections)
+    -> std::span<const std::uint32_t> {
+    // Late from a concurrent pipeline, fusing it would pull the tracks back and count misses
+    // against tracks that were already seen past it
+    if (started_ && timestamp < timestamp_) {
+        detection_ids_.assign(detections.size(), kNoTrack);
+        return detection_ids_;
+    }
+
+    const auto dt =
+        started_ ? std::chrono::duration<float>(timestamp - timestamp_).count() : 0.0F;
+    timestamp_ = timestamp;
+    started_   = true;
+
+    predict(dt);
+
+    const auto rows = tracks_.size();
+    const auto cols = detections.size();
+
+    build_cost(detections);
+    const auto row_to_col = assignment_.solve(cost_, rows, cols, config_.gate_threshold,
+                                              config_.greedy_limit);
+
+    detection_ids_.assign(cols, kNoTrack);
+    track_matched_.assign(rows, false);
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        const auto c = row_to_col[r];
+        if (c == util::Assignment::npos) {
+            continue;
+        }
+        correct(r, detections[c]);
+
+        auto& hits = tracks_.hits[r];
+        hits       = static_cast<std::uint16_t>(std::min<int>(hits + 1, UINT16_MAX));
+
+        tracks_.misses[r] = 0;
+        track_matched_[r] = true;
+        detection_ids_[c] = tracks_.id[r];
+    }
+
+    // Death, backwards so the swap-remove only moves tracks that were already visited
+    for (auto r = rows; r-- > 0;) {
+        if (track_matched_[r]) {
+            continue;
+        }
+        auto& misses = tracks_.misses[r];
+        misses       = static_cast<std::uint16_t>(std::min<int>(misses + 1, UINT16_MAX));
+
+        if (!confirmed(r) || misses > config_.max_coast) {
+            remove(r);
+        }
+    }
+
+    // Birth
+    for (std::size_t c = 0; c < cols; ++c) {
+        if (detection_ids_[c] == kNoTrack) {
+            detection_ids_[c] = spawn(detections[c]);
+        }
+    }
+
+    return detection_ids_;
+}
+
+auto MultiTracker::predict(float dt) noexcept -> void {
+    if (dt <= 0.0F) {
+        return;
+    }
+
+    const auto q   = config_.process_noise;
+    const auto dt2 = dt * dt;
+    const auto qpp = q * dt2 * dt2 / 4.0F;
+    const auto qpv = q * dt2 * dt / 2.0F;
+    const auto qvv = q * dt2;
+
+    const auto n = tracks_.size();
+
+    auto axis = [&](float* p, float* v, float* pp, float* pv, float* vv, float g) {
+        const auto dp = 0.5F * g * dt2;
+        const auto dv = g * dt;
+        for (std::size_t i = 0; i < n; ++i) {
+            p[i] += v[i] * dt + dp;
+            v[i] += dv;
+
+            // F P F^T + Q with F = [[1, dt], [0, 1]]
+            const auto pv_i = pv[i];
+            const auto vv_i = vv[i];
+            pp[i] += dt * (2.0F * pv_i + dt * vv_i) + qpp;
+            pv[i] = pv_i + dt * vv_i + qpv;
+            vv[i] = vv_i + qvv;
+        }
+    };
+
+    auto& t = tracks_;
+    axis(t.x.data(), t.vx.data(), t.x_pp.data(), t.x_pv.data(), t.x_vv.data(), config_.gravity_x);
+    axis(t.y.data(), t.vy.data(), t.y_pp.data(), t.y_pv.data(), t.y_vv.data(), config_.gravity_y);
+}
+
+auto MultiTracker::build_cost(std::span<const Measurement> detections) -> void {
+    const auto rows = tracks_.size();
+    const auto cols = detections.size();
+    const auto r2   = config_.measurement_noise * config_.measurement_noise;
+
+    cost_.resize(rows * cols);
+    for (std::size_t r = 0; r < rows; ++r) {
+        const auto x     = tracks_.x[r];
+        const auto y     = tracks_.y[r];
+        const auto inv_x = 1.0F / (tracks_.x_pp[r] + r2);
+        const auto inv_y = 1.0F / (tracks_.y_pp[r] + r2);
+
+        auto* row = cost_.data() + r * cols;
+        for (std::size_t c = 0; c < cols; ++c) {
+            const auto dx = detections[c].x - x;
+            const auto dy = detections[c].y - y;
+            row[c]        = dx * dx * inv_x + dy * dy * inv_y;
+        }
+    }
+}
+
+auto MultiTracker::correct(std::size_t i, Measurement const& z) noexcept -> void {
+    const auto r2 = config_.measurement_noise * config_.measurement_noise;
+
+    auto axis = [r2](float& p, float& v, float& pp, float& pv, float& vv, float measured) {
+        const auto s  = pp + r2;
+        const auto k0 = pp / s;
+        const auto k1 = pv / s;
+        const auto y  = measured - p;
+
+        p += k0 * y;
+        v += k1 * y;
+
+        // (I - K H) P, H = [1, 0]
+        vv -= k1 * pv;
+        pv -= k0 * pv;
+        pp -= k0 * pp;
+    };
+
+    auto& t = tracks_;
+    axis(t.x[i], t.vx[i], t.x_pp[i], t.x_pv[i], t.x_vv[i], z.x);
+    axis(t.y[i], t.vy[i], t.y_pp[i], t.y_pv[i], t.y_vv[i], z.y);
+}
+
+auto MultiTracker::spawn(Measurement const& z) -> std::uint32_t {
+    const auto r2 = config_.measurement_noise * config_.measurement_noise;
+    const auto v2 = config_.initial_velocity_std * config_.initial_velocity_std;
+
+    const auto id = next_id_++;
+    if (next_id_ == kNoTrack) {
+        next_id_ = 1;
+    }
+
+    auto& t = tracks_;
+    t.id.push_back(id);
+    t.x.push_back(z.x);
+    t.vx.push_back(0.0F);
+    t.y.push_back(z.y);
+    t.vy.push_back(0.0F);
+    t.x_pp.push_back(r2);
+    t.x_pv.push_back(0.0F);
+    t.x_vv.push_back(v2);
+    t.y_pp.push_back(r2);
+    t.y_pv.push_back(0.0F);
+    t.y_vv.push_back(v2);
+    t.hits.push_back(1);
+    t.misses.push_back(0);
+    return id;
+}
+
+auto MultiTracker::remove(std::size_t i) noexcept -> void {
+    auto swap_pop = [i](auto& array) {
+        array[i] = array.back();
+        array.pop_back();
+    };
+
+    auto& t = tracks_;
+    swap_pop(t.id);
+    swap_pop(t.x);
+    swap_pop(t.vx);
+    swap_pop(t.y);
+    swap_pop(t.vy);
+    swap_pop(t.x_pp);
+    swap_pop(t.x_pv);
+    swap_pop(t.x_vv);
+    swap_pop(t.y_pp);
+    swap_pop(t.y_pv);
+    swap_pop(t.y_vv);
+    swap_pop(t.hits);
+    swap_pop(t.misses);
+    swap_pop(track_matched_);
+}
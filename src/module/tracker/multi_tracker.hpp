@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/math/assignment.hpp"
+
+namespace pingpong_tracker::tracker {
+
+/// @brief
+///   Multi-ball tracker for several balls in flight, with tracks stored as structure of arrays.
+/// @note
+///   - Every axis is an independent constant-acceleration Kalman filter on [position, velocity]
+///     with gravity as the known input, so predict and update are closed-form 2x2 algebra over
+///     contiguous arrays that the compiler vectorises.
+///   - Association is gated by the squared Mahalanobis distance, greedy while the smaller side
+///     has at most `greedy_limit` entries, Hungarian above that.
+///   - Unmatched detections start tentative tracks, a track is confirmed after `confirm_hits`
+///     matches and removed after `max_coast` consecutive misses, tentative ones on the first.
+///   - IDs increase monotonically and survive the swap-remove of dead tracks.
+class MultiTracker {
+public:
+    struct Config {
+        // unit / s^2 per axis
+        float gravity_x = 0.0F;
+        float gravity_y = 0.0F;
+
+        // Acceleration variance per step, unit^2 / s^4. Q is the discrete white-noise
+        // acceleration form q [dt^4 / 4, dt^3 / 2; dt^3 / 2, dt^2] on each axis
+        float process_noise = 1.0F;
+        // Measurement standard deviation, unit
+        float measurement_noise = 1.0F;
+        // Standard deviation of the unknown velocity of a new track, unit / s
+        float initial_velocity_std = 1.0F;
+
+        // Squared Mahalanobis distance, chi-square quantile for 2 degrees of freedom
+        float gate_threshold = 9.21F;
+
+        std::size_t confirm_hits = 3;
+        std::size_t max_coast    = 10;
+        std::size_t greedy_limit = 4;
+    };
+
+    struct Measurement {
+        float x;
+        float y;
+    };
+
+    /// @brief Tracks in structure-of-arrays layout, index `i` of every array is one track
+    struct Tracks {
+        std::vector<std::uint32_t> id;
+
+        std::vector<float> x, vx;
+        std::vector<float> y, vy;
+
+        // Per-axis covariance [[pp, pv], [pv, vv]]
+        std::vector<float> x_pp, x_pv, x_vv;
+        std::vector<float> y_pp, y_pv, y_vv;
+
+        std::vector<std::uint16_t> hits;
+        std::vector<std::uint16_t> misses;
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t {
+            return id.size();
+        }
+        [[nodiscard]] auto confirmed(std::size_t i, std::size_t confirm_hits) const noexcept
+            -> bool {
+            return hits[i] >= confirm_hits;
+        }
+    };
+
+    static constexpr auto kNoTrack = std::uint32_t{0};
+
+    explicit MultiTracker(Config config) noexcept;
+
+    /// @brief
+    ///   Advances every track to `timestamp`, associates `detections` and manages birth/death.
+    /// @note
+    ///   - A frame older than the last one is ignored, the tracks are left as they are. Frames
+    ///     with the same timestamp are associated without predicting.
+    /// @return ID of the track that took each detection, all `kNoTrack` for an ignored frame
+    auto update(util::Clock::time_point timestamp, std::span<const Measurement> detections)
+        -> std::span<const std::uint32_t>;
+
+    [[nodiscard]] auto tracks() const noexcept -> Tracks const& {
+        return tracks_;
+    }
+    [[nodiscard]] auto config() const noexcept -> Config const& {
+        return config_;
+    }
+    /// @brief Time the tracks are predicted to, that of the newest frame so far
+    [[nodiscard]] auto timestamp() const noexcept -> util::Clock::time_point {
+        return timestamp_;
+    }
+    [[nodiscard]] auto confirmed(std::size_t i) const noexcept -> bool {
+        return tracks_.confirmed(i, config_.confirm_hits);
+    }
+
+    auto reset() noexcept -> void;
+
+private:
+    auto predict(float dt) noexcept -> void;
+    auto build_cost(std::span<const Measurement> detections) -> void;
+    auto correct(std::size_t track, Measurement const& z) noexcept -> void;
+    auto spawn(Measurement const& z) -> std::uint32_t;
+    auto remove(std::size_t track) noexcept -> void;
+
+    Config config_;
+    Tracks tracks_;
+
+    util::Clock::time_point timestamp_{};
+    bool started_ = false;
+    std::uint32_t next_id_ = 1;
+
+    util::Assignment assignment_;
+    std::vector<double> cost_;
+    std::vector<std::uint32_t> detection_ids_;
+    std::vector<bool> track_matched_;
+};
+
+}  // namespace pingpong_tracker::tracker
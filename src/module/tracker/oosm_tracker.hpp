@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "module/tracker/ball_tracker.hpp"
+
+namespace pingpong_tracker::tracker {
+
+/// @brief
+///   `BallTracker` that accepts detections in any timestamp order within a bounded lag.
+/// @note
+///   - The last `history` frames are kept in a ring, each with its candidates and the tracker
+///     right after it was fused.
+///   - A frame older than the newest one is inserted in timestamp order, the tracker is restored
+///     from the entry before it and every later frame is fused again. Re-running rather than
+///     retrodicting keeps the ballistic model and the gate exact, at a cost bounded by
+///     `history` predict/update steps.
+///   - Frames older than `max_lag` behind the newest, or than the oldest kept entry, are dropped.
+///   - A frame is fused with all of its candidates. Only the first `max_candidates` of them, plus
+///     the one it accepted, are remembered for replays, so the ring never allocates after
+///     construction. `truncated()` counts frames that lost candidates that way.
+template <int Dim>
+class OosmTracker {
+public:
+    using Tracker = BallTracker<Dim>;
+    using ZVec    = typename Tracker::ZVec;
+    using RMat    = typename Tracker::RMat;
+    using XVec    = typename Tracker::XVec;
+
+    static constexpr auto npos = Tracker::npos;
+
+    struct Config {
+        typename Tracker::Config tracker{};
+
+        // Frames kept for re-running, bounds the cost of a late frame
+        std::size_t history = 16;
+        // Candidates kept per frame for re-running, at least 1
+        std::size_t max_candidates = 4;
+        // Seconds, later frames are dropped
+        double max_lag = 0.05;
+    };
+
+    explicit OosmTracker(Config config)
+        : config_{config}
+        , tracker_{config.tracker}
+        , ring_(std::max<std::size_t>(config.history, 1)) {
+        config_.max_candidates = std::max<std::size_t>(config_.max_candidates, 1);
+        for (auto& entry : ring_) {
+            entry.candidates.reserve(config_.max_candidates);
+            entry.noises.reserve(config_.max_candidates);
+        }
+    }
+
+    OosmTracker() : OosmTracker{Config{}} {
+    }
+
+    /// @brief
+    ///   Fuses a frame captured at `timestamp`, which may be older than the previous ones.
+    /// @return
+    ///   Index of the candidate accepted for this frame, `npos` when it coasted, restarted or
+    ///   was dropped as too late.
+    auto update(util::Clock::time_point timestamp, std::span<const ZVec> candidates,
+                std::span<const RMat> noises = {}) noexcept -> std::size_t {
+        last_replayed_ = 0;
+
+        // Position of the new frame, after every entry not later than it
+        auto position = size_;
+        while (position > 0 && at(position - 1).timestamp > timestamp) {
+            --position;
+        }
+
+        if (position < size_) {
+            const auto lag = std::chrono::duration<double>(newest() - timestamp).count();
+            if (position == 0 || lag > config_.max_lag) {
+                ++dropped_;
+                return npos;
+            }
+            // Out of sequence, restart from the state before it
+            tracker_ = at(position - 1).tracker;
+        }
+
+        if (size_ == ring_.size()) {
+            // Full, the oldest entry goes, an accepted frame is never the oldest
+            head_ = (head_ + 1) % ring_.size();
+            --size_;
+            --position;
+        }
+        // Swapped rather than copied, the candidate buffers travel with their entries
+        for (auto i = size_; i > position; --i) {
+            std::swap(at(i), at(i - 1));
+        }
+        ++size_;
+
+        auto& entry         = at(position);
+        entry.timestamp     = timestamp;
+        const auto accepted = fuse(entry, candidates, noises);
+        remember(entry, candidates, noises, accepted);
+
+        for (auto i = position + 1; i < size_; ++i) {
+            auto& later = at(i);
+            fuse(later, later.candidates,
+                 later.noisy ? std::span<const RMat>{later.noises} : std::span<const RMat>{});
+            ++last_replayed_;
+        }
+        return accepted;
+    }
+
+    [[nodiscard]] auto snapshot() const noexcept -> typename Tracker::Snapshot const& {
+        return tracker_.snapshot();
+    }
+
+    [[nodiscard]] auto extrapolate(util::Clock::time_point timestamp) const noexcept -> XVec {
+        return tracker_.extrapolate(timestamp);
+    }
+
+    [[nodiscard]] auto config() const noexcept -> Config const& {
+        return config_;
+    }
+
+    /// @brief Frames fused again by the last update
+    [[nodiscard]] auto last_replayed() const noexcept -> std::size_t {
+        return last_replayed_;
+    }
+
+    /// @brief Frames dropped as older than the lag window since construction
+    [[nodiscard]] auto dropped() const noexcept -> std::size_t {
+        return dropped_;
+    }
+
+    /// @brief Frames remembered with fewer candidates than they were fused with
+    [[nodiscard]] auto truncated() const noexcept -> std::size_t {
+        return truncated_;
+    }
+
+    auto reset() noexcept -> void {
+        tracker_.reset();
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    struct Entry {
+        util::Clock::time_point timestamp{};
+        // Reserved to `max_candidates` at construction
+        std::vector<ZVec> candidates;
+        std::vector<RMat> noises;
+        bool noisy = false;
+
+        // Tracker right after this frame
+        Tracker tracker{};
+    };
+
+    auto at(std::size_t index) noexcept -> Entry& {
+        return ring_[(head_ + index) % ring_.size()];
+    }
+    auto at(std::size_t index) const noexcept -> Entry const& {
+        return ring_[(head_ + index) % ring_.size()];
+    }
+
+    auto newest() const noexcept -> util::Clock::time_point {
+        return at(size_ - 1).timestamp;
+    }
+
+    auto fuse(Entry& entry, std::span<const ZVec> candidates,
+              std::span<const RMat> noises) noexcept -> std::size_t {
+        const auto accepted = tracker_.update(entry.timestamp, candidates, noises);
+        entry.tracker       = tracker_;
+        return accepted;
+    }
+
+    auto remember(Entry& entry, std::span<const ZVec> candidates, std::span<const RMat> noises,
+                  std::size_t accepted) noexcept -> void {
+        const auto kept = std::min(candidates.size(), config_.max_candidates);
+        entry.noisy     = !noises.empty();
+        entry.candidates.assign(candidates.begin(), candidates.begin() + kept);
+        entry.noises.clear();
+        if (entry.noisy) {
+            entry.noises.assign(noises.begin(), noises.begin() + kept);
+        }
+        if (kept == candidates.size()) {
+            return;
+        }
+
+        ++truncated_;
+        // A replay must still find the candidate this frame accepted, a restart takes the first
+        if (accepted != npos && accepted >= kept) {
+            entry.candidates.back() = candidates[accepted];
+            if (entry.noisy) {
+                entry.noises.back() = noises[accepted];
+            }
+        }
+    }
+
+    Config config_;
+    Tracker tracker_;
+
+    std::vector<Entry> ring_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+
+    std::size_t last_replayed_ = 0;
+    std::size_t dropped_       = 0;
+    std::size_t truncated_     = 0;
+};
+
+}  // namespace pingpong_tracker::tracker
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <eigen3/Eigen/Core>
+
+#include "utility/clock.hpp"
+#include "utility/math/kalmanfilter/ekf.hpp"
+
+namespace pingpong_tracker::tracker {
+
+/// @brief
+///   Least-squares polynomial fit over the last `window` samples of one trajectory segment.
+/// @note
+///   - Power sums of time and of time times position are kept running, adding a sample and
+///     evicting the oldest one are O(1), a fit solves one (Degree + 1)^2 system in closed form.
+///   - Times are relative to an anchor inside the window. Every `window` evictions the sums are
+///     rebuilt from the ring and re-anchored, which bounds rounding drift at O(1) amortised.
+///   - Once a segment has `break_min_samples` samples, a sample farther than the break
+///     threshold from the current fit is held back. If the next `break_confirm - 1` samples
+///     miss as well the segment restarts from the held samples (bounce, racket hit), if one
+///     fits they are dropped as outliers.
+///   - With fewer samples than Degree + 1 the fit falls back to a lower degree.
+template <int Dim, int Degree = 2>
+class TrajectoryFitter {
+public:
+    static constexpr int kTerms              = Degree + 1;
+    static constexpr std::size_t kMaxPending = 8;
+
+    using Vec = Eigen::Matrix<double, Dim, 1>;
+
+    struct Config {
+        // Samples in the fit
+        std::size_t window = 16;
+        // Absolute residual that suspects a break, unit
+        double break_threshold = 5.0;
+        // Multiple of the fit RMS residual that suspects a break, whichever is larger
+        double break_sigma = 4.0;
+        // Consecutive suspect samples that confirm a break, at most kMaxPending
+        std::size_t break_confirm = 2;
+        // Samples a segment needs before its extrapolation is trusted for the break test
+        std::size_t break_min_samples = 6;
+    };
+
+    struct State {
+        Vec position;
+        Vec velocity;
+    };
+
+    enum class Result : std::uint8_t {
+        APPENDED,
+        SUSPECT,
+        RESTARTED,
+    };
+
+    explicit TrajectoryFitter(Config config)
+        : config_{config}
+        , ring_(std::max<std::size_t>(config.window, kTerms)) {
+        config_.window        = ring_.size();
+        config_.break_confirm = std::clamp<std::size_t>(config_.break_confirm, 1, kMaxPending);
+    }
+
+    TrajectoryFitter() : TrajectoryFitter{Config{}} {
+    }
+
+    /// @brief Adds a sample, timestamps are expected in increasing order
+    auto add(util::Clock::time_point timestamp, Vec const& position) noexcept -> Result {
+        if (count_ >= std::max<std::size_t>(config_.break_min_samples, kTerms)) {
+            const auto residual = (position - evaluate(timestamp).position).norm();
+            if (residual > threshold()) {
+                pending_[pending_count_++] = {timestamp, position};
+                if (pending_count_ < config_.break_confirm) {
+                    return Result::SUSPECT;
+                }
+                restart();
+                return Result::RESTARTED;
+            }
+        }
+
+        // The held samples were outliers
+        pending_count_ = 0;
+        push(timestamp, position);
+        solve();
+        return Result::APPENDED;
+    }
+
+    /// @brief Fitted position and velocity at `timestamp`, nullopt before the first sample
+    [[nodiscard]] auto predict(util::Clock::time_point timestamp) const noexcept
+        -> std::optional<State> {
+        if (count_ == 0) {
+            return std::nullopt;
+        }
+        return evaluate(timestamp);
+    }
+
+    /// @brief Samples in the current fit
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return count_;
+    }
+
+    /// @brief Timestamp of the first sample of the current segment
+    [[nodiscard]] auto segment_start() const noexcept -> util::Clock::time_point {
+        return segment_start_;
+    }
+
+    /// @brief Root mean square residual of the current fit
+    [[nodiscard]] auto residual_rms() const noexcept -> double {
+        return rms_;
+    }
+
+    /// @brief Polynomial coefficients, column d holds c0 + c1 t + ... for axis d
+    [[nodiscard]] auto coefficients() const noexcept -> Eigen::Matrix<double, kTerms, Dim> const& {
+        return coefficients_;
+    }
+
+    auto reset() noexcept -> void {
+        count_         = 0;
+        head_          = 0;
+        evictions_     = 0;
+        pending_count_ = 0;
+        clear_sums();
+        coefficients_.setZero();
+        rms_ = 0.0;
+    }
+
+private:
+    struct Sample {
+        util::Clock::time_point timestamp{};
+        Vec position{Vec::Zero()};
+    };
+
+    auto seconds(util::Clock::time_point timestamp) const noexcept -> double {
+        return std::chrono::duration<double>(timestamp - anchor_).count();
+    }
+
+    auto threshold() const noexcept -> double {
+        return std::max(config_.break_threshold, config_.break_sigma * rms_);
+    }
+
+    auto evaluate(util::Clock::time_point timestamp) const noexcept -> State {
+        const auto t = seconds(timestamp);
+
+        auto state    = State{Vec::Zero(), Vec::Zero()};
+        auto power    = 1.0;
+        auto previous = 0.0;
+        for (int k = 0; k < kTerms; ++k) {
+            state.position += power * coefficients_.row(k).transpose();
+            if (k > 0) {
+                state.velocity += k * previous * coefficients_.row(k).transpose();
+            }
+            previous = power;
+            power *= t;
+        }
+        return state;
+    }
+
+    auto accumulate(Sample const& sample, double sign) noexcept -> void {
+        const auto t = seconds(sample.timestamp);
+
+        auto power = 1.0;
+        for (int k = 0; k < 2 * kTerms - 1; ++k) {
+            time_sums_[k] += sign * power;
+            if (k < kTerms) {
+                moment_sums_.row(k) += sign * power * sample.position.transpose();
+            }
+            power *= t;
+        }
+        square_sum_ += sign * sample.position.squaredNorm();
+    }
+
+    auto push(util::Clock::time_point timestamp, Vec const& position) noexcept -> void {
+        if (count_ == 0) {
+            anchor_        = timestamp;
+            segment_start_ = timestamp;
+        }
+
+        const auto capacity = ring_.size();
+        if (count_ == capacity) {
+            accumulate(ring_[head_], -1.0);
+            head_ = (head_ + 1) % capacity;
+            --count_;
+
+            if (++evictions_ == capacity) {
+                // Re-anchor and drop the accumulated rounding
+                evictions_ = 0;
+                anchor_    = ring_[head_].timestamp;
+                rebuild();
+            }
+        }
+
+        auto& slot     = ring_[(head_ + count_) % capacity];
+        slot.timestamp = timestamp;
+        slot.position  = position;
+        accumulate(slot, 1.0);
+        ++count_;
+    }
+
+    auto rebuild() noexcept -> void {
+        clear_sums();
+        for (std::size_t i = 0; i < count_; ++i) {
+            accumulate(ring_[(head_ + i) % ring_.size()], 1.0);
+        }
+    }
+
+    auto restart() noexcept -> void {
+        const auto pending = pending_;
+        const auto count   = pending_count_;
+        reset();
+        for (std::size_t i = 0; i < count; ++i) {
+            push(pending[i].timestamp, pending[i].position);
+        }
+        solve();
+    }
+
+    auto solve() noexcept -> void {
+        // Normal equations, unknowns beyond the sample count are pinned to zero
+        const auto terms = static_cast<int>(std::min<std::size_t>(count_, kTerms));
+
+        Eigen::Matrix<double, kTerms, kTerms> A = Eigen::Matrix<double, kTerms, kTerms>::Zero();
+        Eigen::Matrix<double, kTerms, Dim> B    = moment_sums_;
+        for (int i = 0; i < kTerms; ++i) {
+            for (int j = 0; j < kTerms; ++j) {
+                A(i, j) = i < terms && j < terms ? time_sums_[i + j] : (i == j ? 1.0 : 0.0);
+            }
+            if (i >= terms) {
+                B.row(i).setZero();
+            }
+        }
+
+        Eigen::Matrix<double, kTerms, kTerms> A_inv;
+        if (!util::symmetric_inverse(A, A_inv)) [[unlikely]] {
+            // Repeated timestamps, keep the previous fit
+            return;
+        }
+        coefficients_ = A_inv * B;
+
+        // Sum of squared residuals from the same sums, x.x - 2 c.b + c.A.c
+        const auto ssr = square_sum_ - (coefficients_.transpose() * B).trace();
+        rms_ = count_ > static_cast<std::size_t>(terms)
+                 ? std::sqrt(std::max(ssr, 0.0) / static_cast<double>(count_ - terms))
+                 : 0.0;
+    }
+
+    auto clear_sums() noexcept -> void {
+        time_sums_.fill(0.0);
+        moment_sums_.setZero();
+        square_sum_ = 0.0;
+    }
+
+    Config config_;
+
+    std::vector<Sample> ring_;
+    std::size_t head_      = 0;
+    std::size_t count_     = 0;
+    std::size_t evictions_ = 0;
+
+    util::Clock::time_point anchor_{};
+    util::Clock::time_point segment_start_{};
+
+    // sum t^k for k < 2 * kTerms - 1, sum t^k x for k < kTerms, sum |x|^2
+    std::array<double, 2 * kTerms - 1> time_sums_{};
+    Eigen::Matrix<double, kTerms, Dim> moment_sums_{Eigen::Matrix<double, kTerms, Dim>::Zero()};
+    double square_sum_ = 0.0;
+
+    Eigen::Matrix<double, kTerms, Dim> coefficients_{Eigen::Matrix<double, kTerms, Dim>::Zero()};
+    double rms_ = 0.0;
+
+    std::array<Sample, kMaxPending> pending_{};
+    std::size_t pending_count_ = 0;
+};
+
+}  // namespace pingpong_tracker::tracker
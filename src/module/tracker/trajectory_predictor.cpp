@@ -0,0 +1,287 @@
+#include "trajectory_predictor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace pingpong_tracker::tracker;
+
+namespace {
+
+using Vec3 = TrajectoryPredictor::Vec3;
+
+struct Hermite {
+    double h00, h10, h01, h11;
+    double d00, d10, d01, d11;
+
+    // Basis on [0, h] at s = tau / h, derivatives already divided by h
+    static auto at(double s, double h) noexcept -> Hermite {
+        const auto s2 = s * s;
+        const auto s3 = s2 * s;
+        return Hermite{
+            .h00 = 2.0 * s3 - 3.0 * s2 + 1.0,
+            .h10 = (s3 - 2.0 * s2 + s) * h,
+            .h01 = -2.0 * s3 + 3.0 * s2,
+            .h11 = (s3 - s2) * h,
+            .d00 = (6.0 * s2 - 6.0 * s) / h,
+            .d10 = 3.0 * s2 - 4.0 * s + 1.0,
+            .d01 = (-6.0 * s2 + 6.0 * s) / h,
+            .d11 = 3.0 * s2 - 2.0 * s,
+        };
+    }
+
+    template <class State>
+    auto apply(State const& a, State const& b) const noexcept -> State {
+        return State{
+            .position = h00 * a.position + h10 * a.velocity + h01 * b.position + h11 * b.velocity,
+            .velocity = d00 * a.position + d10 * a.velocity + d01 * b.position + d11 * b.velocity,
+        };
+    }
+};
+
+}  // namespace
+
+TrajectoryPredictor::TrajectoryPredictor(Config config) noexcept : config_{config} {
+    const auto capacity = static_cast<std::size_t>(std::ceil(config_.horizon / config_.step)) + 2;
+    samples_.resize(capacity);
+}
+
+auto TrajectoryPredictor::reset() noexcept -> void {
+    anchored_    = false;
+    finished_    = false;
+    head_        = 0;
+    tail_        = 0;
+    bounce_head_ = 0;
+    bounce_tail_ = 0;
+}
+
+auto TrajectoryPredictor::update(util::Clock::time_point timestamp, State const& state) noexcept
+    -> bool {
+    if (anchored_) {
+        const auto time = seconds(timestamp);
+        if (time < now_) {
+            // Stale state, the current trajectory already covers it
+            return false;
+        }
+
+        if (const auto predicted = evaluate(time)) {
+            const auto position_error = (predicted->position - state.position).norm();
+            const auto velocity_error = (predicted->velocity - state.velocity).norm();
+            if (position_error <= config_.position_tolerance
+                && velocity_error <= config_.velocity_tolerance) {
+                const auto k = static_cast<std::size_t>(time / config_.step);
+                head_        = std::clamp(k, head_, tail_ - 1);
+                now_         = time;
+                while (bounce_head_ != bounce_tail_ && record(bounce_head_).sample < head_) {
+                    ++bounce_head_;
+                }
+                extend(config_.max_steps_per_update);
+                return false;
+            }
+        }
+    }
+
+    anchor(timestamp, state);
+    extend(config_.max_steps_per_update);
+    return true;
+}
+
+auto TrajectoryPredictor::predict(util::Clock::time_point timestamp) const noexcept
+    -> std::optional<State> {
+    if (!anchored_) {
+        return std::nullopt;
+    }
+    return evaluate(seconds(timestamp));
+}
+
+auto TrajectoryPredictor::landing() const noexcept -> std::optional<Bounce> {
+    for (auto sequence = bounce_head_; sequence != bounce_tail_; ++sequence) {
+        const auto& bounce = record(sequence);
+        if (bounce.time >= now_) {
+            return Bounce{
+                .timestamp    = time_point(bounce.time),
+                .position     = bounce.position,
+                .velocity_in  = bounce.velocity_in,
+                .velocity_out = bounce.velocity_out,
+            };
+        }
+    }
+    return std::nullopt;
+}
+
+auto TrajectoryPredictor::bounces(std::vector<Bounce>& output) const -> void {
+    output.clear();
+    for (auto sequence = bounce_head_; sequence != bounce_tail_; ++sequence) {
+        const auto& bounce = record(sequence);
+        if (bounce.time >= now_) {
+            output.push_back(Bounce{
+                .timestamp    = time_point(bounce.time),
+                .position     = bounce.position,
+                .velocity_in  = bounce.velocity_in,
+                .velocity_out = bounce.velocity_out,
+            });
+        }
+    }
+}
+
+auto TrajectoryPredictor::horizon_end() const noexcept -> std::optional<util::Clock::time_point> {
+    if (!anchored_) {
+        return std::nullopt;
+    }
+    return time_point(static_cast<double>(tail_ - 1) * config_.step);
+}
+
+auto TrajectoryPredictor::anchor(util::Clock::time_point timestamp, State const& state) noexcept
+    -> void {
+    anchored_    = true;
+    finished_    = false;
+    origin_      = timestamp;
+    now_         = 0.0;
+    head_        = 0;
+    tail_        = 1;
+    bounce_head_ = 0;
+    bounce_tail_ = 0;
+    samples_[0]  = Sample{.position = state.position, .velocity = state.velocity, .bounce = 0};
+}
+
+auto TrajectoryPredictor::extend(std::size_t budget) noexcept -> void {
+    const auto h        = config_.step;
+    const auto bottom   = config_.ball_radius;
+    const auto capacity = samples_.size();
+
+    for (; budget > 0 && !finished_ && tail_ - head_ < capacity; --budget) {
+        const auto k       = tail_ - 1;
+        auto& current      = samples_[k % capacity];
+        const auto from    = State{current.position, current.velocity};
+        auto next          = rk4(from, h);
+        const auto crossed = from.position.z() >= bottom && next.position.z() < bottom;
+
+        if (crossed) {
+            // Locate the contact on the Hermite segment, the z of a falling ball is monotonic
+            auto lo = 0.0;
+            auto hi = 1.0;
+            for (int i = 0; i < 24; ++i) {
+                const auto mid = 0.5 * (lo + hi);
+                const auto z   = Hermite::at(mid, h).apply(from, next).position.z();
+                (z >= bottom ? lo : hi) = mid;
+            }
+            const auto sigma   = 0.5 * (lo + hi);
+            auto contact       = Hermite::at(sigma, h).apply(from, next);
+            contact.position.z() = bottom;
+
+            if (on_table(contact.position) && contact.velocity.z() < 0.0) {
+                if (bounce_tail_ - bounce_head_ == kMaxBounces) {
+                    // The ball has settled as far as this model is concerned
+                    finished_ = true;
+                    break;
+                }
+
+                auto velocity_out = contact.velocity;
+                velocity_out.z()  = -config_.restitution * contact.velocity.z();
+                velocity_out.head<2>() *= 1.0 - config_.friction;
+
+                records_[bounce_tail_ % kMaxBounces] = BounceRecord{
+                    .time         = (static_cast<double>(k) + sigma) * h,
+                    .sample       = k,
+                    .position     = contact.position,
+                    .velocity_in  = contact.velocity,
+                    .velocity_out = velocity_out,
+                };
+                current.bounce = ++bounce_tail_;
+
+                next = rk4(State{contact.position, velocity_out}, (1.0 - sigma) * h);
+            }
+        }
+
+        samples_[tail_ % capacity] =
+            Sample{.position = next.position, .velocity = next.velocity, .bounce = 0};
+        ++tail_;
+        ++integrated_steps_;
+
+        if (next.position.z() < -config_.table_height) {
+            finished_ = true;
+        }
+    }
+}
+
+auto TrajectoryPredictor::rk4(State const& state, double dt) const noexcept -> State {
+    const auto& model = config_.model;
+
+    const Vec3 k1v = model.acceleration(state.velocity);
+    const Vec3 k1p = state.velocity;
+
+    const Vec3 v2  = state.velocity + 0.5 * dt * k1v;
+    const Vec3 k2v = model.acceleration(v2);
+
+    const Vec3 v3  = state.velocity + 0.5 * dt * k2v;
+    const Vec3 k3v = model.acceleration(v3);
+
+    const Vec3 v4  = state.velocity + dt * k3v;
+    const Vec3 k4v = model.acceleration(v4);
+
+    return State{
+        .position = state.position + dt / 6.0 * (k1p + 2.0 * v2 + 2.0 * v3 + v4),
+        .velocity = state.velocity + dt / 6.0 * (k1v + 2.0 * k2v + 2.0 * k3v + k4v),
+    };
+}
+
+auto TrajectoryPredictor::on_table(Vec3 const& position) const noexcept -> bool {
+    return std::abs(position.x()) <= 0.5 * config_.table_length
+        && std::abs(position.y()) <= 0.5 * config_.table_width;
+}
+
+auto TrajectoryPredictor::seconds(util::Clock::time_point timestamp) const noexcept -> double {
+    return std::chrono::duration<double>(timestamp - origin_).count();
+}
+
+auto TrajectoryPredictor::time_point(double seconds) const noexcept -> util::Clock::time_point {
+    return origin_
+         + std::chrono::duration_cast<util::Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+auto TrajectoryPredictor::sample(std::size_t index) const noexcept -> Sample const& {
+    return samples_[index % samples_.size()];
+}
+
+auto TrajectoryPredictor::record(std::uint32_t sequence) const noexcept -> BounceRecord const& {
+    return records_[sequence % kMaxBounces];
+}
+
+auto TrajectoryPredictor::evaluate(double time) const noexcept -> std::optional<State> {
+    const auto h     = config_.step;
+    const auto first = static_cast<double>(head_) * h;
+    const auto last  = static_cast<double>(tail_ - 1) * h;
+
+    // Half a nanosecond of slack for the round trip through Clock::duration
+    constexpr auto kSlack = 1e-9;
+    if (time < first - kSlack || time > last + kSlack) {
+        return std::nullopt;
+    }
+
+    const auto k = std::clamp(static_cast<std::size_t>(std::max(time, 0.0) / h), head_, tail_ - 1);
+    const auto& a = sample(k);
+    if (k + 1 == tail_) {
+        return State{a.position, a.velocity};
+    }
+    const auto& b = sample(k + 1);
+    const auto tau = time - static_cast<double>(k) * h;
+
+    auto taylor = [this](Vec3 const& position, Vec3 const& velocity, double dt) {
+        const Vec3 acceleration = config_.model.acceleration(velocity);
+        return State{
+            .position = position + velocity * dt + 0.5 * dt * dt * acceleration,
+            .velocity = velocity + acceleration * dt,
+        };
+    };
+
+    if (a.bounce != 0) {
+        const auto& bounce = record(a.bounce - 1);
+        if (time < bounce.time) {
+            return taylor(a.position, a.velocity, tau);
+        }
+        return taylor(bounce.position, bounce.velocity_out, time - bounce.time);
+    }
+
+    return Hermite::at(tau / h, h).apply(State{a.position, a.velocity},
+                                         State{b.position, b.velocity});
+}
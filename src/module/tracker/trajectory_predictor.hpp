@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <eigen3/Eigen/Core>
+
+#include "utility/clock.hpp"
+#include "utility/math/ballistic.hpp"
+
+namespace pingpong_tracker::tracker {
+
+/// @brief
+///   Predicts the flight of a tracked ball over the table, including table bounces.
+/// @note
+///   - Table frame: origin at the centre of the playing surface, x along the length, y across,
+///     z up, metres and seconds.
+///   - The trajectory is integrated with RK4 on a fixed time grid into a ring of samples. Later
+///     updates that agree with the prediction within tolerance only drop the consumed head and
+///     extend the tail, anything else re-anchors the ring on the new state.
+///   - Every update integrates at most `max_steps_per_update` steps, so a re-anchored horizon is
+///     filled over a few frames and the per-frame cost has a hard bound.
+///   - `predict` is O(1): cubic Hermite between two samples, or a Taylor step from the bounce
+///     inside the interval that contains one.
+class TrajectoryPredictor {
+public:
+    using Vec3  = Eigen::Vector3d;
+    using Model = util::BallisticModel<3>;
+
+    struct Config {
+        Model model{.gravity = {0.0, 0.0, -9.81}, .drag = 0.14};
+
+        double ball_radius  = 0.02;
+        double table_length = 2.74;
+        double table_width  = 1.525;
+        // Height of the playing surface above the floor, the flight ends below it
+        double table_height = 0.76;
+
+        // Ratio of the normal velocity after and before a bounce
+        double restitution = 0.9;
+        // Fraction of the tangential velocity lost in a bounce
+        double friction = 0.2;
+
+        // Integration step and prediction horizon, seconds
+        double step    = 0.002;
+        double horizon = 1.0;
+
+        std::size_t max_steps_per_update = 128;
+
+        // Deviations of a new state from the prediction that still keep the current trajectory
+        double position_tolerance = 0.01;
+        double velocity_tolerance = 0.15;
+    };
+
+    struct State {
+        Vec3 position = Vec3::Zero();
+        Vec3 velocity = Vec3::Zero();
+    };
+
+    struct Bounce {
+        util::Clock::time_point timestamp;
+        Vec3 position;
+        Vec3 velocity_in;
+        Vec3 velocity_out;
+    };
+
+    static constexpr std::size_t kMaxBounces = 4;
+
+    explicit TrajectoryPredictor(Config config) noexcept;
+
+    /// @brief Feeds the tracked state at `timestamp`
+    /// @return True when the trajectory was re-anchored on this state
+    auto update(util::Clock::time_point timestamp, State const& state) noexcept -> bool;
+
+    /// @brief State at `timestamp`, nullopt outside the integrated span
+    [[nodiscard]] auto predict(util::Clock::time_point timestamp) const noexcept
+        -> std::optional<State>;
+
+    /// @brief First table bounce still ahead of the last update, if it was integrated yet
+    [[nodiscard]] auto landing() const noexcept -> std::optional<Bounce>;
+
+    /// @brief Upcoming bounces in time order
+    auto bounces(std::vector<Bounce>& output) const -> void;
+
+    /// @brief Latest timestamp `predict` can answer, nullopt before the first update
+    [[nodiscard]] auto horizon_end() const noexcept -> std::optional<util::Clock::time_point>;
+
+    /// @brief RK4 steps integrated since construction, each update adds at most
+    ///        `max_steps_per_update`
+    [[nodiscard]] auto integrated_steps() const noexcept -> std::uint64_t {
+        return integrated_steps_;
+    }
+
+    [[nodiscard]] auto config() const noexcept -> Config const& {
+        return config_;
+    }
+
+    auto reset() noexcept -> void;
+
+private:
+    struct Sample {
+        Vec3 position;
+        Vec3 velocity;
+        // 1 + sequence of the bounce inside [this, next) or 0
+        std::uint32_t bounce;
+    };
+
+    struct BounceRecord {
+        double time;
+        std::size_t sample;
+        Vec3 position;
+        Vec3 velocity_in;
+        Vec3 velocity_out;
+    };
+
+    auto anchor(util::Clock::time_point timestamp, State const& state) noexcept -> void;
+    auto extend(std::size_t budget) noexcept -> void;
+    auto rk4(State const& state, double dt) const noexcept -> State;
+    auto on_table(Vec3 const& position) const noexcept -> bool;
+
+    auto seconds(util::Clock::time_point timestamp) const noexcept -> double;
+    auto time_point(double seconds) const noexcept -> util::Clock::time_point;
+    auto sample(std::size_t index) const noexcept -> Sample const&;
+    auto record(std::uint32_t sequence) const noexcept -> BounceRecord const&;
+    auto evaluate(double time) const noexcept -> std::optional<State>;
+
+    Config config_;
+
+    bool anchored_ = false;
+    bool finished_ = false;
+    util::Clock::time_point origin_{};
+    // Seconds since origin of the last accepted update
+    double now_ = 0.0;
+
+    // Absolute sample indices, sample k is at origin + k * step
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+    std::vector<Sample> samples_;
+
+    std::array<BounceRecord, kMaxBounces> records_{};
+    std::uint32_t bounce_head_ = 0;
+    std::uint32_t bounce_tail_ = 0;
+
+    std::uint64_t integrated_steps_ = 0;
+};
+
+}  // namespace pingpong_tracker::tracker
@@ -0,0 +1,379 @@
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/videoio.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kernel/identifier.hpp"
+#include "kernel/tracker.hpp"
+#include "utility/configure/configuration.hpp"
+#include "utility/image/image.details.hpp"
+#include "utility/panic.hpp"
+#include "utility/record/detection_file.hpp"
+#include "utility/serializable.hpp"
+#include "utility/singleton/running.hpp"
+#include "utility/thread/workers.hpp"
+
+using namespace pingpong_tracker;
+
+namespace {
+
+struct Config : util::SerializableMixin {
+    // Inference threads, zero for one per hardware thread
+    int threads = 0;
+    // Frames decoded ahead and in inference at once
+    int in_flight = 8;
+    // Frames per block of the output file
+    int block_frames = 256;
+    // fdatasync after every block
+    bool sync = false;
+    // seconds
+    double report_interval = 5.0;
+    // Frame rate of image sequences, videos use their own
+    double frame_rate = 120.0;
+
+    constexpr static std::tuple kMetas{
+        // clang-format off
+        "threads",                  &Config::threads,
+        "in_flight",                &Config::in_flight,
+        "block_frames",             &Config::block_frames,
+        "sync",                     &Config::sync,
+        "report_interval",          &Config::report_interval,
+        "frame_rate",               &Config::frame_rate,
+        // clang-format on
+    };
+};
+
+/// @brief
+///   Unpaced frames of a video file, or of a directory of images in name order.
+/// @note Timestamps are nanoseconds from the start of the source
+class FrameSource {
+public:
+    auto open(const std::string& location, double image_rate) -> std::expected<void, std::string> {
+        if (std::filesystem::is_directory(location)) {
+            for (const auto& entry : std::filesystem::directory_iterator{location}) {
+                auto extension = entry.path().extension().string();
+                std::ranges::transform(extension, extension.begin(),
+                                       [](unsigned char c) { return std::tolower(c); });
+                if (extension == ".png" || extension == ".jpg" || extension == ".jpeg"
+                    || extension == ".bmp") {
+                    images_.push_back(entry.path().string());
+                }
+            }
+            if (images_.empty()) {
+                return std::unexpected{std::format("No images in '{}'", location)};
+            }
+            std::ranges::sort(images_);
+            frame_rate_ = image_rate;
+            return {};
+        }
+
+        video_.emplace(location);
+        if (!video_->isOpened()) {
+            return std::unexpected{std::format("Failed to open video '{}'", location)};
+        }
+        frame_rate_ = video_->get(cv::CAP_PROP_FPS);
+        if (frame_rate_ <= 0) {
+            frame_rate_ = image_rate;
+        }
+        return {};
+    }
+
+    [[nodiscard]] auto frame_rate() const noexcept {
+        return frame_rate_;
+    }
+
+    /// @return Frames in the source, 0 when unknown
+    [[nodiscard]] auto frames() const noexcept -> std::uint64_t {
+        if (video_) {
+            return static_cast<std::uint64_t>(std::max(0.0, video_->get(cv::CAP_PROP_FRAME_COUNT)));
+        }
+        return images_.size();
+    }
+
+    /// @brief Positions the source so the next read returns frame `index`
+    auto seek(std::uint64_t index) -> std::expected<void, std::string> {
+        next_ = index;
+        if (!video_ || index == 0) {
+            return {};
+        }
+        // Keyframe seeking is not exact for every codec, grab through the frames otherwise
+        video_->set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(index));
+        if (static_cast<std::uint64_t>(video_->get(cv::CAP_PROP_POS_FRAMES)) == index) {
+            return {};
+        }
+        video_->set(cv::CAP_PROP_POS_FRAMES, 0);
+        for (std::uint64_t i = 0; i < index; ++i) {
+            if (!video_->grab()) {
+                return std::unexpected{std::format("The source ends before frame {}", index)};
+            }
+        }
+        return {};
+    }
+
+    /// @return false at the end of the source
+    auto read(cv::Mat& mat, std::int64_t& timestamp) -> bool {
+        const auto fallback = static_cast<std::int64_t>(static_cast<double>(next_) * 1e9
+                                                        / frame_rate_);
+        if (video_) {
+            if (!video_->read(mat) || mat.empty()) {
+                return false;
+            }
+            const auto position = video_->get(cv::CAP_PROP_POS_MSEC);
+            timestamp = position > 0 ? static_cast<std::int64_t>(position * 1e6) : fallback;
+        } else {
+            if (next_ >= images_.size()) {
+                return false;
+            }
+            mat = cv::imread(images_[next_], cv::IMREAD_COLOR);
+            if (mat.empty()) {
+                spdlog::warn("Failed to read '{}', stopping there", images_[next_]);
+                return false;
+            }
+            timestamp = fallback;
+        }
+        ++next_;
+        return true;
+    }
+
+private:
+    std::optional<cv::VideoCapture> video_;
+    std::vector<std::string> images_;
+    double frame_rate_ = 0.0;
+    std::uint64_t next_ = 0;
+};
+
+/// @brief A frame between decoding and writing, the decoder and the writer take turns on it
+struct Slot {
+    enum State : std::uint32_t { FREE, INFERRING, READY, END };
+
+    std::atomic<std::uint32_t> state{FREE};
+
+    std::unique_ptr<Image> image;
+    std::uint64_t index{0};
+    std::int64_t timestamp{0};
+    std::expected<std::vector<Ball2D>, std::string> balls;
+
+    auto wait_while(auto&& busy) const noexcept -> std::uint32_t {
+        for (;;) {
+            const auto current = state.load(std::memory_order_acquire);
+            if (!busy(current)) {
+                return current;
+            }
+            state.wait(current, std::memory_order_acquire);
+        }
+    }
+
+    auto publish(State next) noexcept -> void {
+        state.store(next, std::memory_order_release);
+        state.notify_all();
+    }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        spdlog::error("Usage: {} <video or image directory> <output file>", argv[0]);
+        return 1;
+    }
+    const auto input  = std::string{argv[1]};
+    const auto output = std::string{argv[2]};
+
+    auto handle_result = [&](auto runtime_name, const auto& result) {
+        if (!result.has_value()) {
+            spdlog::error("Failed to init '{}'", runtime_name);
+            spdlog::error("  {}", result.error());
+            util::panic(std::format("Failed to initialize {}", runtime_name));
+        }
+    };
+
+    // Interrupted runs write out the frames in flight, the next run resumes after them
+    std::signal(SIGINT, [](int) { util::set_running(false); });
+    std::signal(SIGTERM, [](int) { util::set_running(false); });
+
+    auto identifier = kernel::Identifier{};
+    auto tracker    = kernel::Tracker{};
+
+    auto configuration = util::configuration();
+    auto offline       = Config{};
+    handle_result("offline", offline.serialize(configuration["offline"]));
+
+    // IDENTIFIER
+    auto ordered_inference = false;
+    {
+        auto config = configuration["identifier"];
+
+        auto resolve_model_location = [](YAML::Node node) {
+            const auto model_location =
+                std::filesystem::path{util::Parameters::share_location()}
+                / std::filesystem::path{node["model_location"].as<std::string>()};
+            node["model_location"] = model_location.string();
+        };
+        resolve_model_location(config);
+        if (config["heatmap"]) {
+            resolve_model_location(config["heatmap"]);
+        }
+        // The heatmap backend stacks consecutive frames, it must see them in order
+        ordered_inference = config["backend"] && config["backend"].as<std::string>() == "heatmap";
+
+        auto result = identifier.initialize(config);
+        handle_result("identifier", result);
+    }
+
+    // TRACKER
+    {
+        auto config = configuration["tracker"];
+        auto result = tracker.initialize(config);
+        handle_result("tracker", result);
+    }
+
+    // SOURCE & OUTPUT
+    auto source = FrameSource{};
+    handle_result("source", source.open(input, offline.frame_rate));
+
+    auto writer = util::DetectionFileWriter::open({
+        .path         = output,
+        .source       = std::filesystem::path{input}.filename().string(),
+        .frame_rate   = source.frame_rate(),
+        .block_frames = static_cast<std::size_t>(std::max(offline.block_frames, 1)),
+        .sync         = offline.sync,
+    });
+    handle_result("output", writer);
+
+    const auto first = writer->next_frame();
+    if (first > 0) {
+        spdlog::info("Resuming '{}' at frame {}", output, first);
+    }
+    handle_result("seek", source.seek(first));
+
+    // RUNTIME
+    auto workers_config    = WorkersContext::Config{};
+    workers_config.threads = static_cast<std::size_t>(std::max(offline.threads, 0));
+    workers_config.name    = "offline";
+    auto workers           = WorkersContext{workers_config};
+
+    const auto slots = ordered_inference ? std::size_t{1}
+                                         : static_cast<std::size_t>(std::max(offline.in_flight, 1));
+    auto ring        = std::vector<Slot>(slots);
+
+    // Decodes in frame order and hands every frame to the pool, a slot is reused once written
+    auto decoder = std::jthread{[&] {
+        for (auto index = first;; ++index) {
+            auto& slot = ring[index % slots];
+            slot.wait_while([](auto state) { return state != Slot::FREE; });
+
+            auto mat = cv::Mat{};
+            if (!util::get_running() || !source.read(mat, slot.timestamp)) {
+                slot.publish(Slot::END);
+                return;
+            }
+            slot.index = index;
+            slot.image = std::make_unique<Image>();
+            slot.image->details().set_mat(std::move(mat));
+            slot.image->set_timestamp(util::Clock::time_point{
+                std::chrono::duration_cast<util::Clock::duration>(
+                    std::chrono::nanoseconds{slot.timestamp})});
+            slot.state.store(Slot::INFERRING, std::memory_order_relaxed);
+
+            workers.spawn([&slot, &identifier]() noexcept {
+                slot.balls = identifier.sync_identify(*slot.image);
+                slot.publish(Slot::READY);
+            });
+        }
+    }};
+
+    // Tracks and writes in frame order on this thread
+    const auto total        = source.frames();
+    const auto report_every = std::chrono::duration_cast<util::Clock::duration>(
+        std::chrono::duration<double>{offline.report_interval});
+    const auto started = util::Clock::now();
+
+    auto reported        = started;
+    auto reported_frames = std::uint64_t{0};
+    auto written         = std::uint64_t{0};
+    auto failed          = std::uint64_t{0};
+    auto write_error     = std::optional<std::string>{};
+
+    for (auto index = first;; ++index) {
+        auto& slot = ring[index % slots];
+        const auto state = slot.wait_while(
+            [](auto state) { return state == Slot::FREE || state == Slot::INFERRING; });
+        if (state == Slot::END) {
+            break;
+        }
+        if (write_error) {
+            // Nothing is appended after a failed write, frames still in flight are only drained
+            slot.image.reset();
+            slot.publish(Slot::FREE);
+            continue;
+        }
+
+        auto balls = std::vector<Ball2D>{};
+        if (slot.balls) {
+            balls = std::move(*slot.balls);
+        } else {
+            ++failed;
+            spdlog::debug("Frame {}: {}", slot.index, slot.balls.error());
+        }
+        const auto tracks = tracker.update(*slot.image, balls);
+
+        if (auto result = writer->append(slot.index, slot.timestamp, balls, tracks); !result) {
+            write_error = result.error();
+            util::set_running(false);
+        } else {
+            ++written;
+        }
+        slot.image.reset();
+        slot.publish(Slot::FREE);
+
+        const auto now = util::Clock::now();
+        if (now - reported >= report_every) {
+            const auto seconds = std::chrono::duration<double>{now - reported}.count();
+            const auto fps     = static_cast<double>(written - reported_frames) / seconds;
+            if (total > 0) {
+                const auto done = first + written;
+                spdlog::info("{}/{} frames ({:.1f}%), {:.1f} fps, about {:.0f}s left", done, total,
+                             100.0 * static_cast<double>(done) / static_cast<double>(total), fps,
+                             static_cast<double>(total - std::min(done, total)) / std::max(fps, 1.0));
+            } else {
+                spdlog::info("{} frames, {:.1f} fps", first + written, fps);
+            }
+            reported        = now;
+            reported_frames = written;
+        }
+    }
+    decoder.join();
+
+    if (write_error) {
+        spdlog::error("Failed to write '{}' at frame {}: {}", output, first + written,
+                      *write_error);
+        return 1;
+    }
+    if (auto result = writer->flush(); !result) {
+        spdlog::error("Failed to write '{}': {}", output, result.error());
+        return 1;
+    }
+
+    const auto seconds = std::chrono::duration<double>{util::Clock::now() - started}.count();
+    spdlog::info("{} frames written to '{}' in {:.1f}s, {:.1f} fps, {} failed detections",
+                 written, output, seconds, static_cast<double>(written) / std::max(seconds, 1e-9),
+                 failed);
+    if (!util::get_running()) {
+        spdlog::info("Interrupted, run again to resume at frame {}", first + written);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <expected>
+#include <format>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "kernel/replay.hpp"
+#include "utility/configure/configuration.hpp"
+#include "utility/panic.hpp"
+#include "utility/record/detection_file.hpp"
+#include "utility/serializable.hpp"
+#include "utility/thread/workers.hpp"
+
+using namespace pingpong_tracker;
+
+namespace {
+
+struct Config : util::SerializableMixin {
+    // Variants replayed at once, zero for one per hardware thread
+    int threads = 0;
+    // Best variants logged, every one goes to the CSV
+    int top = 10;
+    // Share of the detected frames a variant must track to rank by its error
+    double min_coverage = 0.8;
+
+    constexpr static std::tuple kMetas{
+        // clang-format off
+        "threads",                  &Config::threads,
+        "top",                      &Config::top,
+        "min_coverage",             &Config::min_coverage,
+        // clang-format on
+    };
+};
+
+auto write_csv(const std::string& path, const std::vector<kernel::ReplayVariant>& variants,
+               const std::vector<kernel::ReplayResult>& results)
+    -> std::expected<void, std::string> {
+    auto out = std::ofstream{path};
+    if (!out) {
+        return std::unexpected{std::format("Failed to open '{}'", path)};
+    }
+    out << "variant,frames,detected,tracked,coverage,coasting,tracks,predictions,median_error_px,"
+           "p95_error_px,mean_error_px,error\n";
+    for (std::size_t i = 0; i < variants.size(); ++i) {
+        const auto& result = results[i];
+        const auto score   = result.value_or(kernel::ReplayScore{});
+        out << std::format("\"{}\",{},{},{},{:.4f},{},{},{},{:.3f},{:.3f},{:.3f},\"{}\"\n",
+                           variants[i].label, score.frames, score.detected, score.tracked,
+                           score.coverage(), score.coasting, score.tracks, score.predictions,
+                           score.median_error, score.p95_error, score.mean_error,
+                           result ? "" : result.error());
+    }
+    return {};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 3) {
+        spdlog::error("Usage: {} <detection file> [results.csv]", argv[0]);
+        return 1;
+    }
+
+    auto handle_result = [&](auto runtime_name, const auto& result) {
+        if (!result.has_value()) {
+            spdlog::error("Failed to init '{}'", runtime_name);
+            spdlog::error("  {}", result.error());
+            util::panic(std::format("Failed to initialize {}", runtime_name));
+        }
+    };
+
+    auto configuration = util::configuration();
+    auto replay_config = Config{};
+    handle_result("replay", replay_config.serialize(configuration["replay"]));
+
+    auto file = util::DetectionFile::open(argv[1]);
+    handle_result("detection file", file);
+    spdlog::info("Replaying {} frames of '{}'", file->size(), file->source());
+
+    auto variants =
+        kernel::expand_sweep(configuration["tracker"], configuration["replay"]["sweep"]);
+    handle_result("sweep", variants);
+
+    // Every variant owns its tracker and reads the shared mapping, they run side by side
+    auto workers_config    = WorkersContext::Config{};
+    workers_config.threads = static_cast<std::size_t>(std::max(replay_config.threads, 0));
+    workers_config.name    = "replay";
+    auto workers           = WorkersContext{workers_config};
+
+    const auto started = util::Clock::now();
+    auto results       = std::vector<kernel::ReplayResult>(variants->size());
+    workers.parallel_for(0, variants->size(), 1, [&](std::size_t first, std::size_t last) noexcept {
+        for (auto i = first; i < last; ++i) {
+            try {
+                results[i] = kernel::replay(*file, (*variants)[i].config);
+            } catch (const std::exception& e) {
+                results[i] = std::unexpected{std::string{e.what()}};
+            }
+        }
+    });
+    const auto seconds = std::chrono::duration<double>{util::Clock::now() - started}.count();
+
+    const auto order = kernel::rank_variants(results, replay_config.min_coverage);
+    const auto top   = static_cast<std::size_t>(std::max(replay_config.top, 0));
+    const auto shown = std::min(order.size(), top);
+    for (std::size_t rank = 0; rank < shown; ++rank) {
+        const auto& variant = (*variants)[order[rank]];
+        const auto& result  = results[order[rank]];
+        const auto label    = variant.label.empty() ? "configured" : variant.label;
+        if (!result) {
+            spdlog::warn("{}: {}", label, result.error());
+            continue;
+        }
+        const auto& score = *result;
+        spdlog::info("#{} {}: error median {:.2f}px p95 {:.1f}px over {} predictions, coverage "
+                     "{:.1f}%, {} tracks, {} coasting, {:.0f} fps",
+                     rank + 1, label, score.median_error, score.p95_error, score.predictions,
+                     100.0 * score.coverage(), score.tracks, score.coasting,
+                     static_cast<double>(score.frames)
+                         / std::max(std::chrono::duration<double>{score.elapsed}.count(), 1e-9));
+    }
+
+    const auto frames = static_cast<double>(file->size() * variants->size());
+    spdlog::info("{} variants in {:.2f}s on {} threads, {:.0f} frames/s in total", variants->size(),
+                 seconds, workers.threads(), frames / std::max(seconds, 1e-9));
+
+    if (argc == 3) {
+        if (auto result = write_csv(argv[2], *variants, results); !result) {
+            spdlog::error("{}", result.error());
+            return 1;
+        }
+        spdlog::info("Results written to '{}'", argv[2]);
+    }
+    return 0;
+}
@@ -1,18 +1,32 @@
 
 #include <spdlog/spdlog.h>
 
+#include <expected>
 #include <format>
-#include <thread>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "kernel/capturer.hpp"
+#include "kernel/geometry.hpp"
 #include "kernel/identifier.hpp"
+#include "kernel/metrics.hpp"
+#include "kernel/pipeline.hpp"
+#include "kernel/predictor.hpp"
+#include "kernel/publisher.hpp"
+#include "kernel/recorder.hpp"
+#include "kernel/tracker.hpp"
 #include "kernel/visualization.hpp"
 #include "module/debug/action_throttler.hpp"
 #include "module/debug/framerate.hpp"
 #include "utility/configure/configuration.hpp"
-#include "utility/image/ball.hpp"
+#include "utility/coroutine/executor.hpp"
+#include "utility/coroutine/task.hpp"
+#include "utility/metrics/metrics.hpp"
 #include "utility/panic.hpp"
 #include "utility/singleton/running.hpp"
+#include "utility/thread/execution.hpp"
 
 using namespace pingpong_tracker;
 
@@ -33,8 +47,14 @@ int main() {
     /// Runtime
     auto capturer   = kernel::Capturer{};
     auto identifier = kernel::Identifier{};
+    auto tracker    = kernel::Tracker{};
+    auto geometry   = kernel::Geometry{};
+    auto predictor  = kernel::Predictor{};
+    auto publisher  = kernel::Publisher{};
+    auto recorder   = kernel::Recorder{};
 
     auto visualization    = kernel::Visualization{};
+    auto metrics          = kernel::MetricsExporter{};
     auto action_throttler = util::ActionThrottler{1s, 233};
 
     /// Configure
@@ -42,6 +62,15 @@ int main() {
     auto use_visualization = configuration["use_visualization"].as<bool>();
     auto use_painted_image = configuration["use_painted_image"].as<bool>();
 
+    // EXECUTION
+    // Before any thread starts, threads without a role of their own inherit the main one
+    {
+        auto config = configuration["execution"];
+        auto result = util::execution().configure(config);
+        handle_result("execution", result);
+        util::execution().apply("main");
+    }
+
     // CAPTURER
     {
         auto config = configuration["capturer"];
@@ -52,15 +81,69 @@ int main() {
     {
         auto config = configuration["identifier"];
 
-        const auto model_location =
-            std::filesystem::path{util::Parameters::share_location()}
-            / std::filesystem::path{config["model_location"].as<std::string>()};
-        config["model_location"] = model_location.string();
+        auto resolve_model_location = [](YAML::Node node) {
+            const auto model_location =
+                std::filesystem::path{util::Parameters::share_location()}
+                / std::filesystem::path{node["model_location"].as<std::string>()};
+            node["model_location"] = model_location.string();
+        };
+        resolve_model_location(config);
+        if (config["heatmap"]) {
+            resolve_model_location(config["heatmap"]);
+        }
+        // One request per frame in flight, made up front so inference does not allocate them
+        if (const auto concurrent_frames = configuration["runtime"]["concurrent_frames"]) {
+            config["infer_requests"] = concurrent_frames.as<int>();
+        }
 
-        auto result = identifier.initialize(config);
+        // OpenVINO starts its inference threads while compiling, they take the inference role
+        auto result = std::expected<void, std::string>{};
+        util::execution().run_as("inference", [&] { result = identifier.initialize(config); });
         handle_result("identifier", result);
     }
 
+    // TRACKER
+    {
+        auto config = configuration["tracker"];
+        auto result = tracker.initialize(config);
+        handle_result("tracker", result);
+    }
+
+    // GEOMETRY & PREDICTOR
+    {
+        auto config     = configuration["geometry"];
+        config["table"] = configuration["table"];
+        auto result     = geometry.initialize(config);
+        // The capturer delivers a single camera, a pair would never reach `triangulate` and the
+        // predictor would sit configured but unfed
+        if (result && config["mode"].as<std::string>() == "stereo") {
+            result = std::unexpected{std::string{
+                "geometry.mode 'stereo' needs synchronised camera pairs, which the capturer does "
+                "not deliver yet, use 'monocular' or 'none'"}};
+        }
+        handle_result("geometry", result);
+    }
+    if (geometry.initialized()) {
+        auto config     = configuration["predictor"];
+        config["table"] = configuration["table"];
+        auto result     = predictor.initialize(config);
+        handle_result("predictor", result);
+    }
+
+    // PUBLISHER
+    {
+        auto config = configuration["publisher"];
+        auto result = publisher.initialize(config);
+        handle_result("publisher", result);
+    }
+
+    // RECORDER
+    {
+        auto config = configuration["recorder"];
+        auto result = recorder.initialize(config);
+        handle_result("recorder", result);
+    }
+
     // VISUALIZATION
     if (use_visualization) {
         auto config = configuration["visualization"];
@@ -68,20 +151,46 @@ int main() {
         handle_result("visualization", result);
     }
 
+    // METRICS
+    {
+        auto config = configuration["metrics"];
+        auto result = metrics.initialize(config);
+        handle_result("metrics", result);
+    }
+
     // DEBUG
     {
         action_throttler.register_action("no_balls_detected", 3);
         action_throttler.register_action("identify_error", 1);
         action_throttler.register_action("balls_detected", 10);
+        action_throttler.register_action("landing_predicted", 10);
     }
 
-    auto detect_balls = [&](const auto& image) {
-        auto result = identifier.sync_identify(*image);
+    // Frames are processed concurrently, the throttled logging is shared between them
+    auto debug_mutex = std::mutex{};
+
+    // Frames count once tracked, the latency spans capture to the tracking result
+    auto& registry       = util::metrics::registry();
+    auto& frames_tracked = registry.counter("pingpong_frames_total", "Frames through tracking");
+    auto& frame_latency  = registry.histogram("pingpong_frame_latency_seconds",
+                                              "From capture to the tracking result");
+    registry.rate("pingpong_fps", "Frames tracked per second", frames_tracked);
+
+    auto track_frame = [&](const Image& image, const std::vector<Ball2D>& balls_2d) {
+        auto tracks = tracker.update(image, balls_2d);
+        frame_latency.observe(util::Clock::now() - image.get_timestamp());
+        frames_tracked.add();
+        return tracks;
+    };
+
+    // Logs a detection result through the throttler, a failure leaves no balls
+    auto report_detection = [&](std::expected<std::vector<Ball2D>, std::string> result) {
+        auto lock = std::scoped_lock{debug_mutex};
         if (!result) {
             action_throttler.dispatch("identify_error", [&] {
                 spdlog::warn("Failed to identify balls: {}", result.error());
             });
-            return typename decltype(result)::value_type{};
+            return std::vector<Ball2D>{};
         }
 
         const auto& balls = *result;
@@ -93,34 +202,166 @@ int main() {
                                       [&] { spdlog::info("Detected {} balls", balls.size()); });
             action_throttler.reset("no_balls_detected");
         }
-
         return std::move(*result);
     };
 
-    auto visualize_detection = [&](auto& image, const auto& balls_2d) {
-        if (use_painted_image) {
-            for (const auto& ball_2d : balls_2d) {
-                util::draw(image, ball_2d);
-            }
+    auto predict_landing = [&](const Image& image, const std::vector<Ball2D>& balls_2d) {
+        if (!geometry.initialized()) {
+            return std::optional<BallTrack3D>{};
         }
+        auto track = predictor.update(image, geometry.locate(balls_2d));
+        if (!track || !track->landing) {
+            return track;
+        }
+
+        auto lock = std::scoped_lock{debug_mutex};
+        action_throttler.dispatch("landing_predicted", [&] {
+            const auto& landing = *track->landing;
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(landing.timestamp
+                                                                      - track->timestamp);
+            spdlog::info("Ball {} lands at ({:.2f}, {:.2f}) in {}ms, flight probability {:.2f}",
+                         track->id, landing.position.x, landing.position.y, remaining.count(),
+                         landing.confidence);
+        });
+        return track;
+    };
+
+    // RUNTIME
+    const auto mode = configuration["runtime"]["mode"].as<std::string>();
+    if (mode == "staged") {
+        auto pipeline = kernel::Pipeline{};
+
+        pipeline.register_step("capture", [&](kernel::Frame& frame) {
+            frame.image = capturer.fetch_image();
+            frame.balls.clear();
+            frame.tracks.clear();
+            frame.prediction.reset();
+            frame.late = false;
+            return frame.image != nullptr;
+        });
+        pipeline.register_step("detect", [&](kernel::Frame& frame) {
+            frame.balls = report_detection(identifier.sync_identify(*frame.image));
+            return true;
+        });
+        // A late frame skipped detection, feeding it to the filters would read as a miss
+        pipeline.register_step("track", [&](kernel::Frame& frame) {
+            if (!frame.late) {
+                frame.tracks = track_frame(*frame.image, frame.balls);
+            }
+            return true;
+        });
+        pipeline.register_step("predict", [&](kernel::Frame& frame) {
+            if (!frame.late) {
+                frame.prediction = predict_landing(*frame.image, frame.balls);
+            }
+            return true;
+        });
+        pipeline.register_step("publish", [&](kernel::Frame& frame) {
+            if (!frame.late) {
+                publisher.publish(*frame.image, frame.balls, frame.tracks, frame.prediction);
+            }
+            return true;
+        });
+        pipeline.register_step("record", [&](kernel::Frame& frame) {
+            if (!frame.late) {
+                recorder.record(*frame.image, frame.balls, frame.tracks);
+            }
+            return true;
+        });
+        // Overlays are drawn by the streaming thread, only the metadata goes along
+        pipeline.register_step("stream", [&](kernel::Frame& frame) {
+            if (!visualization.initialized()) {
+                return true;
+            }
+            if (use_painted_image) {
+                visualization.send_image(*frame.image, frame.balls, frame.tracks);
+            } else {
+                visualization.send_image(*frame.image);
+            }
+            return true;
+        });
+
+        auto result = pipeline.initialize(configuration["pipeline"]);
+        handle_result("pipeline", result);
+
+        pipeline.run();
+        return 0;
+    }
+    if (mode != "coroutine") {
+        util::panic(std::format("Unknown runtime mode '{}'", mode));
+    }
+
+    auto worker_threads    = configuration["runtime"]["worker_threads"].as<std::size_t>();
+    auto concurrent_frames = configuration["runtime"]["concurrent_frames"].as<std::size_t>();
+    // Without a worker nothing ever resumes the pipelines, sync_wait would block forever
+    if (worker_threads == 0) {
+        util::panic("runtime.worker_threads must be at least 1");
+    }
+    auto frame_budget      = std::chrono::duration_cast<util::Clock::duration>(
+        std::chrono::duration<double, std::milli>{
+            configuration["runtime"]["frame_budget"].as<double>()});
 
-        if (visualization.initialized()) {
-            visualization.send_image(image);
+    // Frames already older than the budget skip detection and go straight to the preview
+    auto& frame_age   = registry.histogram("pingpong_frame_age_seconds",
+                                           "Frame age since capture when detection starts");
+    auto& frames_late = registry.counter("pingpong_frames_late_total",
+                                         "Frames over the budget that skipped detection");
+    auto late_frame   = [&](const Image& image) {
+        const auto age = util::Clock::now() - image.get_timestamp();
+        frame_age.observe(age);
+        if (frame_budget <= util::Clock::duration::zero() || age <= frame_budget) {
+            return false;
         }
+        frames_late.add();
+        return true;
     };
 
-    for (;;) {
-        if (!util::get_running()) [[unlikely]]
-            break;
+    auto workers   = util::Executor{worker_threads, "pipeline"};
+    auto streaming = util::Executor{1, "streaming"};
 
-        if (auto image = capturer.fetch_image()) {
-            auto balls = detect_balls(image);
-            visualize_detection(*image, balls);
+    auto detect_balls = [&](const Image& image) -> util::Task<std::vector<Ball2D>> {
+        co_return report_detection(co_await identifier.await_identify(image, workers));
+    };
 
+    auto visualize_detection = [&](const Image& image, const std::vector<Ball2D>& balls_2d,
+                                   const std::vector<BallTrack2D>& tracks) -> util::Task<void> {
+        if (!visualization.initialized()) {
+            co_return;
+        }
+        if (use_painted_image) {
+            co_await visualization.await_send(image, balls_2d, tracks, streaming);
         } else {
-            std::this_thread::sleep_for(1ms);
+            co_await visualization.await_send(image, {}, {}, streaming);
+        }
+    };
+
+    auto frame_pipeline = [&]() -> util::Task<void> {
+        while (util::get_running()) {
+            auto image = co_await capturer.await_image(workers);
+            if (!image) [[unlikely]]
+                continue;
+
+            if (late_frame(*image)) {
+                co_await visualize_detection(*image, {}, {});
+                continue;
+            }
+
+            auto balls  = co_await detect_balls(*image);
+            auto tracks = track_frame(*image, balls);
+            recorder.record(*image, balls, tracks);
+            auto prediction = predict_landing(*image, balls);
+            publisher.publish(*image, balls, tracks, prediction);
+            co_await visualize_detection(*image, balls, tracks);
         }
+    };
+
+    auto pipelines = std::vector<util::Task<void>>{};
+    pipelines.reserve(concurrent_frames);
+    for (std::size_t i = 0; i < concurrent_frames; ++i) {
+        pipelines.push_back(frame_pipeline());
     }
+    util::sync_wait(util::when_all(std::move(pipelines)));
 
     return 0;
 }
@@ -0,0 +1,186 @@
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/metrics/metrics.hpp"
+#include "utility/publish/ball_message.hpp"
+#include "utility/publish/shm_channel.hpp"
+#include "utility/publish/udp_channel.hpp"
+#include "utility/singleton/running.hpp"
+
+using namespace pingpong_tracker;
+using namespace std::chrono_literals;
+
+namespace {
+
+/// @brief
+///   Per-interval statistics of the received messages, logged once a second.
+/// @note
+///   - Latency is measured against the tracker's steady clock, which is shared by processes
+///     on the same host only.
+class Report {
+public:
+    auto add(const util::BallMessage& message, util::Clock::time_point now) -> void {
+        const auto since = [&](std::int64_t ns) {
+            return now - util::Clock::time_point{std::chrono::nanoseconds{ns}};
+        };
+        capture_->observe(since(message.capture_ns));
+        transport_->observe(since(message.publish_ns));
+
+        if (last_sequence_ && message.sequence > *last_sequence_ + 1) {
+            gaps_ += message.sequence - *last_sequence_ - 1;
+        }
+        last_sequence_ = message.sequence;
+        ++messages_;
+        balls_ += message.ball_count;
+    }
+
+    /// @param lost Messages the transport skipped so far
+    auto log_if_due(util::Clock::time_point now, std::uint64_t lost) -> void {
+        if (now - begin_ < 1s) {
+            return;
+        }
+        const auto seconds = std::chrono::duration<double>(now - begin_).count();
+        const auto us      = [](double value) { return value * 1e6; };
+
+        if (messages_ == 0) {
+            spdlog::info("No messages");
+        } else {
+            spdlog::info(
+                "{:.1f} msg/s, {:.2f} balls/msg, {} missed, {} lapped | capture -> receive "
+                "p50 {:.0f}us p99 {:.0f}us | publish -> receive p50 {:.1f}us p99 {:.1f}us",
+                static_cast<double>(messages_) / seconds,
+                static_cast<double>(balls_) / static_cast<double>(messages_), gaps_,
+                lost - lost_, us(capture_->quantile(0.5)), us(capture_->quantile(0.99)),
+                us(transport_->quantile(0.5)), us(transport_->quantile(0.99)));
+        }
+
+        capture_   = std::make_unique<util::metrics::Histogram>(bounds());
+        transport_ = std::make_unique<util::metrics::Histogram>(bounds());
+        messages_  = 0;
+        balls_     = 0;
+        gaps_      = 0;
+        lost_      = lost;
+        begin_     = now;
+    }
+
+private:
+    // 1us doubling up to about 0.5s
+    static auto bounds() -> std::vector<double> {
+        auto bounds = std::vector<double>{};
+        for (auto bound = 1e-6; bound < 0.6; bound *= 2.0) {
+            bounds.push_back(bound);
+        }
+        return bounds;
+    }
+
+    std::unique_ptr<util::metrics::Histogram> capture_ =
+        std::make_unique<util::metrics::Histogram>(bounds());
+    std::unique_ptr<util::metrics::Histogram> transport_ =
+        std::make_unique<util::metrics::Histogram>(bounds());
+
+    std::optional<std::uint64_t> last_sequence_;
+    std::uint64_t messages_ = 0;
+    std::uint64_t balls_    = 0;
+    std::uint64_t gaps_     = 0;
+    std::uint64_t lost_     = 0;
+
+    util::Clock::time_point begin_ = util::Clock::now();
+};
+
+auto run_udp(const std::string& host, std::uint16_t port) -> int {
+    auto subscriber = util::UdpSubscriber::open(host, port);
+    if (!subscriber) {
+        spdlog::error("{}", subscriber.error());
+        return 1;
+    }
+    spdlog::info("Listening on udp {}:{}", host, port);
+
+    auto messages = std::array<util::BallMessage, 64>{};
+    auto report   = Report{};
+    while (util::get_running()) {
+        const auto count = subscriber->receive(messages, 100ms);
+        const auto now   = util::Clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            report.add(messages[i], now);
+        }
+        report.log_if_due(now, 0);
+    }
+    return 0;
+}
+
+auto run_shm(const std::string& name) -> int {
+    while (util::get_running()) {
+        auto subscriber = util::ShmSubscriber::open(name);
+        if (!subscriber) {
+            spdlog::warn("{}, retrying", subscriber.error());
+            std::this_thread::sleep_for(1s);
+            continue;
+        }
+        spdlog::info("Reading shared memory {}", name);
+
+        auto message = util::BallMessage{};
+        auto report  = Report{};
+        auto status  = util::ShmSubscriber::Status::EMPTY;
+        while (util::get_running()) {
+            status = subscriber->poll(message);
+            if (status == util::ShmSubscriber::Status::CLOSED) {
+                break;
+            }
+            const auto now = util::Clock::now();
+            if (status == util::ShmSubscriber::Status::MESSAGE) {
+                report.add(message, now);
+            } else {
+                // Messages arrive at frame rate, a short sleep costs little latency
+                std::this_thread::sleep_for(50us);
+            }
+            report.log_if_due(now, subscriber->lost());
+        }
+        if (status == util::ShmSubscriber::Status::CLOSED) {
+            spdlog::info("Publisher closed {}, waiting for the next one", name);
+            std::this_thread::sleep_for(1s);
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const auto usage = [&] {
+        spdlog::error("Usage: {} udp <host> <port> | shm <name>", argv[0]);
+        return 1;
+    };
+    if (argc < 3) {
+        return usage();
+    }
+
+    std::signal(SIGINT, [](int) { util::set_running(false); });
+    std::signal(SIGTERM, [](int) { util::set_running(false); });
+
+    const auto transport = std::string_view{argv[1]};
+    if (transport == "udp" && argc == 4) {
+        const auto text = std::string_view{argv[3]};
+        auto port       = std::uint16_t{0};
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), port);
+        if (error != std::errc{} || end != text.data() + text.size()) {
+            return usage();
+        }
+        return run_udp(argv[2], port);
+    }
+    if (transport == "shm" && argc == 3) {
+        return run_shm(argv[2]);
+    }
+    return usage();
+}
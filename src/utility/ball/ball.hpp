@@ -1,5 +1,6 @@
 #pragma once
 
+#include <opencv2/core/matx.hpp>
 #include <opencv2/core/types.hpp>
 namespace pingpong_tracker {
 struct Ball2D {
@@ -8,4 +9,11 @@ struct Ball2D {
     float confidence{0.0F};
 };
 
+struct Ball3D {
+    // Table frame, metres
+    cv::Point3f center{0.0F, 0.0F, 0.0F};
+    cv::Matx33f covariance{cv::Matx33f::zeros()};
+    float confidence{0.0F};
+};
+
 }  // namespace pingpong_tracker
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <opencv2/core/types.hpp>
+#include <optional>
+
+#include "utility/clock.hpp"
+
+namespace pingpong_tracker {
+
+struct BallTrack2D {
+    std::uint32_t id{0};
+    cv::Point2f center{0.0F, 0.0F};
+    // pixel / s
+    cv::Point2f velocity{0.0F, 0.0F};
+    float radius{0.0F};
+    bool coasting{false};
+    util::Clock::time_point timestamp{};
+};
+
+struct BallLanding {
+    // Table frame, metres, the contact point of the next table bounce
+    cv::Point3f position{0.0F, 0.0F, 0.0F};
+    util::Clock::time_point timestamp{};
+    // Probability that the ball is in free flight, the forecast assumes it is
+    float confidence{1.0F};
+};
+
+struct BallTrack3D {
+    std::uint32_t id{0};
+    // Table frame, metres
+    cv::Point3f center{0.0F, 0.0F, 0.0F};
+    // metre / s
+    cv::Point3f velocity{0.0F, 0.0F, 0.0F};
+    bool coasting{false};
+    util::Clock::time_point timestamp{};
+    // Flight, bounce and roll, all flight with a single motion model
+    std::array<float, 3> mode_probabilities{1.0F, 0.0F, 0.0F};
+
+    std::optional<BallLanding> landing{};
+};
+
+}  // namespace pingpong_tracker
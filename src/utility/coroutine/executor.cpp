@@ -0,0 +1,178 @@
+#include "executor.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utility/thread/execution.hpp"
+
+using namespace pingpong_tracker::util;
+
+namespace {
+thread_local const void* current_executor = nullptr;
+}
+
+struct Executor::Impl {
+    std::string name;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    // FIFO of ready operations
+    Operation* ready_head = nullptr;
+    Operation* ready_tail = nullptr;
+
+    // Deadline-ordered singly linked list, polling awaitables keep it short
+    Operation* timers = nullptr;
+
+    bool stopping = false;
+
+    std::vector<std::jthread> workers;
+
+    Impl() noexcept = default;
+    Impl(const Impl&)            = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    ~Impl() noexcept {
+        stop();
+    }
+
+    auto push_ready(Operation* operation) noexcept -> void {
+        operation->next = nullptr;
+        if (ready_tail) {
+            ready_tail->next = operation;
+        } else {
+            ready_head = operation;
+        }
+        ready_tail = operation;
+    }
+
+    auto pop_ready() noexcept -> Operation* {
+        auto* operation = ready_head;
+        if (operation) {
+            ready_head = operation->next;
+            if (!ready_head) {
+                ready_tail = nullptr;
+            }
+        }
+        return operation;
+    }
+
+    auto insert_timer(Operation* operation) noexcept -> bool {
+        auto** cursor = &timers;
+        while (*cursor && (*cursor)->deadline <= operation->deadline) {
+            cursor = &(*cursor)->next;
+        }
+        operation->next = *cursor;
+        *cursor         = operation;
+        return cursor == &timers;
+    }
+
+    auto collect_due_timers(Clock::time_point now) noexcept -> void {
+        while (timers && timers->deadline <= now) {
+            auto* due = timers;
+            timers    = due->next;
+            push_ready(due);
+        }
+    }
+
+    // Notified under the lock: the posted operation may finish and the executor be destroyed
+    // the moment the lock is released, before a notify outside of it would run
+    auto post(Operation* operation) noexcept -> void {
+        auto lock = std::scoped_lock{mutex};
+        push_ready(operation);
+        condition.notify_one();
+    }
+
+    auto post_at(Operation* operation, Clock::time_point deadline) noexcept -> void {
+        operation->deadline = deadline;
+
+        auto lock = std::scoped_lock{mutex};
+        // Sleeping workers only need to re-arm when the earliest deadline moved
+        if (insert_timer(operation)) {
+            condition.notify_one();
+        }
+    }
+
+    auto worker_loop(std::size_t index) noexcept -> void {
+        current_executor = this;
+        execution().apply(name);
+        spdlog::info("[{} worker {}] starts", name, index);
+
+        auto lock = std::unique_lock{mutex};
+        for (;;) {
+            collect_due_timers(Clock::now());
+
+            if (auto* operation = pop_ready()) {
+                lock.unlock();
+                operation->function(operation);
+                lock.lock();
+                continue;
+            }
+
+            if (stopping) {
+                break;
+            }
+
+            if (timers) {
+                // Copied, the operation may be resumed and freed by another worker meanwhile
+                const auto deadline = timers->deadline;
+                condition.wait_until(lock, deadline);
+            } else {
+                condition.wait(lock);
+            }
+        }
+
+        spdlog::info("[{} worker {}] stops", name, index);
+        current_executor = nullptr;
+    }
+
+    auto stop() noexcept -> void {
+        {
+            auto lock = std::scoped_lock{mutex};
+            stopping  = true;
+        }
+        condition.notify_all();
+
+        for (auto& worker : workers) {
+            if (worker.joinable() && worker.get_id() != std::this_thread::get_id()) {
+                worker.join();
+            }
+        }
+    }
+};
+
+Executor::Executor(std::size_t threads, std::string name) : pimpl_{std::make_unique<Impl>()} {
+    pimpl_->name = std::move(name);
+    pimpl_->workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        pimpl_->workers.emplace_back([impl = pimpl_.get(), i] { impl->worker_loop(i); });
+    }
+}
+
+Executor::~Executor() noexcept                     = default;
+Executor::Executor(Executor&&) noexcept            = default;
+Executor& Executor::operator=(Executor&&) noexcept = default;
+
+auto Executor::post(Operation* operation) noexcept -> void {
+    pimpl_->post(operation);
+}
+
+auto Executor::post_at(Operation* operation, Clock::time_point deadline) noexcept -> void {
+    pimpl_->post_at(operation, deadline);
+}
+
+auto Executor::in_this_thread() const noexcept -> bool {
+    return current_executor == pimpl_.get();
+}
+
+auto Executor::threads() const noexcept -> std::size_t {
+    return pimpl_->workers.size();
+}
+
+auto Executor::stop() noexcept -> void {
+    pimpl_->stop();
+}
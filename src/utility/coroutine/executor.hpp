@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <string>
+
+#include "utility/clock.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Fixed set of threads draining one run queue of coroutine continuations.
+/// @note
+///   - The queue is intrusive: every awaitable embeds its own `Operation`, which lives in the
+///     suspended coroutine frame, so scheduling never allocates.
+///   - `post_at` keeps a deadline-ordered list in the same way, used for polling awaitables.
+///   - A single-threaded executor is a strand, which is how non-thread-safe sinks are driven.
+class Executor {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(Executor)
+
+public:
+    struct Operation {
+        using Function = void (*)(Operation*) noexcept;
+
+        Function function{nullptr};
+        Operation* next{nullptr};
+        Clock::time_point deadline{};
+    };
+
+    explicit Executor(std::size_t threads, std::string name = "executor");
+
+    /// @brief Enqueues an operation, safe from any thread including foreign callback threads
+    auto post(Operation* operation) noexcept -> void;
+    auto post_at(Operation* operation, Clock::time_point deadline) noexcept -> void;
+
+    /// @brief Whether the calling thread is one of this executor's workers
+    [[nodiscard]] auto in_this_thread() const noexcept -> bool;
+
+    [[nodiscard]] auto threads() const noexcept -> std::size_t;
+
+    /// @brief Stops the workers after draining the operations which are already due
+    auto stop() noexcept -> void;
+
+    struct ScheduleAwaiter : Operation {
+        Executor& executor;
+        std::coroutine_handle<> continuation{};
+
+        static constexpr auto await_ready() noexcept {
+            return false;
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> void {
+            continuation = awaiting;
+            function     = [](Operation* self) noexcept {
+                static_cast<ScheduleAwaiter*>(self)->continuation.resume();
+            };
+            executor.post(this);
+        }
+        static constexpr auto await_resume() noexcept -> void {
+        }
+    };
+
+    struct SleepAwaiter : Operation {
+        Executor& executor;
+        Clock::time_point wake_at;
+        std::coroutine_handle<> continuation{};
+
+        static constexpr auto await_ready() noexcept {
+            return false;
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> void {
+            continuation = awaiting;
+            function     = [](Operation* self) noexcept {
+                static_cast<SleepAwaiter*>(self)->continuation.resume();
+            };
+            executor.post_at(this, wake_at);
+        }
+        static constexpr auto await_resume() noexcept -> void {
+        }
+    };
+
+    /// @brief `co_await executor.schedule()` continues the coroutine on one of the workers
+    [[nodiscard]] auto schedule() noexcept -> ScheduleAwaiter {
+        return ScheduleAwaiter{{}, *this};
+    }
+
+    [[nodiscard]] auto schedule_after(Clock::duration delay) noexcept -> SleepAwaiter {
+        return SleepAwaiter{{}, *this, Clock::now() + delay};
+    }
+};
+
+}  // namespace pingpong_tracker::util
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Thread-local recycler for coroutine frames.
+/// @note
+///   - Frames are grouped into size classes of kGranularity bytes, freed frames are kept in a
+///     per-thread free list and handed out again on the next allocation of the same class.
+///   - Every block remembers the pool it came from. A frame released on another thread, such as
+///     a task that finished after hopping executors, goes back to its owner through a lock-free
+///     return list, so the owner keeps reusing it instead of falling back to the heap.
+///   - A pool outlives its thread until the last block it handed out has come back.
+///   - Once the long-lived pipeline coroutines are warm, `co_await`ing child tasks does not touch
+///     the global heap anymore.
+class FramePool {
+public:
+    static constexpr auto kGranularity = std::size_t{64};
+    static constexpr auto kClasses     = std::size_t{32};
+
+    static auto allocate(std::size_t size) -> void* {
+        const auto index = class_index(size);
+        if (index >= kClasses) [[unlikely]] {
+            heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(size);
+        }
+
+        auto& pool = local();
+        auto* node = pool.heads[index];
+        if (!node) {
+            // Blocks other threads gave back since the list last ran dry
+            node = pool.returned[index].exchange(nullptr, std::memory_order_acquire);
+        }
+        if (node) {
+            pool.heads[index] = node->next;
+        } else {
+            heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+            node = static_cast<Node*>(::operator new(kHeader + (index + 1) * kGranularity));
+        }
+
+        pool.references.fetch_add(1, std::memory_order_relaxed);
+        auto* header = ::new (static_cast<void*>(node)) Header{&pool};
+        return reinterpret_cast<std::byte*>(header) + kHeader;
+    }
+
+    static auto deallocate(void* pointer, std::size_t size) noexcept -> void {
+        const auto index = class_index(size);
+        if (index >= kClasses) [[unlikely]] {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto* block = reinterpret_cast<std::byte*>(pointer) - kHeader;
+        auto* owner = reinterpret_cast<Header*>(block)->owner;
+        if (owner == &local()) {
+            owner->heads[index] = ::new (static_cast<void*>(block)) Node{owner->heads[index]};
+        } else {
+            auto& list = owner->returned[index];
+            auto* head = list.load(std::memory_order_relaxed);
+            auto* node = ::new (static_cast<void*>(block)) Node{head};
+            while (!list.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+            }
+        }
+        release(owner);
+    }
+
+    /// @brief Blocks taken from the global heap so far, by every thread
+    [[nodiscard]] static auto heap_allocations() noexcept -> std::uint64_t {
+        return heap_allocations_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node {
+        Node* next;
+    };
+
+    struct Pool;
+    struct Header {
+        Pool* owner;
+    };
+    // Keeps the frame after the header at the default new alignment
+    static constexpr auto kHeader = std::size_t{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+    static_assert(sizeof(Header) <= kHeader);
+
+    struct Pool {
+        std::array<Node*, kClasses> heads{};
+        std::array<std::atomic<Node*>, kClasses> returned{};
+        // The owning thread plus every block handed out and not yet given back
+        std::atomic<std::size_t> references{1};
+
+        Pool() noexcept              = default;
+        Pool(const Pool&)            = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        ~Pool() noexcept {
+            for (std::size_t i = 0; i < kClasses; ++i) {
+                free(heads[i]);
+                free(returned[i].load(std::memory_order_acquire));
+            }
+        }
+
+        static auto free(Node* head) noexcept -> void {
+            while (head) {
+                ::operator delete(std::exchange(head, head->next));
+            }
+        }
+    };
+
+    // Held by the thread, drops its reference when the thread exits
+    struct Local {
+        Pool* pool = new Pool{};
+
+        Local() noexcept               = default;
+        Local(const Local&)            = delete;
+        Local& operator=(const Local&) = delete;
+
+        ~Local() noexcept {
+            release(pool);
+        }
+    };
+
+    static auto release(Pool* pool) noexcept -> void {
+        if (pool->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete pool;
+        }
+    }
+
+    static constexpr auto class_index(std::size_t size) noexcept -> std::size_t {
+        return (size + kGranularity - 1) / kGranularity - 1;
+    }
+
+    static auto local() noexcept -> Pool& {
+        thread_local auto local = Local{};
+        return *local.pool;
+    }
+
+    static inline auto heap_allocations_ = std::atomic<std::uint64_t>{0};
+};
+
+}  // namespace pingpong_tracker::util
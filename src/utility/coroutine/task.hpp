@@ -0,0 +1,293 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <semaphore>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/coroutine/frame_pool.hpp"
+
+namespace pingpong_tracker::util {
+
+template <typename T = void>
+class Task;
+
+namespace details {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation{std::noop_coroutine()};
+    std::exception_ptr exception{};
+
+    struct FinalAwaiter {
+        static constexpr auto await_ready() noexcept {
+            return false;
+        }
+        template <class Promise>
+        auto await_suspend(std::coroutine_handle<Promise> self) noexcept
+            -> std::coroutine_handle<> {
+            // Symmetric transfer, the awaiting coroutine continues on this thread without
+            // growing the stack
+            return self.promise().continuation;
+        }
+        static constexpr auto await_resume() noexcept -> void {
+        }
+    };
+
+    static auto operator new(std::size_t size) -> void* {
+        return FramePool::allocate(size);
+    }
+    static auto operator delete(void* pointer, std::size_t size) noexcept -> void {
+        FramePool::deallocate(pointer, size);
+    }
+
+    static constexpr auto initial_suspend() noexcept {
+        return std::suspend_always{};
+    }
+    static constexpr auto final_suspend() noexcept {
+        return FinalAwaiter{};
+    }
+
+    auto unhandled_exception() noexcept -> void {
+        exception = std::current_exception();
+    }
+
+    auto rethrow_if_exception() const -> void {
+        if (exception) [[unlikely]] {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value{};
+
+    auto get_return_object() noexcept -> Task<T>;
+
+    template <typename U>
+        requires std::is_convertible_v<U&&, T>
+    auto return_value(U&& result) noexcept(std::is_nothrow_constructible_v<T, U&&>) -> void {
+        value.emplace(std::forward<U>(result));
+    }
+
+    auto take() -> T {
+        rethrow_if_exception();
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    auto get_return_object() noexcept -> Task<void>;
+
+    static constexpr auto return_void() noexcept -> void {
+    }
+
+    auto take() -> void {
+        rethrow_if_exception();
+    }
+};
+
+}  // namespace details
+
+/// @brief
+///   Lazily started coroutine, it runs when awaited and resumes its awaiter on completion.
+/// @note
+///   - The awaiting coroutine continues on whatever thread finished the task, use
+///     `Executor::schedule()` or an executor-aware awaitable to pick the thread explicitly.
+///   - Frames come from `FramePool`, so steady-state awaits do not allocate.
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = details::Promise<T>;
+    using handle_type  = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(handle_type handle) noexcept : handle_{handle} {
+    }
+
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept : handle_{std::exchange(other.handle_, {})} {
+    }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~Task() noexcept {
+        reset();
+    }
+
+    [[nodiscard]] auto valid() const noexcept -> bool {
+        return static_cast<bool>(handle_);
+    }
+
+    [[nodiscard]] auto done() const noexcept -> bool {
+        return !handle_ || handle_.done();
+    }
+
+    struct Awaiter {
+        handle_type handle;
+
+        [[nodiscard]] auto await_ready() const noexcept -> bool {
+            return !handle || handle.done();
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> std::coroutine_handle<> {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        auto await_resume() -> T {
+            return handle.promise().take();
+        }
+    };
+
+    auto operator co_await() && noexcept -> Awaiter {
+        return Awaiter{handle_};
+    }
+
+    /// @brief Starts the task without an awaiter, only used by the detaching helpers
+    auto start(std::coroutine_handle<> continuation) noexcept -> void {
+        handle_.promise().continuation = continuation;
+        handle_.resume();
+    }
+
+    auto result() -> T {
+        return handle_.promise().take();
+    }
+
+private:
+    auto reset() noexcept -> void {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = {};
+        }
+    }
+
+    handle_type handle_{};
+};
+
+template <typename T>
+auto details::Promise<T>::get_return_object() noexcept -> Task<T> {
+    return Task<T>{std::coroutine_handle<Promise>::from_promise(*this)};
+}
+
+inline auto details::Promise<void>::get_return_object() noexcept -> Task<void> {
+    return Task<void>{std::coroutine_handle<Promise>::from_promise(*this)};
+}
+
+namespace details {
+
+/// Fire-and-forget coroutine, its frame destroys itself once it finishes
+struct Detached {
+    struct promise_type {
+        static auto operator new(std::size_t size) -> void* {
+            return FramePool::allocate(size);
+        }
+        static auto operator delete(void* pointer, std::size_t size) noexcept -> void {
+            FramePool::deallocate(pointer, size);
+        }
+
+        static constexpr auto get_return_object() noexcept {
+            return Detached{};
+        }
+        static constexpr auto initial_suspend() noexcept {
+            return std::suspend_never{};
+        }
+        static constexpr auto final_suspend() noexcept {
+            return std::suspend_never{};
+        }
+        static constexpr auto return_void() noexcept -> void {
+        }
+        [[noreturn]] static auto unhandled_exception() noexcept -> void {
+            std::terminate();
+        }
+    };
+};
+
+}  // namespace details
+
+/// @brief Blocks the calling thread until `task` completes and returns its result
+template <typename T>
+auto sync_wait(Task<T> task) -> T {
+    auto finished = std::binary_semaphore{0};
+
+    auto waiter = [](Task<T>& inner, std::binary_semaphore& signal) -> details::Detached {
+        struct Release {
+            std::binary_semaphore& signal;
+            ~Release() noexcept {
+                signal.release();
+            }
+        } release{signal};
+        try {
+            co_await std::move(inner);
+        } catch (...) {
+            // Kept in the promise, rethrown below by result()
+        }
+    };
+    waiter(task, finished);
+
+    finished.acquire();
+    return task.result();
+}
+
+/// @brief Runs all tasks concurrently and resumes the awaiter once the last one finished
+inline auto when_all(std::vector<Task<void>> tasks) -> Task<void> {
+    struct Counter {
+        std::atomic<std::size_t> remaining;
+        std::coroutine_handle<> continuation;
+
+        auto arrive() noexcept -> void {
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                continuation.resume();
+            }
+        }
+    };
+
+    struct Awaiter {
+        std::vector<Task<void>>& tasks;
+        Counter counter{};
+
+        [[nodiscard]] auto await_ready() const noexcept -> bool {
+            return tasks.empty();
+        }
+        auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> void {
+            // One extra arrival keeps the awaiter suspended until every child started
+            counter.remaining.store(tasks.size() + 1, std::memory_order_relaxed);
+            counter.continuation = awaiting;
+
+            for (auto& task : tasks) {
+                [](Task<void>& inner, Counter& shared) -> details::Detached {
+                    struct Arrive {
+                        Counter& shared;
+                        ~Arrive() noexcept {
+                            shared.arrive();
+                        }
+                    } arrive{shared};
+                    try {
+                        co_await std::move(inner);
+                    } catch (...) {
+                        // Kept in the child promise, rethrown below
+                    }
+                }(task, counter);
+            }
+            counter.arrive();
+        }
+        static constexpr auto await_resume() noexcept -> void {
+        }
+    };
+
+    co_await Awaiter{tasks};
+    for (auto& task : tasks) {
+        task.result();
+    }
+}
+
+}  // namespace pingpong_tracker::util
@@ -3,25 +3,45 @@
 #include <format>
 #include <opencv2/imgproc.hpp>
 
-#include "utility/image/image.details.hpp"
-
 namespace pingpong_tracker::util {
 
-auto draw(Image& canvas, const Ball2D& ball) noexcept -> void {
-    auto& opencv_mat = const_cast<cv::Mat&>(canvas.details().get_mat());
-
-    const auto color = cv::Scalar{0, 255, 0};
+auto draw(cv::Mat& canvas, const Ball2D& ball, float scale) noexcept -> void {
+    const auto center = ball.center * scale;
+    const auto radius = ball.radius * scale;
+    const auto color  = cv::Scalar{0, 255, 0};
 
-    cv::circle(opencv_mat, ball.center, static_cast<int>(ball.radius), color, 2);
-    cv::circle(opencv_mat, ball.center, 2, cv::Scalar{0, 0, 255}, -1);
+    cv::circle(canvas, center, static_cast<int>(radius), color, 2);
+    cv::circle(canvas, center, 2, cv::Scalar{0, 0, 255}, -1);
 
-    const auto font      = cv::FONT_HERSHEY_SIMPLEX;
-    const auto scale     = 0.6;
-    const auto thickness = 1;
-    const auto white     = cv::Scalar{255, 255, 255};
+    const auto font       = cv::FONT_HERSHEY_SIMPLEX;
+    const auto font_scale = 0.6;
+    const auto thickness  = 1;
+    const auto white      = cv::Scalar{255, 255, 255};
 
     auto info = std::format("{:.2f}", ball.confidence);
-    cv::putText(opencv_mat, info, ball.center - cv::Point2f{0, ball.radius + 5}, font, scale, white,
+    cv::putText(canvas, info, center - cv::Point2f{0, radius + 5}, font, font_scale, white,
+                thickness, cv::LINE_AA);
+}
+
+auto draw(cv::Mat& canvas, const BallTrack2D& track, float scale) noexcept -> void {
+    const auto center = track.center * scale;
+    const auto radius = track.radius * scale;
+
+    // Coasting tracks are drawn dimmer, they are not backed by a detection
+    const auto color = track.coasting ? cv::Scalar{128, 64, 0} : cv::Scalar{255, 128, 0};
+
+    // Velocity arrow covers the next 50ms of flight
+    constexpr auto kLookahead = 0.05F;
+
+    cv::circle(canvas, center, static_cast<int>(radius) + 4, color, 1);
+    cv::arrowedLine(canvas, center, center + track.velocity * (kLookahead * scale), color, 2);
+
+    const auto font       = cv::FONT_HERSHEY_SIMPLEX;
+    const auto font_scale = 0.5;
+    const auto thickness  = 1;
+
+    auto info = std::format("#{}", track.id);
+    cv::putText(canvas, info, center + cv::Point2f{radius + 6, 0}, font, font_scale, color,
                 thickness, cv::LINE_AA);
 }
 
@@ -1,9 +1,17 @@
 #pragma once
+#include <opencv2/core/mat.hpp>
+
 #include "utility/ball/ball.hpp"
-#include "utility/image/image.hpp"
+#include "utility/ball/track.hpp"
 
 namespace pingpong_tracker::util {
 
-auto draw(Image&, const Ball2D&) noexcept -> void;
+/// @brief
+///   Overlays for the preview, drawn on a canvas of its own rather than on the captured frame.
+/// @note
+///   - `scale` maps frame coordinates onto the canvas, below one for a downscaled preview.
+auto draw(cv::Mat& canvas, const Ball2D&, float scale = 1.0F) noexcept -> void;
+
+auto draw(cv::Mat& canvas, const BallTrack2D&, float scale = 1.0F) noexcept -> void;
 
 }
@@ -0,0 +1,160 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Gated rectangular assignment on a row-major cost matrix.
+/// @note
+///   - Pairs whose cost is not below `gate` are never returned.
+///   - Greedy takes admissible pairs cheapest first, exact only when the gates barely overlap,
+///     but cheap for a handful of targets.
+///   - Hungarian is the O(n^2 m) shortest augmenting path variant, optimal for any size.
+///   - Buffers are kept between calls, a steady-state solve does not allocate.
+class Assignment {
+public:
+    static constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+    /// @return Column assigned to every row, or `npos`
+    auto solve(std::span<const double> cost, std::size_t rows, std::size_t cols, double gate,
+               std::size_t greedy_limit) -> std::span<const std::size_t> {
+        if (std::min(rows, cols) <= greedy_limit) {
+            return greedy(cost, rows, cols, gate);
+        }
+        return hungarian(cost, rows, cols, gate);
+    }
+
+    auto greedy(std::span<const double> cost, std::size_t rows, std::size_t cols, double gate)
+        -> std::span<const std::size_t> {
+        row_to_col_.assign(rows, npos);
+        col_used_.assign(cols, false);
+
+        pairs_.clear();
+        for (std::size_t r = 0; r < rows; ++r) {
+            for (std::size_t c = 0; c < cols; ++c) {
+                if (const auto value = cost[r * cols + c]; value < gate) {
+                    pairs_.push_back({value, r, c});
+                }
+            }
+        }
+        std::ranges::sort(pairs_, {}, &Pair::cost);
+
+        for (const auto& [_, r, c] : pairs_) {
+            if (row_to_col_[r] == npos && !col_used_[c]) {
+                row_to_col_[r] = c;
+                col_used_[c]   = true;
+            }
+        }
+        return row_to_col_;
+    }
+
+    auto hungarian(std::span<const double> cost, std::size_t rows, std::size_t cols, double gate)
+        -> std::span<const std::size_t> {
+        row_to_col_.assign(rows, npos);
+        if (rows == 0 || cols == 0) {
+            return row_to_col_;
+        }
+
+        // The algorithm needs n <= m, solve the transposed problem otherwise
+        const auto transposed = rows > cols;
+        const auto n          = transposed ? cols : rows;
+        const auto m          = transposed ? rows : cols;
+
+        // Gated pairs get a cost larger than any sum of admissible ones, so the solver first
+        // minimises how many of them it has to use, they are dropped afterwards
+        const auto forbidden = gate * static_cast<double>(n + 1) + 1.0;
+        auto at              = [&](std::size_t i, std::size_t j) {
+            const auto value = transposed ? cost[j * cols + i] : cost[i * cols + j];
+            return value < gate ? value : forbidden;
+        };
+
+        // 1-based, index 0 is the virtual column the augmenting path starts from
+        u_.assign(n + 1, 0.0);
+        v_.assign(m + 1, 0.0);
+        p_.assign(m + 1, 0);
+        way_.assign(m + 1, 0);
+
+        for (std::size_t i = 1; i <= n; ++i) {
+            p_[0]   = i;
+            auto j0 = std::size_t{0};
+            minv_.assign(m + 1, kInfinity);
+            used_.assign(m + 1, false);
+
+            do {
+                used_[j0]     = true;
+                const auto i0 = p_[j0];
+                auto delta    = kInfinity;
+                auto j1       = std::size_t{0};
+                for (std::size_t j = 1; j <= m; ++j) {
+                    if (used_[j]) {
+                        continue;
+                    }
+                    const auto current = at(i0 - 1, j - 1) - u_[i0] - v_[j];
+                    if (current < minv_[j]) {
+                        minv_[j] = current;
+                        way_[j]  = j0;
+                    }
+                    if (minv_[j] < delta) {
+                        delta = minv_[j];
+                        j1    = j;
+                    }
+                }
+                for (std::size_t j = 0; j <= m; ++j) {
+                    if (used_[j]) {
+                        u_[p_[j]] += delta;
+                        v_[j] -= delta;
+                    } else {
+                        minv_[j] -= delta;
+                    }
+                }
+                j0 = j1;
+            } while (p_[j0] != 0);
+
+            do {
+                const auto j1 = way_[j0];
+                p_[j0]        = p_[j1];
+                j0            = j1;
+            } while (j0 != 0);
+        }
+
+        for (std::size_t j = 1; j <= m; ++j) {
+            if (p_[j] == 0) {
+                continue;
+            }
+            const auto i = p_[j] - 1;
+            if (at(i, j - 1) >= gate) {
+                continue;
+            }
+            if (transposed) {
+                row_to_col_[j - 1] = i;
+            } else {
+                row_to_col_[i] = j - 1;
+            }
+        }
+        return row_to_col_;
+    }
+
+private:
+    static constexpr auto kInfinity = std::numeric_limits<double>::infinity();
+
+    struct Pair {
+        double cost;
+        std::size_t row;
+        std::size_t col;
+    };
+
+    std::vector<std::size_t> row_to_col_;
+
+    std::vector<Pair> pairs_;
+    std::vector<bool> col_used_;
+
+    std::vector<double> u_, v_, minv_;
+    std::vector<std::size_t> p_, way_;
+    std::vector<bool> used_;
+};
+
+}  // namespace pingpong_tracker::util
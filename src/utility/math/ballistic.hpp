@@ -0,0 +1,74 @@
+#pragma once
+#include <eigen3/Eigen/Core>
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Point-mass flight under gravity and quadratic air drag, a = g - k * |v| * v.
+/// @note
+///   - State layout is [position(Dim), velocity(Dim)], units follow whatever frame the caller
+///     uses (pixels in image space, metres in table space).
+///   - One step is a second-order Taylor expansion with the acceleration frozen over dt, which
+///     is accurate at camera rates and keeps the Jacobian closed-form.
+template <int Dim, typename Scalar = double>
+struct BallisticModel {
+    static constexpr int kStateDim = 2 * Dim;
+
+    using Vec  = Eigen::Matrix<Scalar, Dim, 1>;
+    using Mat  = Eigen::Matrix<Scalar, Dim, Dim>;
+    using XVec = Eigen::Matrix<Scalar, kStateDim, 1>;
+    using XMat = Eigen::Matrix<Scalar, kStateDim, kStateDim>;
+
+    Vec gravity{Vec::Zero()};
+    Scalar drag{0};
+
+    [[nodiscard]] auto acceleration(Vec const& velocity) const noexcept -> Vec {
+        return gravity - drag * velocity.norm() * velocity;
+    }
+
+    /// d(acceleration) / d(velocity)
+    [[nodiscard]] auto acceleration_jacobian(Vec const& velocity) const noexcept -> Mat {
+        const auto speed = velocity.norm();
+        if (speed <= Scalar{1e-9}) {
+            return Mat::Zero();
+        }
+        return -drag * (speed * Mat::Identity() + velocity * velocity.transpose() / speed);
+    }
+
+    [[nodiscard]] auto transition(XVec const& x, Scalar dt) const noexcept -> XVec {
+        const auto position = x.template head<Dim>();
+        const auto velocity = x.template tail<Dim>();
+        const Vec a         = acceleration(velocity);
+
+        XVec next;
+        next.template head<Dim>() = position + velocity * dt + Scalar{0.5} * a * dt * dt;
+        next.template tail<Dim>() = velocity + a * dt;
+        return next;
+    }
+
+    [[nodiscard]] auto jacobian(XVec const& x, Scalar dt) const noexcept -> XMat {
+        const Mat da = acceleration_jacobian(x.template tail<Dim>());
+
+        XMat F                                = XMat::Identity();
+        F.template block<Dim, Dim>(0, Dim)    = Mat::Identity() * dt + Scalar{0.5} * dt * dt * da;
+        F.template block<Dim, Dim>(Dim, Dim) += dt * da;
+        return F;
+    }
+
+    /// Discrete white-noise acceleration: a constant acceleration of variance `q` (unit^2 / s^4)
+    /// over the step on every axis, Q = q G G^T with G = [dt^2 / 2, dt]
+    [[nodiscard]] static auto process_noise(Scalar q, Scalar dt) noexcept -> XMat {
+        const auto dt2 = dt * dt;
+        const auto dt3 = dt2 * dt;
+        const auto dt4 = dt3 * dt;
+
+        XMat Q                               = XMat::Zero();
+        Q.template block<Dim, Dim>(0, 0)     = Mat::Identity() * (q * dt4 / Scalar{4});
+        Q.template block<Dim, Dim>(0, Dim)   = Mat::Identity() * (q * dt3 / Scalar{2});
+        Q.template block<Dim, Dim>(Dim, 0)   = Mat::Identity() * (q * dt3 / Scalar{2});
+        Q.template block<Dim, Dim>(Dim, Dim) = Mat::Identity() * (q * dt2);
+        return Q;
+    }
+};
+
+}  // namespace pingpong_tracker::util
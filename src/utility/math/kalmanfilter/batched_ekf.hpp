@@ -0,0 +1,437 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "utility/math/kalmanfilter/ekf.hpp"
+
+namespace pingpong_tracker::util {
+
+/**
+ * @brief 同一模型的一批 EKF, 按结构数组 (SoA) 存储并同步推进
+ * - 状态与协方差按分量连续存放: 第 k 个状态分量的所有滤波器相邻, 协方差只存上三角
+ * - 线性模型 (匀速/匀加速等) 的预测与更新逐分量跨滤波器循环, 可被编译器向量化
+ * - 观测维度 <= 3 时创新协方差使用闭式逆, 不走 LDLT; 更高维逐个滤波器回退到 LDLT
+ * - 非线性模型可使用逐滤波器的 predict(f, get_F, Q), 与 EKF 行为一致但不向量化
+ */
+template <int StateDim, int ObsDim, typename Scalar = float>
+class BatchedEKF {
+public:
+    using Filter = EKF<StateDim, ObsDim, Scalar>;
+    using XVec   = typename Filter::XVec;
+    using ZVec   = typename Filter::ZVec;
+    using AMat   = typename Filter::AMat;
+    using PMat   = typename Filter::PMat;
+    using QMat   = typename Filter::QMat;
+    using RMat   = typename Filter::RMat;
+    using HMat   = typename Filter::HMat;
+
+    static constexpr int kCovDim = StateDim * (StateDim + 1) / 2;
+
+    explicit BatchedEKF(std::size_t capacity = 0) {
+        reserve(capacity);
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    /// @brief 分配容量, 已有滤波器保持不变
+    auto reserve(std::size_t capacity) -> void {
+        // 每个分量的行对齐到 16 个元素
+        capacity = (capacity + 15) / 16 * 16;
+        if (capacity <= stride_) {
+            return;
+        }
+
+        auto relayout = [&](std::vector<Scalar>& data, int rows) {
+            auto next = std::vector<Scalar>(static_cast<std::size_t>(rows) * capacity, Scalar{0});
+            for (int k = 0; k < rows; ++k) {
+                std::copy_n(data.data() + k * stride_, size_, next.data() + k * capacity);
+            }
+            data = std::move(next);
+        };
+        relayout(x_, StateDim);
+        relayout(P_, kCovDim);
+
+        stride_ = capacity;
+        scratch_.assign(kScratchRows * stride_, Scalar{0});
+        next_.assign(static_cast<std::size_t>(StateDim * StateDim) * stride_, Scalar{0});
+    }
+
+    auto clear() noexcept -> void {
+        size_ = 0;
+    }
+
+    /// @brief 追加一个滤波器, 返回其下标
+    auto push(XVec const& x, PMat const& P) -> std::size_t {
+        if (size_ == stride_) {
+            reserve(std::max<std::size_t>(2 * stride_, 16));
+        }
+        set(size_++, x, P);
+        return size_ - 1;
+    }
+
+    /// @brief 以最后一个滤波器覆盖第 i 个, 顺序不保留
+    auto erase(std::size_t i) noexcept -> void {
+        const auto last = --size_;
+        for (int k = 0; k < StateDim; ++k) {
+            x(k)[i] = x(k)[last];
+        }
+        for (int k = 0; k < kCovDim; ++k) {
+            P_[k * stride_ + i] = P_[k * stride_ + last];
+        }
+    }
+
+    auto set(std::size_t i, XVec const& x_i, PMat const& P_i) noexcept -> void {
+        for (int a = 0; a < StateDim; ++a) {
+            x(a)[i] = x_i(a);
+            for (int b = a; b < StateDim; ++b) {
+                P(a, b)[i] = P_i(a, b);
+            }
+        }
+    }
+
+    [[nodiscard]] auto state(std::size_t i) const noexcept -> XVec {
+        XVec result;
+        for (int a = 0; a < StateDim; ++a) {
+            result(a) = x(a)[i];
+        }
+        return result;
+    }
+
+    [[nodiscard]] auto covariance(std::size_t i) const noexcept -> PMat {
+        PMat result;
+        for (int a = 0; a < StateDim; ++a) {
+            for (int b = a; b < StateDim; ++b) {
+                result(a, b) = result(b, a) = P(a, b)[i];
+            }
+        }
+        return result;
+    }
+
+    /// @brief 第 k 个状态分量在所有滤波器上的连续数组
+    [[nodiscard]] auto component(int k) noexcept -> std::span<Scalar> {
+        return {x(k), size_};
+    }
+    [[nodiscard]] auto component(int k) const noexcept -> std::span<const Scalar> {
+        return {x(k), size_};
+    }
+
+    /**
+     * @brief 线性预测步, 所有滤波器共享 F 与 Q
+     * 1. x_pre = F * x
+     * 2. P_pre = F * P * F^T + Q
+     * F 中为零的系数整行跳过, 匀速/匀加速模型只剩少量乘加
+     */
+    auto predict(AMat const& F, QMat const& Q) noexcept -> void {
+        const auto n = size_;
+
+        // x_pre, 借用 next_ 的前 StateDim 行
+        for (int a = 0; a < StateDim; ++a) {
+            auto* out = next_.data() + a * stride_;
+            std::fill_n(out, n, Scalar{0});
+            for (int c = 0; c < StateDim; ++c) {
+                axpy(out, F(a, c), x(c), n);
+            }
+        }
+        for (int a = 0; a < StateDim; ++a) {
+            std::copy_n(next_.data() + a * stride_, n, x(a));
+        }
+
+        // T = F * P, 完整 StateDim x StateDim
+        for (int a = 0; a < StateDim; ++a) {
+            for (int d = 0; d < StateDim; ++d) {
+                auto* out = next_.data() + (a * StateDim + d) * stride_;
+                std::fill_n(out, n, Scalar{0});
+                for (int c = 0; c < StateDim; ++c) {
+                    axpy(out, F(a, c), P(c, d), n);
+                }
+            }
+        }
+
+        // P_pre = T * F^T + Q, 上三角
+        for (int a = 0; a < StateDim; ++a) {
+            for (int b = a; b < StateDim; ++b) {
+                auto* out = P(a, b);
+                std::fill_n(out, n, static_cast<Scalar>(Q(a, b)));
+                for (int d = 0; d < StateDim; ++d) {
+                    axpy(out, F(b, d), next_.data() + (a * StateDim + d) * stride_, n);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 非线性预测步, 逐个滤波器求值 f 与雅可比
+     * 与 EKF::predict 相同, 没有跨滤波器的向量化
+     */
+    template <typename ModelFunc, typename JacobianFunc>
+    auto predict(ModelFunc&& f, JacobianFunc&& get_F, QMat const& Q) -> void {
+        static_assert(StateTransitionModel<ModelFunc, StateDim, Scalar>,
+                      "\n[BatchedEKF Error] 状态转移函数 f(x) 签名错误！\n");
+        static_assert(JacobianModel<JacobianFunc, StateDim, StateDim, Scalar>,
+                      "\n[BatchedEKF Error] 状态雅可比函数 get_F(x) 签名错误！\n");
+
+        for (std::size_t i = 0; i < size_; ++i) {
+            const XVec x_i = state(i);
+            const AMat F   = get_F(x_i);
+            const PMat P_i = F * covariance(i) * F.transpose() + Q;
+            set(i, f(x_i), P_i);
+        }
+    }
+
+    /**
+     * @brief 线性更新步, 所有滤波器共享 H 与 R
+     * @param z 观测, 按分量存放: z[o * size() + i] 为第 i 个滤波器的第 o 个分量
+     * @param mask 非零表示该滤波器本帧有观测, 为空时全部更新
+     * @return 实际更新的滤波器个数, 创新协方差非正定的滤波器保持不变
+     * 公式:
+     * 1. y = z - H * x
+     * 2. S = H * P * H^T + R
+     * 3. K = P * H^T * S^-1
+     * 4. x = x + K * y
+     * 5. P = P - K * (H * P)
+     */
+    auto update(std::span<const Scalar> z, HMat const& H, RMat const& R,
+                std::span<const std::uint8_t> mask = {}) noexcept -> std::size_t {
+        const auto n = size_;
+
+        // HP = H * P
+        for (int o = 0; o < ObsDim; ++o) {
+            for (int c = 0; c < StateDim; ++c) {
+                auto* out = hp(o, c);
+                std::fill_n(out, n, Scalar{0});
+                for (int a = 0; a < StateDim; ++a) {
+                    axpy(out, H(o, a), P(a, c), n);
+                }
+            }
+        }
+
+        // S = HP * H^T + R, 上三角
+        for (int o = 0; o < ObsDim; ++o) {
+            for (int p = o; p < ObsDim; ++p) {
+                auto* out = s(o, p);
+                std::fill_n(out, n, static_cast<Scalar>(R(o, p)));
+                for (int c = 0; c < StateDim; ++c) {
+                    axpy(out, H(p, c), hp(o, c), n);
+                }
+            }
+        }
+
+        // y = z - H * x
+        for (int o = 0; o < ObsDim; ++o) {
+            auto* out = y(o);
+            std::copy_n(z.data() + o * n, n, out);
+            for (int a = 0; a < StateDim; ++a) {
+                axpy(out, -H(o, a), x(a), n);
+            }
+        }
+
+        // S^-1 原地覆盖 S, 无效的滤波器 S^-1 置零, 增益随之为零
+        auto* valid = row(kValidRow);
+        for (std::size_t i = 0; i < n; ++i) {
+            valid[i] = mask.empty() || mask[i] != 0 ? Scalar{1} : Scalar{0};
+        }
+        invert(n);
+
+        // 无观测的滤波器 z 可能是任意值, 残差置零以免 0 * NaN
+        for (int o = 0; o < ObsDim; ++o) {
+            auto* out = y(o);
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = valid[i] != Scalar{0} ? out[i] : Scalar{0};
+            }
+        }
+
+        auto updated = std::size_t{0};
+        for (std::size_t i = 0; i < n; ++i) {
+            updated += valid[i] != Scalar{0} ? 1 : 0;
+        }
+
+        // K = (HP)^T * S^-1
+        for (int a = 0; a < StateDim; ++a) {
+            for (int o = 0; o < ObsDim; ++o) {
+                auto* out = k(a, o);
+                std::fill_n(out, n, Scalar{0});
+                for (int p = 0; p < ObsDim; ++p) {
+                    mul_add(out, hp(p, a), s(p, o), n);
+                }
+            }
+        }
+
+        // x += K * y
+        for (int a = 0; a < StateDim; ++a) {
+            for (int o = 0; o < ObsDim; ++o) {
+                mul_add(x(a), k(a, o), y(o), n);
+            }
+        }
+
+        // P -= K * HP, 上三角, 对称性由构造保证
+        for (int a = 0; a < StateDim; ++a) {
+            for (int b = a; b < StateDim; ++b) {
+                for (int o = 0; o < ObsDim; ++o) {
+                    mul_sub(P(a, b), k(a, o), hp(o, b), n);
+                }
+            }
+        }
+        return updated;
+    }
+
+private:
+    // 暂存行: HP, S / S^-1 (上三角), y, K, 有效标记
+    static constexpr int kSymObs     = ObsDim * (ObsDim + 1) / 2;
+    static constexpr int kHPRow      = 0;
+    static constexpr int kSRow       = kHPRow + ObsDim * StateDim;
+    static constexpr int kYRow       = kSRow + kSymObs;
+    static constexpr int kKRow       = kYRow + ObsDim;
+    static constexpr int kValidRow   = kKRow + StateDim * ObsDim;
+    static constexpr int kScratchRows = kValidRow + 1;
+
+    static constexpr auto symmetric_index(int a, int b, int dim) noexcept -> int {
+        if (a > b) {
+            std::swap(a, b);
+        }
+        return a * dim - a * (a - 1) / 2 + (b - a);
+    }
+
+    auto x(int a) noexcept -> Scalar* {
+        return x_.data() + a * stride_;
+    }
+    auto x(int a) const noexcept -> Scalar const* {
+        return x_.data() + a * stride_;
+    }
+    auto P(int a, int b) noexcept -> Scalar* {
+        return P_.data() + symmetric_index(a, b, StateDim) * stride_;
+    }
+    auto P(int a, int b) const noexcept -> Scalar const* {
+        return P_.data() + symmetric_index(a, b, StateDim) * stride_;
+    }
+
+    auto row(int r) noexcept -> Scalar* {
+        return scratch_.data() + r * stride_;
+    }
+    auto hp(int o, int c) noexcept -> Scalar* {
+        return row(kHPRow + o * StateDim + c);
+    }
+    auto s(int o, int p) noexcept -> Scalar* {
+        return row(kSRow + symmetric_index(o, p, ObsDim));
+    }
+    auto y(int o) noexcept -> Scalar* {
+        return row(kYRow + o);
+    }
+    auto k(int a, int o) noexcept -> Scalar* {
+        return row(kKRow + a * ObsDim + o);
+    }
+
+    // out += alpha * in, 系数为零时直接跳过
+    static auto axpy(Scalar* out, Scalar alpha, Scalar const* in, std::size_t n) noexcept -> void {
+        if (alpha == Scalar{0}) {
+            return;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] += alpha * in[i];
+        }
+    }
+
+    // out += a * b, 逐元素
+    static auto mul_add(Scalar* out, Scalar const* a, Scalar const* b, std::size_t n) noexcept
+        -> void {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] += a[i] * b[i];
+        }
+    }
+
+    // out -= a * b, 逐元素
+    static auto mul_sub(Scalar* out, Scalar const* a, Scalar const* b, std::size_t n) noexcept
+        -> void {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] -= a[i] * b[i];
+        }
+    }
+
+    // 对 S 逐滤波器求逆并乘上有效标记, 非正定时有效标记清零
+    auto invert(std::size_t n) noexcept -> void {
+        auto* valid = row(kValidRow);
+
+        if constexpr (ObsDim == 1) {
+            auto* s00 = s(0, 0);
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto ok = s00[i] > Scalar{0};
+                valid[i]      = ok ? valid[i] : Scalar{0};
+                s00[i]        = ok ? valid[i] / s00[i] : Scalar{0};
+            }
+        } else if constexpr (ObsDim == 2) {
+            auto* s00 = s(0, 0);
+            auto* s01 = s(0, 1);
+            auto* s11 = s(1, 1);
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto det = s00[i] * s11[i] - s01[i] * s01[i];
+                const auto ok  = s00[i] > Scalar{0} && det > Scalar{0};
+                valid[i]       = ok ? valid[i] : Scalar{0};
+
+                const auto inv = ok ? valid[i] / det : Scalar{0};
+                const auto a   = s00[i];
+                s00[i]         = s11[i] * inv;
+                s11[i]         = a * inv;
+                s01[i]         = -s01[i] * inv;
+            }
+        } else if constexpr (ObsDim == 3) {
+            auto* s00 = s(0, 0);
+            auto* s01 = s(0, 1);
+            auto* s02 = s(0, 2);
+            auto* s11 = s(1, 1);
+            auto* s12 = s(1, 2);
+            auto* s22 = s(2, 2);
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto c00   = s11[i] * s22[i] - s12[i] * s12[i];
+                const auto c01   = s12[i] * s02[i] - s01[i] * s22[i];
+                const auto c02   = s01[i] * s12[i] - s11[i] * s02[i];
+                const auto c11   = s00[i] * s22[i] - s02[i] * s02[i];
+                const auto c12   = s01[i] * s02[i] - s00[i] * s12[i];
+                const auto minor = s00[i] * s11[i] - s01[i] * s01[i];
+                const auto det   = s00[i] * c00 + s01[i] * c01 + s02[i] * c02;
+                const auto ok = s00[i] > Scalar{0} && minor > Scalar{0} && det > Scalar{0};
+                valid[i]      = ok ? valid[i] : Scalar{0};
+
+                const auto inv = ok ? valid[i] / det : Scalar{0};
+                s00[i]         = c00 * inv;
+                s01[i]         = c01 * inv;
+                s02[i]         = c02 * inv;
+                s11[i]         = c11 * inv;
+                s12[i]         = c12 * inv;
+                s22[i]         = minor * inv;
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                RMat S;
+                for (int o = 0; o < ObsDim; ++o) {
+                    for (int p = o; p < ObsDim; ++p) {
+                        S(o, p) = S(p, o) = s(o, p)[i];
+                    }
+                }
+                RMat S_inv = RMat::Zero();
+                if (!symmetric_inverse(S, S_inv)) {
+                    valid[i] = Scalar{0};
+                }
+                for (int o = 0; o < ObsDim; ++o) {
+                    for (int p = o; p < ObsDim; ++p) {
+                        s(o, p)[i] = S_inv(o, p) * valid[i];
+                    }
+                }
+            }
+        }
+    }
+
+    std::size_t size_   = 0;
+    std::size_t stride_ = 0;
+
+    std::vector<Scalar> x_;
+    std::vector<Scalar> P_;
+    std::vector<Scalar> scratch_;
+    // 预测步的 F * P 中间结果
+    std::vector<Scalar> next_;
+};
+
+}  // namespace pingpong_tracker::util
@@ -11,35 +11,88 @@ inline auto DefaultAdd = [](auto const& a, auto const& b) { return a + b; };
 inline auto DefaultSubtract = [](auto const& a, auto const& b) { return a - b; };
 
 // 约束状态转移函数: f(x) -> x_next
-template <typename Modelfunc, int StateDim>
-concept StateTransitionModel = requires(Modelfunc f, Eigen::Matrix<double, StateDim, 1> x) {
-    { f(x) } -> std::convertible_to<Eigen::Matrix<double, StateDim, 1>>;
+template <typename Modelfunc, int StateDim, typename Scalar = double>
+concept StateTransitionModel = requires(Modelfunc f, Eigen::Matrix<Scalar, StateDim, 1> x) {
+    { f(x) } -> std::convertible_to<Eigen::Matrix<Scalar, StateDim, 1>>;
 };
 
 // 约束观测函数: h(x) -> z
-template <typename H, int StateDim, int ObsDim>
-concept ObservationModel = requires(H h, Eigen::Matrix<double, StateDim, 1> x) {
-    { h(x) } -> std::convertible_to<Eigen::Matrix<double, ObsDim, 1>>;
+template <typename H, int StateDim, int ObsDim, typename Scalar = double>
+concept ObservationModel = requires(H h, Eigen::Matrix<Scalar, StateDim, 1> x) {
+    { h(x) } -> std::convertible_to<Eigen::Matrix<Scalar, ObsDim, 1>>;
 };
 
 // 约束雅可比计算: Jacobian(x) -> Matrix
-template <typename JacobianFunc, int Rows, int Cols>
-concept JacobianModel = requires(JacobianFunc j, Eigen::Matrix<double, Cols, 1> x) {
-    { j(x) } -> std::convertible_to<Eigen::Matrix<double, Rows, Cols>>;
+template <typename JacobianFunc, int Rows, int Cols, typename Scalar = double>
+concept JacobianModel = requires(JacobianFunc j, Eigen::Matrix<Scalar, Cols, 1> x) {
+    { j(x) } -> std::convertible_to<Eigen::Matrix<Scalar, Rows, Cols>>;
 };
 
-template <int StateDim, int ObsDim>
+/**
+ * @brief 小维度对称正定矩阵求逆
+ * 1~3 维使用伴随矩阵闭式解, 顺序主子式判定正定; 更高维退回 LDLT
+ * @return 非正定时返回 false, inverse 不变
+ */
+template <typename Scalar, int N>
+auto symmetric_inverse(Eigen::Matrix<Scalar, N, N> const& S, Eigen::Matrix<Scalar, N, N>& inverse)
+    -> bool {
+    if constexpr (N == 1) {
+        if (!(S(0, 0) > Scalar{0})) {
+            return false;
+        }
+        inverse(0, 0) = Scalar{1} / S(0, 0);
+        return true;
+    } else if constexpr (N == 2) {
+        const auto det = S(0, 0) * S(1, 1) - S(0, 1) * S(1, 0);
+        if (!(S(0, 0) > Scalar{0}) || !(det > Scalar{0})) {
+            return false;
+        }
+        const auto inv = Scalar{1} / det;
+        inverse << S(1, 1) * inv, -S(0, 1) * inv, -S(1, 0) * inv, S(0, 0) * inv;
+        return true;
+    } else if constexpr (N == 3) {
+        const auto c00   = S(1, 1) * S(2, 2) - S(1, 2) * S(2, 1);
+        const auto c01   = S(1, 2) * S(2, 0) - S(1, 0) * S(2, 2);
+        const auto c02   = S(1, 0) * S(2, 1) - S(1, 1) * S(2, 0);
+        const auto minor = S(0, 0) * S(1, 1) - S(0, 1) * S(1, 0);
+        const auto det   = S(0, 0) * c00 + S(0, 1) * c01 + S(0, 2) * c02;
+        if (!(S(0, 0) > Scalar{0}) || !(minor > Scalar{0}) || !(det > Scalar{0})) {
+            return false;
+        }
+        const auto inv = Scalar{1} / det;
+        inverse(0, 0)  = c00 * inv;
+        inverse(1, 0)  = c01 * inv;
+        inverse(2, 0)  = c02 * inv;
+        inverse(0, 1)  = (S(0, 2) * S(2, 1) - S(0, 1) * S(2, 2)) * inv;
+        inverse(1, 1)  = (S(0, 0) * S(2, 2) - S(0, 2) * S(2, 0)) * inv;
+        inverse(2, 1)  = (S(0, 1) * S(2, 0) - S(0, 0) * S(2, 1)) * inv;
+        inverse(0, 2)  = (S(0, 1) * S(1, 2) - S(0, 2) * S(1, 1)) * inv;
+        inverse(1, 2)  = (S(0, 2) * S(1, 0) - S(0, 0) * S(1, 2)) * inv;
+        inverse(2, 2)  = minor * inv;
+        return true;
+    } else {
+        auto ldlt = S.ldlt();
+        if (ldlt.info() != Eigen::Success || !ldlt.isPositive()) {
+            return false;
+        }
+        inverse = ldlt.solve(Eigen::Matrix<Scalar, N, N>::Identity());
+        return true;
+    }
+}
+
+template <int StateDim, int ObsDim, typename Scalar = double>
 class EKF {
 public:
-    using XVec = Eigen::Matrix<double, StateDim, 1>;
-    using ZVec = Eigen::Matrix<double, ObsDim, 1>;
-    using AMat = Eigen::Matrix<double, StateDim, StateDim>;
-    using PMat = Eigen::Matrix<double, StateDim, StateDim>;
-    using PDig = Eigen::Matrix<double, StateDim, 1>;
-    using RMat = Eigen::Matrix<double, ObsDim, ObsDim>;
-    using RDig = Eigen::Matrix<double, ObsDim, 1>;
-    using QMat = Eigen::Matrix<double, StateDim, StateDim>;
-    using HMat = Eigen::Matrix<double, ObsDim, StateDim>;
+    using Real = Scalar;
+    using XVec = Eigen::Matrix<Scalar, StateDim, 1>;
+    using ZVec = Eigen::Matrix<Scalar, ObsDim, 1>;
+    using AMat = Eigen::Matrix<Scalar, StateDim, StateDim>;
+    using PMat = Eigen::Matrix<Scalar, StateDim, StateDim>;
+    using PDig = Eigen::Matrix<Scalar, StateDim, 1>;
+    using RMat = Eigen::Matrix<Scalar, ObsDim, ObsDim>;
+    using RDig = Eigen::Matrix<Scalar, ObsDim, 1>;
+    using QMat = Eigen::Matrix<Scalar, StateDim, StateDim>;
+    using HMat = Eigen::Matrix<Scalar, ObsDim, StateDim>;
 
     XVec x;
 
@@ -61,23 +114,23 @@ public:
      */
     template <typename ModelFunc, typename JacobianFunc>
     auto predict(ModelFunc&& f, JacobianFunc&& get_F, QMat const& Q) -> void {
-        static_assert(StateTransitionModel<ModelFunc, StateDim>,
+        static_assert(StateTransitionModel<ModelFunc, StateDim, Scalar>,
                       "\n[EKF Error] 状态转移函数 f(x) 签名错误！\n"
                       "预期格式: XVec f(const XVec&)\n");
 
-        static_assert(JacobianModel<JacobianFunc, StateDim, StateDim>,
+        static_assert(JacobianModel<JacobianFunc, StateDim, StateDim, Scalar>,
                       "\n[EKF Error] 状态雅可比函数 get_F(x) 签名错误！\n"
                       "预期格式: AMat get_F(const XVec&)\n"
                       "请检查返回矩阵是否为 [StateDim x StateDim] 维度.");
 
         // x_{k|k-1} = f(x_{k-1|k-1}, u_k)
-        auto x_pre = f(x);
+        const XVec x_pre = f(x);
 
         // F = df/dx | x=x_{k-1}
-        auto F = get_F(x);
+        const AMat F = get_F(x);
 
         // P_{k|k-1} = F * P_{k-1|k-1} * F^T + Q
-        auto P_pre = F * P_ * F.transpose() + Q;
+        const PMat P_pre = F * P_ * F.transpose() + Q;
 
         // 更新内部状态
         x  = x_pre;
@@ -105,15 +158,15 @@ public:
               typename SubOp = decltype(DefaultSubtract)>
     auto update(ZVec const& z, MeasFunc&& h, JacobianFunc&& get_H, RMat const& R, AddOp&& x_add_op,
                 SubOp&& z_sub_op) -> bool {
-        static_assert(ObservationModel<MeasFunc, StateDim, ObsDim>,
+        static_assert(ObservationModel<MeasFunc, StateDim, ObsDim, Scalar>,
                       "\n[EKF Error] 观测函数 h(x) 不符合要求！\n"
-                      "预期签名: Eigen::Matrix<double, ObsDim, 1> h(const Eigen::Matrix<double, "
+                      "预期签名: Eigen::Matrix<Scalar, ObsDim, 1> h(const Eigen::Matrix<Scalar, "
                       "StateDim,1>&)\n");
 
-        static_assert(JacobianModel<JacobianFunc, ObsDim, StateDim>,
+        static_assert(JacobianModel<JacobianFunc, ObsDim, StateDim, Scalar>,
                       "\n[EKF Error] 观测雅可比函数 get_H(x) 不符合要求！\n"
-                      "预期签名: Eigen::Matrix<double, ObsDim, StateDim> get_H(const "
-                      "Eigen::Matrix<double,StateDim, 1>&)\n");
+                      "预期签名: Eigen::Matrix<Scalar, ObsDim, StateDim> get_H(const "
+                      "Eigen::Matrix<Scalar,StateDim, 1>&)\n");
 
         static_assert(std::is_invocable_r_v<XVec, AddOp, XVec, XVec>,
                       "x_add_op 必须接受两个 XVec 并返回 XVec");
@@ -121,23 +174,24 @@ public:
                       "z_sub_op 必须接受两个 ZVec 并返回 ZVec");
 
         // H = dh/dx | x=x_pre
-        auto H = get_H(x);
+        const HMat H = get_H(x);
         // --- 1. 计算残差 (Innovation) ---
         // y_k = z_k - h(x_{k|k-1})
-        auto y = z_sub_op(z, h(x));
+        // 显式求值, 否则表达式模板会引用 h(x) 的临时量
+        const ZVec y = z_sub_op(z, h(x));
 
         // --- 2. 计算残差协方差 (Innovation Covariance) ---
         // S_k = H_k * P_{k|k-1} * H_k^T + R_k
-        auto S = H * P_ * H.transpose() + R;
+        const RMat S = H * P_ * H.transpose() + R;
 
         // --- 3. 计算最优卡尔曼增益 (Optimal Kalman Gain) ---
         // K_k = P_{k|k-1} * H_k^T * S_k^-1
-        // 使用高效的 LDLT 分解求解线性方程组 S*K^T = H*P
-        auto ldlt = S.ldlt();
-        if (ldlt.info() != Eigen::Success || !ldlt.isPositive()) {
+        // 观测维度 <= 3 时使用闭式逆, 否则 LDLT
+        RMat S_inv;
+        if (!symmetric_inverse(S, S_inv)) {
             return false;
         }
-        auto K = P_ * H.transpose() * ldlt.solve(RMat::Identity());
+        const Eigen::Matrix<Scalar, StateDim, ObsDim> K = P_ * H.transpose() * S_inv;
 
         // --- 4. 状态后验更新 (State Update) ---
         // x_{k|k} = x_{k|k-1} + K_k * y_k
@@ -155,6 +209,15 @@ public:
         return true;
     }
 
+    [[nodiscard]] auto covariance() const noexcept -> PMat const& {
+        return P_;
+    }
+
+    auto reset(XVec const& initial_x, PMat const& initial_P) noexcept -> void {
+        x  = initial_x;
+        P_ = initial_P;
+    }
+
 private:
     PMat P_;
 };
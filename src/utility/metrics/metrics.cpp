@@ -0,0 +1,158 @@
+#include "metrics.hpp"
+
+#include <format>
+
+#include "utility/panic.hpp"
+
+namespace pingpong_tracker::util::metrics {
+
+namespace {
+
+auto escape(std::string_view value) -> std::string {
+    auto escaped = std::string{};
+    escaped.reserve(value.size());
+    for (const auto c : value) {
+        switch (c) {
+        case '\\': escaped += "\\\\"; break;
+        case '"': escaped += "\\\""; break;
+        case '\n': escaped += "\\n"; break;
+        default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+auto render_labels(Registry::Labels const& labels) -> std::string {
+    auto rendered = std::string{};
+    for (const auto& [key, value] : labels) {
+        if (!rendered.empty()) {
+            rendered += ',';
+        }
+        rendered += std::format("{}=\"{}\"", key, escape(value));
+    }
+    return rendered;
+}
+
+// `{a="b",extra}` or `{extra}` or nothing
+auto braces(std::string_view labels, std::string_view extra = {}) -> std::string {
+    if (labels.empty() && extra.empty()) {
+        return {};
+    }
+    if (labels.empty() || extra.empty()) {
+        return std::format("{{{}{}}}", labels, extra);
+    }
+    return std::format("{{{},{}}}", labels, extra);
+}
+
+}  // namespace
+
+template <typename T>
+auto Registry::find_or_add(std::string_view name, std::string_view help, std::string_view type,
+                           Labels const& labels, auto&& make) -> T& {
+    auto family = families_.find(name);
+    if (family == families_.end()) {
+        auto entry = Family{std::string{help}, std::string{type}, {}};
+        family     = families_.emplace(std::string{name}, std::move(entry)).first;
+    }
+
+    // References to the registered metric are held for the registry's lifetime, it can never be
+    // replaced, and every series of a family shares its type
+    if (family->second.type != type) {
+        panic(std::format("Metric '{}' registered as {} and as {}", name, family->second.type,
+                          type));
+    }
+
+    auto [series, inserted] = family->second.series.try_emplace(render_labels(labels));
+    if (inserted) {
+        series->second = make();
+    }
+    return *std::get<std::unique_ptr<T>>(series->second);
+}
+
+auto Registry::counter(std::string_view name, std::string_view help, Labels const& labels)
+    -> Counter& {
+    auto lock = std::scoped_lock{mutex_};
+    return find_or_add<Counter>(name, help, "counter", labels,
+                                [] { return std::make_unique<Counter>(); });
+}
+
+auto Registry::gauge(std::string_view name, std::string_view help, Labels const& labels)
+    -> Gauge& {
+    auto lock = std::scoped_lock{mutex_};
+    return find_or_add<Gauge>(name, help, "gauge", labels,
+                              [] { return std::make_unique<Gauge>(); });
+}
+
+auto Registry::histogram(std::string_view name, std::string_view help, std::vector<double> bounds,
+                         Labels const& labels) -> Histogram& {
+    auto lock = std::scoped_lock{mutex_};
+    return find_or_add<Histogram>(name, help, "histogram", labels, [&] {
+        return std::make_unique<Histogram>(std::move(bounds));
+    });
+}
+
+auto Registry::rate(std::string_view name, std::string_view help, Counter const& source,
+                    Labels const& labels) -> Gauge& {
+    auto lock    = std::scoped_lock{mutex_};
+    auto& target = find_or_add<Gauge>(name, help, "gauge", labels,
+                                      [] { return std::make_unique<Gauge>(); });
+
+    const auto existing = std::ranges::find(rates_, &target, &Rate::target);
+    if (existing == rates_.end()) {
+        rates_.push_back({&source, &target, source.value(), Clock::now()});
+    }
+    return target;
+}
+
+auto Registry::update_rates(Clock::time_point now) -> void {
+    auto lock = std::scoped_lock{mutex_};
+    for (auto& rate : rates_) {
+        const auto elapsed = std::chrono::duration<double>{now - rate.last_time}.count();
+        if (elapsed < 1.0) {
+            continue;
+        }
+        const auto value = rate.source->value();
+        rate.target->set(static_cast<double>(value - rate.last_value) / elapsed);
+        rate.last_value = value;
+        rate.last_time  = now;
+    }
+}
+
+auto Registry::render() const -> std::string {
+    auto lock = std::scoped_lock{mutex_};
+
+    auto text = std::string{};
+    for (const auto& [name, family] : families_) {
+        text += std::format("# HELP {} {}\n# TYPE {} {}\n", name, family.help, name, family.type);
+
+        for (const auto& [labels, metric] : family.series) {
+            if (const auto* counter = std::get_if<std::unique_ptr<Counter>>(&metric)) {
+                text += std::format("{}{} {}\n", name, braces(labels), (*counter)->value());
+            } else if (const auto* gauge = std::get_if<std::unique_ptr<Gauge>>(&metric)) {
+                text += std::format("{}{} {}\n", name, braces(labels), (*gauge)->value());
+            } else if (const auto* histogram = std::get_if<std::unique_ptr<Histogram>>(&metric)) {
+                const auto snapshot = (*histogram)->snapshot();
+
+                auto cumulative = std::uint64_t{0};
+                for (std::size_t i = 0; i < snapshot.bounds.size(); ++i) {
+                    cumulative += snapshot.counts[i];
+                    const auto bound = std::format("le=\"{}\"", snapshot.bounds[i]);
+                    text += std::format("{}_bucket{} {}\n", name, braces(labels, bound),
+                                        cumulative);
+                }
+                text += std::format("{}_bucket{} {}\n", name, braces(labels, "le=\"+Inf\""),
+                                    snapshot.count);
+                text += std::format("{}_sum{} {}\n", name, braces(labels), snapshot.sum);
+                text += std::format("{}_count{} {}\n", name, braces(labels), snapshot.count);
+            }
+        }
+    }
+    return text;
+}
+
+auto registry() -> Registry& {
+    static auto instance = Registry{};
+    return instance;
+}
+
+}  // namespace pingpong_tracker::util::metrics
@@ -0,0 +1,193 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "utility/clock.hpp"
+
+namespace pingpong_tracker::util::metrics {
+
+/// @brief Monotonic count, one relaxed increment per update
+class alignas(64) Counter {
+public:
+    auto add(std::uint64_t amount = 1) noexcept -> void {
+        value_.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto value() const noexcept -> std::uint64_t {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+/// @brief Last written value, one relaxed store per update
+class alignas(64) Gauge {
+public:
+    auto set(double value) noexcept -> void {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto value() const noexcept -> double {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/// @brief
+///   Cumulative histogram over fixed upper bounds, Prometheus style.
+/// @note
+///   - An observation is a short search over the bounds and two relaxed increments, the bucket
+///     and the sum. The sum is kept in fixed point, nanounits, so it needs no CAS loop.
+///   - The count is the total of the buckets, computed when read.
+class Histogram {
+public:
+    static constexpr double kSumScale = 1e9;
+
+    struct Snapshot {
+        std::vector<double> bounds;
+        // Per bucket, the last one is +Inf
+        std::vector<std::uint64_t> counts;
+        std::uint64_t count = 0;
+        double sum          = 0.0;
+    };
+
+    explicit Histogram(std::vector<double> bounds)
+        : bounds_{std::move(bounds)}
+        , counts_{std::make_unique<std::atomic<std::uint64_t>[]>(bounds_.size() + 1)} {
+        std::ranges::sort(bounds_);
+    }
+
+    auto observe(double value) noexcept -> void {
+        const auto bucket = static_cast<std::size_t>(
+            std::ranges::lower_bound(bounds_, value) - bounds_.begin());
+        counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(std::llround(value * kSumScale), std::memory_order_relaxed);
+    }
+
+    /// @brief Observes a duration in seconds
+    auto observe(Clock::duration duration) noexcept -> void {
+        observe(std::chrono::duration<double>{duration}.count());
+    }
+
+    [[nodiscard]] auto snapshot() const -> Snapshot {
+        auto snapshot   = Snapshot{};
+        snapshot.bounds = bounds_;
+        snapshot.counts.resize(bounds_.size() + 1);
+        for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+            snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+            snapshot.count += snapshot.counts[i];
+        }
+        snapshot.sum = static_cast<double>(sum_.load(std::memory_order_relaxed)) / kSumScale;
+        return snapshot;
+    }
+
+    /// @brief Estimated `q` quantile, linear within the bucket, the last finite bound for +Inf
+    [[nodiscard]] auto quantile(double q) const -> double {
+        return quantile(snapshot(), q);
+    }
+
+    static auto quantile(Snapshot const& snapshot, double q) noexcept -> double {
+        if (snapshot.count == 0 || snapshot.bounds.empty()) {
+            return 0.0;
+        }
+        const auto rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(snapshot.count);
+
+        auto below = 0.0;
+        for (std::size_t i = 0; i < snapshot.bounds.size(); ++i) {
+            const auto in_bucket = static_cast<double>(snapshot.counts[i]);
+            if (below + in_bucket >= rank && in_bucket > 0) {
+                const auto lower = i == 0 ? 0.0 : snapshot.bounds[i - 1];
+                return lower + (snapshot.bounds[i] - lower) * (rank - below) / in_bucket;
+            }
+            below += in_bucket;
+        }
+        return snapshot.bounds.back();
+    }
+
+    /// @brief 0.5 ms to 0.5 s, doubling
+    static auto latency_bounds() -> std::vector<double> {
+        auto bounds = std::vector<double>{};
+        for (auto bound = 0.0005; bound < 0.6; bound *= 2.0) {
+            bounds.push_back(bound);
+        }
+        return bounds;
+    }
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;
+    std::atomic<std::int64_t> sum_{0};
+};
+
+/// @brief
+///   Process-wide set of named metrics, rendered in the Prometheus text exposition format.
+/// @note
+///   - Registration takes a lock and should happen once, keep the returned reference. It stays
+///     valid for the lifetime of the registry.
+///   - Registering the same name and labels again returns the existing metric. Registering a
+///     name again with another metric type panics.
+///   - A rate is a gauge derived from a counter, refreshed by `update_rates` about every second.
+class Registry {
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    auto counter(std::string_view name, std::string_view help, Labels const& labels = {})
+        -> Counter&;
+    auto gauge(std::string_view name, std::string_view help, Labels const& labels = {}) -> Gauge&;
+    auto histogram(std::string_view name, std::string_view help,
+                   std::vector<double> bounds = Histogram::latency_bounds(),
+                   Labels const& labels = {}) -> Histogram&;
+
+    /// @brief Per-second rate of `source`
+    auto rate(std::string_view name, std::string_view help, Counter const& source,
+              Labels const& labels = {}) -> Gauge&;
+
+    auto update_rates(Clock::time_point now = Clock::now()) -> void;
+
+    [[nodiscard]] auto render() const -> std::string;
+
+private:
+    using Metric = std::variant<std::unique_ptr<Counter>, std::unique_ptr<Gauge>,
+                                std::unique_ptr<Histogram>>;
+
+    struct Family {
+        std::string help;
+        std::string type;
+        // Rendered label set to metric
+        std::map<std::string, Metric> series;
+    };
+
+    struct Rate {
+        Counter const* source;
+        Gauge* target;
+        std::uint64_t last_value;
+        Clock::time_point last_time;
+    };
+
+    template <typename T>
+    auto find_or_add(std::string_view name, std::string_view help, std::string_view type,
+                     Labels const& labels, auto&& make) -> T&;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family, std::less<>> families_;
+    std::vector<Rate> rates_;
+};
+
+/// @brief The process-wide registry
+auto registry() -> Registry&;
+
+}  // namespace pingpong_tracker::util::metrics
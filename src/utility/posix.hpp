@@ -0,0 +1,61 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace pingpong_tracker::util {
+
+/// @brief Owns a POSIX file descriptor and closes it, -1 when empty
+struct FileDescriptor {
+    int fd = -1;
+
+    explicit FileDescriptor(int fd = -1) noexcept : fd{fd} {
+    }
+    FileDescriptor(const FileDescriptor&)            = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    FileDescriptor(FileDescriptor&& other) noexcept : fd{std::exchange(other.fd, -1)} {
+    }
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+        std::swap(fd, other.fd);
+        return *this;
+    }
+    ~FileDescriptor() noexcept {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+/// @brief Owns a region mapped with `mmap` and unmaps it, `base` is null when empty
+struct Mapping {
+    void* base       = nullptr;
+    std::size_t size = 0;
+
+    Mapping() = default;
+    Mapping(const Mapping&)            = delete;
+    Mapping& operator=(const Mapping&) = delete;
+    Mapping(Mapping&& other) noexcept
+        : base{std::exchange(other.base, nullptr)}
+        , size{std::exchange(other.size, 0)} {
+    }
+    Mapping& operator=(Mapping&& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(size, other.size);
+        return *this;
+    }
+    ~Mapping() noexcept {
+        if (base != nullptr) {
+            ::munmap(base, size);
+        }
+    }
+
+    [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+        return {static_cast<const std::byte*>(base), base == nullptr ? 0 : size};
+    }
+};
+
+}  // namespace pingpong_tracker::util
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Fixed-layout result of one frame, what external consumers such as the robot controller
+///   receive over UDP and shared memory.
+/// @note
+///   - Plain little-endian structs with explicit padding, 608 bytes, the same bytes on every
+///     transport. Consumers in other languages mirror the layout field by field.
+///   - Times are nanoseconds of CLOCK_MONOTONIC (`util::Clock`), comparable between processes
+///     on the same host.
+///   - At most `kMaxBalls` detections and `kMaxTracks` tracks, the counts tell how many entries
+///     are valid.
+struct BallMessage {
+    static constexpr std::uint32_t kMagic   = 0x4C42'5050;  // "PPBL"
+    static constexpr std::uint16_t kVersion = 1;
+
+    static constexpr std::size_t kMaxBalls  = 16;
+    static constexpr std::size_t kMaxTracks = 8;
+
+    struct Ball {
+        float x;
+        float y;
+        float radius;
+        float confidence;
+    };
+
+    struct Track {
+        static constexpr std::uint32_t kCoasting = 1U << 0U;
+
+        std::uint32_t id;
+        std::uint32_t flags;
+        // pixel, pixel / s
+        float x;
+        float y;
+        float vx;
+        float vy;
+        float radius;
+        std::uint32_t reserved;
+    };
+
+    /// @brief Table-frame state of the primary ball and its landing forecast
+    struct Prediction {
+        static constexpr std::uint32_t kValid    = 1U << 0U;
+        static constexpr std::uint32_t kLanding  = 1U << 1U;
+        static constexpr std::uint32_t kCoasting = 1U << 2U;
+
+        std::uint32_t id;
+        std::uint32_t flags;
+        // metre, metre / s
+        float x;
+        float y;
+        float z;
+        float vx;
+        float vy;
+        float vz;
+        // metre, the contact point of the next table bounce
+        float landing_x;
+        float landing_y;
+        float landing_z;
+        float landing_confidence;
+        std::int64_t landing_ns;
+    };
+
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t size;
+    // Counts every published frame, a gap means a consumer missed messages
+    std::uint64_t sequence;
+    // When the frame was captured and when the message left the tracker
+    std::int64_t capture_ns;
+    std::int64_t publish_ns;
+    std::uint16_t ball_count;
+    std::uint16_t track_count;
+    std::uint32_t reserved;
+
+    std::array<Ball, kMaxBalls> balls;
+    std::array<Track, kMaxTracks> tracks;
+    Prediction prediction;
+
+    [[nodiscard]] auto valid() const noexcept -> bool {
+        return magic == kMagic && version == kVersion && size == sizeof(BallMessage)
+            && ball_count <= kMaxBalls && track_count <= kMaxTracks;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<BallMessage>);
+static_assert(std::is_standard_layout_v<BallMessage>);
+static_assert(sizeof(BallMessage::Track) == 32);
+static_assert(sizeof(BallMessage::Prediction) == 56);
+static_assert(sizeof(BallMessage) == 608);
+
+}  // namespace pingpong_tracker::util
@@ -0,0 +1,508 @@
+#include "frame_bus.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "utility/posix.hpp"
+
+using namespace pingpong_tracker::util;
+
+namespace {
+
+constexpr std::size_t kCacheLine = 64;
+
+// Readers back off a slot the writer is claiming, a few retries cover a frame being published
+constexpr int kAcquireAttempts = 8;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Atomics shared between processes must be lock-free");
+
+struct Header {
+    static constexpr std::uint64_t kMagic   = 0x5345'4D41'5246'5050;  // "PPFRAMES"
+    static constexpr std::uint32_t kVersion = 1;
+
+    // Written last by the writer, readers wait for it
+    std::atomic<std::uint64_t> magic;
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint64_t slot_bytes;
+    // Page aligned, the pixels are mapped apart from the writable control block
+    std::uint64_t data_offset;
+    std::atomic<std::uint32_t> closed;
+
+    alignas(kCacheLine) std::atomic<std::uint64_t> published;
+    std::atomic<std::uint32_t> latest;
+};
+
+struct alignas(kCacheLine) Slot {
+    std::atomic<std::uint64_t> sequence;
+    // Readers count themselves in, the writer claims the slot with `writing`, checking both in
+    // opposite order keeps them from overlapping
+    std::atomic<std::uint32_t> readers;
+    std::atomic<std::uint32_t> writing;
+
+    std::atomic<std::int64_t> timestamp_ns;
+    std::atomic<std::int32_t> rows;
+    std::atomic<std::int32_t> cols;
+    std::atomic<std::int32_t> type;
+    std::atomic<std::uint64_t> bytes;
+};
+
+// Bytes of a frame stored without row padding, nullopt for metadata describing no valid cv::Mat
+auto packed_bytes(std::int32_t rows, std::int32_t cols, std::int32_t type) noexcept
+    -> std::optional<std::size_t> {
+    if (rows <= 0 || cols <= 0 || type < 0 || (type & ~CV_MAT_TYPE_MASK) != 0) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(rows) * static_cast<std::size_t>(cols)
+         * static_cast<std::size_t>(CV_ELEM_SIZE(type));
+}
+
+auto round_up(std::size_t value, std::size_t alignment) noexcept -> std::size_t {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+auto control_size(std::uint32_t slot_count) noexcept -> std::size_t {
+    return round_up(sizeof(Header) + sizeof(Slot) * slot_count,
+                    static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)));
+}
+
+auto slots_of(void* base) noexcept -> Slot* {
+    return reinterpret_cast<Slot*>(static_cast<std::byte*>(base) + sizeof(Header));
+}
+
+auto system_error(std::string_view what) -> std::string {
+    return std::format("{}: {}", what, std::strerror(errno));
+}
+
+}  // namespace
+
+/// Writer
+
+struct FrameBusWriter::Impl {
+    std::string name;
+    Mapping mapping;
+    Header* header      = nullptr;
+    Slot* slots         = nullptr;
+    std::byte* data     = nullptr;
+    std::uint64_t count = 0;
+    std::uint64_t overwritten = 0;
+    // Identity of the segment, the name may have been taken over by another writer since
+    dev_t device = 0;
+    ino_t inode  = 0;
+
+    Impl() = default;
+    Impl(const Impl&)            = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    ~Impl() noexcept {
+        if (header != nullptr) {
+            header->closed.store(1, std::memory_order_release);
+            if (owns_name()) {
+                ::shm_unlink(name.c_str());
+            }
+        }
+    }
+
+    auto owns_name() const noexcept -> bool {
+        const auto current = FileDescriptor{::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0)};
+        struct stat status {};
+        return current.fd >= 0 && ::fstat(current.fd, &status) == 0 && status.st_dev == device
+            && status.st_ino == inode;
+    }
+
+    auto open(std::uint32_t slot_count, std::size_t slot_bytes, bool takeover) noexcept
+        -> std::expected<void, std::string> {
+        if (slot_count < 2 || slot_bytes == 0) {
+            return std::unexpected{"Frame bus needs at least two slots of positive size"};
+        }
+        slot_bytes = round_up(slot_bytes, kCacheLine);
+
+        if (takeover) {
+            // Readers of a segment left behind by a crashed writer see no more frames
+            ::shm_unlink(name.c_str());
+        }
+
+        // Readers write their reference counts, so the group needs write access too
+        const auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+        if (fd < 0 && errno == EEXIST) {
+            return std::unexpected{std::format(
+                "Shared memory '{}' is in use by another writer or left behind by one, take it "
+                "over explicitly to replace it",
+                name)};
+        }
+        if (fd < 0) {
+            return std::unexpected{system_error(std::format("shm_open '{}'", name))};
+        }
+        struct stat status {};
+        if (::fstat(fd, &status) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return std::unexpected{system_error("fstat")};
+        }
+        device = status.st_dev;
+        inode  = status.st_ino;
+        const auto data_offset = control_size(slot_count);
+        const auto size        = data_offset + slot_bytes * slot_count;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return std::unexpected{system_error("ftruncate")};
+        }
+        auto* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return std::unexpected{system_error("mmap")};
+        }
+        mapping.base = base;
+        mapping.size = size;
+
+        header = ::new (base) Header{};
+        slots  = slots_of(base);
+        for (std::uint32_t i = 0; i < slot_count; ++i) {
+            ::new (static_cast<void*>(slots + i)) Slot{};
+        }
+        data = static_cast<std::byte*>(base) + data_offset;
+
+        header->version     = Header::kVersion;
+        header->slot_count  = slot_count;
+        header->slot_bytes  = slot_bytes;
+        header->data_offset = data_offset;
+        header->latest.store(slot_count - 1, std::memory_order_relaxed);
+        header->magic.store(Header::kMagic, std::memory_order_release);
+        return {};
+    }
+
+    // The oldest slot nobody holds, or the oldest one when every slot is held
+    auto claim() noexcept -> std::uint32_t {
+        const auto slot_count = header->slot_count;
+        const auto latest     = header->latest.load(std::memory_order_relaxed);
+        for (std::uint32_t k = 1; k <= slot_count; ++k) {
+            const auto index = (latest + k) % slot_count;
+            auto& slot       = slots[index];
+            if (index == latest || slot.readers.load(std::memory_order_acquire) != 0) {
+                continue;
+            }
+            slot.writing.store(1, std::memory_order_seq_cst);
+            if (slot.readers.load(std::memory_order_seq_cst) == 0) {
+                return index;
+            }
+            slot.writing.store(0, std::memory_order_release);
+        }
+
+        ++overwritten;
+        const auto index = (latest + 1) % slot_count;
+        slots[index].writing.store(1, std::memory_order_seq_cst);
+        return index;
+    }
+
+    auto publish(const cv::Mat& mat, Clock::time_point timestamp) noexcept -> bool {
+        const auto row_bytes = static_cast<std::size_t>(mat.cols) * mat.elemSize();
+        const auto bytes     = row_bytes * static_cast<std::size_t>(mat.rows);
+        if (mat.empty() || bytes > header->slot_bytes) {
+            return false;
+        }
+
+        const auto index = claim();
+        auto& slot       = slots[index];
+        auto* target     = data + header->slot_bytes * index;
+
+        slot.sequence.store(2 * count + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (mat.isContinuous()) {
+            std::memcpy(target, mat.data, bytes);
+        } else {
+            for (int row = 0; row < mat.rows; ++row) {
+                std::memcpy(target + row_bytes * static_cast<std::size_t>(row), mat.ptr(row),
+                            row_bytes);
+            }
+        }
+        slot.timestamp_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    timestamp.time_since_epoch())
+                                    .count(),
+                                std::memory_order_relaxed);
+        slot.rows.store(mat.rows, std::memory_order_relaxed);
+        slot.cols.store(mat.cols, std::memory_order_relaxed);
+        slot.type.store(mat.type(), std::memory_order_relaxed);
+        slot.bytes.store(bytes, std::memory_order_relaxed);
+
+        slot.sequence.store(2 * count + 2, std::memory_order_release);
+        slot.writing.store(0, std::memory_order_release);
+        header->latest.store(index, std::memory_order_release);
+        header->published.store(++count, std::memory_order_release);
+        return true;
+    }
+};
+
+FrameBusWriter::FrameBusWriter() : pimpl_{std::make_unique<Impl>()} {
+}
+
+FrameBusWriter::~FrameBusWriter() noexcept                           = default;
+FrameBusWriter::FrameBusWriter(FrameBusWriter&&) noexcept            = default;
+FrameBusWriter& FrameBusWriter::operator=(FrameBusWriter&&) noexcept = default;
+
+auto FrameBusWriter::open(const std::string& name, std::uint32_t slots, std::size_t slot_bytes,
+                          bool takeover) noexcept -> std::expected<FrameBusWriter, std::string> {
+    auto writer          = FrameBusWriter{};
+    writer.pimpl_->name = name;
+    if (auto result = writer.pimpl_->open(slots, slot_bytes, takeover); !result) {
+        return std::unexpected{result.error()};
+    }
+    return writer;
+}
+
+auto FrameBusWriter::publish(const cv::Mat& mat, Clock::time_point timestamp) noexcept -> bool {
+    return pimpl_->publish(mat, timestamp);
+}
+
+auto FrameBusWriter::overwritten() const noexcept -> std::uint64_t {
+    return pimpl_->overwritten;
+}
+
+/// View
+
+FrameView::~FrameView() noexcept {
+    release();
+}
+
+FrameView::FrameView(FrameView&& other) noexcept
+    : readers_{std::exchange(other.readers_, nullptr)}
+    , sequence_{std::exchange(other.sequence_, nullptr)}
+    , expected_sequence_{other.expected_sequence_}
+    , index_{other.index_}
+    , timestamp_{other.timestamp_}
+    , rows_{other.rows_}
+    , cols_{other.cols_}
+    , type_{other.type_}
+    , bytes_{std::exchange(other.bytes_, {})} {
+}
+
+FrameView& FrameView::operator=(FrameView&& other) noexcept {
+    if (this != &other) {
+        release();
+        readers_           = std::exchange(other.readers_, nullptr);
+        sequence_          = std::exchange(other.sequence_, nullptr);
+        expected_sequence_ = other.expected_sequence_;
+        index_             = other.index_;
+        timestamp_         = other.timestamp_;
+        rows_              = other.rows_;
+        cols_              = other.cols_;
+        type_              = other.type_;
+        bytes_             = std::exchange(other.bytes_, {});
+    }
+    return *this;
+}
+
+auto FrameView::mat() const noexcept -> cv::Mat {
+    // The shape comes from another process, a header reaching past the slot is never handed out
+    const auto needed = packed_bytes(rows_, cols_, type_);
+    if (empty() || !needed || *needed > bytes_.size()) {
+        return {};
+    }
+    // The mapping is read-only, the const_cast only satisfies the cv::Mat constructor
+    return cv::Mat{rows_, cols_, type_, const_cast<std::byte*>(bytes_.data())};
+}
+
+auto FrameView::intact() const noexcept -> bool {
+    if (empty()) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sequence_->load(std::memory_order_relaxed) == expected_sequence_;
+}
+
+auto FrameView::release() noexcept -> void {
+    if (readers_ != nullptr) {
+        readers_->fetch_sub(1, std::memory_order_release);
+        readers_  = nullptr;
+        sequence_ = nullptr;
+        bytes_    = {};
+    }
+}
+
+/// Reader
+
+struct FrameBusReader::Impl {
+    Mapping control;
+    Mapping pixels;
+    const Header* header      = nullptr;
+    Slot* slots               = nullptr;
+    const std::byte* data     = nullptr;
+    // Copied when mapping, the control block is writable by every reader
+    std::uint32_t slot_count  = 0;
+    std::size_t slot_bytes    = 0;
+    std::uint64_t next        = 0;
+    std::uint64_t lost        = 0;
+
+    auto open(const std::string& name) noexcept -> std::expected<void, std::string> {
+        const auto fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) {
+            return std::unexpected{system_error(std::format("shm_open '{}'", name))};
+        }
+        auto result = map(name, fd);
+        ::close(fd);
+        return result;
+    }
+
+    auto map(const std::string& name, int fd) noexcept -> std::expected<void, std::string> {
+        const auto not_a_bus = [&] {
+            return std::unexpected{std::format("'{}' is not a frame bus of this version", name)};
+        };
+
+        struct stat status {};
+        if (::fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header))) {
+            return not_a_bus();
+        }
+        const auto size = static_cast<std::size_t>(status.st_size);
+
+        // The header alone first, to learn where the pixels start
+        auto* base = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            return std::unexpected{system_error("mmap")};
+        }
+        const auto& probe = *static_cast<const Header*>(base);
+        const auto valid  = probe.magic.load(std::memory_order_acquire) == Header::kMagic
+                        && probe.version == Header::kVersion && probe.slot_count >= 2
+                        && probe.data_offset == control_size(probe.slot_count)
+                        && probe.data_offset + probe.slot_bytes * probe.slot_count == size;
+        const auto data_offset = probe.data_offset;
+        const auto probe_slots = probe.slot_count;
+        ::munmap(base, sizeof(Header));
+        if (!valid) {
+            return not_a_bus();
+        }
+
+        base = ::mmap(nullptr, data_offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            return std::unexpected{system_error("mmap control block")};
+        }
+        control.base = base;
+        control.size = data_offset;
+
+        base = ::mmap(nullptr, size - data_offset, PROT_READ, MAP_SHARED, fd,
+                      static_cast<off_t>(data_offset));
+        if (base == MAP_FAILED) {
+            return std::unexpected{system_error("mmap pixels")};
+        }
+        pixels.base = base;
+        pixels.size = size - data_offset;
+
+        header     = static_cast<const Header*>(control.base);
+        slots      = slots_of(control.base);
+        data       = static_cast<const std::byte*>(pixels.base);
+        slot_count = probe_slots;
+        slot_bytes = (size - data_offset) / slot_count;
+
+        // Start at the newest frame, the ones before the subscription are not counted as lost
+        const auto published = header->published.load(std::memory_order_acquire);
+        next                 = published == 0 ? 0 : published - 1;
+        return {};
+    }
+
+    auto next_frame(FrameView& view) noexcept -> Status {
+        view.release();
+
+        for (int attempt = 0; attempt < kAcquireAttempts; ++attempt) {
+            const auto published = header->published.load(std::memory_order_acquire);
+            if (next >= published) {
+                break;
+            }
+
+            const auto index = header->latest.load(std::memory_order_acquire);
+            if (index >= slot_count) [[unlikely]] {
+                break;
+            }
+            auto& slot = slots[index];
+            slot.readers.fetch_add(1, std::memory_order_seq_cst);
+            if (slot.writing.load(std::memory_order_seq_cst) != 0) {
+                slot.readers.fetch_sub(1, std::memory_order_release);
+                continue;
+            }
+
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            // Odd is a forced overwrite in progress, zero was never written
+            if (sequence % 2 != 0 || sequence == 0 || sequence / 2 - 1 < next) {
+                slot.readers.fetch_sub(1, std::memory_order_release);
+                continue;
+            }
+            const auto frame = sequence / 2 - 1;
+
+            const auto timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+            const auto rows         = slot.rows.load(std::memory_order_relaxed);
+            const auto cols         = slot.cols.load(std::memory_order_relaxed);
+            const auto type         = slot.type.load(std::memory_order_relaxed);
+            const auto bytes        = slot.bytes.load(std::memory_order_relaxed);
+
+            // A forced overwrite may have started after the sequence was read, the metadata only
+            // belongs to the frame if the sequence is still the same
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                slot.readers.fetch_sub(1, std::memory_order_release);
+                continue;
+            }
+
+            const auto needed = packed_bytes(rows, cols, type);
+            if (!needed || *needed > bytes || bytes > slot_bytes) [[unlikely]] {
+                // Metadata no writer of this version produces, the frame is skipped as lost
+                slot.readers.fetch_sub(1, std::memory_order_release);
+                lost += frame + 1 - next;
+                next = frame + 1;
+                continue;
+            }
+
+            view.readers_           = &slot.readers;
+            view.sequence_          = &slot.sequence;
+            view.expected_sequence_ = sequence;
+            view.index_             = frame;
+            view.timestamp_         = Clock::time_point{std::chrono::nanoseconds{timestamp_ns}};
+            view.rows_              = rows;
+            view.cols_              = cols;
+            view.type_              = type;
+            view.bytes_             = {data + slot_bytes * index, bytes};
+
+            lost += frame - next;
+            next = frame + 1;
+            return Status::FRAME;
+        }
+
+        return header->closed.load(std::memory_order_acquire) != 0
+                    && next >= header->published.load(std::memory_order_acquire)
+                 ? Status::CLOSED
+                 : Status::EMPTY;
+    }
+};
+
+FrameBusReader::FrameBusReader() : pimpl_{std::make_unique<Impl>()} {
+}
+
+FrameBusReader::~FrameBusReader() noexcept                           = default;
+FrameBusReader::FrameBusReader(FrameBusReader&&) noexcept            = default;
+FrameBusReader& FrameBusReader::operator=(FrameBusReader&&) noexcept = default;
+
+auto FrameBusReader::open(const std::string& name) noexcept
+    -> std::expected<FrameBusReader, std::string> {
+    auto reader = FrameBusReader{};
+    if (auto result = reader.pimpl_->open(name); !result) {
+        return std::unexpected{result.error()};
+    }
+    return reader;
+}
+
+auto FrameBusReader::next(FrameView& view) noexcept -> Status {
+    return pimpl_->next_frame(view);
+}
+
+auto FrameBusReader::lost() const noexcept -> std::uint64_t {
+    return pimpl_->lost;
+}
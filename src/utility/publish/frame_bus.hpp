@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <opencv2/core/mat.hpp>
+#include <span>
+#include <string>
+
+#include "utility/clock.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Publishes camera frames into a POSIX shared-memory ring of fixed-size slots, so other
+///   processes on the host can read them without a copy or an encode.
+/// @note
+///   - Slots are seqlocked like `ShmPublisher`: a slot's sequence is odd while it is written and
+///     `2 i + 2` once it holds frame `i`. Pixels are copied once, into the slot.
+///   - Readers hold slots through a reference count. The writer takes the oldest slot nobody
+///     holds; when every slot is held it overwrites the oldest anyway and counts it, so a slow
+///     or crashed reader never stalls capture. `FrameView::intact` detects the overwrite.
+///   - Single writer. Opening fails while a segment of the same name exists, unless `takeover`
+///     asks to replace it. Closing marks the bus closed and unlinks the name if it still refers
+///     to this bus.
+class FrameBusWriter {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(FrameBusWriter)
+
+public:
+    /// @param name POSIX shm name, such as "/pingpong_tracker_frames"
+    /// @param slots Frames kept at once, more than the readers hold together
+    /// @param slot_bytes Largest frame in bytes, rows are stored without padding
+    /// @param takeover Replace an existing segment, such as one left behind by a crash
+    static auto open(const std::string& name, std::uint32_t slots, std::size_t slot_bytes,
+                     bool takeover = false) noexcept
+        -> std::expected<FrameBusWriter, std::string>;
+
+    /// @return False when the frame is empty or larger than a slot
+    auto publish(const cv::Mat&, Clock::time_point timestamp) noexcept -> bool;
+
+    /// @brief Frames written over a slot a reader still held
+    [[nodiscard]] auto overwritten() const noexcept -> std::uint64_t;
+
+private:
+    FrameBusWriter();
+};
+
+/// @brief
+///   A frame held in the shared ring, the pixels stay in the mapping of the reader.
+/// @note
+///   - Releases its slot on destruction, must not outlive the `FrameBusReader` it came from.
+///   - The metadata is copied when the frame is taken. The pixels are not, check `intact`
+///     after using them: false means the writer had to reuse the slot meanwhile.
+class FrameView {
+public:
+    FrameView() noexcept = default;
+    ~FrameView() noexcept;
+
+    FrameView(const FrameView&)            = delete;
+    FrameView& operator=(const FrameView&) = delete;
+    FrameView(FrameView&&) noexcept;
+    FrameView& operator=(FrameView&&) noexcept;
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return readers_ == nullptr;
+    }
+
+    /// @brief Publication number of the frame, consecutive across the bus
+    [[nodiscard]] auto index() const noexcept -> std::uint64_t {
+        return index_;
+    }
+    [[nodiscard]] auto timestamp() const noexcept -> Clock::time_point {
+        return timestamp_;
+    }
+    [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+        return bytes_;
+    }
+
+    /// @brief Read-only header over the shared pixels, writing through it faults
+    /// @return Empty when the view is, or when its shape does not fit in its bytes
+    [[nodiscard]] auto mat() const noexcept -> cv::Mat;
+
+    /// @brief Whether the slot still holds this frame
+    [[nodiscard]] auto intact() const noexcept -> bool;
+
+    auto release() noexcept -> void;
+
+private:
+    friend class FrameBusReader;
+
+    std::atomic<std::uint32_t>* readers_          = nullptr;
+    const std::atomic<std::uint64_t>* sequence_ = nullptr;
+    std::uint64_t expected_sequence_            = 0;
+
+    std::uint64_t index_ = 0;
+    Clock::time_point timestamp_{};
+    std::int32_t rows_ = 0;
+    std::int32_t cols_ = 0;
+    std::int32_t type_ = 0;
+    std::span<const std::byte> bytes_;
+};
+
+/// @brief
+///   Maps a bus written by `FrameBusWriter`, from any process.
+/// @note
+///   - `next` hands out the newest frame not returned yet. Frames published in between are
+///     counted in `lost`, a reader only ever looks at the present.
+///   - Pixels are mapped read-only, only the slot reference counts are writable.
+class FrameBusReader {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(FrameBusReader)
+
+public:
+    enum class Status : std::uint8_t { FRAME, EMPTY, CLOSED };
+
+    static auto open(const std::string& name) noexcept
+        -> std::expected<FrameBusReader, std::string>;
+
+    /// @brief Releases `view` and takes the newest unread frame into it
+    auto next(FrameView& view) noexcept -> Status;
+
+    /// @brief Frames published while this reader was not looking
+    [[nodiscard]] auto lost() const noexcept -> std::uint64_t;
+
+private:
+    FrameBusReader();
+};
+
+}  // namespace pingpong_tracker::util
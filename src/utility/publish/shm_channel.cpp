@@ -0,0 +1,314 @@
+#include "shm_channel.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <new>
+
+#include "utility/posix.hpp"
+
+using namespace pingpong_tracker::util;
+
+namespace {
+
+constexpr std::size_t kCacheLine = 64;
+constexpr std::size_t kWords     = sizeof(BallMessage) / sizeof(std::uint64_t);
+static_assert(sizeof(BallMessage) % sizeof(std::uint64_t) == 0);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Atomics shared between processes must be lock-free");
+
+using Words = std::array<std::uint64_t, kWords>;
+
+struct Header {
+    static constexpr std::uint64_t kMagic   = 0x474E'4952'4C42'5050;  // "PPBLRING"
+    static constexpr std::uint32_t kVersion = 1;
+
+    // Written last by the publisher, readers wait for it
+    std::atomic<std::uint64_t> magic;
+    std::uint32_t version;
+    std::uint32_t capacity;
+    std::uint32_t message_size;
+    std::atomic<std::uint32_t> closed;
+
+    alignas(kCacheLine) std::atomic<std::uint64_t> published;
+};
+
+struct alignas(kCacheLine) Slot {
+    std::atomic<std::uint64_t> sequence;
+    std::array<std::atomic<std::uint64_t>, kWords> words;
+};
+
+auto segment_size(std::uint32_t capacity) noexcept -> std::size_t {
+    return sizeof(Header) + sizeof(Slot) * capacity;
+}
+
+auto slots_of(void* base) noexcept -> Slot* {
+    return reinterpret_cast<Slot*>(static_cast<std::byte*>(base) + sizeof(Header));
+}
+
+auto system_error(std::string_view what) -> std::string {
+    return std::format("{}: {}", what, std::strerror(errno));
+}
+
+}  // namespace
+
+/// Publisher
+
+struct ShmPublisher::Impl {
+    std::string name;
+    Mapping mapping;
+    Header* header = nullptr;
+    Slot* slots    = nullptr;
+    std::uint64_t count = 0;
+    // Identity of the segment, the name may have been taken over by another publisher since
+    dev_t device = 0;
+    ino_t inode  = 0;
+
+    Impl() = default;
+    Impl(const Impl&)            = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    ~Impl() noexcept {
+        if (header != nullptr) {
+            header->closed.store(1, std::memory_order_release);
+            if (owns_name()) {
+                ::shm_unlink(name.c_str());
+            }
+        }
+    }
+
+    auto owns_name() const noexcept -> bool {
+        const auto current = FileDescriptor{::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0)};
+        struct stat status {};
+        return current.fd >= 0 && ::fstat(current.fd, &status) == 0 && status.st_dev == device
+            && status.st_ino == inode;
+    }
+
+    auto open(std::uint32_t capacity, bool takeover) noexcept
+        -> std::expected<void, std::string> {
+        if (capacity == 0) {
+            return std::unexpected{"Shared memory ring needs a positive capacity"};
+        }
+        if (takeover) {
+            // Readers of a segment left behind by a crashed publisher see no more messages
+            ::shm_unlink(name.c_str());
+        }
+
+        const auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0 && errno == EEXIST) {
+            return std::unexpected{std::format(
+                "Shared memory '{}' is in use by another publisher or left behind by one, "
+                "take it over explicitly to replace it",
+                name)};
+        }
+        if (fd < 0) {
+            return std::unexpected{system_error(std::format("shm_open '{}'", name))};
+        }
+        struct stat status {};
+        if (::fstat(fd, &status) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return std::unexpected{system_error("fstat")};
+        }
+        device = status.st_dev;
+        inode  = status.st_ino;
+
+        const auto size = segment_size(capacity);
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return std::unexpected{system_error("ftruncate")};
+        }
+        auto* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return std::unexpected{system_error("mmap")};
+        }
+        mapping.base = base;
+        mapping.size = size;
+
+        header = ::new (base) Header{};
+        slots  = slots_of(base);
+        for (std::uint32_t i = 0; i < capacity; ++i) {
+            ::new (static_cast<void*>(slots + i)) Slot{};
+        }
+        header->version      = Header::kVersion;
+        header->capacity     = capacity;
+        header->message_size = sizeof(BallMessage);
+        header->magic.store(Header::kMagic, std::memory_order_release);
+        return {};
+    }
+
+    auto publish(const BallMessage& message) noexcept -> void {
+        auto& slot = slots[count % header->capacity];
+
+        slot.sequence.store(2 * count + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto words = Words{};
+        std::memcpy(words.data(), &message, sizeof(BallMessage));
+        for (std::size_t i = 0; i < kWords; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        slot.sequence.store(2 * count + 2, std::memory_order_release);
+        header->published.store(++count, std::memory_order_release);
+    }
+};
+
+ShmPublisher::ShmPublisher() : pimpl_{std::make_unique<Impl>()} {
+}
+
+ShmPublisher::~ShmPublisher() noexcept                         = default;
+ShmPublisher::ShmPublisher(ShmPublisher&&) noexcept            = default;
+ShmPublisher& ShmPublisher::operator=(ShmPublisher&&) noexcept = default;
+
+auto ShmPublisher::open(const std::string& name, std::uint32_t capacity, bool takeover) noexcept
+    -> std::expected<ShmPublisher, std::string> {
+    auto publisher          = ShmPublisher{};
+    publisher.pimpl_->name = name;
+    if (auto result = publisher.pimpl_->open(capacity, takeover); !result) {
+        return std::unexpected{result.error()};
+    }
+    return publisher;
+}
+
+auto ShmPublisher::publish(const BallMessage& message) noexcept -> void {
+    pimpl_->publish(message);
+}
+
+/// Subscriber
+
+struct ShmSubscriber::Impl {
+    Mapping mapping;
+    const Header* header = nullptr;
+    const Slot* slots    = nullptr;
+    std::uint64_t next   = 0;
+    std::uint64_t lost   = 0;
+
+    auto open(const std::string& name) noexcept -> std::expected<void, std::string> {
+        const auto fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0) {
+            return std::unexpected{system_error(std::format("shm_open '{}'", name))};
+        }
+        struct stat status {};
+        if (::fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header))) {
+            ::close(fd);
+            return std::unexpected{std::format("'{}' is not a ball message ring", name)};
+        }
+        const auto size = static_cast<std::size_t>(status.st_size);
+        auto* base      = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            return std::unexpected{system_error("mmap")};
+        }
+        mapping.base = base;
+        mapping.size = size;
+
+        header = static_cast<const Header*>(base);
+        if (header->magic.load(std::memory_order_acquire) != Header::kMagic
+            || header->version != Header::kVersion
+            || header->message_size != sizeof(BallMessage)
+            || segment_size(header->capacity) != size) {
+            return std::unexpected{
+                std::format("'{}' is not a ball message ring of this version", name)};
+        }
+        slots = slots_of(base);
+
+        // Start at the newest message, history from before the subscription is not replayed
+        const auto published = header->published.load(std::memory_order_acquire);
+        next                 = published == 0 ? 0 : published - 1;
+        return {};
+    }
+
+    // Copies message `index`, false when the writer reused the slot meanwhile
+    auto read(std::uint64_t index, BallMessage& message) const noexcept -> bool {
+        const auto& slot = slots[index % header->capacity];
+
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) {
+            return false;
+        }
+        auto words = Words{};
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        std::memcpy(&message, words.data(), sizeof(BallMessage));
+        return true;
+    }
+
+    auto poll(BallMessage& message) noexcept -> Status {
+        for (;;) {
+            const auto published = header->published.load(std::memory_order_acquire);
+            if (next >= published) {
+                return header->closed.load(std::memory_order_acquire) != 0 ? Status::CLOSED
+                                                                           : Status::EMPTY;
+            }
+            // Lapped, the oldest message left is `published - capacity`
+            if (published - next > header->capacity) {
+                lost += published - header->capacity - next;
+                next = published - header->capacity;
+            }
+            if (read(next, message)) {
+                ++next;
+                return Status::MESSAGE;
+            }
+            // Overwritten while copying, the next round skips past it
+        }
+    }
+
+    auto latest(BallMessage& message) noexcept -> Status {
+        for (;;) {
+            const auto published = header->published.load(std::memory_order_acquire);
+            if (next >= published) {
+                return header->closed.load(std::memory_order_acquire) != 0 ? Status::CLOSED
+                                                                           : Status::EMPTY;
+            }
+            if (read(published - 1, message)) {
+                lost += published - 1 - next;
+                next = published;
+                return Status::MESSAGE;
+            }
+        }
+    }
+};
+
+ShmSubscriber::ShmSubscriber() : pimpl_{std::make_unique<Impl>()} {
+}
+
+ShmSubscriber::~ShmSubscriber() noexcept                          = default;
+ShmSubscriber::ShmSubscriber(ShmSubscriber&&) noexcept            = default;
+ShmSubscriber& ShmSubscriber::operator=(ShmSubscriber&&) noexcept = default;
+
+auto ShmSubscriber::open(const std::string& name) noexcept
+    -> std::expected<ShmSubscriber, std::string> {
+    auto subscriber = ShmSubscriber{};
+    if (auto result = subscriber.pimpl_->open(name); !result) {
+        return std::unexpected{result.error()};
+    }
+    return subscriber;
+}
+
+auto ShmSubscriber::poll(BallMessage& message) noexcept -> Status {
+    return pimpl_->poll(message);
+}
+
+auto ShmSubscriber::latest(BallMessage& message) noexcept -> Status {
+    return pimpl_->latest(message);
+}
+
+auto ShmSubscriber::lost() const noexcept -> std::uint64_t {
+    return pimpl_->lost;
+}
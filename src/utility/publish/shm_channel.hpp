@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <string>
+
+#include "utility/pimpl.hpp"
+#include "utility/publish/ball_message.hpp"
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Publishes `BallMessage`s into a POSIX shared-memory ring for consumers on the same host.
+/// @note
+///   - A ring of seqlocked slots: a slot's sequence is odd while it is written and `2 i + 2`
+///     once it holds message `i`, then the publication counter advances. Neither side takes a
+///     lock or makes a system call per message.
+///   - Words are copied through relaxed atomics, the same protocol as `util::LatestValue`, but
+///     across processes.
+///   - Single writer. Opening fails while a segment of the same name exists, unless `takeover`
+///     asks to replace it. Closing marks the ring closed and unlinks the name if it still refers
+///     to this ring.
+class ShmPublisher {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(ShmPublisher)
+
+public:
+    /// @param name POSIX shm name, such as "/pingpong_tracker"
+    /// @param capacity Messages kept for slow readers
+    /// @param takeover Replace an existing segment, such as one left behind by a crash
+    static auto open(const std::string& name, std::uint32_t capacity,
+                     bool takeover = false) noexcept -> std::expected<ShmPublisher, std::string>;
+
+    auto publish(const BallMessage&) noexcept -> void;
+
+private:
+    ShmPublisher();
+};
+
+/// @brief
+///   Reads a ring written by `ShmPublisher`, wait-free, from any process.
+/// @note
+///   - `poll` returns every message in order. A reader lapped by the writer skips ahead to the
+///     oldest message still in the ring and counts the skipped ones in `lost`.
+///   - `latest` only looks at the newest message, for consumers that need the current state.
+class ShmSubscriber {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(ShmSubscriber)
+
+public:
+    enum class Status : std::uint8_t { MESSAGE, EMPTY, CLOSED };
+
+    static auto open(const std::string& name) noexcept
+        -> std::expected<ShmSubscriber, std::string>;
+
+    /// @brief The next unread message
+    auto poll(BallMessage&) noexcept -> Status;
+
+    /// @brief The newest message, EMPTY when it was already returned
+    auto latest(BallMessage&) noexcept -> Status;
+
+    /// @brief Messages overwritten before this reader got to them
+    [[nodiscard]] auto lost() const noexcept -> std::uint64_t;
+
+private:
+    ShmSubscriber();
+};
+
+}  // namespace pingpong_tracker::util
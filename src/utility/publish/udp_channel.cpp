@@ -0,0 +1,240 @@
+#include "udp_channel.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <format>
+
+using namespace pingpong_tracker::util;
+
+namespace {
+
+auto system_error(std::string_view what) -> std::string {
+    return std::format("{}: {}", what, std::strerror(errno));
+}
+
+auto make_address(const std::string& host, std::uint16_t port)
+    -> std::expected<sockaddr_in, std::string> {
+    auto address       = sockaddr_in{};
+    address.sin_family = AF_INET;
+    address.sin_port   = htons(port);
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        return std::unexpected{std::format("Invalid IPv4 address '{}'", host)};
+    }
+    return address;
+}
+
+auto parse_target(std::string_view target) -> std::expected<sockaddr_in, std::string> {
+    const auto colon = target.rfind(':');
+    if (colon == std::string_view::npos) {
+        return std::unexpected{std::format("Target '{}' is not host:port", target)};
+    }
+    const auto port_text = target.substr(colon + 1);
+    auto port            = std::uint16_t{0};
+    const auto [end, error] =
+        std::from_chars(port_text.data(), port_text.data() + port_text.size(), port);
+    if (error != std::errc{} || end != port_text.data() + port_text.size() || port == 0) {
+        return std::unexpected{std::format("Target '{}' has an invalid port", target)};
+    }
+    return make_address(std::string{target.substr(0, colon)}, port);
+}
+
+struct Socket {
+    int fd = -1;
+
+    Socket() = default;
+    Socket(const Socket&)            = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    ~Socket() noexcept {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    auto open() noexcept -> std::expected<void, std::string> {
+        fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return std::unexpected{system_error("socket")};
+        }
+        return {};
+    }
+};
+
+}  // namespace
+
+/// Publisher
+
+struct UdpPublisher::Impl {
+    Socket socket;
+    std::vector<sockaddr_in> targets;
+    std::uint64_t dropped = 0;
+
+    // Reused between calls, one entry per datagram
+    std::vector<iovec> vectors;
+    std::vector<mmsghdr> headers;
+
+    auto publish(std::span<const BallMessage> messages) noexcept -> std::size_t {
+        const auto count = messages.size() * targets.size();
+        vectors.resize(count);
+        headers.resize(count);
+
+        auto k = std::size_t{0};
+        for (const auto& message : messages) {
+            for (auto& target : targets) {
+                vectors[k] = iovec{
+                    .iov_base = const_cast<BallMessage*>(&message),
+                    .iov_len  = sizeof(BallMessage),
+                };
+                headers[k]         = mmsghdr{};
+                auto& header       = headers[k].msg_hdr;
+                header.msg_name    = &target;
+                header.msg_namelen = sizeof(target);
+                header.msg_iov     = &vectors[k];
+                header.msg_iovlen  = 1;
+                ++k;
+            }
+        }
+
+        auto sent = std::size_t{0};
+        auto lost = std::size_t{0};
+        while (sent < count) {
+            const auto result = ::sendmmsg(socket.fd, headers.data() + sent,
+                                           static_cast<unsigned int>(count - sent), MSG_DONTWAIT);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // EAGAIN or an unreachable target, drop this datagram and carry on with the rest
+                ++lost;
+                ++sent;
+                continue;
+            }
+            sent += static_cast<std::size_t>(result);
+        }
+        dropped += lost;
+        return count - lost;
+    }
+};
+
+UdpPublisher::UdpPublisher() : pimpl_{std::make_unique<Impl>()} {
+}
+
+UdpPublisher::~UdpPublisher() noexcept                         = default;
+UdpPublisher::UdpPublisher(UdpPublisher&&) noexcept            = default;
+UdpPublisher& UdpPublisher::operator=(UdpPublisher&&) noexcept = default;
+
+auto UdpPublisher::open(const std::vector<std::string>& targets) noexcept
+    -> std::expected<UdpPublisher, std::string> {
+    if (targets.empty()) {
+        return std::unexpected{"UDP publisher needs at least one target"};
+    }
+    auto publisher = UdpPublisher{};
+    for (const auto& target : targets) {
+        auto address = parse_target(target);
+        if (!address) {
+            return std::unexpected{address.error()};
+        }
+        publisher.pimpl_->targets.push_back(*address);
+    }
+    if (auto result = publisher.pimpl_->socket.open(); !result) {
+        return std::unexpected{result.error()};
+    }
+    return publisher;
+}
+
+auto UdpPublisher::publish(std::span<const BallMessage> messages) noexcept -> std::size_t {
+    return pimpl_->publish(messages);
+}
+
+auto UdpPublisher::dropped() const noexcept -> std::uint64_t {
+    return pimpl_->dropped;
+}
+
+/// Subscriber
+
+struct UdpSubscriber::Impl {
+    Socket socket;
+
+    std::vector<iovec> vectors;
+    std::vector<mmsghdr> headers;
+
+    auto receive(std::span<BallMessage> messages, std::chrono::milliseconds timeout) noexcept
+        -> std::size_t {
+        if (messages.empty()) {
+            return 0;
+        }
+        auto poll_fd = pollfd{.fd = socket.fd, .events = POLLIN, .revents = 0};
+        if (::poll(&poll_fd, 1, static_cast<int>(timeout.count())) <= 0) {
+            return 0;
+        }
+
+        vectors.resize(messages.size());
+        headers.resize(messages.size());
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            vectors[i] = iovec{.iov_base = &messages[i], .iov_len = sizeof(BallMessage)};
+            headers[i] = mmsghdr{};
+            headers[i].msg_hdr.msg_iov    = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const auto result = ::recvmmsg(socket.fd, headers.data(),
+                                       static_cast<unsigned int>(messages.size()), MSG_DONTWAIT,
+                                       nullptr);
+        if (result <= 0) {
+            return 0;
+        }
+
+        // Compact the well-formed messages to the front
+        auto kept = std::size_t{0};
+        for (std::size_t i = 0; i < static_cast<std::size_t>(result); ++i) {
+            if (headers[i].msg_len != sizeof(BallMessage) || !messages[i].valid()) {
+                continue;
+            }
+            if (kept != i) {
+                messages[kept] = messages[i];
+            }
+            ++kept;
+        }
+        return kept;
+    }
+};
+
+UdpSubscriber::UdpSubscriber() : pimpl_{std::make_unique<Impl>()} {
+}
+
+UdpSubscriber::~UdpSubscriber() noexcept                          = default;
+UdpSubscriber::UdpSubscriber(UdpSubscriber&&) noexcept            = default;
+UdpSubscriber& UdpSubscriber::operator=(UdpSubscriber&&) noexcept = default;
+
+auto UdpSubscriber::open(const std::string& host, std::uint16_t port) noexcept
+    -> std::expected<UdpSubscriber, std::string> {
+    auto address = make_address(host, port);
+    if (!address) {
+        return std::unexpected{address.error()};
+    }
+
+    auto subscriber = UdpSubscriber{};
+    auto& socket    = subscriber.pimpl_->socket;
+    if (auto result = socket.open(); !result) {
+        return std::unexpected{result.error()};
+    }
+    // Room for bursts while the consumer is busy
+    const auto buffer = 1 << 20;
+    ::setsockopt(socket.fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    if (::bind(socket.fd, reinterpret_cast<const sockaddr*>(&*address), sizeof(*address)) != 0) {
+        return std::unexpected{system_error(std::format("bind {}:{}", host, port))};
+    }
+    return subscriber;
+}
+
+auto UdpSubscriber::receive(std::span<BallMessage> messages,
+                            std::chrono::milliseconds timeout) noexcept -> std::size_t {
+    return pimpl_->receive(messages, timeout);
+}
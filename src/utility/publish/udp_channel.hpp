@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "utility/pimpl.hpp"
+#include "utility/publish/ball_message.hpp"
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Sends `BallMessage`s as UDP datagrams, one message per datagram.
+/// @note
+///   - Every message goes to every target in a single `sendmmsg` call, a batch of messages
+///     included.
+///   - The socket never blocks: datagrams the kernel cannot take right away are dropped and
+///     counted, a stale result is worth less than the next one.
+class UdpPublisher {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(UdpPublisher)
+
+public:
+    /// @param targets "host:port" IPv4 destinations
+    static auto open(const std::vector<std::string>& targets) noexcept
+        -> std::expected<UdpPublisher, std::string>;
+
+    /// @return Datagrams sent, messages times targets when nothing was dropped
+    auto publish(std::span<const BallMessage>) noexcept -> std::size_t;
+
+    /// @brief Datagrams dropped so far
+    [[nodiscard]] auto dropped() const noexcept -> std::uint64_t;
+
+private:
+    UdpPublisher();
+};
+
+/// @brief Receives `BallMessage` datagrams, batched through `recvmmsg`
+class UdpSubscriber {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(UdpSubscriber)
+
+public:
+    static auto open(const std::string& host, std::uint16_t port) noexcept
+        -> std::expected<UdpSubscriber, std::string>;
+
+    /// @brief Waits up to `timeout` for datagrams, malformed ones are skipped
+    /// @return Messages written to the front of `messages`
+    auto receive(std::span<BallMessage> messages, std::chrono::milliseconds timeout) noexcept
+        -> std::size_t;
+
+private:
+    UdpSubscriber();
+};
+
+}  // namespace pingpong_tracker::util
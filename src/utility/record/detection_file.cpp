@@ -0,0 +1,474 @@
+#include "detection_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <format>
+
+#include "utility/posix.hpp"
+
+using namespace pingpong_tracker::util;
+
+namespace {
+
+using Format = DetectionFileFormat;
+
+constexpr auto align8(std::size_t size) noexcept -> std::size_t {
+    return (size + 7) & ~std::size_t{7};
+}
+
+auto fnv1a(std::span<const std::byte> data) noexcept -> std::uint64_t {
+    auto hash = std::uint64_t{0xcbf29ce484222325};
+    for (const auto byte : data) {
+        hash ^= static_cast<std::uint64_t>(byte);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+auto system_error(std::string_view what) -> std::string {
+    return std::format("{}: {}", what, std::strerror(errno));
+}
+
+// Walks the columns of a payload in their fixed order
+struct ColumnCursor {
+    std::span<const std::byte> payload;
+    std::size_t offset = 0;
+
+    template <typename T>
+    auto take(std::size_t count) noexcept -> std::span<const T> {
+        const auto* data = reinterpret_cast<const T*>(payload.data() + offset);
+        offset += align8(count * sizeof(T));
+        return {data, count};
+    }
+};
+
+auto payload_size(const Format::BlockHeader& header) noexcept -> std::size_t {
+    const auto frames = std::size_t{header.frames};
+    const auto balls  = std::size_t{header.balls};
+    const auto tracks = std::size_t{header.tracks};
+    return align8(frames * 8) * 2 + align8((frames + 1) * 4) * 2 + align8(balls * 4) * 4
+         + align8(tracks * 4) * 6 + align8(tracks);
+}
+
+auto make_block(const Format::BlockHeader& header, std::span<const std::byte> payload) noexcept
+    -> DetectionBlock {
+    auto cursor = ColumnCursor{payload};
+    auto block  = DetectionBlock{};
+
+    block.frame_index     = cursor.take<std::uint64_t>(header.frames);
+    block.timestamp       = cursor.take<std::int64_t>(header.frames);
+    block.ball_offset     = cursor.take<std::uint32_t>(header.frames + 1);
+    block.track_offset    = cursor.take<std::uint32_t>(header.frames + 1);
+    block.ball_x          = cursor.take<float>(header.balls);
+    block.ball_y          = cursor.take<float>(header.balls);
+    block.ball_radius     = cursor.take<float>(header.balls);
+    block.ball_confidence = cursor.take<float>(header.balls);
+    block.track_id        = cursor.take<std::uint32_t>(header.tracks);
+    block.track_x         = cursor.take<float>(header.tracks);
+    block.track_y         = cursor.take<float>(header.tracks);
+    block.track_vx        = cursor.take<float>(header.tracks);
+    block.track_vy        = cursor.take<float>(header.tracks);
+    block.track_radius    = cursor.take<float>(header.tracks);
+    block.track_coasting  = cursor.take<std::uint8_t>(header.tracks);
+    return block;
+}
+
+struct Parsed {
+    std::string_view source;
+    double frame_rate = 0.0;
+    std::vector<DetectionBlock> blocks;
+    // End of the last intact block
+    std::size_t valid_size = 0;
+};
+
+// Stops at the first block that is cut short or fails its checksum
+auto parse(std::span<const std::byte> file) noexcept -> std::expected<Parsed, std::string> {
+    auto header = Format::Header{};
+    if (file.size() < sizeof(header)) {
+        return std::unexpected{"Detection file is too short for its header"};
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != Format::kMagic) {
+        return std::unexpected{"Not a detection file"};
+    }
+    if (header.version != Format::kVersion) {
+        return std::unexpected{std::format("Unsupported detection file version {}", header.version)};
+    }
+
+    auto offset = sizeof(header) + align8(header.source_length);
+    if (file.size() < offset) {
+        return std::unexpected{"Detection file is too short for its source name"};
+    }
+
+    auto parsed       = Parsed{};
+    parsed.source     = {reinterpret_cast<const char*>(file.data() + sizeof(header)),
+                         header.source_length};
+    parsed.frame_rate = header.frame_rate;
+
+    for (;;) {
+        parsed.valid_size = offset;
+
+        auto block = Format::BlockHeader{};
+        if (file.size() - offset < sizeof(block)) {
+            break;
+        }
+        std::memcpy(&block, file.data() + offset, sizeof(block));
+        if (block.magic != Format::kBlockMagic || block.payload_size != payload_size(block)
+            || file.size() - offset - sizeof(block) < block.payload_size) {
+            break;
+        }
+        const auto payload = file.subspan(offset + sizeof(block), block.payload_size);
+        if (fnv1a(payload) != block.checksum) {
+            break;
+        }
+        parsed.blocks.push_back(make_block(block, payload));
+        offset += sizeof(block) + block.payload_size;
+    }
+    return parsed;
+}
+
+// Read-only view of the whole file, an empty file maps to nothing
+auto map_file(int fd, Mapping& mapping) noexcept -> std::expected<void, std::string> {
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        return std::unexpected{system_error("fstat")};
+    }
+    const auto size = static_cast<std::size_t>(status.st_size);
+    if (size == 0) {
+        return {};
+    }
+    auto* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return std::unexpected{system_error("mmap")};
+    }
+    ::madvise(base, size, MADV_SEQUENTIAL);
+    mapping.base = base;
+    mapping.size = size;
+    return {};
+}
+
+auto write_all(int fd, std::span<const std::byte> data) noexcept -> bool {
+    while (!data.empty()) {
+        const auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data = data.subspan(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+}  // namespace
+
+/// Writer
+
+struct DetectionFileWriter::Impl {
+    Config config;
+    FileDescriptor file;
+    std::uint64_t next_frame = 0;
+
+    // Pending block, column by column
+    std::vector<std::uint64_t> frame_index;
+    std::vector<std::int64_t> timestamp;
+    std::vector<std::uint32_t> ball_offset{0};
+    std::vector<std::uint32_t> track_offset{0};
+    std::vector<float> ball_x, ball_y, ball_radius, ball_confidence;
+    std::vector<std::uint32_t> track_id;
+    std::vector<float> track_x, track_y, track_vx, track_vy, track_radius;
+    std::vector<std::uint8_t> track_coasting;
+
+    std::vector<std::byte> payload;
+
+    auto open() noexcept -> std::expected<void, std::string> {
+        file.fd = ::open(config.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (file.fd < 0) {
+            return std::unexpected{system_error(std::format("open '{}'", config.path))};
+        }
+
+        auto existing = Mapping{};
+        if (auto result = map_file(file.fd, existing); !result) {
+            return std::unexpected{result.error()};
+        }
+        if (existing.bytes().empty()) {
+            return write_header();
+        }
+
+        auto parsed = parse(existing.bytes());
+        if (!parsed) {
+            return std::unexpected{std::format("'{}': {}", config.path, parsed.error())};
+        }
+        if (parsed->source != config.source) {
+            return std::unexpected{std::format("'{}' was written for '{}', not '{}'", config.path,
+                                               parsed->source, config.source)};
+        }
+        if (!parsed->blocks.empty()) {
+            next_frame = parsed->blocks.back().frame_index.back() + 1;
+        }
+
+        // Cut off a block torn by an interrupted run, then append after the intact ones
+        if (parsed->valid_size != existing.bytes().size()
+            && ::ftruncate(file.fd, static_cast<off_t>(parsed->valid_size)) != 0) {
+            return std::unexpected{system_error("ftruncate")};
+        }
+        if (::lseek(file.fd, static_cast<off_t>(parsed->valid_size), SEEK_SET) < 0) {
+            return std::unexpected{system_error("lseek")};
+        }
+        return {};
+    }
+
+    auto write_header() noexcept -> std::expected<void, std::string> {
+        const auto header = Format::Header{
+            .magic         = Format::kMagic,
+            .version       = Format::kVersion,
+            .source_length = static_cast<std::uint32_t>(config.source.size()),
+            .frame_rate    = config.frame_rate,
+        };
+        auto bytes = std::vector<std::byte>(sizeof(header) + align8(config.source.size()));
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        std::memcpy(bytes.data() + sizeof(header), config.source.data(), config.source.size());
+
+        if (!write_all(file.fd, bytes)) {
+            return std::unexpected{system_error("write header")};
+        }
+        return {};
+    }
+
+    auto append(std::uint64_t index, std::int64_t time, std::span<const Ball2D> balls,
+                std::span<const BallTrack2D> tracks) noexcept -> std::expected<void, std::string> {
+        if (index < next_frame) {
+            return std::unexpected{
+                std::format("Frame {} is behind the file, next is {}", index, next_frame)};
+        }
+
+        frame_index.push_back(index);
+        timestamp.push_back(time);
+        for (const auto& ball : balls) {
+            ball_x.push_back(ball.center.x);
+            ball_y.push_back(ball.center.y);
+            ball_radius.push_back(ball.radius);
+            ball_confidence.push_back(ball.confidence);
+        }
+        for (const auto& track : tracks) {
+            track_id.push_back(track.id);
+            track_x.push_back(track.center.x);
+            track_y.push_back(track.center.y);
+            track_vx.push_back(track.velocity.x);
+            track_vy.push_back(track.velocity.y);
+            track_radius.push_back(track.radius);
+            track_coasting.push_back(track.coasting ? 1 : 0);
+        }
+        ball_offset.push_back(static_cast<std::uint32_t>(ball_x.size()));
+        track_offset.push_back(static_cast<std::uint32_t>(track_id.size()));
+        next_frame = index + 1;
+
+        if (frame_index.size() >= std::max<std::size_t>(config.block_frames, 1)) {
+            return flush();
+        }
+        return {};
+    }
+
+    template <typename T>
+    auto put(const std::vector<T>& column) -> void {
+        const auto bytes = std::as_bytes(std::span{column});
+        payload.insert(payload.end(), bytes.begin(), bytes.end());
+        payload.resize(align8(payload.size()));
+    }
+
+    auto flush() noexcept -> std::expected<void, std::string> {
+        if (frame_index.empty()) {
+            return {};
+        }
+
+        auto header = Format::BlockHeader{
+            .magic        = Format::kBlockMagic,
+            .frames       = static_cast<std::uint32_t>(frame_index.size()),
+            .balls        = static_cast<std::uint32_t>(ball_x.size()),
+            .tracks       = static_cast<std::uint32_t>(track_id.size()),
+            .payload_size = 0,
+            .checksum     = 0,
+        };
+
+        payload.assign(sizeof(header), std::byte{0});
+        put(frame_index);
+        put(timestamp);
+        put(ball_offset);
+        put(track_offset);
+        put(ball_x);
+        put(ball_y);
+        put(ball_radius);
+        put(ball_confidence);
+        put(track_id);
+        put(track_x);
+        put(track_y);
+        put(track_vx);
+        put(track_vy);
+        put(track_radius);
+        put(track_coasting);
+
+        const auto body     = std::span{payload}.subspan(sizeof(header));
+        header.payload_size = body.size();
+        header.checksum     = fnv1a(body);
+        std::memcpy(payload.data(), &header, sizeof(header));
+
+        if (!write_all(file.fd, payload)) {
+            return std::unexpected{system_error("write block")};
+        }
+        if (config.sync && ::fdatasync(file.fd) != 0) {
+            return std::unexpected{system_error("fdatasync")};
+        }
+
+        frame_index.clear();
+        timestamp.clear();
+        ball_offset.assign(1, 0);
+        track_offset.assign(1, 0);
+        for (auto* column : {&ball_x, &ball_y, &ball_radius, &ball_confidence, &track_x, &track_y,
+                             &track_vx, &track_vy, &track_radius}) {
+            column->clear();
+        }
+        track_id.clear();
+        track_coasting.clear();
+        return {};
+    }
+};
+
+DetectionFileWriter::DetectionFileWriter() : pimpl_{std::make_unique<Impl>()} {
+}
+
+DetectionFileWriter::~DetectionFileWriter() noexcept {
+    // A failure has nowhere to go here, the lost frames are analyzed again on resume
+    if (pimpl_) {
+        static_cast<void>(pimpl_->flush());
+    }
+}
+
+DetectionFileWriter::DetectionFileWriter(DetectionFileWriter&&) noexcept            = default;
+DetectionFileWriter& DetectionFileWriter::operator=(DetectionFileWriter&&) noexcept = default;
+
+auto DetectionFileWriter::open(Config config) noexcept
+    -> std::expected<DetectionFileWriter, std::string> {
+    auto writer           = DetectionFileWriter{};
+    writer.pimpl_->config = std::move(config);
+    if (auto result = writer.pimpl_->open(); !result) {
+        return std::unexpected{result.error()};
+    }
+    return writer;
+}
+
+auto DetectionFileWriter::next_frame() const noexcept -> std::uint64_t {
+    return pimpl_->next_frame;
+}
+
+auto DetectionFileWriter::append(std::uint64_t frame_index, std::int64_t timestamp,
+                                 std::span<const Ball2D> balls,
+                                 std::span<const BallTrack2D> tracks) noexcept
+    -> std::expected<void, std::string> {
+    return pimpl_->append(frame_index, timestamp, balls, tracks);
+}
+
+auto DetectionFileWriter::flush() noexcept -> std::expected<void, std::string> {
+    return pimpl_->flush();
+}
+
+/// Reader
+
+struct DetectionFile::Impl {
+    Mapping mapping;
+    Parsed parsed;
+    // Frames before each block
+    std::vector<std::size_t> first_frame;
+    std::size_t frames = 0;
+};
+
+DetectionFile::DetectionFile() : pimpl_{std::make_unique<Impl>()} {
+}
+
+DetectionFile::~DetectionFile() noexcept                            = default;
+DetectionFile::DetectionFile(DetectionFile&&) noexcept            = default;
+DetectionFile& DetectionFile::operator=(DetectionFile&&) noexcept = default;
+
+auto DetectionFile::open(const std::string& path) noexcept
+    -> std::expected<DetectionFile, std::string> {
+    auto descriptor = FileDescriptor{};
+    descriptor.fd   = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor.fd < 0) {
+        return std::unexpected{system_error(std::format("open '{}'", path))};
+    }
+
+    auto file   = DetectionFile{};
+    auto& impl  = *file.pimpl_;
+    if (auto result = map_file(descriptor.fd, impl.mapping); !result) {
+        return std::unexpected{result.error()};
+    }
+    auto parsed = parse(impl.mapping.bytes());
+    if (!parsed) {
+        return std::unexpected{std::format("'{}': {}", path, parsed.error())};
+    }
+    impl.parsed = std::move(*parsed);
+
+    for (const auto& block : impl.parsed.blocks) {
+        impl.first_frame.push_back(impl.frames);
+        impl.frames += block.frame_index.size();
+    }
+    return file;
+}
+
+auto DetectionFile::source() const noexcept -> std::string_view {
+    return pimpl_->parsed.source;
+}
+
+auto DetectionFile::frame_rate() const noexcept -> double {
+    return pimpl_->parsed.frame_rate;
+}
+
+auto DetectionFile::blocks() const noexcept -> std::span<const DetectionBlock> {
+    return pimpl_->parsed.blocks;
+}
+
+auto DetectionFile::size() const noexcept -> std::size_t {
+    return pimpl_->frames;
+}
+
+auto DetectionFile::frame(std::size_t position) const noexcept -> DetectionFrame {
+    const auto& first = pimpl_->first_frame;
+    const auto which  = static_cast<std::size_t>(std::ranges::upper_bound(first, position)
+                                                 - first.begin())
+                     - 1;
+    const auto& block = pimpl_->parsed.blocks[which];
+    const auto row    = position - first[which];
+
+    auto frame      = DetectionFrame{};
+    frame.index     = block.frame_index[row];
+    frame.timestamp = block.timestamp[row];
+
+    for (auto i = block.ball_offset[row]; i < block.ball_offset[row + 1]; ++i) {
+        frame.balls.push_back(Ball2D{
+            .center     = {block.ball_x[i], block.ball_y[i]},
+            .radius     = block.ball_radius[i],
+            .confidence = block.ball_confidence[i],
+        });
+    }
+
+    const auto time = Clock::time_point{std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds{frame.timestamp})};
+    for (auto i = block.track_offset[row]; i < block.track_offset[row + 1]; ++i) {
+        frame.tracks.push_back(BallTrack2D{
+            .id        = block.track_id[i],
+            .center    = {block.track_x[i], block.track_y[i]},
+            .velocity  = {block.track_vx[i], block.track_vy[i]},
+            .radius    = block.track_radius[i],
+            .coasting  = block.track_coasting[i] != 0,
+            .timestamp = time,
+        });
+    }
+    return frame;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utility/ball/ball.hpp"
+#include "utility/ball/track.hpp"
+#include "utility/pimpl.hpp"
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Columnar per-frame detections and tracked states, as written by the offline analyzer.
+/// @note
+///   - A header names the source, then blocks of frames follow. A block stores every field as
+///     its own contiguous column, 8-byte aligned, so the file is read in place through mmap.
+///   - Balls and tracks of frame `i` of a block are the rows [offset[i], offset[i + 1]) of their
+///     columns.
+///   - Every block carries a checksum, a block torn by a crash is detected and discarded.
+///   - Timestamps are nanoseconds from the start of the source, not clock readings.
+struct DetectionFileFormat {
+    static constexpr std::uint64_t kMagic      = 0x3154'4544'5450'5050;  // "PPPTDET1"
+    static constexpr std::uint32_t kBlockMagic = 0x4B43'4C42;            // "BLCK"
+    static constexpr std::uint32_t kVersion    = 1;
+
+    struct Header {
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t source_length;
+        double frame_rate;
+        // Followed by the source name, padded to 8 bytes
+    };
+
+    struct BlockHeader {
+        std::uint32_t magic;
+        std::uint32_t frames;
+        std::uint32_t balls;
+        std::uint32_t tracks;
+        std::uint64_t payload_size;
+        // FNV-1a over the payload
+        std::uint64_t checksum;
+    };
+};
+
+/// @brief One block of frames, every span points into the mapped file
+struct DetectionBlock {
+    std::span<const std::uint64_t> frame_index;
+    std::span<const std::int64_t> timestamp;
+    // frames + 1 entries each
+    std::span<const std::uint32_t> ball_offset;
+    std::span<const std::uint32_t> track_offset;
+
+    std::span<const float> ball_x;
+    std::span<const float> ball_y;
+    std::span<const float> ball_radius;
+    std::span<const float> ball_confidence;
+
+    std::span<const std::uint32_t> track_id;
+    std::span<const float> track_x;
+    std::span<const float> track_y;
+    std::span<const float> track_vx;
+    std::span<const float> track_vy;
+    std::span<const float> track_radius;
+    std::span<const std::uint8_t> track_coasting;
+};
+
+/// @brief One frame gathered from the columns
+struct DetectionFrame {
+    std::uint64_t index{0};
+    // ns from the start of the source
+    std::int64_t timestamp{0};
+    std::vector<Ball2D> balls;
+    std::vector<BallTrack2D> tracks;
+};
+
+/// @brief
+///   Appends frames block by block.
+/// @note
+///   - Opening an existing file resumes it: torn blocks at the end are cut off and `next_frame`
+///     tells where the previous run stopped. The source must match.
+///   - Frames are buffered and written once `block_frames` are pending, or on `flush`, which the
+///     destructor also calls.
+class DetectionFileWriter {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(DetectionFileWriter)
+
+public:
+    struct Config {
+        std::string path;
+        // Name of the video or recording, checked on resume
+        std::string source;
+        double frame_rate = 0.0;
+        std::size_t block_frames = 256;
+        // fdatasync every block, a crash then loses at most the pending frames
+        bool sync = false;
+    };
+
+    static auto open(Config config) noexcept -> std::expected<DetectionFileWriter, std::string>;
+
+    /// @brief First frame index not in the file yet, 0 for a new file
+    [[nodiscard]] auto next_frame() const noexcept -> std::uint64_t;
+
+    auto append(std::uint64_t frame_index, std::int64_t timestamp, std::span<const Ball2D> balls,
+                std::span<const BallTrack2D> tracks) noexcept -> std::expected<void, std::string>;
+
+    auto flush() noexcept -> std::expected<void, std::string>;
+
+private:
+    DetectionFileWriter();
+};
+
+/// @brief
+///   Read-only view of a detection file through mmap.
+/// @note Blocks are indexed on open, frames are then addressed by their position in the file
+class DetectionFile {
+    PINGPONG_TRACKER_PIMPL_DEFINITION(DetectionFile)
+
+public:
+    static auto open(const std::string& path) noexcept -> std::expected<DetectionFile, std::string>;
+
+    [[nodiscard]] auto source() const noexcept -> std::string_view;
+    [[nodiscard]] auto frame_rate() const noexcept -> double;
+
+    [[nodiscard]] auto blocks() const noexcept -> std::span<const DetectionBlock>;
+
+    /// @brief Frames over all blocks
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /// @brief The `position`-th frame in the file, gathered from the columns
+    [[nodiscard]] auto frame(std::size_t position) const noexcept -> DetectionFrame;
+
+private:
+    DetectionFile();
+};
+
+}  // namespace pingpong_tracker::util
@@ -0,0 +1,244 @@
+#include "execution.hpp"
+
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace pingpong_tracker::util {
+
+namespace {
+
+// Blocks below the mmap threshold stay in the heap once freed, so the prefaulted pages are reused
+constexpr std::size_t kPrefaultBlock = std::size_t{1} << 20;
+// Frame sized buffers come from the locked heap instead of fresh mappings faulting on each use
+constexpr int kMmapThreshold = 16 << 20;
+
+auto describe(const ThreadPolicy& policy) -> std::string {
+    auto cores = std::string{};
+    for (const auto core : policy.cores) {
+        cores += std::format("{}{}", cores.empty() ? "" : ",", core);
+    }
+    if (cores.empty()) {
+        cores = "any";
+    }
+    if (policy.policy == "fifo") {
+        return std::format("cores {}, SCHED_FIFO priority {}", cores, policy.priority);
+    }
+    return std::format("cores {}, SCHED_OTHER nice {}", cores, policy.nice);
+}
+
+auto validate(const ThreadPolicy& policy, long cpus) -> std::expected<void, std::string> {
+    for (const auto core : policy.cores) {
+        if (core < 0 || core >= cpus) {
+            return std::unexpected{std::format("Core {} out of range, {} cpus", core, cpus)};
+        }
+    }
+    if (policy.policy == "fifo") {
+        const auto min = ::sched_get_priority_min(SCHED_FIFO);
+        const auto max = ::sched_get_priority_max(SCHED_FIFO);
+        if (policy.priority < min || policy.priority > max) {
+            return std::unexpected{
+                std::format("Priority {} out of [{}, {}]", policy.priority, min, max)};
+        }
+        return {};
+    }
+    if (policy.policy == "other") {
+        if (policy.nice < -20 || policy.nice > 19) {
+            return std::unexpected{std::format("Nice {} out of [-20, 19]", policy.nice)};
+        }
+        return {};
+    }
+    return std::unexpected{std::format("Unknown policy '{}', use other or fifo", policy.policy)};
+}
+
+/// @return The failures, empty when everything was applied
+auto apply_policy(const ThreadPolicy& policy) noexcept -> std::string {
+    auto errors = std::string{};
+    const auto fail = [&](std::string_view what, int error) {
+        errors += std::format("{}{}: {}", errors.empty() ? "" : "; ", what, std::strerror(error));
+    };
+
+    if (!policy.cores.empty()) {
+        auto set = cpu_set_t{};
+        CPU_ZERO(&set);
+        for (const auto core : policy.cores) {
+            CPU_SET(core, &set);
+        }
+        if (const auto error = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set)) {
+            fail("affinity", error);
+        }
+    }
+
+    if (policy.policy == "fifo") {
+        const auto param = sched_param{.sched_priority = policy.priority};
+        if (const auto error = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param)) {
+            fail("SCHED_FIFO, needs CAP_SYS_NICE or an rtprio limit", error);
+        }
+        return errors;
+    }
+
+    // Leaves a real-time policy inherited from the parent thread
+    const auto param = sched_param{.sched_priority = 0};
+    if (const auto error = ::pthread_setschedparam(::pthread_self(), SCHED_OTHER, &param)) {
+        fail("SCHED_OTHER", error);
+    }
+    // The nice value is per thread on Linux
+    if (::setpriority(PRIO_PROCESS, static_cast<id_t>(::gettid()), policy.nice) != 0) {
+        fail("nice, lowering needs CAP_SYS_NICE or a nice limit", errno);
+    }
+    return errors;
+}
+
+[[gnu::noinline]] auto prefault_stack() noexcept -> void {
+    constexpr std::size_t kStack = 512 * 1024;
+    std::byte stack[kStack];
+    std::memset(stack, 0, kStack);
+    // Keeps the writes to a buffer nobody reads
+    asm volatile("" : : "r"(stack) : "memory");
+}
+
+auto lock_memory(std::size_t prefault) -> std::expected<void, std::string> {
+    ::mallopt(M_TRIM_THRESHOLD, -1);
+    ::mallopt(M_MMAP_THRESHOLD, kMmapThreshold);
+
+    if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        return std::unexpected{std::format(
+            "Failed to lock memory: {}, needs CAP_IPC_LOCK or a memlock limit covering the process",
+            std::strerror(errno))};
+    }
+
+    prefault_stack();
+    auto blocks = std::vector<void*>{};
+    for (std::size_t done = 0; done < prefault; done += kPrefaultBlock) {
+        auto* block = std::malloc(kPrefaultBlock);
+        if (block == nullptr) {
+            break;
+        }
+        std::memset(block, 0, kPrefaultBlock);
+        blocks.push_back(block);
+    }
+    for (auto* block : blocks) {
+        std::free(block);
+    }
+
+    spdlog::info("[Execution] Memory locked, {} MiB of heap prefaulted",
+                 blocks.size() * kPrefaultBlock >> 20);
+    return {};
+}
+
+}  // namespace
+
+auto ExecutionProfile::configure(const YAML::Node& yaml) -> std::expected<void, std::string> try {
+    auto lock = std::scoped_lock{mutex_};
+    enable_   = false;
+    roles_.clear();
+
+    if (!yaml["enable"].as<bool>()) {
+        spdlog::info("[Execution] Profile disabled, threads are left to the system scheduler");
+        return {};
+    }
+
+    const auto& threads = yaml["threads"];
+    if (!threads || !threads.IsMap()) {
+        return std::unexpected{"Execution profile needs a 'threads' map"};
+    }
+
+    const auto cpus = ::sysconf(_SC_NPROCESSORS_CONF);
+    for (const auto& entry : threads) {
+        const auto role = entry.first.as<std::string>();
+
+        auto policy = ThreadPolicy{};
+        if (auto result = policy.serialize(entry.second); !result.has_value()) {
+            return std::unexpected{std::format("Thread role '{}': {}", role, result.error())};
+        }
+        if (auto result = validate(policy, cpus); !result) {
+            return std::unexpected{std::format("Thread role '{}': {}", role, result.error())};
+        }
+
+        spdlog::info("[Execution] {}: {}", role, describe(policy));
+        roles_.emplace(role, Role{.policy = std::move(policy)});
+    }
+
+    if (yaml["lock_memory"].as<bool>()) {
+        const auto prefault = yaml["prefault"].as<std::size_t>() << 20;
+        if (auto result = lock_memory(prefault); !result) {
+            return result;
+        }
+    }
+
+    enable_ = true;
+    return {};
+
+} catch (const std::exception& e) {
+    return std::unexpected{e.what()};
+}
+
+auto ExecutionProfile::enabled() const -> bool {
+    auto lock = std::scoped_lock{mutex_};
+    return enable_;
+}
+
+auto ExecutionProfile::apply(std::string_view role) noexcept -> void {
+    auto lock = std::unique_lock{mutex_};
+    if (!enable_) {
+        return;
+    }
+    const auto found = roles_.find(role);
+    if (found == roles_.end()) {
+        return;
+    }
+    const auto policy = found->second.policy;
+    lock.unlock();
+
+    const auto name = std::string{role.substr(0, 15)};
+    ::pthread_setname_np(::pthread_self(), name.c_str());
+
+    const auto errors = apply_policy(policy);
+    const auto tid    = ::gettid();
+
+    lock.lock();
+    if (errors.empty()) {
+        const auto applied = ++found->second.applied;
+        spdlog::info("[Execution] {} thread {} ({}): {}", role, applied, tid, describe(policy));
+    } else {
+        spdlog::warn("[Execution] {} thread {}: {}", role, tid, errors);
+    }
+}
+
+auto ExecutionProfile::run_as(std::string_view role, const std::function<void()>& function)
+    -> void {
+    auto error = std::exception_ptr{};
+    {
+        auto thread = std::jthread{[&] {
+            apply(role);
+            try {
+                function();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }};
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+auto execution() -> ExecutionProfile& {
+    static auto instance = ExecutionProfile{};
+    return instance;
+}
+
+}  // namespace pingpong_tracker::util
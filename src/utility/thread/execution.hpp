@@ -0,0 +1,78 @@
+#pragma once
+#include <yaml-cpp/yaml.h>
+
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utility/serializable.hpp"
+
+namespace pingpong_tracker::util {
+
+/// @brief Scheduling of the threads playing one role
+struct ThreadPolicy : SerializableMixin {
+    // CPUs the threads may run on, empty to leave the affinity alone
+    std::vector<int> cores{};
+    // "other" for the time-sharing scheduler, "fifo" for real-time SCHED_FIFO
+    std::string policy{"other"};
+    // SCHED_FIFO priority, 1 to 99, unused under "other"
+    int priority = 0;
+    // Nice value, -20 to 19, unused under "fifo"
+    int nice = 0;
+
+    constexpr static std::tuple kMetas{
+        // clang-format off
+        "cores",                    &ThreadPolicy::cores,
+        "policy",                   &ThreadPolicy::policy,
+        "priority",                 &ThreadPolicy::priority,
+        "nice",                     &ThreadPolicy::nice,
+        // clang-format on
+    };
+};
+
+/// @brief
+///   Real-time execution profile: which CPUs and scheduler every thread role gets, and whether
+///   the process memory is locked.
+/// @note
+///   - Threads apply their role themselves when they start, `configure` only validates and
+///     locks memory. A thread without a policy of its own keeps the one it inherited from the
+///     thread that started it.
+///   - Cores are checked against the CPUs the system has, not the current affinity, so cores
+///     isolated from the scheduler can be named.
+///   - A policy the process lacks the privilege for is reported and skipped, the thread keeps
+///     running as it was.
+class ExecutionProfile {
+public:
+    auto configure(const YAML::Node& yaml) -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto enabled() const -> bool;
+
+    /// @brief Applies the policy of `role` to the calling thread and names it after the role
+    auto apply(std::string_view role) noexcept -> void;
+
+    /// @brief
+    ///   Runs `function` on a thread playing `role` and waits for it, threads created meanwhile
+    ///   inherit the policy. Meant for libraries starting their own pools, such as OpenVINO.
+    auto run_as(std::string_view role, const std::function<void()>& function) -> void;
+
+private:
+    struct Role {
+        ThreadPolicy policy;
+        // Threads which took the policy
+        std::size_t applied = 0;
+    };
+
+    mutable std::mutex mutex_;
+    bool enable_ = false;
+    std::map<std::string, Role, std::less<>> roles_;
+};
+
+/// @brief The process-wide profile
+auto execution() -> ExecutionProfile&;
+
+}  // namespace pingpong_tracker::util
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Publication point for the latest value of `T`, single writer, any number of readers.
+/// @note
+///   - A ring of `Slots` seqlocked slots: the writer fills the slot after the last published
+///     one and then advances the publication counter, so readers always find a complete slot
+///     the writer is not touching.
+///   - The writer is wait-free. Readers are lock-free but not wait-free: a reader retries when
+///     the writer laps the slot it is copying, which needs `Slots - 1` publications during a
+///     single copy, so a reader racing a fast writer has no bound on its retries.
+///   - The value is copied word by word through relaxed atomics, no data race for the sanitizers
+///     to report, so `T` must be trivially copyable.
+///   - Concurrent writers must be serialised by the caller.
+template <typename T, std::size_t Slots = 4>
+    requires std::is_trivially_copyable_v<T> && (Slots >= 2)
+class LatestValue {
+public:
+    LatestValue() noexcept = default;
+
+    LatestValue(const LatestValue&)            = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    auto publish(const T& value) noexcept -> void {
+        const auto count = published_.load(std::memory_order_relaxed);
+        auto& slot       = slots_[count % Slots];
+
+        const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto words = Words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < kWords; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        published_.store(count + 1, std::memory_order_release);
+    }
+
+    /// @brief The last published value, nullopt before the first publication
+    [[nodiscard]] auto load() const noexcept -> std::optional<T> {
+        auto words = Words{};
+        while (true) {
+            const auto count = published_.load(std::memory_order_acquire);
+            if (count == 0) {
+                return std::nullopt;
+            }
+            const auto& slot = slots_[(count - 1) % Slots];
+
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before % 2 != 0) [[unlikely]] {
+                continue;
+            }
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before) [[unlikely]] {
+                continue;
+            }
+
+            auto value = std::optional<T>{std::in_place};
+            std::memcpy(static_cast<void*>(&*value), words.data(), sizeof(T));
+            return value;
+        }
+    }
+
+    /// @brief Publications so far, readers can use it to skip values they have already seen
+    [[nodiscard]] auto version() const noexcept -> std::uint64_t {
+        return published_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+    static constexpr std::size_t kWords     = (sizeof(T) + sizeof(std::uint64_t) - 1) / 8;
+    using Words                             = std::array<std::uint64_t, kWords>;
+
+    struct alignas(kCacheLine) Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::array<std::atomic<std::uint64_t>, kWords> words{};
+    };
+
+    std::array<Slot, Slots> slots_{};
+    alignas(kCacheLine) std::atomic<std::uint64_t> published_{0};
+};
+
+}  // namespace pingpong_tracker::util
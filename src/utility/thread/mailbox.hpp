@@ -0,0 +1,86 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+namespace pingpong_tracker::util {
+
+/// @brief
+///   Single-value handoff where the latest value wins, for a consumer that only cares about the
+///   present, such as an encoder that should always get the freshest frame.
+/// @note
+///   - `put` replaces a value nobody has taken yet and counts it as skipped, so a slow consumer
+///     holds at most one pending value and never falls behind.
+///   - `take` sleeps until a value arrives or the stop token fires, an idle consumer costs no
+///     CPU.
+///   - Any number of producers and consumers, a short mutex section on each side.
+template <typename T>
+class Mailbox {
+public:
+    Mailbox() noexcept = default;
+
+    Mailbox(const Mailbox&)            = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    /// @return False when it replaced a value nobody had taken
+    auto put(T value) -> bool {
+        auto replaced = false;
+        {
+            auto lock = std::scoped_lock{mutex_};
+            replaced  = value_.has_value();
+            value_    = std::move(value);
+            skipped_ += replaced ? 1 : 0;
+        }
+        ready_.notify_one();
+        return !replaced;
+    }
+
+    /// @return The pending value, nullopt once `token` is stopped
+    auto take(std::stop_token token) -> std::optional<T> {
+        auto lock = std::unique_lock{mutex_};
+        if (!ready_.wait(lock, token, [this] { return value_.has_value(); })) {
+            return std::nullopt;
+        }
+        return std::exchange(value_, std::nullopt);
+    }
+
+    /// @brief Like `take`, but gives up at `deadline` so the consumer can do periodic work
+    /// @return The pending value, nullopt at the deadline or once `token` is stopped
+    template <typename Clock, typename Duration>
+    auto take_until(std::stop_token token, std::chrono::time_point<Clock, Duration> deadline)
+        -> std::optional<T> {
+        auto lock = std::unique_lock{mutex_};
+        if (!ready_.wait_until(lock, token, deadline, [this] { return value_.has_value(); })) {
+            return std::nullopt;
+        }
+        return std::exchange(value_, std::nullopt);
+    }
+
+    [[nodiscard]] auto try_take() -> std::optional<T> {
+        auto lock = std::scoped_lock{mutex_};
+        return std::exchange(value_, std::nullopt);
+    }
+
+    auto clear() -> void {
+        auto lock = std::scoped_lock{mutex_};
+        value_.reset();
+    }
+
+    /// @brief Values replaced before anyone took them
+    [[nodiscard]] auto skipped() const -> std::uint64_t {
+        auto lock = std::scoped_lock{mutex_};
+        return skipped_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable_any ready_;
+    std::optional<T> value_;
+    std::uint64_t skipped_ = 0;
+};
+
+}  // namespace pingpong_tracker::util
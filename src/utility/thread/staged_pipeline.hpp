@@ -0,0 +1,442 @@
+#pragma once
+#include <boost/lockfree/policies.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utility/clock.hpp"
+
+namespace pingpong_tracker::util {
+
+enum class Backpressure : std::uint8_t {
+    // The previous stage waits for room
+    BLOCK,
+    // The previous stage discards the item
+    DROP,
+};
+
+enum class LatePolicy : std::uint8_t {
+    // The stage discards the item
+    DROP,
+    // The stage runs its cheaper `late_steps` instead
+    DEGRADE,
+};
+
+/// @brief
+///   Depth a stage's input queue is held to, driven by the ages of the items the stage picks up.
+/// @note
+///   - A run of kShrinkAfter late items in a row halves the limit, a single late item among
+///     timely ones is noise and leaves it alone.
+///   - A run of kGrowAfter items within half the budget grows it by one, up to the capacity.
+///   - Owned by the stage's thread, the stage publishes `value` for the producer.
+class QueueLimit {
+public:
+    static constexpr std::uint32_t kShrinkAfter = 3;
+    static constexpr std::uint32_t kGrowAfter   = 32;
+
+    QueueLimit(std::size_t capacity, Clock::duration budget) noexcept
+        : capacity_{capacity}
+        , budget_{budget}
+        , value_{capacity} {
+    }
+
+    /// @return Whether the item is over budget
+    auto observe(Clock::duration age) noexcept -> bool {
+        if (age > budget_) {
+            on_time_ = 0;
+            if (++late_ >= kShrinkAfter) {
+                late_  = 0;
+                value_ = std::max<std::size_t>(value_ / 2, 1);
+            }
+            return true;
+        }
+        late_ = 0;
+        if (age <= budget_ / 2 && ++on_time_ >= kGrowAfter) {
+            on_time_ = 0;
+            value_   = std::min(value_ + 1, capacity_);
+        }
+        return false;
+    }
+
+    [[nodiscard]] auto value() const noexcept -> std::size_t {
+        return value_;
+    }
+
+private:
+    std::size_t capacity_;
+    Clock::duration budget_;
+    std::size_t value_;
+    std::uint32_t late_    = 0;
+    std::uint32_t on_time_ = 0;
+};
+
+/// @brief
+///   Items flowing through a chain of stages, one dedicated thread per stage.
+/// @note
+///   - Adjacent stages are linked by bounded single-producer single-consumer lock-free queues,
+///     an idle stage sleeps on the queue counter instead of spinning.
+///   - Each stage runs its steps in order, a step returning false discards the item. The first
+///     stage produces, a discard there means nothing was available and it backs off for `idle`.
+///   - Items are preallocated and recycled, never constructed on the way. The first step must
+///     overwrite whatever it reuses.
+///   - A full queue either blocks the producing stage or drops the item, per stage.
+///   - A stage with a latency budget checks the age of every item it picks up. Items over budget
+///     are dropped or take the cheaper path, and the queue in front of the stage follows a
+///     `QueueLimit`, so it settles at the depth the stage can serve in time. Stages without a
+///     budget never look at the clock for it.
+///   - A single stage holding every step is the serial loop.
+template <typename Item>
+class StagedPipeline {
+public:
+    using Step = std::function<bool(Item&)>;
+    // When the item came into being, its age is measured from there
+    using Timestamp = std::function<Clock::time_point(const Item&)>;
+
+    struct StageConfig {
+        std::string name;
+        std::vector<Step> steps;
+
+        // Items waiting in front of this stage, unused for the first one
+        std::size_t capacity = 4;
+        Backpressure backpressure = Backpressure::BLOCK;
+
+        // Oldest an item may be when the stage picks it up, zero for no limit
+        Clock::duration budget{};
+        LatePolicy late = LatePolicy::DROP;
+        // Run instead of `steps` for items over budget under `LatePolicy::DEGRADE`
+        std::vector<Step> late_steps{};
+
+        // Called with the age of every item the stage picks up, unused without a budget
+        std::function<void(Clock::duration)> observe_age{};
+
+        // Called on the stage's thread before anything else, to set up its scheduling
+        std::function<void()> on_start{};
+    };
+
+    struct StageMetrics {
+        std::string_view name;
+        // Items through every step of the stage
+        std::uint64_t processed = 0;
+        // Items a step discarded
+        std::uint64_t rejected = 0;
+        // Items dropped in front of the stage, queue full
+        std::uint64_t dropped = 0;
+        // Items over budget the stage dropped
+        std::uint64_t late = 0;
+        // Items over budget sent down the cheaper path
+        std::uint64_t degraded = 0;
+        // Depth the queue is held to now, at most its capacity
+        std::size_t limit = 0;
+        // Items waiting in front of the stage now
+        std::size_t depth = 0;
+        // Time spent in the steps
+        Clock::duration busy{};
+        // Longest pass through the steps since the previous collect
+        Clock::duration max_service{};
+    };
+
+    struct Metrics {
+        std::vector<StageMetrics> stages;
+        // Items through the last stage
+        std::uint64_t completed = 0;
+        // From entering the first stage to leaving the last one, since the previous collect
+        Clock::duration mean_latency{};
+        Clock::duration max_latency{};
+    };
+
+    /// @param timestamp Defaults to the time the item entered the first stage
+    explicit StagedPipeline(std::vector<StageConfig> stages,
+                            Clock::duration idle = std::chrono::milliseconds{1},
+                            Timestamp timestamp  = {})
+        : idle_{idle}
+        , timestamp_{std::move(timestamp)} {
+        auto slots = std::size_t{1};
+        for (auto& config : stages) {
+            config.capacity = std::max<std::size_t>(config.capacity, 1);
+            slots += config.capacity + 1;
+        }
+
+        slots_ = std::make_unique<Slot[]>(slots);
+        free_  = std::make_unique<FreeList>(slots);
+        for (std::size_t i = 0; i < slots; ++i) {
+            free_->push(&slots_[i]);
+        }
+
+        stages_.reserve(stages.size());
+        for (auto& config : stages) {
+            stages_.push_back(std::make_unique<Stage>(std::move(config)));
+        }
+    }
+
+    StagedPipeline(const StagedPipeline&)            = delete;
+    StagedPipeline& operator=(const StagedPipeline&) = delete;
+
+    ~StagedPipeline() noexcept {
+        stop();
+    }
+
+    auto start() -> void {
+        stopping_.store(false, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < stages_.size(); ++i) {
+            threads_.emplace_back([this, i] {
+                if (const auto& on_start = stages_[i]->config.on_start) {
+                    on_start();
+                }
+                i == 0 ? run_source() : run_stage(i);
+            });
+        }
+    }
+
+    /// @brief Stops and joins every stage, items in flight are abandoned
+    auto stop() noexcept -> void {
+        stopping_.store(true, std::memory_order_relaxed);
+        for (auto& stage : stages_) {
+            stage->pushed.fetch_add(1, std::memory_order_release);
+            stage->pushed.notify_all();
+            stage->popped.fetch_add(1, std::memory_order_release);
+            stage->popped.notify_all();
+        }
+        threads_.clear();
+    }
+
+    /// @note
+    ///   - Counters are cumulative, the maxima and the mean latency cover the interval since the
+    ///     previous call.
+    ///   - Meant for a single reporting thread.
+    auto collect() noexcept -> Metrics {
+        auto metrics = Metrics{};
+        for (const auto& stage : stages_) {
+            metrics.stages.push_back(StageMetrics{
+                .name        = stage->config.name,
+                .processed   = stage->processed.load(std::memory_order_relaxed),
+                .rejected    = stage->rejected.load(std::memory_order_relaxed),
+                .dropped     = stage->dropped.load(std::memory_order_relaxed),
+                .late        = stage->late.load(std::memory_order_relaxed),
+                .degraded    = stage->degraded.load(std::memory_order_relaxed),
+                .limit       = stage->limit.load(std::memory_order_relaxed),
+                .depth       = stage->queue.read_available(),
+                .busy        = Clock::duration{stage->busy.load(std::memory_order_relaxed)},
+                .max_service = Clock::duration{stage->max_service.exchange(0)},
+            });
+        }
+
+        metrics.completed    = completed_.load(std::memory_order_relaxed);
+        const auto count     = metrics.completed - collected_;
+        const auto latency   = latency_sum_.exchange(0);
+        collected_           = metrics.completed;
+        metrics.mean_latency = Clock::duration{count > 0 ? latency / static_cast<Rep>(count) : 0};
+        metrics.max_latency  = Clock::duration{max_latency_.exchange(0)};
+        return metrics;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return stages_.size();
+    }
+
+    /// @brief Items waiting in front of stage `index` now, cheaper than `collect`
+    [[nodiscard]] auto depth(std::size_t index) const noexcept -> std::size_t {
+        return stages_[index]->queue.read_available();
+    }
+
+    /// @brief Depth the queue in front of stage `index` is held to now
+    [[nodiscard]] auto limit(std::size_t index) const noexcept -> std::size_t {
+        return stages_[index]->limit.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Rep = Clock::rep;
+
+    struct Slot {
+        Item item{};
+        Clock::time_point entered{};
+    };
+
+    using FreeList = boost::lockfree::queue<Slot*, boost::lockfree::fixed_sized<true>>;
+
+    struct Stage {
+        explicit Stage(StageConfig config)
+            : config{std::move(config)}
+            , queue{this->config.capacity}
+            , limit{this->config.capacity}
+            , adaptation{this->config.capacity, this->config.budget} {
+        }
+
+        StageConfig config;
+
+        // Input queue, with counters to sleep on while it is empty or full
+        boost::lockfree::spsc_queue<Slot*> queue;
+        std::atomic<std::uint32_t> pushed{0};
+        std::atomic<std::uint32_t> popped{0};
+
+        std::atomic<std::uint64_t> processed{0};
+        std::atomic<std::uint64_t> rejected{0};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> late{0};
+        std::atomic<std::uint64_t> degraded{0};
+
+        // Written by the stage, read by the previous one when pushing
+        std::atomic<std::size_t> limit;
+        QueueLimit adaptation;
+
+        std::atomic<Rep> busy{0};
+        std::atomic<Rep> max_service{0};
+    };
+
+    static auto update_max(std::atomic<Rep>& target, Rep value) noexcept -> void {
+        auto current = target.load(std::memory_order_relaxed);
+        while (value > current
+               && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    auto stopping() const noexcept -> bool {
+        return stopping_.load(std::memory_order_relaxed);
+    }
+
+    auto release(Slot* slot) noexcept -> void {
+        free_->push(slot);
+    }
+
+    /// @return Whether the item is over the stage's budget, adjusting the queue limit
+    auto check_age(Stage& stage, const Slot& slot) noexcept -> bool {
+        if (stage.config.budget <= Clock::duration::zero()) {
+            return false;
+        }
+        const auto age = Clock::now() - (timestamp_ ? timestamp_(slot.item) : slot.entered);
+        if (stage.config.observe_age) {
+            stage.config.observe_age(age);
+        }
+
+        const auto late = stage.adaptation.observe(age);
+        stage.limit.store(stage.adaptation.value(), std::memory_order_relaxed);
+        return late;
+    }
+
+    /// @return false when the stage is done with the item
+    auto process(Stage& stage, Slot& slot, bool late = false) noexcept -> bool {
+        const auto begin = Clock::now();
+        auto passed      = true;
+        for (auto& step : late ? stage.config.late_steps : stage.config.steps) {
+            if (!step(slot.item)) {
+                passed = false;
+                break;
+            }
+        }
+        const auto service = (Clock::now() - begin).count();
+
+        stage.busy.fetch_add(service, std::memory_order_relaxed);
+        update_max(stage.max_service, service);
+        (passed ? stage.processed : stage.rejected).fetch_add(1, std::memory_order_relaxed);
+        return passed;
+    }
+
+    auto forward(std::size_t index, Slot* slot) noexcept -> void {
+        if (index + 1 == stages_.size()) {
+            const auto latency = (Clock::now() - slot->entered).count();
+            latency_sum_.fetch_add(latency, std::memory_order_relaxed);
+            update_max(max_latency_, latency);
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            release(slot);
+            return;
+        }
+
+        auto& next = *stages_[index + 1];
+        // The queue counts as full at its current limit, not only at capacity
+        const auto full = [&] {
+            return next.config.capacity - next.queue.write_available()
+                >= next.limit.load(std::memory_order_relaxed);
+        };
+        while (full() || !next.queue.push(slot)) {
+            if (next.config.backpressure == Backpressure::DROP || stopping()) {
+                next.dropped.fetch_add(1, std::memory_order_relaxed);
+                release(slot);
+                return;
+            }
+            const auto seen = next.popped.load(std::memory_order_acquire);
+            if (full() && !stopping()) {
+                next.popped.wait(seen, std::memory_order_acquire);
+            }
+        }
+        next.pushed.fetch_add(1, std::memory_order_release);
+        next.pushed.notify_one();
+    }
+
+    auto run_source() noexcept -> void {
+        auto& stage = *stages_.front();
+        while (!stopping()) {
+            auto* slot = static_cast<Slot*>(nullptr);
+            if (!free_->pop(slot)) [[unlikely]] {
+                std::this_thread::sleep_for(idle_);
+                continue;
+            }
+
+            slot->entered = Clock::now();
+            if (!process(stage, *slot)) {
+                release(slot);
+                std::this_thread::sleep_for(idle_);
+                continue;
+            }
+            forward(0, slot);
+        }
+    }
+
+    auto run_stage(std::size_t index) noexcept -> void {
+        auto& stage = *stages_[index];
+        while (!stopping()) {
+            auto* slot = static_cast<Slot*>(nullptr);
+            if (!stage.queue.pop(slot)) {
+                const auto seen = stage.pushed.load(std::memory_order_acquire);
+                if (stage.queue.read_available() == 0 && !stopping()) {
+                    stage.pushed.wait(seen, std::memory_order_acquire);
+                }
+                continue;
+            }
+            stage.popped.fetch_add(1, std::memory_order_release);
+            stage.popped.notify_one();
+
+            const auto late = check_age(stage, *slot);
+            if (late) {
+                if (stage.config.late == LatePolicy::DROP) {
+                    stage.late.fetch_add(1, std::memory_order_relaxed);
+                    release(slot);
+                    continue;
+                }
+                stage.degraded.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!process(stage, *slot, late)) {
+                release(slot);
+                continue;
+            }
+            forward(index, slot);
+        }
+    }
+
+    Clock::duration idle_;
+    Timestamp timestamp_;
+
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<FreeList> free_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> completed_{0};
+    std::atomic<Rep> latency_sum_{0};
+    std::atomic<Rep> max_latency_{0};
+    std::uint64_t collected_ = 0;
+
+    // Last, joined first on destruction
+    std::vector<std::jthread> threads_;
+};
+
+}  // namespace pingpong_tracker::util
@@ -1,17 +1,391 @@
 #include "workers.hpp"
-#include <queue>
+
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace pingpong_tracker;
 
+namespace {
+
+using Task = WorkersContext::Task;
+
+/// @brief
+///   Chase-Lev deque with a fixed capacity, after Le et al. for weak memory models.
+/// @note
+///   - Only the owner pushes and pops, at the bottom. Any thread steals from the top.
+///   - Slots are published with release stores, which also hands the task contents to thieves.
+class TaskDeque {
+public:
+    static constexpr std::int64_t kCapacity = 4096;
+
+    /// @return false when full
+    auto push(Task* task) noexcept -> bool {
+        const auto b = bottom_.load(std::memory_order_relaxed);
+        const auto t = top_.load(std::memory_order_acquire);
+        if (b - t >= kCapacity) {
+            return false;
+        }
+        slots_[static_cast<std::size_t>(b & kMask)].store(task, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    auto pop() noexcept -> Task* {
+        const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto* task = slots_[static_cast<std::size_t>(b & kMask)].load(std::memory_order_acquire);
+        if (t == b) {
+            // Last one, race the thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    auto steal() noexcept -> Task* {
+        auto t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        auto* task = slots_[static_cast<std::size_t>(t & kMask)].load(std::memory_order_acquire);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::int64_t kMask = kCapacity - 1;
+
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::unique_ptr<std::atomic<Task*>[]> slots_{
+        std::make_unique<std::atomic<Task*>[]>(kCapacity)};
+};
+
+// Recycled task nodes. Submitters and executors are often different threads, so surplus nodes
+// travel in batches through a shared stash instead of going back to the allocator
+struct TaskNodes {
+    std::vector<Task*> nodes;
+
+    TaskNodes() = default;
+    TaskNodes(const TaskNodes&)            = delete;
+    TaskNodes& operator=(const TaskNodes&) = delete;
+
+    ~TaskNodes() noexcept {
+        for (auto* node : nodes) {
+            delete node;
+        }
+    }
+};
+
+constexpr std::size_t kCacheLimit = 256;
+constexpr std::size_t kBatch      = 64;
+
+struct TaskStash {
+    std::mutex mutex;
+    TaskNodes free;
+};
+
+auto task_stash() noexcept -> TaskStash& {
+    static auto stash = TaskStash{};
+    return stash;
+}
+
+thread_local auto task_cache = TaskNodes{};
+
+// Set on worker threads
+thread_local const void* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+thread_local std::uint64_t steal_seed  = 0x9E3779B97F4A7C15ULL;
+
+auto next_random() noexcept -> std::uint64_t {
+    steal_seed ^= steal_seed << 13U;
+    steal_seed ^= steal_seed >> 7U;
+    steal_seed ^= steal_seed << 17U;
+    return steal_seed;
+}
+
+}  // namespace
+
 struct WorkersContext::Impl {
-    std::queue<std::unique_ptr<WorkersContext::InternalTask>> tasks;
+    struct alignas(64) Worker {
+        TaskDeque deque;
+    };
+
+    Config config;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Submissions from foreign threads
+    std::mutex injection_mutex;
+    std::deque<Task*> injection;
+    std::atomic<std::size_t> injected{0};
+
+    // Sleeping workers wait on the epoch, a submission bumps it when anyone sleeps
+    std::atomic<std::uint32_t> epoch{0};
+    std::atomic<std::uint32_t> sleepers{0};
+    std::atomic<bool> stopping{false};
+
+    std::vector<std::jthread> threads;
+
+    explicit Impl(Config config_) : config{std::move(config_)} {
+        if (config.threads == 0) {
+            config.threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        workers.reserve(config.threads);
+        for (std::size_t i = 0; i < config.threads; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        threads.reserve(config.threads);
+        for (std::size_t i = 0; i < config.threads; ++i) {
+            threads.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    Impl(const Impl&)            = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    ~Impl() noexcept {
+        stopping.store(true, std::memory_order_seq_cst);
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        epoch.notify_all();
+        threads.clear();
+    }
+
+    auto on_worker() const noexcept -> bool {
+        return current_pool == this;
+    }
+
+    auto submit(Task* task) noexcept -> void {
+        if (on_worker()) {
+            if (!workers[current_index]->deque.push(task)) [[unlikely]] {
+                // Full, the owner runs it right away rather than growing
+                run(task);
+                return;
+            }
+        } else {
+            auto lock = std::scoped_lock{injection_mutex};
+            injection.push_back(task);
+            injected.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake();
+    }
+
+    auto wake() noexcept -> void {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            epoch.notify_one();
+        }
+    }
+
+    static auto run(Task* task) noexcept -> void {
+        task->run();
+        WorkersContext::release_task(task);
+    }
+
+    auto take_injected() noexcept -> Task* {
+        if (injected.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        auto lock = std::scoped_lock{injection_mutex};
+        if (injection.empty()) {
+            return nullptr;
+        }
+        auto* task = injection.front();
+        injection.pop_front();
+        injected.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    auto find_task() noexcept -> Task* {
+        const auto own = on_worker();
+        if (own) {
+            if (auto* task = workers[current_index]->deque.pop()) {
+                return task;
+            }
+        }
+        if (auto* task = take_injected()) {
+            return task;
+        }
+
+        const auto count = workers.size();
+        const auto start = static_cast<std::size_t>(next_random() % count);
+        for (std::size_t k = 0; k < count; ++k) {
+            const auto victim = (start + k) % count;
+            if (own && victim == current_index) {
+                continue;
+            }
+            if (auto* task = workers[victim]->deque.steal()) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    auto anything_queued() const noexcept -> bool {
+        if (injected.load(std::memory_order_seq_cst) > 0) {
+            return true;
+        }
+        return std::ranges::any_of(workers, [](const auto& worker) {
+            return !worker->deque.empty();
+        });
+    }
+
+    auto help_one() noexcept -> bool {
+        auto* task = find_task();
+        if (task == nullptr) {
+            return false;
+        }
+        run(task);
+        return true;
+    }
+
+    auto configure_thread(std::size_t index) noexcept -> void {
+        const auto name = std::format("{}-{}", config.name, index).substr(0, 15);
+        pthread_setname_np(pthread_self(), name.c_str());
+
+        if (config.cores.empty()) {
+            return;
+        }
+        const auto core = config.cores[index % config.cores.size()];
+        auto set        = cpu_set_t{};
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            spdlog::warn("[{} worker {}] failed to pin to core {}", config.name, index, core);
+        }
+    }
+
+    auto worker_loop(std::size_t index) noexcept -> void {
+        current_pool  = this;
+        current_index = index;
+        steal_seed += index * 0x2545F4914F6CDD1DULL;
+        configure_thread(index);
+
+        constexpr auto kSpins = 64;
+        auto idle             = 0;
+        for (;;) {
+            if (auto* task = find_task()) {
+                run(task);
+                idle = 0;
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) && !anything_queued()) {
+                break;
+            }
+            if (++idle < kSpins) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce the sleep, then look once more so a racing submission is never missed
+            const auto seen = epoch.load(std::memory_order_seq_cst);
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!anything_queued() && !stopping.load(std::memory_order_seq_cst)) {
+                epoch.wait(seen, std::memory_order_seq_cst);
+            }
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            idle = 0;
+        }
+
+        current_pool = nullptr;
+    }
 };
 
-WorkersContext::WorkersContext() noexcept
-    : pimpl_ { std::make_unique<Impl>() } { }
+WorkersContext::WorkersContext() : WorkersContext{Config{}} {
+}
+
+WorkersContext::WorkersContext(Config config)
+    : pimpl_{std::make_unique<Impl>(std::move(config))} {
+}
+
+WorkersContext::~WorkersContext() noexcept                          = default;
+WorkersContext::WorkersContext(WorkersContext&&) noexcept            = default;
+WorkersContext& WorkersContext::operator=(WorkersContext&&) noexcept = default;
+
+auto WorkersContext::threads() const noexcept -> std::size_t {
+    return pimpl_->workers.size();
+}
 
-WorkersContext::~WorkersContext() noexcept = default;
+auto WorkersContext::allocate_task() noexcept -> Task* {
+    auto& nodes = task_cache.nodes;
+    if (nodes.empty()) {
+        auto& stash = task_stash();
+        auto lock   = std::scoped_lock{stash.mutex};
+        const auto count = std::min(kBatch, stash.free.nodes.size());
+        nodes.insert(nodes.end(), stash.free.nodes.end() - static_cast<std::ptrdiff_t>(count),
+                     stash.free.nodes.end());
+        stash.free.nodes.resize(stash.free.nodes.size() - count);
+    }
+    if (nodes.empty()) {
+        return new Task{};
+    }
+    auto* task = nodes.back();
+    nodes.pop_back();
+    return task;
+}
+
+auto WorkersContext::release_task(Task* task) noexcept -> void {
+    auto& nodes = task_cache.nodes;
+    nodes.push_back(task);
+    if (nodes.size() > kCacheLimit) {
+        auto& stash = task_stash();
+        auto lock   = std::scoped_lock{stash.mutex};
+        stash.free.nodes.insert(stash.free.nodes.end(),
+                                nodes.end() - static_cast<std::ptrdiff_t>(kBatch), nodes.end());
+        nodes.resize(nodes.size() - kBatch);
+    }
+}
+
+auto WorkersContext::submit(Task* task) noexcept -> void {
+    pimpl_->submit(task);
+}
+
+auto WorkersContext::help_one() noexcept -> bool {
+    return pimpl_->help_one();
+}
 
-auto WorkersContext::internal_enqueue(std::unique_ptr<InternalTask> task) noexcept -> void {
-    pimpl_->tasks.push(std::move(task));
+auto WorkersContext::idle_wait(std::atomic<std::size_t>& pending, std::size_t seen) noexcept
+    -> void {
+    // Only yield, never block on `pending`: a worker must keep looking for tasks, and the group
+    // may be gone by the time the last task could notify a sleeper
+    constexpr auto kYields = 16;
+    for (int i = 0; i < kYields && pending.load(std::memory_order_acquire) == seen; ++i) {
+        if (pimpl_->anything_queued()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
 }
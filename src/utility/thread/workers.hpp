@@ -1,49 +1,207 @@
 #pragma once
-#include "utility/pimpl.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <future>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utility/pimpl.hpp"
 
 namespace pingpong_tracker {
 
+/// @brief
+///   Work-stealing thread pool.
+/// @note
+///   - Every worker owns a Chase-Lev deque, it pushes and pops its own tasks at the bottom and
+///     idle workers steal from the top. Tasks from foreign threads go through a shared queue.
+///   - A task is a cache-line node holding the callable inline, nodes are recycled through a
+///     per-thread cache, so submitting a small closure does not allocate. Larger closures fall
+///     back to the heap.
+///   - A thread waiting on a `TaskGroup` runs pending tasks meanwhile, fork/join nests freely.
+///   - Remaining tasks are drained before the workers stop.
 class WorkersContext {
     PINGPONG_TRACKER_PIMPL_DEFINITION(WorkersContext)
 
-    struct InternalTask {
-        virtual auto run() noexcept -> void { }
-        virtual ~InternalTask() noexcept = default;
+public:
+    struct Config {
+        // Zero for one per hardware thread
+        std::size_t threads = 0;
+        // Worker i is pinned to cores[i % cores.size()], empty for no pinning
+        std::vector<int> cores{};
+        // Thread name prefix
+        std::string name = "workers";
     };
 
-public:
-    WorkersContext() noexcept;
+    class alignas(64) Task {
+    public:
+        static constexpr std::size_t kInlineSize = 48;
 
-    template <typename F, typename... Args>
-        requires std::is_nothrow_invocable_v<F, Args...>
-    auto enqueue(F&& f, Args&&... args) noexcept {
-        using return_type = std::invoke_result_t<F, Args...>;
+        template <typename F>
+        auto emplace(F&& f) noexcept -> void {
+            using Callable = std::decay_t<F>;
+            if constexpr (sizeof(Callable) <= kInlineSize
+                          && alignof(Callable) <= alignof(std::max_align_t)) {
+                ::new (static_cast<void*>(storage_)) Callable{std::forward<F>(f)};
+                run_ = [](void* storage) noexcept {
+                    auto* callable = std::launder(static_cast<Callable*>(storage));
+                    std::invoke(*callable);
+                    callable->~Callable();
+                };
+            } else {
+                ::new (static_cast<void*>(storage_)) Callable*{new Callable{std::forward<F>(f)}};
+                run_ = [](void* storage) noexcept {
+                    auto* callable = *std::launder(static_cast<Callable**>(storage));
+                    std::invoke(*callable);
+                    delete callable;
+                };
+            }
+        }
+
+        /// @brief Runs and destroys the callable
+        auto run() noexcept -> void {
+            run_(storage_);
+        }
+
+    private:
+        alignas(std::max_align_t) std::byte storage_[kInlineSize];
+        void (*run_)(void*) noexcept = nullptr;
+    };
+
+    /// @brief
+    ///   Fork/join scope, `run` forks and `wait` joins.
+    /// @note The waiting thread executes queued tasks instead of blocking
+    class TaskGroup {
+    public:
+        explicit TaskGroup(WorkersContext& workers) noexcept : workers_{workers} {
+        }
+
+        TaskGroup(const TaskGroup&)            = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        ~TaskGroup() noexcept {
+            wait();
+        }
+
+        /// @note `f` must not throw
+        template <typename F>
+        auto run(F&& f) noexcept -> void {
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            workers_.spawn([this, f = std::forward<F>(f)]() mutable noexcept {
+                f();
+                pending_.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
 
-        struct Task : public InternalTask {
-            std::packaged_task<return_type(Args...)> task;
-            std::tuple<Args...> args;
+        auto wait() noexcept -> void {
+            for (;;) {
+                const auto pending = pending_.load(std::memory_order_acquire);
+                if (pending == 0) {
+                    return;
+                }
+                if (!workers_.help_one()) {
+                    workers_.idle_wait(pending_, pending);
+                }
+            }
+        }
 
-            explicit Task(F&& f, Args&&... args) noexcept
-                : task { std::forward<F>(f) }
-                , args { std::forward<Args>(args)... } { }
+    private:
+        WorkersContext& workers_;
+        std::atomic<std::size_t> pending_{0};
+    };
+
+    WorkersContext();
+    explicit WorkersContext(Config config);
+
+    [[nodiscard]] auto threads() const noexcept -> std::size_t;
+
+    /// @brief Fire-and-forget, `f` must not throw
+    template <typename F>
+    auto spawn(F&& f) noexcept -> void {
+        auto* task = allocate_task();
+        task->emplace(std::forward<F>(f));
+        submit(task);
+    }
+
+    /// @brief `f` and `args` are stored decayed and invoked once as rvalues, move-only is fine
+    template <typename F, typename... Args>
+        requires std::is_nothrow_invocable_v<std::decay_t<F>, std::decay_t<Args>...>
+    auto enqueue(F&& f, Args&&... args) noexcept {
+        using return_type = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
 
-            ~Task() noexcept override = default;
+        auto task = std::packaged_task<return_type()>{
+            [f = std::forward<F>(f), ... args = std::forward<Args>(args)]() mutable {
+                return std::invoke(std::move(f), std::move(args)...);
+            }};
+        auto future = task.get_future();
+        spawn([task = std::move(task)]() mutable noexcept { task(); });
+        return future;
+    }
 
-            auto run() noexcept -> void override { std::apply(task, args); }
+    /// @brief
+    ///   Calls `body(first, last)` over [begin, end) in chunks of at most `grain` and returns once
+    ///   every chunk is done.
+    /// @note
+    ///   - Chunks are claimed from a shared counter by the caller and up to `threads()` helpers,
+    ///     uneven chunks balance themselves.
+    ///   - `body` must not throw.
+    template <typename F>
+    auto parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& body) noexcept
+        -> void {
+        if (begin >= end) {
+            return;
+        }
+        grain             = std::max<std::size_t>(grain, 1);
+        const auto chunks = (end - begin + grain - 1) / grain;
 
-            auto future() { return task.get_future(); }
+        auto next  = std::atomic<std::size_t>{begin};
+        auto claim = [&]() noexcept {
+            for (;;) {
+                const auto first = next.fetch_add(grain, std::memory_order_relaxed);
+                if (first >= end) {
+                    return;
+                }
+                body(first, std::min(first + grain, end));
+            }
         };
-        auto enqueue_task  = std::make_unique<Task>( //
-            std::forward<F>(f), std::forward<Args>(args)...);
-        auto return_future = enqueue_task->future();
 
-        internal_enqueue(std::move(enqueue_task));
-        return return_future;
+        auto group         = TaskGroup{*this};
+        const auto helpers = std::min(chunks - 1, threads());
+        for (std::size_t i = 0; i < helpers; ++i) {
+            group.run(claim);
+        }
+        claim();
+        group.wait();
+    }
+
+    /// @brief Runs `f(i)` for every i in [0, count), forking one task per call and joining
+    template <typename F>
+    auto fork_join(std::size_t count, F&& f) noexcept -> void {
+        auto group = TaskGroup{*this};
+        for (std::size_t i = 1; i < count; ++i) {
+            group.run([&f, i]() noexcept { f(i); });
+        }
+        if (count > 0) {
+            f(std::size_t{0});
+        }
+        group.wait();
     }
 
 private:
-    auto internal_enqueue(std::unique_ptr<InternalTask> task) noexcept -> void;
+    static auto allocate_task() noexcept -> Task*;
+    static auto release_task(Task*) noexcept -> void;
+
+    auto submit(Task*) noexcept -> void;
+
+    /// @brief Runs one queued task if there is any
+    auto help_one() noexcept -> bool;
+
+    /// @brief Backs off briefly while `pending` still holds `seen` and nothing is runnable
+    auto idle_wait(std::atomic<std::size_t>& pending, std::size_t seen) noexcept -> void;
 };
 
-}
+}  // namespace pingpong_tracker
@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "utility/math/kalmanfilter/batched_ekf.hpp"
+#include "utility/math/kalmanfilter/ekf.hpp"
+
+using pingpong_tracker::util::BatchedEKF;
+using pingpong_tracker::util::EKF;
+
+namespace {
+
+// 2D constant velocity, state (x, y, vx, vy), pixels
+constexpr double kDt    = 1.0 / 120.0;
+constexpr double kQ     = 1e4;
+constexpr double kNoise = 2.0;
+
+template <typename Scalar>
+auto transition() -> Eigen::Matrix<Scalar, 4, 4> {
+    Eigen::Matrix<Scalar, 4, 4> F = Eigen::Matrix<Scalar, 4, 4>::Identity();
+    F(0, 2)                       = static_cast<Scalar>(kDt);
+    F(1, 3)                       = static_cast<Scalar>(kDt);
+    return F;
+}
+
+template <typename Scalar>
+auto process_noise() -> Eigen::Matrix<Scalar, 4, 4> {
+    const auto dt2 = kDt * kDt;
+    const auto dt3 = dt2 * kDt / 2.0;
+    const auto dt4 = dt2 * dt2 / 4.0;
+
+    Eigen::Matrix<double, 4, 4> Q = Eigen::Matrix<double, 4, 4>::Zero();
+    for (int k = 0; k < 2; ++k) {
+        Q(k, k)         = dt4 * kQ;
+        Q(k, k + 2)     = dt3 * kQ;
+        Q(k + 2, k)     = dt3 * kQ;
+        Q(k + 2, k + 2) = dt2 * kQ;
+    }
+    return Q.cast<Scalar>();
+}
+
+template <typename Scalar>
+auto observation() -> Eigen::Matrix<Scalar, 2, 4> {
+    Eigen::Matrix<Scalar, 2, 4> H = Eigen::Matrix<Scalar, 2, 4>::Zero();
+    H(0, 0)                       = 1;
+    H(1, 1)                       = 1;
+    return H;
+}
+
+template <typename Scalar>
+auto initial_covariance() -> Eigen::Matrix<Scalar, 4, 4> {
+    Eigen::Matrix<Scalar, 4, 4> P = Eigen::Matrix<Scalar, 4, 4>::Zero();
+    P.diagonal() << 4, 4, 1e6, 1e6;
+    return P;
+}
+
+// Noisy measurements of `filters` balls over `frames` frames, component-major per frame
+struct Scenario {
+    std::size_t filters;
+    std::size_t frames;
+    std::vector<double> truth;         // frame, filter, (x, y)
+    std::vector<double> measurements;  // frame, component, filter
+    std::vector<std::uint8_t> mask;    // frame, filter
+
+    Scenario(std::size_t filters, std::size_t frames)
+        : filters{filters}
+        , frames{frames} {
+        auto random = std::mt19937{11};
+        auto noise  = std::normal_distribution<double>{0.0, kNoise};
+        auto start  = std::uniform_real_distribution<double>{0.0, 1000.0};
+        auto speed  = std::uniform_real_distribution<double>{-600.0, 600.0};
+        auto drop   = std::bernoulli_distribution{0.1};
+
+        truth.resize(frames * filters * 2);
+        measurements.resize(frames * filters * 2);
+        mask.resize(frames * filters);
+        for (std::size_t i = 0; i < filters; ++i) {
+            auto x        = start(random);
+            auto y        = start(random);
+            const auto vx = speed(random);
+            const auto vy = speed(random);
+            for (std::size_t f = 0; f < frames; ++f) {
+                truth[(f * filters + i) * 2]     = x;
+                truth[(f * filters + i) * 2 + 1] = y;
+
+                measurements[(f * 2) * filters + i]     = x + noise(random);
+                measurements[(f * 2 + 1) * filters + i] = y + noise(random);
+                mask[f * filters + i] = f == 0 || !drop(random) ? 1 : 0;
+
+                x += vx * kDt;
+                y += vy * kDt;
+            }
+        }
+    }
+
+    auto z(std::size_t frame, std::size_t filter) const -> Eigen::Vector2d {
+        return {measurements[(frame * 2) * filters + filter],
+                measurements[(frame * 2 + 1) * filters + filter]};
+    }
+};
+
+template <typename Scalar>
+auto run_scalar(Scenario const& scenario) -> std::vector<EKF<4, 2, Scalar>> {
+    using Filter = EKF<4, 2, Scalar>;
+
+    const auto F = transition<Scalar>();
+    const auto Q = process_noise<Scalar>();
+    const auto H = observation<Scalar>();
+    const typename Filter::RMat R =
+        Filter::RMat::Identity() * static_cast<Scalar>(kNoise * kNoise);
+
+    auto filters = std::vector<Filter>{};
+    for (std::size_t i = 0; i < scenario.filters; ++i) {
+        auto x = typename Filter::XVec{};
+        x << scenario.z(0, i).cast<Scalar>(), 0, 0;
+        filters.emplace_back(x, initial_covariance<Scalar>());
+    }
+
+    auto f     = [&](auto const& x) -> typename Filter::XVec { return F * x; };
+    auto get_F = [&](auto const&) { return F; };
+    auto h     = [&](auto const& x) -> typename Filter::ZVec { return H * x; };
+    auto get_H = [&](auto const&) { return H; };
+    auto add   = [](auto const& a, auto const& b) -> typename Filter::XVec { return a + b; };
+    auto sub   = [](auto const& a, auto const& b) -> typename Filter::ZVec { return a - b; };
+
+    for (std::size_t frame = 1; frame < scenario.frames; ++frame) {
+        for (std::size_t i = 0; i < scenario.filters; ++i) {
+            filters[i].predict(f, get_F, Q);
+            if (scenario.mask[frame * scenario.filters + i] != 0) {
+                filters[i].update(scenario.z(frame, i).cast<Scalar>(), h, get_H, R, add, sub);
+            }
+        }
+    }
+    return filters;
+}
+
+template <typename Scalar>
+struct BatchedRun {
+    BatchedEKF<4, 2, Scalar> filters;
+    std::vector<Scalar> z;
+
+    explicit BatchedRun(Scenario const& scenario)
+        : filters{scenario.filters}
+        , z(2 * scenario.filters) {
+        for (std::size_t i = 0; i < scenario.filters; ++i) {
+            auto x = typename BatchedEKF<4, 2, Scalar>::XVec{};
+            x << scenario.z(0, i).cast<Scalar>(), 0, 0;
+            filters.push(x, initial_covariance<Scalar>());
+        }
+    }
+
+    auto run(Scenario const& scenario) -> void {
+        const auto F = transition<Scalar>();
+        const auto Q = process_noise<Scalar>();
+        const auto H = observation<Scalar>();
+        const typename BatchedEKF<4, 2, Scalar>::RMat R =
+            BatchedEKF<4, 2, Scalar>::RMat::Identity() * static_cast<Scalar>(kNoise * kNoise);
+
+        for (std::size_t frame = 1; frame < scenario.frames; ++frame) {
+            const auto* source = &scenario.measurements[frame * 2 * scenario.filters];
+            for (std::size_t k = 0; k < z.size(); ++k) {
+                z[k] = static_cast<Scalar>(source[k]);
+            }
+            const auto mask =
+                std::span{&scenario.mask[frame * scenario.filters], scenario.filters};
+
+            filters.predict(F, Q);
+            filters.update(z, H, R, mask);
+        }
+    }
+};
+
+template <typename Function>
+auto seconds(Function&& function) -> double {
+    const auto begin = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}  // namespace
+
+TEST(ekf, ClosedFormInverseMatchesLdlt) {
+    auto random  = std::mt19937{3};
+    auto uniform = std::uniform_real_distribution<double>{-1.0, 1.0};
+
+    for (int round = 0; round < 100; ++round) {
+        Eigen::Matrix3d A;
+        for (int i = 0; i < 9; ++i) {
+            A(i / 3, i % 3) = uniform(random);
+        }
+        const Eigen::Matrix3d S = A * A.transpose() + 0.1 * Eigen::Matrix3d::Identity();
+
+        Eigen::Matrix3d inverse;
+        ASSERT_TRUE(pingpong_tracker::util::symmetric_inverse(S, inverse));
+        EXPECT_LT((inverse * S - Eigen::Matrix3d::Identity()).norm(), 1e-9);
+
+        const Eigen::Matrix2d S2 = S.topLeftCorner<2, 2>();
+        Eigen::Matrix2d inverse2;
+        ASSERT_TRUE(pingpong_tracker::util::symmetric_inverse(S2, inverse2));
+        EXPECT_LT((inverse2 * S2 - Eigen::Matrix2d::Identity()).norm(), 1e-9);
+    }
+
+    Eigen::Matrix2d indefinite;
+    indefinite << 1.0, 2.0, 2.0, 1.0;
+    Eigen::Matrix2d unused;
+    EXPECT_FALSE(pingpong_tracker::util::symmetric_inverse(indefinite, unused));
+}
+
+TEST(ekf, FloatTracksDouble) {
+    const auto scenario = Scenario{64, 240};
+
+    const auto reference = run_scalar<double>(scenario);
+    const auto single    = run_scalar<float>(scenario);
+
+    for (std::size_t i = 0; i < scenario.filters; ++i) {
+        const auto error = (reference[i].x - single[i].x.cast<double>()).head<2>().norm();
+        EXPECT_LT(error, 1e-2) << "filter " << i;
+    }
+}
+
+TEST(batched_ekf, MatchesScalarFilters) {
+    const auto scenario  = Scenario{100, 240};
+    const auto reference = run_scalar<double>(scenario);
+
+    auto batched_double = BatchedRun<double>{scenario};
+    batched_double.run(scenario);
+    auto batched_float = BatchedRun<float>{scenario};
+    batched_float.run(scenario);
+
+    auto max_double = 0.0;
+    auto max_float  = 0.0;
+    auto max_truth  = 0.0;
+    for (std::size_t i = 0; i < scenario.filters; ++i) {
+        const auto& expected = reference[i].x;
+
+        max_double = std::max(max_double, (batched_double.filters.state(i) - expected).norm());
+        max_float  = std::max(
+            max_float, (batched_float.filters.state(i).template cast<double>() - expected)
+                           .head<2>()
+                           .norm());
+
+        const auto last  = (scenario.frames - 1) * scenario.filters + i;
+        const auto truth = Eigen::Vector2d{scenario.truth[last * 2], scenario.truth[last * 2 + 1]};
+        max_truth = std::max(max_truth, (expected.head<2>() - truth).norm());
+
+        EXPECT_LT((batched_double.filters.covariance(i) - reference[i].covariance()).norm(),
+                  1e-6 * reference[i].covariance().norm());
+    }
+
+    std::cout << "max |double batched - scalar| " << max_double << ", float batched position "
+              << max_float << " px, filter vs truth " << max_truth << " px" << std::endl;
+
+    EXPECT_LT(max_double, 1e-6);
+    EXPECT_LT(max_float, 1e-2);
+    EXPECT_LT(max_truth, 5.0 * kNoise);
+}
+
+TEST(batched_ekf, IgnoresMaskedAndIndefinite) {
+    using Batch = BatchedEKF<4, 2, float>;
+
+    auto filters = Batch{};
+    const auto x = Batch::XVec{10.0F, 20.0F, 0.0F, 0.0F};
+    filters.push(x, initial_covariance<float>());
+    filters.push(x, initial_covariance<float>());
+    filters.push(x, initial_covariance<float>());
+
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    // component-major: x of each filter, then y of each filter
+    const auto z    = std::vector<float>{11.0F, nan, 11.0F, 21.0F, nan, 21.0F};
+    const auto mask = std::vector<std::uint8_t>{1, 0, 1};
+
+    // The third filter sees a negative noise larger than its covariance
+    auto R        = Batch::RMat{};
+    R << 1.0F, 0.0F, 0.0F, 1.0F;
+    filters.set(2, x, -10.0F * initial_covariance<float>());
+
+    EXPECT_EQ(filters.update(z, observation<float>(), R, mask), 1U);
+    EXPECT_GT(filters.state(0).x(), 10.5F);
+    EXPECT_EQ(filters.state(1), x);
+    EXPECT_EQ(filters.state(2), x);
+
+    filters.erase(0);
+    EXPECT_EQ(filters.size(), 2U);
+    EXPECT_EQ(filters.state(0), x);
+}
+
+TEST(batched_ekf, Throughput) {
+    const auto scenario = Scenario{1024, 120};
+    const auto updates  = static_cast<double>(scenario.filters * (scenario.frames - 1));
+
+    auto scalar_double = 0.0;
+    auto scalar_float  = 0.0;
+    auto batched_float = 0.0;
+    auto batched_dbl   = 0.0;
+    for (int round = 0; round < 3; ++round) {
+        auto result_double = std::vector<EKF<4, 2, double>>{};
+        auto result_float  = std::vector<EKF<4, 2, float>>{};
+        auto run_float     = BatchedRun<float>{scenario};
+        auto run_double    = BatchedRun<double>{scenario};
+
+        const auto a = seconds([&] { result_double = run_scalar<double>(scenario); });
+        const auto b = seconds([&] { result_float = run_scalar<float>(scenario); });
+        const auto c = seconds([&] { run_float.run(scenario); });
+        const auto d = seconds([&] { run_double.run(scenario); });
+
+        scalar_double = std::max(scalar_double, updates / a);
+        scalar_float  = std::max(scalar_float, updates / b);
+        batched_float = std::max(batched_float, updates / c);
+        batched_dbl   = std::max(batched_dbl, updates / d);
+    }
+
+    std::cout << "filter steps per second: scalar double " << scalar_double << ", scalar float "
+              << scalar_float << ", batched double " << batched_dbl << ", batched float "
+              << batched_float << std::endl;
+}
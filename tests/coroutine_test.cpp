@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "utility/coroutine/executor.hpp"
+#include "utility/coroutine/frame_pool.hpp"
+#include "utility/coroutine/task.hpp"
+
+using pingpong_tracker::util::Executor;
+using pingpong_tracker::util::FramePool;
+using pingpong_tracker::util::sync_wait;
+using pingpong_tracker::util::Task;
+using pingpong_tracker::util::when_all;
+
+namespace {
+
+auto doubled_on(Executor& executor, int value) -> Task<int> {
+    co_await executor.schedule();
+    co_return value * 2;
+}
+
+auto sum_of_doubles(Executor& executor, int count) -> Task<long> {
+    auto sum = 0L;
+    for (int i = 0; i < count; ++i) {
+        sum += co_await doubled_on(executor, i);
+    }
+    co_return sum;
+}
+
+// Allocated on the caller's thread, finishes and is destroyed on `other`
+auto hop(Executor& other, int value) -> Task<int> {
+    co_await other.schedule();
+    co_return value;
+}
+
+}  // namespace
+
+TEST(coroutine, SyncWaitReturnsValue) {
+    auto executor = Executor{2, "test"};
+    EXPECT_EQ(sync_wait(doubled_on(executor, 21)), 42);
+}
+
+TEST(coroutine, ScheduleResumesOnExecutor) {
+    auto executor = Executor{1, "test"};
+
+    auto task = [&]() -> Task<bool> {
+        const auto before = executor.in_this_thread();
+        co_await executor.schedule();
+        co_return !before && executor.in_this_thread();
+    };
+    EXPECT_TRUE(sync_wait(task()));
+}
+
+TEST(coroutine, ScheduleAfterWaitsForDeadline) {
+    using namespace std::chrono_literals;
+    auto executor = Executor{1, "test"};
+
+    auto task = [&]() -> Task<std::chrono::steady_clock::duration> {
+        const auto start = std::chrono::steady_clock::now();
+        co_await executor.schedule_after(5ms);
+        co_return std::chrono::steady_clock::now() - start;
+    };
+    EXPECT_GE(sync_wait(task()), 5ms);
+}
+
+TEST(coroutine, WhenAllRunsPipelinesConcurrently) {
+    auto executor = Executor{4, "test"};
+
+    constexpr auto kPipelines = 8;
+    constexpr auto kSteps     = 1000;
+
+    auto total    = std::atomic<long>{0};
+    auto pipeline = [&]() -> Task<void> {
+        total += co_await sum_of_doubles(executor, kSteps);
+    };
+
+    auto pipelines = std::vector<Task<void>>{};
+    for (int i = 0; i < kPipelines; ++i) {
+        pipelines.push_back(pipeline());
+    }
+    sync_wait(when_all(std::move(pipelines)));
+
+    EXPECT_EQ(total.load(), static_cast<long>(kPipelines) * (kSteps - 1) * kSteps);
+}
+
+TEST(coroutine, ExceptionPropagatesToAwaiter) {
+    auto failing = []() -> Task<int> {
+        throw std::runtime_error{"failure"};
+        co_return 0;
+    };
+    EXPECT_THROW(sync_wait(failing()), std::runtime_error);
+}
+
+TEST(coroutine, FramesReleasedOnAnotherThreadAreReused) {
+    auto workers   = Executor{1, "workers"};
+    auto streaming = Executor{1, "streaming"};
+
+    constexpr auto kRounds = 10000;
+    auto task = [&](int rounds) -> Task<long> {
+        auto sum = 0L;
+        for (int i = 0; i < rounds; ++i) {
+            co_await workers.schedule();
+            sum += co_await hop(streaming, i);
+        }
+        co_return sum;
+    };
+
+    // Warm up both threads' pools, then every round should reuse the frame it gave back
+    sync_wait(task(16));
+    const auto before = FramePool::heap_allocations();
+    EXPECT_EQ(sync_wait(task(kRounds)), static_cast<long>(kRounds - 1) * kRounds / 2);
+    EXPECT_LE(FramePool::heap_allocations() - before, 8U);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "utility/record/detection_file.hpp"
+
+using namespace pingpong_tracker;
+
+namespace {
+
+class DetectionFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::temp_directory_path()
+              / std::format("detection_file_test_{}.bin", ::testing::UnitTest::GetInstance()
+                                                               ->current_test_info()
+                                                               ->name());
+        std::filesystem::remove(path_);
+    }
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    auto open_writer(std::string source = "match.mp4") const {
+        return util::DetectionFileWriter::open({
+            .path         = path_.string(),
+            .source       = std::move(source),
+            .frame_rate   = 120.0,
+            .block_frames = 16,
+            .sync         = false,
+        });
+    }
+
+    // Frame i holds i % 3 balls and one track on odd frames
+    static auto write_frames(util::DetectionFileWriter& writer, std::uint64_t begin,
+                             std::uint64_t end) -> void {
+        for (auto i = begin; i < end; ++i) {
+            auto balls = std::vector<Ball2D>{};
+            for (std::uint64_t k = 0; k < i % 3; ++k) {
+                balls.push_back(Ball2D{
+                    .center     = {static_cast<float>(i), static_cast<float>(k)},
+                    .radius     = 4.0F,
+                    .confidence = 0.5F,
+                });
+            }
+            auto tracks = std::vector<BallTrack2D>{};
+            if (i % 2 == 1) {
+                tracks.push_back(BallTrack2D{
+                    .id       = static_cast<std::uint32_t>(i / 10),
+                    .center   = {static_cast<float>(i), 1.0F},
+                    .velocity = {2.0F, -3.0F},
+                    .radius   = 5.0F,
+                    .coasting = i % 4 == 1,
+                });
+            }
+            ASSERT_TRUE(writer.append(i, static_cast<std::int64_t>(i) * 8'333'333, balls, tracks));
+        }
+    }
+
+    static auto check_frame(const util::DetectionFrame& frame, std::uint64_t i) -> void {
+        EXPECT_EQ(frame.index, i);
+        EXPECT_EQ(frame.timestamp, static_cast<std::int64_t>(i) * 8'333'333);
+        ASSERT_EQ(frame.balls.size(), i % 3);
+        for (std::size_t k = 0; k < frame.balls.size(); ++k) {
+            EXPECT_EQ(frame.balls[k].center.x, static_cast<float>(i));
+            EXPECT_EQ(frame.balls[k].center.y, static_cast<float>(k));
+        }
+        ASSERT_EQ(frame.tracks.size(), i % 2);
+        if (i % 2 == 1) {
+            EXPECT_EQ(frame.tracks[0].id, i / 10);
+            EXPECT_EQ(frame.tracks[0].velocity.y, -3.0F);
+            EXPECT_EQ(frame.tracks[0].coasting, i % 4 == 1);
+        }
+    }
+
+    std::filesystem::path path_;
+};
+
+}  // namespace
+
+TEST_F(DetectionFileTest, RoundTrip) {
+    {
+        auto writer = open_writer();
+        ASSERT_TRUE(writer) << writer.error();
+        EXPECT_EQ(writer->next_frame(), 0U);
+        write_frames(*writer, 0, 100);
+    }
+
+    auto file = util::DetectionFile::open(path_.string());
+    ASSERT_TRUE(file) << file.error();
+    EXPECT_EQ(file->source(), "match.mp4");
+    EXPECT_EQ(file->frame_rate(), 120.0);
+    EXPECT_EQ(file->size(), 100U);
+    EXPECT_EQ(file->blocks().size(), 7U);
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        check_frame(file->frame(i), i);
+    }
+
+    // Columns are scanned without gathering frames
+    auto balls = std::size_t{0};
+    for (const auto& block : file->blocks()) {
+        balls += block.ball_x.size();
+        EXPECT_EQ(block.ball_offset.back(), block.ball_x.size());
+    }
+    EXPECT_EQ(balls, 99U);
+}
+
+TEST_F(DetectionFileTest, ResumeAfterTornBlock) {
+    {
+        auto writer = open_writer();
+        ASSERT_TRUE(writer);
+        write_frames(*writer, 0, 40);
+    }
+    const auto intact = std::filesystem::file_size(path_);
+    {
+        // A run killed while writing leaves a partial block behind
+        auto stream        = std::ofstream{path_, std::ios::binary | std::ios::app};
+        const auto garbage = std::vector<char>(100, '\x42');
+        stream.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+
+    {
+        auto writer = open_writer();
+        ASSERT_TRUE(writer) << writer.error();
+        EXPECT_EQ(writer->next_frame(), 40U);
+        EXPECT_EQ(std::filesystem::file_size(path_), intact);
+        EXPECT_FALSE(writer->append(39, 0, {}, {}));
+        write_frames(*writer, 40, 70);
+    }
+
+    auto file = util::DetectionFile::open(path_.string());
+    ASSERT_TRUE(file);
+    ASSERT_EQ(file->size(), 70U);
+    for (std::uint64_t i = 0; i < 70; ++i) {
+        check_frame(file->frame(i), i);
+    }
+
+    EXPECT_FALSE(open_writer("another.mp4"));
+}
+
+TEST_F(DetectionFileTest, ScanThroughput) {
+    constexpr auto kFrames = std::uint64_t{200'000};
+    {
+        auto writer = open_writer();
+        ASSERT_TRUE(writer);
+        write_frames(*writer, 0, kFrames);
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    auto file        = util::DetectionFile::open(path_.string());
+    ASSERT_TRUE(file);
+    auto sum = 0.0;
+    for (const auto& block : file->blocks()) {
+        for (const auto x : block.ball_x) {
+            sum += x;
+        }
+    }
+    const auto taken = std::chrono::duration<double, std::milli>{
+        std::chrono::steady_clock::now() - begin};
+
+    std::cout << "open and scan " << kFrames << " frames (" << std::filesystem::file_size(path_)
+              << " bytes): " << taken.count() << "ms" << std::endl;
+    EXPECT_EQ(file->size(), kFrames);
+    EXPECT_GT(sum, 0.0);
+}
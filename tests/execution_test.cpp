@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/thread/execution.hpp"
+
+using namespace pingpong_tracker;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto configure(const std::string& text) {
+    return util::execution().configure(YAML::Load(text));
+}
+
+auto profile(const std::string& threads) {
+    return configure(std::format(
+        "{{enable: true, lock_memory: false, prefault: 0, threads: {{{}}}}}", threads));
+}
+
+auto current_cores() -> std::vector<int> {
+    auto set = cpu_set_t{};
+    ::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set);
+    auto cores = std::vector<int>{};
+    for (int core = 0; core < CPU_SETSIZE; ++core) {
+        if (CPU_ISSET(core, &set)) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+// A core the test may run on, cores outside the inherited affinity cannot be taken
+auto first_core() -> int {
+    return current_cores().front();
+}
+
+// Cores isolated from the scheduler with isolcpus, "0-1,4" style
+auto isolated_cores() -> std::vector<int> {
+    auto file  = std::ifstream{"/sys/devices/system/cpu/isolated"};
+    auto line  = std::string{};
+    std::getline(file, line);
+
+    auto ranges = std::istringstream{line};
+    auto cores  = std::vector<int>{};
+    auto range  = std::string{};
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash  = range.find('-');
+        const auto first = std::stoi(range.substr(0, dash));
+        const auto last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int core = first; core <= last; ++core) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+auto current_nice() -> int {
+    return ::getpriority(PRIO_PROCESS, static_cast<id_t>(::gettid()));
+}
+
+auto current_name() -> std::string {
+    char name[16]{};
+    ::pthread_getname_np(::pthread_self(), name, sizeof(name));
+    return name;
+}
+
+// Lateness of 1ms periodic wakeups, sorted
+auto measure_wakeups(const std::string& role, int rounds) -> std::vector<util::Clock::duration> {
+    auto lateness = std::vector<util::Clock::duration>{};
+    lateness.reserve(static_cast<std::size_t>(rounds));
+    auto thread = std::jthread{[&] {
+        util::execution().apply(role);
+        auto next = util::Clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            next += 1ms;
+            std::this_thread::sleep_until(next);
+            lateness.push_back(util::Clock::now() - next);
+        }
+    }};
+    thread.join();
+    std::ranges::sort(lateness);
+    return lateness;
+}
+
+}  // namespace
+
+TEST(execution, RejectsInvalidProfiles) {
+    const auto policy = [](const std::string& fields) {
+        return profile(std::format("worker: {{{}}}", fields));
+    };
+    EXPECT_TRUE(policy("cores: [0], policy: other, priority: 0, nice: 0"));
+
+    EXPECT_FALSE(policy("cores: [100000], policy: other, priority: 0, nice: 0"));
+    EXPECT_FALSE(policy("cores: [-1], policy: other, priority: 0, nice: 0"));
+    EXPECT_FALSE(policy("cores: [], policy: rr, priority: 0, nice: 0"));
+    EXPECT_FALSE(policy("cores: [], policy: fifo, priority: 0, nice: 0"));
+    EXPECT_FALSE(policy("cores: [], policy: fifo, priority: 100, nice: 0"));
+    EXPECT_FALSE(policy("cores: [], policy: other, priority: 0, nice: 20"));
+    EXPECT_FALSE(policy("cores: [], policy: other, priority: 0"));
+    EXPECT_FALSE(configure("{enable: true, lock_memory: false, prefault: 0}"));
+
+    // A rejected profile leaves nothing enabled
+    EXPECT_FALSE(util::execution().enabled());
+}
+
+TEST(execution, DisabledProfileLeavesThreadsAlone) {
+    ASSERT_TRUE(configure("{enable: false}"));
+    EXPECT_FALSE(util::execution().enabled());
+
+    auto thread = std::jthread{[] {
+        const auto cores = current_cores();
+        const auto nice  = current_nice();
+        util::execution().apply("worker");
+        EXPECT_EQ(current_cores(), cores);
+        EXPECT_EQ(current_nice(), nice);
+    }};
+}
+
+TEST(execution, AppliesPolicyToTheCallingThread) {
+    const auto core = first_core();
+    ASSERT_TRUE(profile(
+        std::format("worker: {{cores: [{}], policy: other, priority: 0, nice: 5}}", core)));
+
+    const auto cores = current_cores();
+    auto thread      = std::jthread{[core] {
+        util::execution().apply("worker");
+        EXPECT_EQ(current_cores(), std::vector{core});
+        EXPECT_EQ(current_nice(), 5);
+        EXPECT_EQ(current_name(), "worker");
+
+        // Roles without a policy are left as they are
+        util::execution().apply("unknown");
+        EXPECT_EQ(current_cores(), std::vector{core});
+    }};
+    thread.join();
+
+    // Only the thread that applied it is affected
+    EXPECT_EQ(current_cores(), cores);
+}
+
+TEST(execution, RunAsIsInheritedByNewThreads) {
+    const auto core = first_core();
+    ASSERT_TRUE(profile(
+        std::format("library: {{cores: [{}], policy: other, priority: 0, nice: 3}}", core)));
+
+    auto inherited = std::vector<int>{};
+    auto nice      = 0;
+    util::execution().run_as("library", [&] {
+        // Stands for a pool a library starts while it is being set up
+        auto pool = std::jthread{[&] {
+            inherited = current_cores();
+            nice      = current_nice();
+        }};
+    });
+    EXPECT_EQ(inherited, std::vector{core});
+    EXPECT_EQ(nice, 3);
+
+    EXPECT_THROW(util::execution().run_as("library", [] { throw std::runtime_error{"failed"}; }),
+                 std::runtime_error);
+}
+
+TEST(execution, WakeupLatencyBenchmark) {
+    constexpr int kRounds = 2000;
+
+    // Every core busy, the timer thread competes with them for a CPU
+    auto stop  = std::atomic<bool>{false};
+    auto hogs  = std::vector<std::jthread>{};
+    const auto cpus = std::max(1U, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < cpus; ++i) {
+        hogs.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+            }
+        });
+    }
+
+    ASSERT_TRUE(configure("{enable: false}"));
+    const auto plain = measure_wakeups("timer", kRounds);
+
+    ASSERT_TRUE(profile(std::format("timer: {{cores: [{}], policy: fifo, priority: 90, nice: 0}}",
+                                    first_core())));
+    const auto profiled = measure_wakeups("timer", kRounds);
+
+    stop.store(true, std::memory_order_relaxed);
+    hogs.clear();
+
+    // The hogs inherit the affinity of the test and stay off isolated cores, so this only loads
+    // the rest of the machine, as the tracker would
+    auto isolated = std::vector<util::Clock::duration>{};
+    if (const auto cores = isolated_cores(); !cores.empty()) {
+        stop.store(false, std::memory_order_relaxed);
+        for (unsigned i = 0; i < cpus; ++i) {
+            hogs.emplace_back([&] {
+                while (!stop.load(std::memory_order_relaxed)) {
+                }
+            });
+        }
+        ASSERT_TRUE(profile(std::format(
+            "timer: {{cores: [{}], policy: fifo, priority: 90, nice: 0}}", cores.front())));
+        isolated = measure_wakeups("timer", kRounds);
+        stop.store(true, std::memory_order_relaxed);
+        hogs.clear();
+    }
+
+    const auto quantile = [](const auto& sorted, double q) {
+        const auto index = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1));
+        return std::chrono::duration<double, std::micro>(sorted[index]).count();
+    };
+    const auto line = [&](const char* name, const auto& sorted) {
+        return std::format("{}: p50 {:.0f}us p99 {:.0f}us p999 {:.0f}us max {:.0f}us\n", name,
+                           quantile(sorted, 0.5), quantile(sorted, 0.99),
+                           quantile(sorted, 0.999), quantile(sorted, 1.0));
+    };
+    std::cout << "1ms wakeup lateness with every core busy\n"
+              << line("  default scheduling", plain)
+              << line("  pinned SCHED_FIFO 90", profiled)
+              << (isolated.empty() ? std::string{"  isolated core: none isolated, not measured\n"}
+                                   : line("  isolated core SCHED_FIFO 90", isolated));
+    ASSERT_TRUE(configure("{enable: false}"));
+}
@@ -0,0 +1,385 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/publish/frame_bus.hpp"
+
+using namespace pingpong_tracker;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int kRows = 480;
+constexpr int kCols = 640;
+
+constexpr std::size_t kFrameBytes = std::size_t{kRows} * kCols * 3;
+
+auto unique_name() -> std::string {
+    return std::format("/frame_bus_test_{}_{}", ::getpid(),
+                       ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+// Every byte holds the low byte of the frame index, the first eight the whole index
+class Frame {
+public:
+    auto fill(std::uint64_t index) -> const cv::Mat& {
+        std::memset(pixels_.data(), static_cast<int>(index & 0xFF), pixels_.size());
+        std::memcpy(pixels_.data(), &index, sizeof(index));
+        return mat_;
+    }
+
+    static auto matches(std::span<const std::byte> bytes, std::uint64_t index) -> bool {
+        if (bytes.size() != kFrameBytes) {
+            return false;
+        }
+        auto stored = std::uint64_t{0};
+        std::memcpy(&stored, bytes.data(), sizeof(stored));
+        if (stored != index) {
+            return false;
+        }
+        for (std::size_t i = sizeof(stored); i < bytes.size(); i += 997) {
+            if (bytes[i] != static_cast<std::byte>(index & 0xFF)) {
+                return false;
+            }
+        }
+        return bytes.back() == static_cast<std::byte>(index & 0xFF);
+    }
+
+private:
+    std::vector<std::uint8_t> pixels_ = std::vector<std::uint8_t>(kFrameBytes);
+    cv::Mat mat_{kRows, kCols, CV_8UC3, pixels_.data()};
+};
+
+auto open_writer(std::uint32_t slots) {
+    return util::FrameBusWriter::open(unique_name(), slots, kFrameBytes);
+}
+
+}  // namespace
+
+TEST(frame_bus, RoundTrip) {
+    auto writer = open_writer(4);
+    ASSERT_TRUE(writer) << writer.error();
+    auto reader = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(reader) << reader.error();
+
+    auto view = util::FrameView{};
+    EXPECT_EQ(reader->next(view), util::FrameBusReader::Status::EMPTY);
+
+    auto frame     = Frame{};
+    const auto now = util::Clock::now();
+    ASSERT_TRUE(writer->publish(frame.fill(0), now));
+
+    ASSERT_EQ(reader->next(view), util::FrameBusReader::Status::FRAME);
+    EXPECT_EQ(view.index(), 0U);
+    EXPECT_EQ(view.timestamp(), now);
+    EXPECT_TRUE(Frame::matches(view.bytes(), 0));
+    EXPECT_TRUE(view.intact());
+
+    const auto mat = view.mat();
+    EXPECT_EQ(mat.rows, kRows);
+    EXPECT_EQ(mat.cols, kCols);
+    EXPECT_EQ(mat.type(), CV_8UC3);
+    EXPECT_EQ(static_cast<const void*>(mat.data), static_cast<const void*>(view.bytes().data()));
+
+    EXPECT_EQ(reader->next(view), util::FrameBusReader::Status::EMPTY);
+    EXPECT_TRUE(view.empty());
+}
+
+TEST(frame_bus, ReaderSkipsToTheNewestFrame) {
+    auto writer = open_writer(4);
+    ASSERT_TRUE(writer) << writer.error();
+    auto reader = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(reader) << reader.error();
+
+    auto frame = Frame{};
+    for (std::uint64_t i = 0; i < 6; ++i) {
+        ASSERT_TRUE(writer->publish(frame.fill(i), util::Clock::now()));
+    }
+
+    auto view = util::FrameView{};
+    ASSERT_EQ(reader->next(view), util::FrameBusReader::Status::FRAME);
+    EXPECT_EQ(view.index(), 5U);
+    EXPECT_TRUE(Frame::matches(view.bytes(), 5));
+    EXPECT_EQ(reader->lost(), 5U);
+}
+
+TEST(frame_bus, HeldSlotIsNotReused) {
+    auto writer = open_writer(3);
+    ASSERT_TRUE(writer) << writer.error();
+    auto reader = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(reader) << reader.error();
+
+    auto frame = Frame{};
+    ASSERT_TRUE(writer->publish(frame.fill(0), util::Clock::now()));
+    auto view = util::FrameView{};
+    ASSERT_EQ(reader->next(view), util::FrameBusReader::Status::FRAME);
+
+    // The other two slots take turns
+    for (std::uint64_t i = 1; i < 20; ++i) {
+        ASSERT_TRUE(writer->publish(frame.fill(i), util::Clock::now()));
+    }
+    EXPECT_TRUE(view.intact());
+    EXPECT_TRUE(Frame::matches(view.bytes(), 0));
+    EXPECT_EQ(writer->overwritten(), 0U);
+
+    // Released by taking the next frame
+    ASSERT_EQ(reader->next(view), util::FrameBusReader::Status::FRAME);
+    EXPECT_EQ(view.index(), 19U);
+}
+
+TEST(frame_bus, OverwritesWhenEverySlotIsHeld) {
+    auto writer = open_writer(2);
+    ASSERT_TRUE(writer) << writer.error();
+    auto first = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(first) << first.error();
+
+    auto frame      = Frame{};
+    auto first_view = util::FrameView{};
+    ASSERT_TRUE(writer->publish(frame.fill(0), util::Clock::now()));
+    ASSERT_EQ(first->next(first_view), util::FrameBusReader::Status::FRAME);
+
+    ASSERT_TRUE(writer->publish(frame.fill(1), util::Clock::now()));
+    auto second = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(second) << second.error();
+    auto second_view = util::FrameView{};
+    ASSERT_EQ(second->next(second_view), util::FrameBusReader::Status::FRAME);
+    EXPECT_EQ(second_view.index(), 1U);
+
+    // Capture never waits for readers
+    ASSERT_TRUE(writer->publish(frame.fill(2), util::Clock::now()));
+    EXPECT_EQ(writer->overwritten(), 1U);
+    EXPECT_FALSE(first_view.intact());
+    EXPECT_TRUE(second_view.intact());
+}
+
+TEST(frame_bus, RejectsFramesThatDoNotFit) {
+    auto writer = util::FrameBusWriter::open(unique_name(), 2, 1024);
+    ASSERT_TRUE(writer) << writer.error();
+
+    auto frame = Frame{};
+    EXPECT_FALSE(writer->publish(frame.fill(0), util::Clock::now()));
+    EXPECT_FALSE(writer->publish(cv::Mat{}, util::Clock::now()));
+    EXPECT_FALSE(util::FrameBusWriter::open(unique_name(), 1, 1024));
+}
+
+TEST(frame_bus, RefusesAnExistingSegmentUnlessTakingOver) {
+    auto opened = open_writer(2);
+    ASSERT_TRUE(opened) << opened.error();
+    auto first = std::optional{std::move(*opened)};
+    EXPECT_FALSE(open_writer(2));
+
+    auto second = util::FrameBusWriter::open(unique_name(), 2, kFrameBytes, true);
+    ASSERT_TRUE(second) << second.error();
+
+    // The replaced writer leaves the name of its successor alone
+    first.reset();
+    auto reader = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(reader) << reader.error();
+    auto frame = Frame{};
+    ASSERT_TRUE(second->publish(frame.fill(0), util::Clock::now()));
+    auto view = util::FrameView{};
+    EXPECT_EQ(reader->next(view), util::FrameBusReader::Status::FRAME);
+}
+
+TEST(frame_bus, ShapeAgreesWithBytesWhileSizesAlternate) {
+    constexpr std::uint64_t kFrames = 5000;
+
+    auto writer = open_writer(2);
+    ASSERT_TRUE(writer) << writer.error();
+    auto pinning = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(pinning) << pinning.error();
+    auto reader = util::FrameBusReader::open(unique_name());
+    ASSERT_TRUE(reader) << reader.error();
+
+    // One slot stays pinned, so publishing overwrites whatever the other reader is taking
+    auto large = Frame{};
+    auto small = cv::Mat{kRows / 4, kCols / 2, CV_8UC3};
+    ASSERT_TRUE(writer->publish(large.fill(0), util::Clock::now()));
+    auto pinned = util::FrameView{};
+    ASSERT_EQ(pinning->next(pinned), util::FrameBusReader::Status::FRAME);
+
+    auto done  = std::atomic<bool>{false};
+    auto publisher = std::thread{[&] {
+        for (std::uint64_t i = 1; i < kFrames; ++i) {
+            const auto& mat = i % 2 == 0 ? large.fill(i) : small;
+            [[maybe_unused]] const auto published = writer->publish(mat, util::Clock::now());
+        }
+        done.store(true, std::memory_order_release);
+    }};
+
+    auto frames       = std::uint64_t{0};
+    auto inconsistent = std::uint64_t{0};
+    auto view         = util::FrameView{};
+    while (!done.load(std::memory_order_acquire)) {
+        if (reader->next(view) != util::FrameBusReader::Status::FRAME) {
+            continue;
+        }
+        ++frames;
+        const auto mat = view.mat();
+        if (mat.empty() || mat.total() * mat.elemSize() != view.bytes().size()) {
+            ++inconsistent;
+        }
+    }
+    publisher.join();
+
+    std::cout << std::format("frames {}, overwritten {}, lost {}\n", frames,
+                             writer->overwritten(), reader->lost());
+    EXPECT_EQ(inconsistent, 0U);
+}
+
+TEST(frame_bus, ReportsClosedWriter) {
+    auto reader = std::optional<util::FrameBusReader>{};
+    {
+        auto writer = open_writer(2);
+        ASSERT_TRUE(writer) << writer.error();
+        auto result = util::FrameBusReader::open(unique_name());
+        ASSERT_TRUE(result) << result.error();
+        reader.emplace(std::move(*result));
+
+        auto frame = Frame{};
+        ASSERT_TRUE(writer->publish(frame.fill(0), util::Clock::now()));
+    }
+
+    // Frames published before closing are still readable
+    auto view = util::FrameView{};
+    EXPECT_EQ(reader->next(view), util::FrameBusReader::Status::FRAME);
+    EXPECT_TRUE(Frame::matches(view.bytes(), 0));
+    EXPECT_EQ(reader->next(view), util::FrameBusReader::Status::CLOSED);
+    EXPECT_FALSE(util::FrameBusReader::open(unique_name()));
+}
+
+TEST(frame_bus, MultipleReaderProcesses) {
+    constexpr int kReaders           = 3;
+    constexpr std::uint64_t kFrames  = 3000;
+    constexpr auto kPublishInterval  = 200us;
+    constexpr auto kSlowReaderHold   = 2ms;
+
+    struct Result {
+        std::uint64_t frames       = 0;
+        std::uint64_t lost         = 0;
+        std::uint64_t torn         = 0;
+        std::uint64_t overwritten  = 0;
+        std::int64_t latency_total = 0;
+        std::int64_t latency_max   = 0;
+    };
+
+    // Taken before forking, the name contains the process id
+    const auto name = unique_name();
+    auto opened     = util::FrameBusWriter::open(name, 8, kFrameBytes);
+    ASSERT_TRUE(opened) << opened.error();
+    auto writer = std::optional{std::move(*opened)};
+
+    auto results = std::array<int, 2>{};
+    auto ready   = std::array<int, 2>{};
+    ASSERT_EQ(::pipe(results.data()), 0);
+    ASSERT_EQ(::pipe(ready.data()), 0);
+
+    auto children = std::vector<pid_t>{};
+    for (int k = 0; k < kReaders; ++k) {
+        const auto pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid != 0) {
+            children.push_back(pid);
+            continue;
+        }
+
+        // Reader process, reader 0 holds every frame for a while
+        auto reader = util::FrameBusReader::open(name);
+        auto result = Result{};
+        const auto signal = char{1};
+        [[maybe_unused]] auto written = ::write(ready[1], &signal, 1);
+        if (reader) {
+            auto view = util::FrameView{};
+            for (;;) {
+                const auto status = reader->next(view);
+                if (status == util::FrameBusReader::Status::CLOSED) {
+                    break;
+                }
+                if (status == util::FrameBusReader::Status::EMPTY) {
+                    std::this_thread::sleep_for(20us);
+                    continue;
+                }
+                const auto latency = (util::Clock::now() - view.timestamp()).count();
+                result.latency_total += latency;
+                result.latency_max = std::max(result.latency_max, latency);
+                ++result.frames;
+
+                if (k == 0) {
+                    std::this_thread::sleep_for(kSlowReaderHold);
+                }
+                const auto matches = Frame::matches(view.bytes(), view.index());
+                if (!view.intact()) {
+                    ++result.overwritten;
+                } else if (!matches) {
+                    ++result.torn;
+                }
+            }
+            result.lost = reader->lost();
+        }
+        written = ::write(results[1], &result, sizeof(result));
+        ::_exit(reader ? 0 : 1);
+    }
+
+    for (int k = 0; k < kReaders; ++k) {
+        auto signal = char{};
+        ASSERT_EQ(::read(ready[0], &signal, 1), 1);
+    }
+
+    auto frame          = Frame{};
+    auto publish_total  = util::Clock::duration{};
+    const auto begin    = util::Clock::now();
+    for (std::uint64_t i = 0; i < kFrames; ++i) {
+        const auto& mat = frame.fill(i);
+        const auto now  = util::Clock::now();
+        ASSERT_TRUE(writer->publish(mat, now));
+        publish_total += util::Clock::now() - now;
+        std::this_thread::sleep_until(begin + kPublishInterval * (i + 1));
+    }
+    const auto elapsed = std::chrono::duration<double>(util::Clock::now() - begin).count();
+    const auto overwritten = writer->overwritten();
+    writer.reset();
+
+    for (int k = 0; k < kReaders; ++k) {
+        auto result = Result{};
+        ASSERT_EQ(::read(results[0], &result, sizeof(result)),
+                  static_cast<ssize_t>(sizeof(result)));
+        EXPECT_GT(result.frames, 0U);
+        EXPECT_EQ(result.torn, 0U);
+        EXPECT_EQ(result.frames + result.lost, kFrames);
+        std::cout << std::format(
+            "Reader: {} frames, {} skipped, {} overwritten while held, latency avg {:.1f}us max "
+            "{:.1f}us\n",
+            result.frames, result.lost, result.overwritten,
+            static_cast<double>(result.latency_total) / static_cast<double>(result.frames) / 1e3,
+            static_cast<double>(result.latency_max) / 1e3);
+    }
+    for (const auto pid : children) {
+        auto status = 0;
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    for (const auto fd : {results[0], results[1], ready[0], ready[1]}) {
+        ::close(fd);
+    }
+
+    const auto megabytes = static_cast<double>(kFrameBytes * kFrames) / (1 << 20);
+    std::cout << std::format(
+        "Writer: {:.0f} frames/s, {:.0f} MiB/s, publish {:.1f}us per {}x{} frame, {} slots "
+        "overwritten\n",
+        kFrames / elapsed, megabytes / elapsed,
+        std::chrono::duration<double, std::micro>(publish_total).count() / kFrames, kCols, kRows,
+        overwritten);
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+#include "module/identifier/ball_detection.hpp"
+#include "module/identifier/heatmap_decode.hpp"
+#include "utility/image/image.details.hpp"
+
+using pingpong_tracker::Image;
+using pingpong_tracker::identifier::BallDetection;
+using pingpong_tracker::identifier::HeatmapDecoder;
+using pingpong_tracker::identifier::HeatmapPeak;
+
+namespace {
+
+struct Blob {
+    float x;
+    float y;
+    float sigma;
+    float amplitude;
+};
+
+auto render_heatmap(int rows, int cols, const std::vector<Blob>& blobs) -> std::vector<float> {
+    auto heatmap = std::vector<float>(static_cast<std::size_t>(rows * cols), 0.0F);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            auto& value = heatmap[static_cast<std::size_t>(r * cols + c)];
+            for (const auto& blob : blobs) {
+                const auto dx = static_cast<float>(c) - blob.x;
+                const auto dy = static_cast<float>(r) - blob.y;
+                value = std::max(value, blob.amplitude
+                                            * std::exp(-(dx * dx + dy * dy)
+                                                       / (2.0F * blob.sigma * blob.sigma)));
+            }
+        }
+    }
+    return heatmap;
+}
+
+}  // namespace
+
+TEST(heatmap, DecodesPeaksWithSubpixelAccuracy) {
+    constexpr auto kRows = 288;
+    constexpr auto kCols = 512;
+
+    const auto blobs = std::vector<Blob>{
+        {100.3F, 50.7F, 2.5F, 0.95F},
+        {400.6F, 200.2F, 3.0F, 0.80F},
+        {0.0F, 287.0F, 2.0F, 0.70F},
+    };
+    const auto heatmap = render_heatmap(kRows, kCols, blobs);
+
+    auto decoder = HeatmapDecoder{};
+    auto peaks   = std::vector<HeatmapPeak>{};
+    decoder.decode(heatmap, kRows, kCols, {.threshold = 0.5F, .min_distance = 4.0F}, peaks);
+
+    ASSERT_EQ(peaks.size(), blobs.size());
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        EXPECT_NEAR(peaks[i].x, blobs[i].x, 0.1F);
+        EXPECT_NEAR(peaks[i].y, blobs[i].y, 0.1F);
+        EXPECT_NEAR(peaks[i].score, blobs[i].amplitude, 0.05F);
+    }
+}
+
+TEST(heatmap, IgnoresPeaksBelowThreshold) {
+    const auto heatmap = render_heatmap(64, 64, {{32.0F, 32.0F, 2.0F, 0.3F}});
+
+    auto decoder = HeatmapDecoder{};
+    auto peaks   = std::vector<HeatmapPeak>{};
+    decoder.decode(heatmap, 64, 64, {.threshold = 0.5F}, peaks);
+    EXPECT_TRUE(peaks.empty());
+}
+
+TEST(heatmap, MergesPlateaus) {
+    auto heatmap = std::vector<float>(32 * 32, 0.0F);
+    for (int r = 10; r < 13; ++r) {
+        for (int c = 10; c < 13; ++c) {
+            heatmap[static_cast<std::size_t>(r * 32 + c)] = 1.0F;
+        }
+    }
+
+    auto decoder = HeatmapDecoder{};
+    auto peaks   = std::vector<HeatmapPeak>{};
+    decoder.decode(heatmap, 32, 32, {.threshold = 0.5F, .min_distance = 4.0F}, peaks);
+    EXPECT_EQ(peaks.size(), 1);
+}
+
+TEST(heatmap, DecodeLatency) {
+    constexpr auto kRows       = 288;
+    constexpr auto kCols       = 512;
+    constexpr auto kIterations = 200;
+
+    const auto heatmap = render_heatmap(kRows, kCols, {{100.0F, 50.0F, 2.5F, 0.9F}});
+
+    auto decoder = HeatmapDecoder{};
+    auto peaks   = std::vector<HeatmapPeak>{};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        decoder.decode(heatmap, kRows, kCols, {}, peaks);
+    }
+    const auto elapsed = std::chrono::duration<double, std::micro>(
+                             std::chrono::steady_clock::now() - start)
+                             .count()
+                       / kIterations;
+
+    std::cout << "heatmap decode " << kRows << "x" << kCols << ": " << elapsed << " us\n";
+    EXPECT_EQ(peaks.size(), 1);
+}
+
+// Latency and recall of both backends on a sequence made from the shared model test image, each
+// frame shifted a little further so the ball moves and no two frames are the same. Skipped unless
+// both models are available under TEST_MODELS_ROOT
+TEST(heatmap, CompareWithYoloBackend) {
+    const auto get_path = [](const char* env_var, std::filesystem::path fallback) {
+        if (const auto env = std::getenv(env_var))
+            return std::filesystem::path(env);
+        return fallback;
+    };
+    const auto assets_root = get_path("TEST_ASSETS_ROOT", "/tmp/pingpong_tracker");
+    const auto models_root = get_path("TEST_MODELS_ROOT", std::filesystem::path{PROJECT_ROOT} / "models");
+
+    const auto yolo_model    = models_root / "yolov8.onnx";
+    const auto heatmap_model = models_root / "tracknet.onnx";
+    const auto image_path    = assets_root / "pingpong.png";
+    if (!std::filesystem::exists(yolo_model) || !std::filesystem::exists(heatmap_model)
+        || !std::filesystem::exists(image_path)) {
+        GTEST_SKIP() << "Models or test image missing";
+    }
+
+    const auto origin = cv::imread(image_path.string());
+
+    auto config               = YAML::Node{};
+    config["model_location"]  = yolo_model.string();
+    config["infer_device"]    = "CPU";
+    config["input_rows"]      = 800;
+    config["input_cols"]      = 800;
+    config["score_threshold"] = 0.5;
+    config["nms_threshold"]   = 0.45;
+
+    auto heatmap                       = YAML::Node{};
+    heatmap["model_location"]          = heatmap_model.string();
+    heatmap["infer_device"]            = "CPU";
+    heatmap["input_rows"]              = 288;
+    heatmap["input_cols"]              = 512;
+    heatmap["frames"]                  = 3;
+    heatmap["score_threshold"]         = 0.5;
+    heatmap["min_distance"]            = 8.0;
+    heatmap["ball_radius"]             = 20.0;
+    config["heatmap"]                  = heatmap;
+
+    constexpr auto kIterations = 20;
+    constexpr auto kExpectedX  = 596.0F;
+    constexpr auto kExpectedY  = 343.0F;
+    constexpr auto kTolerance  = 10.0F;
+    constexpr auto kStepX      = 4.0F;
+    constexpr auto kStepY      = 2.0F;
+
+    auto frames = std::vector<Image>(kIterations);
+    for (int i = 0; i < kIterations; ++i) {
+        const auto shift = cv::Matx23f{1, 0, kStepX * i, 0, 1, kStepY * i};
+        auto shifted     = cv::Mat{};
+        cv::warpAffine(origin, shifted, shift, origin.size(), cv::INTER_LINEAR,
+                       cv::BORDER_REPLICATE);
+        frames[i].details().set_mat(shifted);
+    }
+
+    for (const auto* backend : {"yolo", "heatmap"}) {
+        config["backend"] = backend;
+
+        auto detection = BallDetection{};
+        ASSERT_TRUE(detection.initialize(config).has_value()) << backend;
+
+        auto recalled = 0;
+        auto total_us = 0.0;
+        for (int i = 0; i < kIterations; ++i) {
+            const auto start  = std::chrono::steady_clock::now();
+            const auto result = detection.sync_detect(frames[i]);
+            total_us += std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+
+            ASSERT_TRUE(result.has_value()) << backend << ": " << result.error();
+            const auto expected_x = kExpectedX + kStepX * static_cast<float>(i);
+            const auto expected_y = kExpectedY + kStepY * static_cast<float>(i);
+            for (const auto& ball : *result) {
+                if (std::hypot(ball.center.x - expected_x, ball.center.y - expected_y)
+                    < kTolerance) {
+                    ++recalled;
+                    break;
+                }
+            }
+        }
+
+        std::cout << backend << ": latency " << total_us / kIterations << " us, recall "
+                  << static_cast<double>(recalled) / kIterations << '\n';
+    }
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "module/tracker/ball_tracker.hpp"
+#include "module/tracker/imm_tracker.hpp"
+
+using pingpong_tracker::tracker::BallTracker;
+using pingpong_tracker::tracker::ImmTracker;
+using pingpong_tracker::tracker::MotionMode;
+using pingpong_tracker::tracker::TrackState;
+using Clock = pingpong_tracker::util::Clock;
+
+namespace {
+
+using Imm2D    = ImmTracker<2>;
+using Single2D = BallTracker<2>;
+using ZVec     = Imm2D::ZVec;
+
+constexpr double kRate    = 240.0;
+constexpr double kGravity = 2000.0;
+constexpr double kTable   = 700.0;
+
+auto make_single_config() -> Single2D::Config {
+    auto config                 = Single2D::Config{};
+    config.model.gravity        = {0.0, kGravity};
+    config.process_noise        = 1e4;
+    config.measurement_noise    = 2.0;
+    config.initial_velocity_std = 2e3;
+    config.gate_threshold       = 9.21;
+    config.max_coast            = 5;
+    return config;
+}
+
+auto make_imm_config() -> Imm2D::Config {
+    auto config                 = Imm2D::Config{};
+    config.model.gravity        = {0.0, kGravity};
+    config.process_noise        = 1e4;
+    config.bounce_velocity_std  = 1500.0;
+    config.roll_process_noise   = 1e3;
+    config.roll_damping         = 30.0;
+    config.measurement_noise    = 2.0;
+    config.initial_velocity_std = 2e3;
+    config.gate_threshold       = 9.21;
+    config.max_coast            = 5;
+    return config;
+}
+
+auto at_seconds(Clock::time_point origin, double t) -> Clock::time_point {
+    return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+}
+
+// A serve in image space: two table bounces, then the ball rests on the table
+struct Rally {
+    std::vector<ZVec> truth;
+    std::vector<ZVec> measurements;
+    std::vector<std::size_t> bounces;
+    std::size_t rest = 0;
+
+    explicit Rally(unsigned seed) {
+        auto random = std::mt19937{seed};
+        auto noise  = std::normal_distribution<double>{0.0, 2.0};
+
+        const auto dt = 1.0 / kRate;
+        auto position = ZVec{100.0, 500.0};
+        auto velocity = ZVec{600.0, 0.0};
+        for (int i = 0; i < 400; ++i) {
+            truth.push_back(position);
+            measurements.push_back(position + ZVec{noise(random), noise(random)});
+
+            if (bounces.size() < 2) {
+                velocity.y() += kGravity * dt;
+                position += velocity * dt;
+                if (position.y() > kTable) {
+                    // Reflect about the table line, restitution 0.85
+                    position.y() = 2.0 * kTable - position.y();
+                    velocity.y() = -0.85 * velocity.y();
+                    bounces.push_back(truth.size());
+                    if (bounces.size() == 2) {
+                        position.y() = kTable;
+                        velocity     = {0.0, 0.0};
+                        rest         = truth.size();
+                    }
+                }
+            }
+        }
+    }
+};
+
+struct Errors {
+    double near_bounce = 0.0;
+    double overall     = 0.0;
+    std::size_t lost   = 0;
+};
+
+template <typename Tracker>
+auto run(Tracker tracker, Rally const& rally, std::vector<MotionMode>* modes = nullptr)
+    -> Errors {
+    const auto origin = Clock::now();
+
+    auto errors        = Errors{};
+    auto near_count    = 0;
+    auto overall_count = 0;
+    for (std::size_t i = 0; i < rally.truth.size(); ++i) {
+        const auto candidates = std::vector<ZVec>{rally.measurements[i]};
+        tracker.update(at_seconds(origin, static_cast<double>(i) / kRate), candidates);
+
+        const auto& snapshot = tracker.snapshot();
+        if (snapshot.state == TrackState::LOST) {
+            ++errors.lost;
+            continue;
+        }
+        if constexpr (requires { snapshot.mode(); }) {
+            if (modes != nullptr) {
+                modes->push_back(snapshot.mode());
+            }
+        }
+
+        const auto error = (snapshot.x.template head<2>() - rally.truth[i]).squaredNorm();
+        errors.overall += error;
+        ++overall_count;
+        const auto near = std::ranges::any_of(rally.bounces, [&](std::size_t bounce) {
+            return i + 2 >= bounce && i < bounce + 8;
+        });
+        if (near) {
+            errors.near_bounce += error;
+            ++near_count;
+        }
+    }
+    errors.overall     = std::sqrt(errors.overall / overall_count);
+    errors.near_bounce = std::sqrt(errors.near_bounce / near_count);
+    return errors;
+}
+
+}  // namespace
+
+TEST(imm_tracker, FollowsBouncesBetterThanSingleModel) {
+    auto imm_near    = 0.0;
+    auto single_near = 0.0;
+    auto imm_lost    = std::size_t{0};
+    auto single_lost = std::size_t{0};
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        const auto rally  = Rally{seed};
+        const auto imm    = run(Imm2D{make_imm_config()}, rally);
+        const auto single = run(Single2D{make_single_config()}, rally);
+
+        imm_near += imm.near_bounce / 10.0;
+        single_near += single.near_bounce / 10.0;
+        imm_lost += imm.lost;
+        single_lost += single.lost;
+    }
+
+    std::cout << "RMS error around bounces: imm " << imm_near << "px, single " << single_near
+              << "px; frames lost: imm " << imm_lost << ", single " << single_lost << std::endl;
+    EXPECT_EQ(imm_lost, 0U);
+    EXPECT_LT(imm_near, single_near);
+}
+
+TEST(imm_tracker, ModeProbabilitiesFollowThePhase) {
+    const auto rally = Rally{1};
+    auto modes       = std::vector<MotionMode>{};
+    const auto imm   = run(Imm2D{make_imm_config()}, rally, &modes);
+    ASSERT_EQ(imm.lost, 0U);
+    ASSERT_EQ(modes.size(), rally.truth.size());
+
+    // Well before the first bounce the ball is in flight
+    const auto first = rally.bounces.front();
+    for (std::size_t i = 20; i + 5 < first; ++i) {
+        EXPECT_EQ(modes[i], MotionMode::FLIGHT) << "frame " << i;
+    }
+
+    // The bounce mode takes over right after the impact
+    auto bounce_seen = false;
+    for (auto i = first; i < first + 3; ++i) {
+        bounce_seen = bounce_seen || modes[i] == MotionMode::BOUNCE;
+    }
+    EXPECT_TRUE(bounce_seen);
+
+    // Resting on the table, the ROLL mode wins
+    for (auto i = rally.rest + 30; i < modes.size(); ++i) {
+        EXPECT_EQ(modes[i], MotionMode::ROLL) << "frame " << i;
+    }
+}
+
+TEST(imm_tracker, CostPerUpdate) {
+    const auto rally  = Rally{3};
+    const auto origin = Clock::now();
+
+    auto time = [&](auto tracker) {
+        auto candidates = std::vector<ZVec>(1);
+        auto best       = std::chrono::nanoseconds::max();
+        for (int round = 0; round < 5; ++round) {
+            tracker.reset();
+            const auto begin = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < rally.truth.size(); ++i) {
+                candidates[0] = rally.measurements[i];
+                tracker.update(at_seconds(origin, static_cast<double>(i) / kRate), candidates);
+            }
+            best = std::min(best, std::chrono::steady_clock::now() - begin);
+        }
+        return best / rally.truth.size();
+    };
+
+    const auto imm    = time(Imm2D{make_imm_config()});
+    const auto single = time(Single2D{make_single_config()});
+    std::cout << "per update: imm " << imm.count() << "ns, single " << single.count() << "ns"
+              << std::endl;
+}
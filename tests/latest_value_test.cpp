@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "utility/thread/latest_value.hpp"
+
+using pingpong_tracker::util::LatestValue;
+
+namespace {
+
+// Every field derives from `sequence`, a torn copy mixes two of them
+struct Payload {
+    std::uint64_t sequence = 0;
+    std::array<double, 12> fields{};
+    std::int64_t timestamp = 0;
+};
+
+auto make_payload(std::uint64_t sequence) -> Payload {
+    auto payload     = Payload{.sequence = sequence};
+    payload.timestamp = static_cast<std::int64_t>(sequence) * 1000;
+    for (std::size_t i = 0; i < payload.fields.size(); ++i) {
+        payload.fields[i] = static_cast<double>(sequence) * static_cast<double>(i + 1);
+    }
+    return payload;
+}
+
+auto consistent(Payload const& payload) -> bool {
+    if (payload.timestamp != static_cast<std::int64_t>(payload.sequence) * 1000) {
+        return false;
+    }
+    for (std::size_t i = 0; i < payload.fields.size(); ++i) {
+        if (payload.fields[i] != static_cast<double>(payload.sequence) * static_cast<double>(i + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(latest_value, EmptyUntilPublished) {
+    auto value = LatestValue<Payload>{};
+    EXPECT_FALSE(value.load().has_value());
+    EXPECT_EQ(value.version(), 0U);
+
+    for (std::uint64_t i = 1; i <= 10; ++i) {
+        value.publish(make_payload(i));
+    }
+    const auto loaded = value.load();
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->sequence, 10U);
+    EXPECT_TRUE(consistent(*loaded));
+    EXPECT_EQ(value.version(), 10U);
+}
+
+TEST(latest_value, ConcurrentReadersSeeConsistentSnapshots) {
+    constexpr auto kReaders      = 4;
+    constexpr auto kPublications = std::uint64_t{200'000};
+
+    auto value   = LatestValue<Payload>{};
+    auto running = std::atomic<bool>{true};
+    auto torn    = std::atomic<std::size_t>{0};
+    auto regress = std::atomic<std::size_t>{0};
+    auto reads   = std::atomic<std::size_t>{0};
+
+    auto readers = std::vector<std::thread>{};
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&] {
+            auto previous = std::uint64_t{0};
+            auto count    = std::size_t{0};
+            while (running.load(std::memory_order_relaxed)) {
+                const auto loaded = value.load();
+                if (!loaded) {
+                    continue;
+                }
+                if (!consistent(*loaded)) {
+                    torn.fetch_add(1);
+                }
+                if (loaded->sequence < previous) {
+                    regress.fetch_add(1);
+                }
+                previous = loaded->sequence;
+                ++count;
+            }
+            reads.fetch_add(count);
+        });
+    }
+
+    for (std::uint64_t i = 1; i <= kPublications; ++i) {
+        value.publish(make_payload(i));
+    }
+    running.store(false);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0U);
+    EXPECT_EQ(regress.load(), 0U);
+    EXPECT_GT(reads.load(), 0U);
+    EXPECT_EQ(value.load()->sequence, kPublications);
+}
+
+TEST(latest_value, ReadLatency) {
+    auto value = LatestValue<Payload>{};
+    value.publish(make_payload(1));
+
+    // A writer at far beyond camera rate, readers at a 1 kHz control loop would see less
+    auto running = std::atomic<bool>{true};
+    auto writer  = std::thread{[&] {
+        auto sequence = std::uint64_t{2};
+        while (running.load(std::memory_order_relaxed)) {
+            value.publish(make_payload(sequence++));
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+        }
+    }};
+
+    constexpr auto kBatch = 1000;
+    auto costs            = std::vector<std::chrono::nanoseconds>{};
+    auto checksum         = std::uint64_t{0};
+    for (int round = 0; round < 1001; ++round) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < kBatch; ++i) {
+            checksum += value.load()->sequence;
+        }
+        const auto cost = std::chrono::steady_clock::now() - begin;
+        costs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(cost) / kBatch);
+    }
+    running.store(false);
+    writer.join();
+
+    std::ranges::sort(costs);
+    const auto median = costs[costs.size() / 2];
+    std::cout << "load: median " << median.count() << "ns, p99 "
+              << costs[costs.size() * 99 / 100].count() << "ns (checksum " << checksum % 10 << ")"
+              << std::endl;
+    EXPECT_LT(median, std::chrono::microseconds{1});
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <time.h>
+
+#include <boost/lockfree/spsc_queue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/thread/mailbox.hpp"
+
+using namespace pingpong_tracker;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Frame {
+    int index = 0;
+    util::Clock::time_point pushed;
+};
+
+auto thread_cpu_time() -> std::chrono::nanoseconds {
+    auto spec = timespec{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &spec);
+    return std::chrono::seconds{spec.tv_sec} + std::chrono::nanoseconds{spec.tv_nsec};
+}
+
+// Stands for the encoder, slower than the camera
+auto encode() -> void {
+    std::this_thread::sleep_for(20ms);
+}
+
+struct Measurement {
+    std::chrono::nanoseconds consumer_cpu{};
+    std::size_t encoded = 0;
+    // From pushing a frame to its encoding finishing, sorted
+    std::vector<util::Clock::duration> latency;
+};
+
+}  // namespace
+
+TEST(mailbox, LatestWins) {
+    auto mailbox = util::Mailbox<int>{};
+    EXPECT_TRUE(mailbox.put(1));
+    EXPECT_FALSE(mailbox.put(2));
+    EXPECT_FALSE(mailbox.put(3));
+    EXPECT_EQ(mailbox.skipped(), 2);
+
+    EXPECT_EQ(mailbox.try_take(), 3);
+    EXPECT_EQ(mailbox.try_take(), std::nullopt);
+
+    EXPECT_TRUE(mailbox.put(4));
+    mailbox.clear();
+    EXPECT_EQ(mailbox.try_take(), std::nullopt);
+}
+
+TEST(mailbox, TakeBlocksUntilPut) {
+    auto mailbox  = util::Mailbox<int>{};
+    auto received = std::optional<int>{};
+    auto consumer = std::jthread{[&](std::stop_token token) { received = mailbox.take(token); }};
+
+    std::this_thread::sleep_for(20ms);
+    mailbox.put(7);
+    consumer.join();
+    EXPECT_EQ(received, 7);
+}
+
+TEST(mailbox, StopUnblocksTake) {
+    auto mailbox  = util::Mailbox<int>{};
+    auto source   = std::stop_source{};
+    auto received = std::optional<int>{1};
+    auto consumer = std::jthread{[&] { received = mailbox.take(source.get_token()); }};
+
+    std::this_thread::sleep_for(20ms);
+    source.request_stop();
+    consumer.join();
+    EXPECT_EQ(received, std::nullopt);
+}
+
+TEST(mailbox, TakeUntilGivesUpAtTheDeadline) {
+    auto mailbox = util::Mailbox<int>{};
+    auto source  = std::stop_source{};
+
+    const auto begin = util::Clock::now();
+    EXPECT_EQ(mailbox.take_until(source.get_token(), begin + 20ms), std::nullopt);
+    EXPECT_GE(util::Clock::now() - begin, 20ms);
+
+    mailbox.put(7);
+    EXPECT_EQ(mailbox.take_until(source.get_token(), util::Clock::now() + 1s), 7);
+}
+
+TEST(mailbox, StreamingHandoffBenchmark) {
+    constexpr auto kFrames = std::size_t{240};
+    constexpr auto kPeriod = std::chrono::microseconds{8333};
+    // The camera going quiet afterwards, a consumer with nothing to do should cost nothing
+    constexpr auto kIdle = 500ms;
+
+    // Paces a 120 Hz camera, `push` hands each frame to the consumer
+    const auto produce = [&](auto push) {
+        auto next = util::Clock::now();
+        for (std::size_t i = 0; i < kFrames; ++i) {
+            push(Frame{.index = static_cast<int>(i), .pushed = util::Clock::now()});
+            next += kPeriod;
+            std::this_thread::sleep_until(next);
+        }
+    };
+    const auto finish = [](Measurement& measurement, const Frame& frame) {
+        encode();
+        measurement.latency.push_back(util::Clock::now() - frame.pushed);
+        ++measurement.encoded;
+    };
+
+    // Before: a bounded queue drained by a thread that yields while it is empty
+    auto queue  = boost::lockfree::spsc_queue<Frame, boost::lockfree::capacity<100>>{};
+    auto queued = Measurement{};
+    {
+        auto consumer = std::jthread{[&](std::stop_token token) {
+            const auto begin = thread_cpu_time();
+            while (!token.stop_requested()) {
+                auto frame = Frame{};
+                if (queue.pop(frame)) {
+                    finish(queued, frame);
+                }
+                std::this_thread::yield();
+            }
+            queued.consumer_cpu = thread_cpu_time() - begin;
+        }};
+        produce([&](const Frame& frame) { queue.push(frame); });
+        // The backlog left over is what a viewer would still be waiting for
+        while (queue.read_available() != 0) {
+            std::this_thread::sleep_for(1ms);
+        }
+        std::this_thread::sleep_for(kIdle);
+    }
+
+    // After: the newest frame waits in the mailbox, the consumer sleeps while it is empty
+    auto mailbox = util::Mailbox<Frame>{};
+    auto latest  = Measurement{};
+    {
+        auto consumer = std::jthread{[&](std::stop_token token) {
+            const auto begin = thread_cpu_time();
+            while (auto frame = mailbox.take(token)) {
+                finish(latest, *frame);
+            }
+            latest.consumer_cpu = thread_cpu_time() - begin;
+        }};
+        produce([&](const Frame& frame) { mailbox.put(frame); });
+        std::this_thread::sleep_for(kIdle);
+    }
+
+    ASSERT_GT(latest.encoded, 0);
+    EXPECT_EQ(latest.encoded + mailbox.skipped(), kFrames);
+
+    const auto line = [](const char* name, Measurement& measurement) {
+        std::ranges::sort(measurement.latency);
+        const auto quantile = [&](double q) {
+            const auto index = static_cast<std::size_t>(
+                q * static_cast<double>(measurement.latency.size() - 1));
+            return std::chrono::duration<double, std::milli>(measurement.latency[index]).count();
+        };
+        return std::format("{}: {} encoded, consumer cpu {:.1f}ms, push to encoded p50 {:.0f}ms "
+                           "p99 {:.0f}ms\n",
+                           name, measurement.encoded,
+                           std::chrono::duration<double, std::milli>(measurement.consumer_cpu)
+                               .count(),
+                           quantile(0.5), quantile(0.99));
+    };
+    std::cout << std::format("{} frames at 120 Hz into a 20ms encoder, then {}ms idle\n",
+                             kFrames, std::chrono::milliseconds{kIdle}.count())
+              << line("  queue + yield", queued) << line("  latest-frame mailbox", latest);
+}
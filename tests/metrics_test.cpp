@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utility/metrics/metrics.hpp"
+
+using namespace pingpong_tracker::util;
+
+TEST(metrics, RenderPrometheusText) {
+    auto registry = metrics::Registry{};
+
+    auto& frames = registry.counter("frames_total", "Frames seen");
+    frames.add(3);
+    EXPECT_EQ(&registry.counter("frames_total", "Frames seen"), &frames);
+
+    registry.gauge("queue_depth", "Queue depth", {{"stage", "detect"}}).set(2);
+    registry.gauge("queue_depth", "Queue depth", {{"stage", "say \"hi\""}}).set(1);
+
+    auto& latency = registry.histogram("latency_seconds", "Latency", {0.01, 0.1});
+    latency.observe(0.005);
+    latency.observe(0.05);
+    latency.observe(std::chrono::milliseconds{500});
+
+    const auto text = registry.render();
+    EXPECT_NE(text.find("# HELP frames_total Frames seen\n# TYPE frames_total counter\n"
+                        "frames_total 3\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("# TYPE queue_depth gauge\n"), std::string::npos);
+    EXPECT_NE(text.find("queue_depth{stage=\"detect\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("queue_depth{stage=\"say \\\"hi\\\"\"} 1\n"), std::string::npos);
+
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"0.01\"} 1\n"
+                        "latency_seconds_bucket{le=\"0.1\"} 2\n"
+                        "latency_seconds_bucket{le=\"+Inf\"} 3\n"
+                        "latency_seconds_sum 0.555\n"
+                        "latency_seconds_count 3\n"),
+              std::string::npos)
+        << text;
+}
+
+TEST(metrics, HistogramQuantiles) {
+    auto histogram = metrics::Histogram{metrics::Histogram::latency_bounds()};
+    EXPECT_EQ(histogram.quantile(0.5), 0.0);
+
+    // Uniform over (0, 100ms], so the p50 is about 50ms and the p99 about 99ms
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.observe(0.0001 * i);
+    }
+    const auto p50 = histogram.quantile(0.5);
+    const auto p99 = histogram.quantile(0.99);
+    EXPECT_GT(p50, 0.032);
+    EXPECT_LT(p50, 0.064);
+    EXPECT_GT(p99, 0.064);
+    EXPECT_LE(p99, 0.128);
+    EXPECT_LE(p50, p99);
+}
+
+TEST(metrics, SameNameReturnsTheRegisteredMetric) {
+    auto registry = metrics::Registry{};
+    auto& first   = registry.counter("frames_total", "Frames seen", {{"camera", "left"}});
+    auto& again   = registry.counter("frames_total", "Frames seen", {{"camera", "left"}});
+    auto& other   = registry.counter("frames_total", "Frames seen", {{"camera", "right"}});
+    EXPECT_EQ(&first, &again);
+    EXPECT_NE(&first, &other);
+
+    // The mismatch is a programming error, the registered counter stays valid
+    EXPECT_THROW(registry.gauge("frames_total", "Frames seen", {{"camera", "left"}}),
+                 std::runtime_error);
+    EXPECT_THROW(registry.histogram("frames_total", "Frames seen"), std::runtime_error);
+    first.add();
+    EXPECT_EQ(again.value(), 1U);
+}
+
+TEST(metrics, Rate) {
+    auto registry = metrics::Registry{};
+    auto& frames  = registry.counter("frames_total", "Frames seen");
+    auto& fps     = registry.rate("fps", "Frames per second", frames);
+
+    frames.add(120);
+    registry.update_rates(Clock::now() + std::chrono::seconds{2});
+    EXPECT_NEAR(fps.value(), 60.0, 1.0);
+}
+
+TEST(metrics, ConcurrentUpdatesAreExact) {
+    auto registry   = metrics::Registry{};
+    auto& counter   = registry.counter("events_total", "Events");
+    auto& histogram = registry.histogram("latency_seconds", "Latency");
+
+    constexpr auto kThreads = 4;
+    constexpr auto kEvents  = 100'000;
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < kEvents; ++i) {
+                    counter.add();
+                    histogram.observe(0.001);
+                }
+            });
+        }
+        // Rendering while writers run must be safe
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_FALSE(registry.render().empty());
+        }
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(counter.value(), std::uint64_t{kThreads} * kEvents);
+    EXPECT_EQ(snapshot.count, std::uint64_t{kThreads} * kEvents);
+    EXPECT_NEAR(snapshot.sum, 0.001 * kThreads * kEvents, 1e-6);
+}
+
+TEST(metrics, HotPathCost) {
+    auto registry   = metrics::Registry{};
+    auto& counter   = registry.counter("events_total", "Events");
+    auto& histogram = registry.histogram("latency_seconds", "Latency");
+
+    constexpr auto kRounds = 10'000'000;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        counter.add();
+    }
+    const auto counter_cost = std::chrono::duration<double, std::nano>{
+                                  std::chrono::steady_clock::now() - begin}
+                                  .count()
+                            / kRounds;
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        histogram.observe(0.000001 * (i & 1023));
+    }
+    const auto histogram_cost = std::chrono::duration<double, std::nano>{
+                                    std::chrono::steady_clock::now() - begin}
+                                    .count()
+                              / kRounds;
+
+    std::cout << "counter add: " << counter_cost << "ns, histogram observe: " << histogram_cost
+              << "ns" << std::endl;
+    EXPECT_EQ(counter.value(), std::uint64_t{kRounds});
+}
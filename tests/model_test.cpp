@@ -237,4 +237,105 @@ TEST_F(OpenVinoNetTest, AsyncInferSuccessWithValidImage) {
     } else {
         ADD_FAILURE() << "Async inference failed: " << result.error();
     }
-}
\ No newline at end of file
+}
+
+TEST_F(OpenVinoNetTest, SyncInferSuccessWithStridedInputSizedView) {
+    if (!HasValidModel()) {
+        GTEST_SKIP() << "Model file missing";
+    }
+    if (!HasValidImage()) {
+        GTEST_SKIP() << "Test image missing";
+    }
+
+    ASSERT_TRUE(net_.configure(config_).has_value());
+
+    auto origin = cv::imread(test_image_path_);
+    if (origin.empty()) {
+        GTEST_SKIP() << "Failed to read image";
+    }
+
+    const auto rows = config_["input_rows"].as<int>();
+    const auto cols = config_["input_cols"].as<int>();
+
+    // Place the frame inside a wider canvas, then take an input-sized ROI around the ball so the
+    // network sees a non-continuous view that takes the zero-copy path
+    constexpr auto kBorder = 32;
+    auto canvas = cv::Mat{std::max(origin.rows, rows) + 2 * kBorder,
+                          std::max(origin.cols, cols) + 2 * kBorder, CV_8UC3,
+                          cv::Scalar{114, 114, 114}};
+    origin.copyTo(canvas(cv::Rect{kBorder, kBorder, origin.cols, origin.rows}));
+
+    const auto& target = kExpectedDetections.front();
+    const auto roi_x =
+        std::clamp(static_cast<int>(target.center.x) + kBorder - cols / 2, 0, canvas.cols - cols);
+    const auto roi_y =
+        std::clamp(static_cast<int>(target.center.y) + kBorder - rows / 2, 0, canvas.rows - rows);
+    const auto roi = canvas(cv::Rect{roi_x, roi_y, cols, rows});
+    ASSERT_FALSE(roi.isContinuous());
+    // The tensor gets the parent's row stride, wider than the packed rows it describes
+    ASSERT_GT(roi.step[0], static_cast<std::size_t>(cols) * roi.elemSize());
+
+    auto image = Image{};
+    image.details().set_mat(roi);
+
+    auto result = net_.sync_infer(image);
+    ASSERT_TRUE(result.has_value());
+
+    auto shifted = kExpectedDetections;
+    for (auto& expected : shifted) {
+        expected.center.x += kBorder - roi_x;
+        expected.center.y += kBorder - roi_y;
+    }
+    ValidateDetections(result.value(), shifted);
+
+    // The same pixels packed must give the same detections, a plugin reading the view with the
+    // wrong strides would see sheared rows
+    auto packed = Image{};
+    packed.details().set_mat(roi.clone());
+    auto reference = net_.sync_infer(packed);
+    ASSERT_TRUE(reference.has_value());
+    ASSERT_EQ(result->size(), reference->size());
+    for (std::size_t i = 0; i < result->size(); ++i) {
+        EXPECT_NEAR((*result)[i].center.x, (*reference)[i].center.x, 1e-3);
+        EXPECT_NEAR((*result)[i].center.y, (*reference)[i].center.y, 1e-3);
+        EXPECT_NEAR((*result)[i].radius, (*reference)[i].radius, 1e-3);
+        EXPECT_NEAR((*result)[i].confidence, (*reference)[i].confidence, 1e-4);
+    }
+}
+
+TEST_F(OpenVinoNetTest, AsyncInferReusesPooledRequests) {
+    if (!HasValidModel()) {
+        GTEST_SKIP() << "Model file missing";
+    }
+    if (!HasValidImage()) {
+        GTEST_SKIP() << "Test image missing";
+    }
+
+    config_["infer_requests"] = 2;
+    ASSERT_TRUE(net_.configure(config_).has_value());
+    EXPECT_EQ(net_.infer_requests(), 2U);
+
+    auto image_opt = LoadTestImage();
+    if (!image_opt) {
+        GTEST_SKIP() << "Failed to read image";
+    }
+
+    using ResultType = std::expected<std::vector<Ball2D>, std::string>;
+    auto run_pair    = [&] {
+        auto first  = std::promise<ResultType>{};
+        auto second = std::promise<ResultType>{};
+        net_.async_infer(*image_opt, [&first](auto result) { first.set_value(std::move(result)); });
+        net_.async_infer(*image_opt,
+                         [&second](auto result) { second.set_value(std::move(result)); });
+        return std::pair{first.get_future().get(), second.get_future().get()};
+    };
+
+    // Two frames in flight at a time never need a third request
+    for (int i = 0; i < 8; ++i) {
+        const auto [first, second] = run_pair();
+        ASSERT_TRUE(first.has_value()) << first.error();
+        ASSERT_TRUE(second.has_value()) << second.error();
+        ValidateDetections(*first, kExpectedDetections);
+    }
+    EXPECT_EQ(net_.infer_requests(), 2U);
+}
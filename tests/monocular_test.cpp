@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <eigen3/Eigen/Cholesky>
+#include <eigen3/Eigen/Geometry>
+
+#include "module/geometry/camera_model.hpp"
+#include "module/geometry/monocular.hpp"
+
+using pingpong_tracker::geometry::CameraModel;
+using pingpong_tracker::geometry::MonocularLocator;
+using Vec2 = CameraModel::Vec2;
+using Vec3 = CameraModel::Vec3;
+
+namespace {
+
+constexpr auto kTableLength  = 2.74;
+constexpr auto kTableWidth   = 1.525;
+constexpr auto kBallDiameter = 0.04;
+
+auto look_at(Vec3 const& eye, Vec3 const& target) -> CameraModel::Pose {
+    const Vec3 forward = (target - eye).normalized();
+    const Vec3 right   = forward.cross(Vec3::UnitZ()).normalized();
+    const Vec3 down    = forward.cross(right);
+
+    auto pose = CameraModel::Pose{};
+    pose.rotation.row(0) = right;
+    pose.rotation.row(1) = down;
+    pose.rotation.row(2) = forward;
+    pose.translation     = -pose.rotation * eye;
+    return pose;
+}
+
+auto make_intrinsics() -> CameraModel::Intrinsics {
+    return CameraModel::Intrinsics{
+        .fx         = 1400.0,
+        .fy         = 1400.0,
+        .cx         = 720.0,
+        .cy         = 540.0,
+        .distortion = {-0.12, 0.05, 0.001, -0.0005, 0.0},
+    };
+}
+
+// Side view from behind the net post, far enough to see the whole table
+auto make_truth() -> CameraModel {
+    return CameraModel{make_intrinsics(), look_at({0.0, -4.0, 2.0}, {0.0, 0.0, 0.0})};
+}
+
+auto in_image(Vec2 const& pixel) -> bool {
+    return pixel.x() >= 0.0 && pixel.x() < 1440.0 && pixel.y() >= 0.0 && pixel.y() < 1080.0;
+}
+
+auto table_corners(CameraModel const& camera) -> std::array<Vec2, 4> {
+    const auto l = 0.5 * kTableLength;
+    const auto w = 0.5 * kTableWidth;
+    return {
+        *camera.project({-l, -w, 0.0}),
+        *camera.project({l, -w, 0.0}),
+        *camera.project({l, w, 0.0}),
+        *camera.project({-l, w, 0.0}),
+    };
+}
+
+// Image radius of a sphere, f * tan(asin(R / d))
+auto apparent_radius(CameraModel const& camera, Vec3 const& center) -> double {
+    const auto distance = (center - camera.center()).norm();
+    return camera.intrinsics().fx * std::tan(std::asin(0.5 * kBallDiameter / distance));
+}
+
+auto random_ball(std::mt19937& random) -> Vec3 {
+    auto x = std::uniform_real_distribution<double>{-1.37, 1.37};
+    auto y = std::uniform_real_distribution<double>{-0.76, 0.76};
+    auto z = std::uniform_real_distribution<double>{0.02, 0.6};
+    return {x(random), y(random), z(random)};
+}
+
+auto make_locator(CameraModel const& camera) -> MonocularLocator {
+    auto config          = MonocularLocator::Config{};
+    config.ball_diameter = kBallDiameter;
+    config.pixel_noise   = 0.5;
+    config.radius_noise  = 0.3;
+    return MonocularLocator{camera, config};
+}
+
+}  // namespace
+
+TEST(monocular, PoseFromTableCorners) {
+    const auto truth = make_truth();
+    const auto pose  = MonocularLocator::estimate_pose(make_intrinsics(), table_corners(truth),
+                                                       kTableLength, kTableWidth);
+    ASSERT_TRUE(pose.has_value()) << pose.error();
+
+    EXPECT_LT((pose->rotation - truth.pose().rotation).norm(), 1e-6);
+    EXPECT_LT((pose->translation - truth.pose().translation).norm(), 1e-6);
+
+    // Half a pixel of click noise on the corners keeps the camera within a few centimetres
+    auto random  = std::mt19937{2};
+    auto noise   = std::normal_distribution<double>{0.0, 0.5};
+    auto corners = table_corners(truth);
+    for (auto& corner : corners) {
+        corner += Vec2{noise(random), noise(random)};
+    }
+    const auto noisy = MonocularLocator::estimate_pose(make_intrinsics(), corners, kTableLength,
+                                                       kTableWidth);
+    ASSERT_TRUE(noisy.has_value());
+    const auto center = CameraModel{make_intrinsics(), *noisy}.center();
+    EXPECT_LT((center - truth.center()).norm(), 0.05);
+}
+
+TEST(monocular, LocatesFromRadius) {
+    const auto truth = make_truth();
+    const auto pose  = MonocularLocator::estimate_pose(make_intrinsics(), table_corners(truth),
+                                                       kTableLength, kTableWidth);
+    ASSERT_TRUE(pose.has_value());
+    const auto locator = make_locator(CameraModel{make_intrinsics(), *pose});
+
+    auto random = std::mt19937{9};
+    auto noise  = std::normal_distribution<double>{0.0, 1.0};
+
+    // Exact detections: only the ray table interpolation is left
+    for (int i = 0; i < 500; ++i) {
+        const auto ball  = random_ball(random);
+        const auto pixel = *truth.project(ball);
+        ASSERT_TRUE(in_image(pixel));
+
+        const auto estimate = locator.locate(pixel, apparent_radius(truth, ball));
+        ASSERT_TRUE(estimate.has_value());
+        EXPECT_LT((estimate->position - ball).norm(), 1e-3);
+    }
+
+    // Noisy detections: error consistent with the covariance
+    constexpr auto kSamples = 2000;
+    auto nees_sum           = 0.0;
+    for (int i = 0; i < kSamples; ++i) {
+        const auto ball = random_ball(random);
+        const Vec2 pixel  = *truth.project(ball) + 0.5 * Vec2{noise(random), noise(random)};
+        const auto radius = apparent_radius(truth, ball) + 0.3 * noise(random);
+
+        const auto estimate = locator.locate(pixel, radius);
+        ASSERT_TRUE(estimate.has_value());
+        const Vec3 error = estimate->position - ball;
+        nees_sum += error.dot(estimate->covariance.ldlt().solve(error));
+    }
+    const auto mean_nees = nees_sum / kSamples;
+    std::cout << "mean NEES: " << mean_nees << "\n";
+    EXPECT_GT(mean_nees, 2.0);
+    EXPECT_LT(mean_nees, 4.5);
+
+    EXPECT_FALSE(locator.locate({720.0, 540.0}, 0.0).has_value());
+}
+
+TEST(monocular, LocateCost) {
+    constexpr auto kIterations = 1000000;
+
+    const auto truth   = make_truth();
+    const auto locator = make_locator(truth);
+
+    auto sink        = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        const auto pixel = Vec2{100.0 + (i % 1200), 100.0 + (i % 800)};
+        if (const auto estimate = locator.locate(pixel, 10.0 + (i % 7))) {
+            sink += estimate->position.z();
+        }
+    }
+    const auto per_locate = std::chrono::duration<double, std::nano>(
+                                std::chrono::steady_clock::now() - start)
+                                .count()
+                          / kIterations;
+
+    std::cout << "locate: " << per_locate << " ns (" << sink << ")\n";
+}
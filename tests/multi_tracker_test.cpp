@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "module/tracker/multi_tracker.hpp"
+#include "utility/math/assignment.hpp"
+
+using pingpong_tracker::tracker::MultiTracker;
+using pingpong_tracker::util::Assignment;
+using Clock = pingpong_tracker::util::Clock;
+
+namespace {
+
+auto at_seconds(Clock::time_point origin, double t) -> Clock::time_point {
+    return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+}
+
+auto make_config() -> MultiTracker::Config {
+    auto config                 = MultiTracker::Config{};
+    config.gravity_y            = 2000.0F;
+    config.process_noise        = 1e4F;
+    config.measurement_noise    = 2.0F;
+    config.initial_velocity_std = 1e3F;
+    config.confirm_hits         = 3;
+    config.max_coast            = 5;
+    return config;
+}
+
+// Minimal gated cost over every assignment of the smaller side
+auto brute_force(const std::vector<double>& cost, std::size_t rows, std::size_t cols, double gate)
+    -> std::pair<std::size_t, double> {
+    auto best_pairs = std::size_t{0};
+    auto best_cost  = 0.0;
+
+    auto columns = std::vector<std::size_t>(std::max(rows, cols));
+    std::iota(columns.begin(), columns.end(), 0);
+    do {
+        auto pairs = std::size_t{0};
+        auto total = 0.0;
+        for (std::size_t r = 0; r < rows; ++r) {
+            const auto c = columns[r];
+            if (c < cols && cost[r * cols + c] < gate) {
+                ++pairs;
+                total += cost[r * cols + c];
+            }
+        }
+        if (pairs > best_pairs || (pairs == best_pairs && total < best_cost)) {
+            best_pairs = pairs;
+            best_cost  = total;
+        }
+    } while (std::next_permutation(columns.begin(), columns.end()));
+    return {best_pairs, best_cost};
+}
+
+}  // namespace
+
+TEST(assignment, HungarianMatchesBruteForce) {
+    auto random   = std::mt19937{7};
+    auto uniform  = std::uniform_real_distribution<double>{0.0, 10.0};
+    auto solver   = Assignment{};
+    const auto gate = 6.0;
+
+    for (const auto& [rows, cols] : {std::pair{6UZ, 6UZ}, {5UZ, 7UZ}, {7UZ, 5UZ}, {1UZ, 4UZ}}) {
+        for (int round = 0; round < 50; ++round) {
+            auto cost = std::vector<double>(rows * cols);
+            std::ranges::generate(cost, [&] { return uniform(random); });
+
+            const auto row_to_col = solver.hungarian(cost, rows, cols, gate);
+
+            auto pairs   = std::size_t{0};
+            auto total   = 0.0;
+            auto columns = std::vector<bool>(cols, false);
+            for (std::size_t r = 0; r < rows; ++r) {
+                if (const auto c = row_to_col[r]; c != Assignment::npos) {
+                    ASSERT_LT(cost[r * cols + c], gate);
+                    ASSERT_FALSE(columns[c]);
+                    columns[c] = true;
+                    ++pairs;
+                    total += cost[r * cols + c];
+                }
+            }
+
+            const auto [best_pairs, best_cost] = brute_force(cost, rows, cols, gate);
+            EXPECT_EQ(pairs, best_pairs);
+            EXPECT_NEAR(total, best_cost, 1e-9);
+        }
+    }
+}
+
+TEST(assignment, GreedyRespectsGate) {
+    auto solver     = Assignment{};
+    const auto cost = std::vector<double>{
+        1.0, 20.0, //
+        2.0, 30.0, //
+    };
+    const auto row_to_col = solver.greedy(cost, 2, 2, 9.21);
+    EXPECT_EQ(row_to_col[0], 0);
+    EXPECT_EQ(row_to_col[1], Assignment::npos);
+}
+
+TEST(multi_tracker, KeepsIdentitiesThroughCrossing) {
+    for (const auto greedy_limit : {0UZ, 64UZ}) {
+        auto config         = make_config();
+        config.greedy_limit = greedy_limit;
+        auto tracker        = MultiTracker{config};
+
+        const auto origin = Clock::now();
+        auto first_ids    = std::vector<std::uint32_t>{};
+
+        // Two balls crossing each other at t = 0.25s, reported in a shuffled order
+        for (int i = 0; i < 120; ++i) {
+            const auto t  = static_cast<float>(i / 240.0);
+            const auto dy = 0.5F * 2000.0F * t * t;
+
+            auto a = MultiTracker::Measurement{100.0F + 800.0F * t, 300.0F - 400.0F * t + dy};
+            auto b = MultiTracker::Measurement{300.0F - 800.0F * t, 200.0F + 0.0F * t + dy};
+
+            const auto swapped    = (i % 2) == 1;
+            const auto detections = swapped ? std::vector{b, a} : std::vector{a, b};
+            const auto ids        = tracker.update(at_seconds(origin, t), detections);
+
+            auto ordered = swapped ? std::vector{ids[1], ids[0]} : std::vector{ids[0], ids[1]};
+            if (i == 0) {
+                first_ids = ordered;
+                ASSERT_NE(first_ids[0], first_ids[1]);
+            } else {
+                ASSERT_EQ(ordered, first_ids) << "frame " << i << " greedy " << greedy_limit;
+            }
+        }
+        EXPECT_EQ(tracker.tracks().size(), 2);
+    }
+}
+
+TEST(multi_tracker, BirthAndDeath) {
+    auto tracker      = MultiTracker{make_config()};
+    const auto origin = Clock::now();
+
+    auto frame = 0;
+    auto step  = [&](std::vector<MultiTracker::Measurement> detections) {
+        const auto t = frame++ / 240.0;
+        tracker.update(at_seconds(origin, t), detections);
+    };
+
+    for (int i = 0; i < 5; ++i) {
+        step({{100.0F, 100.0F}});
+    }
+    ASSERT_EQ(tracker.tracks().size(), 1);
+    EXPECT_TRUE(tracker.confirmed(0));
+    const auto id = tracker.tracks().id[0];
+
+    // A single false positive is born tentative and dies on its first miss
+    step({{100.0F, 100.0F}, {600.0F, 600.0F}});
+    ASSERT_EQ(tracker.tracks().size(), 2);
+    EXPECT_FALSE(tracker.confirmed(1));
+    step({{100.0F, 100.0F}});
+    ASSERT_EQ(tracker.tracks().size(), 1);
+    EXPECT_EQ(tracker.tracks().id[0], id);
+
+    // A confirmed track survives max_coast misses, not one more
+    for (int i = 0; i < 5; ++i) {
+        step({});
+    }
+    EXPECT_EQ(tracker.tracks().size(), 1);
+    step({});
+    EXPECT_EQ(tracker.tracks().size(), 0);
+
+    // A new ball gets a fresh id
+    step({{100.0F, 100.0F}});
+    ASSERT_EQ(tracker.tracks().size(), 1);
+    EXPECT_GT(tracker.tracks().id[0], id);
+}
+
+TEST(multi_tracker, IgnoresOlderFrames) {
+    auto tracker      = MultiTracker{make_config()};
+    const auto origin = Clock::now();
+
+    const auto ball = std::vector<MultiTracker::Measurement>{{100.0F, 100.0F}};
+
+    auto frame = 0;
+    for (; frame < 5; ++frame) {
+        tracker.update(at_seconds(origin, frame / 240.0), ball);
+    }
+    ASSERT_EQ(tracker.tracks().size(), 1);
+    const auto before    = tracker.tracks();
+    const auto timestamp = tracker.timestamp();
+
+    // A frame from before the last one, far off and missing the track, changes nothing
+    const auto late = std::vector<MultiTracker::Measurement>{{300.0F, 300.0F}};
+    const auto ids  = tracker.update(at_seconds(origin, (frame - 2) / 240.0), late);
+    ASSERT_EQ(ids.size(), 1);
+    EXPECT_EQ(ids[0], MultiTracker::kNoTrack);
+    EXPECT_EQ(tracker.timestamp(), timestamp);
+    ASSERT_EQ(tracker.tracks().size(), 1);
+    EXPECT_EQ(tracker.tracks().id, before.id);
+    EXPECT_EQ(tracker.tracks().x, before.x);
+    EXPECT_EQ(tracker.tracks().y, before.y);
+    EXPECT_EQ(tracker.tracks().x_pp, before.x_pp);
+    EXPECT_EQ(tracker.tracks().hits, before.hits);
+    EXPECT_EQ(tracker.tracks().misses, before.misses);
+
+    // The next frame in order is tracked as usual
+    tracker.update(at_seconds(origin, frame / 240.0), ball);
+    ASSERT_EQ(tracker.tracks().size(), 1);
+    EXPECT_EQ(tracker.tracks().id, before.id);
+    EXPECT_EQ(tracker.tracks().hits[0], before.hits[0] + 1);
+}
+
+TEST(multi_tracker, AssociationCost32x32) {
+    constexpr auto kBalls      = 32;
+    constexpr auto kIterations = 2000;
+
+    for (const auto greedy_limit : {0UZ, 64UZ}) {
+        auto config         = make_config();
+        config.greedy_limit = greedy_limit;
+        auto tracker        = MultiTracker{config};
+
+        auto random = std::mt19937{3};
+        auto noise  = std::normal_distribution<float>{0.0F, 2.0F};
+
+        // Balls on a loose grid, close enough that gates overlap between neighbours
+        auto frames = std::vector<std::vector<MultiTracker::Measurement>>(kIterations);
+        for (int i = 0; i < kIterations; ++i) {
+            const auto t  = static_cast<float>((i % 120) / 240.0);
+            const auto dy = 0.5F * 2000.0F * t * t;
+            for (int b = 0; b < kBalls; ++b) {
+                const auto x0 = 40.0F * static_cast<float>(b % 8);
+                const auto y0 = 40.0F * static_cast<float>(b / 8);
+                frames[i].push_back({x0 + 100.0F * t + noise(random), y0 + dy + noise(random)});
+            }
+            std::ranges::shuffle(frames[i], random);
+        }
+
+        auto timestamp = [&](int i) { return at_seconds(Clock::time_point{}, i / 240.0); };
+        for (int i = 0; i < 10; ++i) {
+            tracker.update(timestamp(i), frames[i]);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 10; i < kIterations; ++i) {
+            if (i % 120 == 0) {
+                tracker.reset();
+            }
+            tracker.update(timestamp(i), frames[i]);
+        }
+        const auto per_update = std::chrono::duration<double, std::micro>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count()
+                              / (kIterations - 10);
+
+        std::cout << (greedy_limit == 0 ? "hungarian" : "greedy") << " 32x32 update: "
+                  << per_update << " us\n";
+        EXPECT_EQ(tracker.tracks().size(), kBalls);
+        EXPECT_LT(per_update, 50.0);
+    }
+}
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "module/tracker/oosm_tracker.hpp"
+
+using pingpong_tracker::tracker::BallTracker;
+using pingpong_tracker::tracker::OosmTracker;
+using pingpong_tracker::tracker::TrackState;
+using Clock = pingpong_tracker::util::Clock;
+
+namespace {
+
+using Tracker2D = OosmTracker<2>;
+using ZVec      = Tracker2D::ZVec;
+
+auto make_config() -> Tracker2D::Config {
+    auto config                        = Tracker2D::Config{};
+    config.tracker.model.gravity       = {0.0, 2000.0};
+    config.tracker.model.drag          = 0.0;
+    config.tracker.process_noise       = 1e4;
+    config.tracker.measurement_noise   = 2.0;
+    config.tracker.initial_velocity_std = 2e3;
+    config.tracker.gate_threshold      = 9.21;
+    config.tracker.max_coast           = 5;
+    config.history                     = 16;
+    config.max_lag                     = 0.05;
+    return config;
+}
+
+auto truth_at(double t) -> ZVec {
+    return {100.0 + 800.0 * t, 400.0 - 900.0 * t + 0.5 * 2000.0 * t * t};
+}
+
+auto at_seconds(Clock::time_point origin, double t) -> Clock::time_point {
+    return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+}
+
+struct Frame {
+    Clock::time_point timestamp;
+    ZVec z;
+};
+
+auto make_frames(Clock::time_point origin, int count) -> std::vector<Frame> {
+    auto noise  = std::normal_distribution<double>{0.0, 2.0};
+    auto random = std::mt19937{5};
+
+    auto frames = std::vector<Frame>{};
+    for (int i = 0; i < count; ++i) {
+        const auto t = i / 240.0;
+        auto z       = truth_at(t);
+        z.x() += noise(random);
+        z.y() += noise(random);
+        frames.push_back({at_seconds(origin, t), z});
+    }
+    return frames;
+}
+
+}  // namespace
+
+TEST(oosm_tracker, ReorderedFramesMatchInOrder) {
+    const auto origin = Clock::now();
+    const auto frames = make_frames(origin, 120);
+
+    auto reference = BallTracker<2>{make_config().tracker};
+    for (const auto& frame : frames) {
+        reference.update(frame.timestamp, std::vector<ZVec>{frame.z});
+    }
+
+    // Every block of 6 frames arrives in a scrambled order, at most 5 frames late
+    auto order  = std::vector<std::size_t>(frames.size());
+    auto random = std::mt19937{9};
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    for (std::size_t begin = 0; begin + 6 <= order.size(); begin += 6) {
+        std::shuffle(order.begin() + static_cast<long>(begin),
+                     order.begin() + static_cast<long>(begin + 6), random);
+    }
+    // The very first frame must come first, nothing can be inserted before the oldest entry
+    std::iter_swap(order.begin(), std::find(order.begin(), order.end(), 0));
+
+    auto tracker  = Tracker2D{make_config()};
+    auto replayed = std::size_t{0};
+    for (const auto index : order) {
+        tracker.update(frames[index].timestamp, std::vector<ZVec>{frames[index].z});
+        replayed += tracker.last_replayed();
+    }
+
+    const auto& expected = reference.snapshot();
+    const auto& actual   = tracker.snapshot();
+    ASSERT_EQ(actual.state, TrackState::TRACKING);
+    EXPECT_EQ(actual.timestamp, expected.timestamp);
+    EXPECT_LT((actual.x - expected.x).norm(), 1e-9);
+    EXPECT_LT((actual.P - expected.P).norm(), 1e-9 * expected.P.norm());
+    EXPECT_GT(replayed, 0U);
+    EXPECT_EQ(tracker.dropped(), 0U);
+}
+
+TEST(oosm_tracker, DropsFramesBeyondTheLagWindow) {
+    const auto origin = Clock::now();
+    const auto frames = make_frames(origin, 40);
+
+    auto tracker = Tracker2D{make_config()};
+    for (std::size_t i = 1; i < frames.size(); ++i) {
+        tracker.update(frames[i].timestamp, std::vector<ZVec>{frames[i].z});
+    }
+    const auto before = tracker.snapshot();
+
+    // 39 frames at 240 fps is beyond both the 50 ms lag and the 16 frame history
+    const auto accepted = tracker.update(frames[0].timestamp, std::vector<ZVec>{frames[0].z});
+    EXPECT_EQ(accepted, Tracker2D::npos);
+    EXPECT_EQ(tracker.dropped(), 1U);
+    EXPECT_EQ(tracker.snapshot().x, before.x);
+
+    // Two and a half frames late is fine, the current estimate keeps its timestamp
+    const auto late = at_seconds(origin, 36.5 / 240.0);
+    EXPECT_NE(tracker.update(late, std::vector<ZVec>{truth_at(36.5 / 240.0)}), Tracker2D::npos);
+    EXPECT_EQ(tracker.last_replayed(), 3U);
+    EXPECT_EQ(tracker.snapshot().timestamp, before.timestamp);
+}
+
+TEST(oosm_tracker, CandidateLimitOnlyAppliesToReplays) {
+    const auto origin = Clock::now();
+    const auto frames = make_frames(origin, 60);
+
+    // Once the track runs, four clutter detections far outside the gate come before the ball
+    const auto detections = [&](std::size_t index) {
+        auto candidates = std::vector<ZVec>{};
+        if (index >= 10) {
+            for (int i = 0; i < 4; ++i) {
+                candidates.emplace_back(2000.0 + 100.0 * i, -1000.0);
+            }
+        }
+        candidates.push_back(frames[index].z);
+        return candidates;
+    };
+
+    auto config           = make_config();
+    config.max_candidates = 2;
+
+    auto reference = BallTracker<2>{config.tracker};
+    auto in_order  = Tracker2D{config};
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const auto expected = reference.update(frames[i].timestamp, detections(i));
+        EXPECT_EQ(in_order.update(frames[i].timestamp, detections(i)), expected);
+    }
+    EXPECT_EQ(in_order.truncated(), frames.size() - 10);
+    EXPECT_EQ(in_order.snapshot().x, reference.snapshot().x);
+
+    // A late frame replays the ones after it from the two kept candidates, which still hold the
+    // accepted one
+    auto late = Tracker2D{config};
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const auto index = i == 40 ? 41 : i == 41 ? 40 : i;
+        late.update(frames[index].timestamp, detections(index));
+    }
+    EXPECT_EQ(late.snapshot().state, TrackState::TRACKING);
+    EXPECT_LT((late.snapshot().x - reference.snapshot().x).norm(), 1e-9);
+}
+
+TEST(oosm_tracker, WorstCaseReplayCost) {
+    const auto origin = Clock::now();
+    const auto frames = make_frames(origin, 2000);
+
+    auto config    = make_config();
+    config.max_lag = 1.0;
+    auto tracker   = Tracker2D{config};
+    for (std::size_t i = 0; i < 16; ++i) {
+        tracker.update(frames[i].timestamp, std::vector<ZVec>{frames[i].z});
+    }
+
+    // Every other frame arrives one frame late
+    auto candidates = std::vector<ZVec>(1);
+    auto worst      = std::chrono::nanoseconds{0};
+    auto total      = std::chrono::nanoseconds{0};
+    auto count      = 0;
+    for (std::size_t i = 16; i + 1 < frames.size(); i += 2) {
+        candidates[0] = frames[i + 1].z;
+        tracker.update(frames[i + 1].timestamp, candidates);
+
+        candidates[0]     = frames[i].z;
+        const auto begin  = std::chrono::steady_clock::now();
+        tracker.update(frames[i].timestamp, candidates);
+        const auto cost   = std::chrono::steady_clock::now() - begin;
+
+        ASSERT_EQ(tracker.last_replayed(), 1U);
+        worst = std::max(worst, std::chrono::duration_cast<std::chrono::nanoseconds>(cost));
+        total += std::chrono::duration_cast<std::chrono::nanoseconds>(cost);
+        ++count;
+    }
+
+    // Now the worst case: insert right after the oldest entry of a full ring
+    auto costs = std::vector<std::chrono::nanoseconds>{};
+    for (int round = 0; round < 201; ++round) {
+        auto copy         = tracker;
+        const auto oldest = tracker.snapshot().timestamp - std::chrono::microseconds{62'000};
+
+        candidates[0]    = tracker.extrapolate(oldest).head<2>();
+        const auto begin = std::chrono::steady_clock::now();
+        copy.update(oldest, candidates);
+        const auto cost  = std::chrono::steady_clock::now() - begin;
+
+        ASSERT_EQ(copy.last_replayed(), 15U);
+        costs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(cost));
+    }
+    std::ranges::sort(costs);
+    const auto median = costs[costs.size() / 2];
+
+    std::cout << "one frame late: mean " << total.count() / count << "ns, max " << worst.count()
+              << "ns; 15 frames replayed: median " << median.count() << "ns, p99 "
+              << costs[costs.size() * 99 / 100].count() << "ns" << std::endl;
+}
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "utility/clock.hpp"
+#include "utility/publish/ball_message.hpp"
+#include "utility/publish/shm_channel.hpp"
+#include "utility/publish/udp_channel.hpp"
+
+using namespace pingpong_tracker;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto make_message(std::uint64_t sequence) -> util::BallMessage {
+    auto message       = util::BallMessage{};
+    message.magic      = util::BallMessage::kMagic;
+    message.version    = util::BallMessage::kVersion;
+    message.size       = sizeof(util::BallMessage);
+    message.sequence   = sequence;
+    message.capture_ns = static_cast<std::int64_t>(sequence) * 1000;
+    message.ball_count = static_cast<std::uint16_t>(sequence % util::BallMessage::kMaxBalls);
+    for (std::size_t i = 0; i < message.ball_count; ++i) {
+        message.balls[i] = {static_cast<float>(sequence), static_cast<float>(i), 3.0F, 0.5F};
+    }
+    message.publish_ns = util::Clock::now().time_since_epoch().count();
+    return message;
+}
+
+// Every field derived from the sequence, a torn read mixes two sequences
+auto consistent(const util::BallMessage& message) -> bool {
+    if (!message.valid() || message.capture_ns != static_cast<std::int64_t>(message.sequence) * 1000
+        || message.ball_count != message.sequence % util::BallMessage::kMaxBalls) {
+        return false;
+    }
+    for (std::size_t i = 0; i < message.ball_count; ++i) {
+        if (message.balls[i].x != static_cast<float>(message.sequence)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto unique_name() -> std::string {
+    return std::format("/publisher_test_{}_{}", ::getpid(),
+                       ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+}  // namespace
+
+TEST(publisher, MessageLayout) {
+    EXPECT_EQ(sizeof(util::BallMessage), 608U);
+    EXPECT_EQ(offsetof(util::BallMessage, balls), 40U);
+    EXPECT_TRUE(make_message(3).valid());
+
+    auto message    = make_message(3);
+    message.version = 0;
+    EXPECT_FALSE(message.valid());
+}
+
+TEST(publisher, ShmDeliversInOrder) {
+    auto publisher = util::ShmPublisher::open(unique_name(), 64);
+    ASSERT_TRUE(publisher) << publisher.error();
+    auto subscriber = util::ShmSubscriber::open(unique_name());
+    ASSERT_TRUE(subscriber) << subscriber.error();
+
+    auto message = util::BallMessage{};
+    EXPECT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::EMPTY);
+
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        publisher->publish(make_message(i));
+    }
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::MESSAGE);
+        EXPECT_EQ(message.sequence, i);
+        EXPECT_TRUE(consistent(message));
+    }
+    EXPECT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::EMPTY);
+    EXPECT_EQ(subscriber->lost(), 0U);
+}
+
+TEST(publisher, ShmSkipsLappedMessages) {
+    auto publisher = util::ShmPublisher::open(unique_name(), 8);
+    ASSERT_TRUE(publisher) << publisher.error();
+    auto subscriber = util::ShmSubscriber::open(unique_name());
+    ASSERT_TRUE(subscriber) << subscriber.error();
+
+    for (std::uint64_t i = 0; i < 20; ++i) {
+        publisher->publish(make_message(i));
+    }
+
+    // Only the last eight are left
+    auto message = util::BallMessage{};
+    ASSERT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::MESSAGE);
+    EXPECT_EQ(message.sequence, 12U);
+    EXPECT_EQ(subscriber->lost(), 12U);
+
+    publisher->publish(make_message(20));
+    ASSERT_EQ(subscriber->latest(message), util::ShmSubscriber::Status::MESSAGE);
+    EXPECT_EQ(message.sequence, 20U);
+    // 13 to 19 were skipped
+    EXPECT_EQ(subscriber->lost(), 19U);
+    EXPECT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::EMPTY);
+}
+
+TEST(publisher, ShmReportsClosedPublisher) {
+    auto subscriber = std::optional<util::ShmSubscriber>{};
+    {
+        auto publisher = util::ShmPublisher::open(unique_name(), 8);
+        ASSERT_TRUE(publisher) << publisher.error();
+        auto result = util::ShmSubscriber::open(unique_name());
+        ASSERT_TRUE(result) << result.error();
+        subscriber.emplace(std::move(*result));
+
+        publisher->publish(make_message(0));
+    }
+
+    // Messages published before closing are still delivered
+    auto message = util::BallMessage{};
+    EXPECT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::MESSAGE);
+    EXPECT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::CLOSED);
+    EXPECT_FALSE(util::ShmSubscriber::open(unique_name()));
+}
+
+TEST(publisher, ShmRefusesAnExistingSegmentUnlessTakingOver) {
+    auto opened = util::ShmPublisher::open(unique_name(), 8);
+    ASSERT_TRUE(opened) << opened.error();
+    auto first = std::optional<util::ShmPublisher>{std::move(*opened)};
+
+    // Another instance on the same name must not steal the channel
+    EXPECT_FALSE(util::ShmPublisher::open(unique_name(), 8));
+    auto subscriber = util::ShmSubscriber::open(unique_name());
+    ASSERT_TRUE(subscriber) << subscriber.error();
+    first->publish(make_message(0));
+    auto message = util::BallMessage{};
+    EXPECT_EQ(subscriber->poll(message), util::ShmSubscriber::Status::MESSAGE);
+
+    // Taking over is explicit, and the previous owner closing keeps the new segment linked
+    auto second = util::ShmPublisher::open(unique_name(), 8, true);
+    ASSERT_TRUE(second) << second.error();
+    first.reset();
+    auto taken = util::ShmSubscriber::open(unique_name());
+    ASSERT_TRUE(taken) << taken.error();
+    second->publish(make_message(1));
+    ASSERT_EQ(taken->poll(message), util::ShmSubscriber::Status::MESSAGE);
+    EXPECT_EQ(message.sequence, 1U);
+}
+
+TEST(publisher, ShmConcurrentReaderNeverSeesTornMessages) {
+    constexpr std::uint64_t kMessages = 200'000;
+
+    auto publisher = util::ShmPublisher::open(unique_name(), 16);
+    ASSERT_TRUE(publisher) << publisher.error();
+    auto subscriber = util::ShmSubscriber::open(unique_name());
+    ASSERT_TRUE(subscriber) << subscriber.error();
+
+    auto done   = std::atomic<bool>{false};
+    auto writer = std::jthread{[&] {
+        for (std::uint64_t i = 0; i < kMessages; ++i) {
+            publisher->publish(make_message(i));
+        }
+        done.store(true, std::memory_order_release);
+    }};
+
+    auto received = std::uint64_t{0};
+    auto previous = std::optional<std::uint64_t>{};
+    auto torn     = std::uint64_t{0};
+    auto message  = util::BallMessage{};
+    for (;;) {
+        const auto finished = done.load(std::memory_order_acquire);
+        const auto status   = subscriber->poll(message);
+        if (status == util::ShmSubscriber::Status::MESSAGE) {
+            torn += consistent(message) ? 0 : 1;
+            if (previous) {
+                ASSERT_GT(message.sequence, *previous);
+            }
+            previous = message.sequence;
+            ++received;
+        } else if (finished) {
+            break;
+        }
+    }
+
+    EXPECT_EQ(torn, 0U);
+    EXPECT_EQ(previous, kMessages - 1);
+    // Everything is either received or counted as lost
+    EXPECT_EQ(received + subscriber->lost(), kMessages);
+}
+
+TEST(publisher, UdpLoopbackBatch) {
+    auto subscriber = util::UdpSubscriber::open("127.0.0.1", 39870);
+    ASSERT_TRUE(subscriber) << subscriber.error();
+    auto publisher = util::UdpPublisher::open({"127.0.0.1:39870"});
+    ASSERT_TRUE(publisher) << publisher.error();
+
+    auto batch = std::vector<util::BallMessage>{};
+    for (std::uint64_t i = 0; i < 32; ++i) {
+        batch.push_back(make_message(i));
+    }
+    EXPECT_EQ(publisher->publish(batch), 32U);
+    EXPECT_EQ(publisher->dropped(), 0U);
+
+    auto messages = std::array<util::BallMessage, 64>{};
+    auto received = std::size_t{0};
+    while (received < batch.size()) {
+        const auto count = subscriber->receive(std::span{messages}.subspan(received), 500ms);
+        ASSERT_GT(count, 0U);
+        received += count;
+    }
+    for (std::size_t i = 0; i < received; ++i) {
+        EXPECT_EQ(messages[i].sequence, i);
+        EXPECT_TRUE(consistent(messages[i]));
+    }
+}
+
+TEST(publisher, RejectsInvalidTargets) {
+    EXPECT_FALSE(util::UdpPublisher::open({}));
+    EXPECT_FALSE(util::UdpPublisher::open({"127.0.0.1"}));
+    EXPECT_FALSE(util::UdpPublisher::open({"localhost:80"}));
+    EXPECT_FALSE(util::UdpPublisher::open({"127.0.0.1:0"}));
+}
+
+TEST(publisher, LatencyBenchmark) {
+    constexpr int kRounds = 2000;
+
+    auto publisher = util::ShmPublisher::open(unique_name(), 64);
+    ASSERT_TRUE(publisher) << publisher.error();
+    auto shm = util::ShmSubscriber::open(unique_name());
+    ASSERT_TRUE(shm) << shm.error();
+
+    auto udp_subscriber = util::UdpSubscriber::open("127.0.0.1", 39871);
+    ASSERT_TRUE(udp_subscriber) << udp_subscriber.error();
+    auto udp = util::UdpPublisher::open({"127.0.0.1:39871"});
+    ASSERT_TRUE(udp) << udp.error();
+
+    auto shm_total = util::Clock::duration{};
+    auto udp_total = util::Clock::duration{};
+    auto message   = util::BallMessage{};
+    auto received  = std::array<util::BallMessage, 1>{};
+    for (int i = 0; i < kRounds; ++i) {
+        const auto sequence = static_cast<std::uint64_t>(i);
+
+        auto begin = util::Clock::now();
+        publisher->publish(make_message(sequence));
+        while (shm->poll(message) != util::ShmSubscriber::Status::MESSAGE) {
+        }
+        shm_total += util::Clock::now() - begin;
+
+        begin = util::Clock::now();
+        udp->publish({std::array{make_message(sequence)}});
+        ASSERT_EQ(udp_subscriber->receive(received, 500ms), 1U);
+        udp_total += util::Clock::now() - begin;
+        ASSERT_EQ(received[0].sequence, sequence);
+    }
+
+    const auto average = [](util::Clock::duration total) {
+        return std::chrono::duration<double, std::micro>(total).count() / kRounds;
+    };
+    std::cout << std::format("Publish to receive: shared memory {:.2f}us, UDP loopback {:.2f}us\n",
+                             average(shm_total), average(udp_total));
+}
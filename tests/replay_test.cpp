@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+#include "kernel/recorder.hpp"
+#include "kernel/replay.hpp"
+#include "utility/record/detection_file.hpp"
+
+using namespace pingpong_tracker;
+
+namespace {
+
+constexpr std::uint64_t kFrames = 240;
+constexpr auto kFramePeriod     = std::chrono::microseconds{8333};
+// Frames without a detection, the tracker coasts through them
+constexpr std::uint64_t kMissEvery = 10;
+
+constexpr auto kTracker = R"(
+gravity: [0.0, 2000.0]
+drag: 0.0
+process_noise: 10000.0
+measurement_noise: 2.0
+initial_velocity_std: 1000.0
+gate_threshold: 9.21
+max_coast_frames: 10
+history_frames: 16
+history_candidates: 4
+max_lag: 0.05
+multi_target: false
+confirm_hits: 3
+greedy_limit: 4
+)";
+
+auto temporary_path() -> std::filesystem::path {
+    return std::filesystem::temp_directory_path()
+         / std::format("replay_test_{}.bin",
+                       ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+// A lob under gravity, y grows downwards
+auto ball_at(std::uint64_t frame) -> std::vector<Ball2D> {
+    if (frame % kMissEvery == kMissEvery - 1) {
+        return {};
+    }
+    const auto t = std::chrono::duration<float>{kFramePeriod * frame}.count();
+    return {Ball2D{
+        .center     = {100.0F + 400.0F * t, 600.0F - 900.0F * t + 1000.0F * t * t},
+        .radius     = 6.0F,
+        .confidence = 0.9F,
+    }};
+}
+
+auto score(double coverage, double median_error) -> kernel::ReplayResult {
+    auto result         = kernel::ReplayScore{};
+    result.detected     = 100;
+    result.tracked      = static_cast<std::uint64_t>(coverage * 100.0);
+    result.median_error = median_error;
+    return result;
+}
+
+}  // namespace
+
+TEST(replay, RecordedFramesReplayInCaptureOrder) {
+    const auto path = temporary_path();
+    std::filesystem::remove(path);
+
+    const auto origin = util::Clock::now();
+    const auto capture_of = [&](std::uint64_t frame) {
+        return origin + std::chrono::duration_cast<util::Clock::duration>(kFramePeriod * frame);
+    };
+    {
+        auto recorder = kernel::Recorder{};
+        auto config   = YAML::Load(std::format(
+            "{{enable: true, path: '{}', block_frames: 16, sync: false, queue: 512, "
+            "reorder_window: 4}}",
+            path.string()));
+        ASSERT_TRUE(recorder.initialize(config));
+        ASSERT_TRUE(recorder.initialized());
+
+        // Two pipelines finishing each other's frames first, the earliest capture comes second
+        auto image = Image{};
+        for (std::uint64_t k = 0; k < kFrames; ++k) {
+            const auto frame = k ^ 1;
+            image.set_timestamp(capture_of(frame));
+            recorder.record(image, ball_at(frame), {});
+        }
+    }
+
+    auto file = util::DetectionFile::open(path.string());
+    ASSERT_TRUE(file) << file.error();
+    ASSERT_EQ(file->size(), kFrames);
+    for (std::uint64_t i = 0; i < kFrames; ++i) {
+        const auto frame = file->frame(i);
+        EXPECT_EQ(frame.index, i);
+        EXPECT_EQ(frame.timestamp,
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(capture_of(i) - origin)
+                      .count());
+        ASSERT_EQ(frame.balls.size(), ball_at(i).size());
+        if (!frame.balls.empty()) {
+            EXPECT_EQ(frame.balls.front().center.x, ball_at(i).front().center.x);
+            EXPECT_EQ(frame.balls.front().center.y, ball_at(i).front().center.y);
+        }
+    }
+
+    const auto result = kernel::replay(*file, YAML::Load(kTracker));
+    ASSERT_TRUE(result) << result.error();
+    std::cout << std::format("coverage {:.3f}, median error {:.3f}px, p95 {:.3f}px, {} tracks\n",
+                             result->coverage(), result->median_error, result->p95_error,
+                             result->tracks);
+    EXPECT_EQ(result->frames, kFrames);
+    EXPECT_EQ(result->detected, kFrames - kFrames / kMissEvery);
+    EXPECT_EQ(result->tracks, 1U);
+    EXPECT_GT(result->coverage(), 0.95);
+    EXPECT_LT(result->median_error, 1.0);
+
+    std::filesystem::remove(path);
+}
+
+TEST(replay, SweepExpandsEveryCombination) {
+    const auto tracker = YAML::Load(kTracker);
+
+    const auto variants = kernel::expand_sweep(
+        tracker, YAML::Load("{process_noise: [5000.0, 20000.0], gate_threshold: [9.21, 13.8]}"));
+    ASSERT_TRUE(variants) << variants.error();
+    ASSERT_EQ(variants->size(), 4U);
+    EXPECT_EQ(variants->front().label, "process_noise=5000.0 gate_threshold=9.21");
+    EXPECT_EQ(variants->back().label, "process_noise=20000.0 gate_threshold=13.8");
+    EXPECT_EQ(variants->back().config["process_noise"].as<double>(), 20000.0);
+    EXPECT_EQ(variants->back().config["gate_threshold"].as<double>(), 13.8);
+    // The configuration the sweep started from is left alone
+    EXPECT_EQ(tracker["process_noise"].as<double>(), 10000.0);
+
+    const auto configured = kernel::expand_sweep(tracker, YAML::Node{});
+    ASSERT_TRUE(configured);
+    ASSERT_EQ(configured->size(), 1U);
+    EXPECT_TRUE(configured->front().label.empty());
+
+    EXPECT_FALSE(kernel::expand_sweep(tracker, YAML::Load("{unknown: [1]}")));
+    EXPECT_FALSE(kernel::expand_sweep(tracker, YAML::Load("{drag: []}")));
+    EXPECT_FALSE(kernel::expand_sweep(tracker, YAML::Load("{drag: 0.1}")));
+}
+
+TEST(replay, RankingPenalizesLowCoverage) {
+    const auto results = std::vector<kernel::ReplayResult>{
+        score(0.95, 3.0),
+        // Most accurate, but only because it dropped the ball on the hard frames
+        score(0.40, 0.5),
+        std::unexpected{"bad configuration"},
+        score(0.90, 1.0),
+        score(0.60, 2.0),
+    };
+
+    EXPECT_EQ(kernel::rank_variants(results, 0.8), (std::vector<std::size_t>{3, 0, 4, 1, 2}));
+    // Without a coverage floor the error alone ranks, failures still last
+    EXPECT_EQ(kernel::rank_variants(results, 0.0), (std::vector<std::size_t>{1, 3, 4, 0, 2}));
+}
@@ -0,0 +1,371 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "utility/thread/staged_pipeline.hpp"
+
+using pingpong_tracker::util::Backpressure;
+using pingpong_tracker::util::LatePolicy;
+using pingpong_tracker::util::QueueLimit;
+using pingpong_tracker::util::StagedPipeline;
+
+namespace {
+
+struct Item {
+    std::uint64_t sequence = 0;
+    std::vector<int> visited;
+    std::chrono::steady_clock::time_point born{};
+};
+
+using Pipeline = StagedPipeline<Item>;
+
+auto wait_until(const std::atomic<bool>& flag) -> void {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (!flag.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+}
+
+// Stand-ins for the runtime steps, times from a 60 fps camera with a CPU detector
+struct Costs {
+    std::chrono::microseconds capture{500};
+    std::chrono::microseconds preprocess{1000};
+    std::chrono::microseconds infer{3000};
+    std::chrono::microseconds track{200};
+    std::chrono::microseconds visualize{1500};
+};
+
+auto sleeping(std::chrono::microseconds cost) -> Pipeline::Step {
+    return [cost](Item&) {
+        std::this_thread::sleep_for(cost);
+        return true;
+    };
+}
+
+struct Result {
+    double fps;
+    double mean_latency_ms;
+    double max_latency_ms;
+};
+
+auto measure(std::vector<Pipeline::StageConfig> stages) -> Result {
+    auto pipeline = Pipeline{std::move(stages)};
+    pipeline.start();
+
+    // Warm up, then one measured window
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    const auto before = pipeline.collect();
+    const auto begin  = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds{600});
+    const auto after   = pipeline.collect();
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    pipeline.stop();
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    return {
+        .fps = static_cast<double>(after.completed - before.completed)
+             / std::chrono::duration<double>(elapsed).count(),
+        .mean_latency_ms = Milliseconds{after.mean_latency}.count(),
+        .max_latency_ms  = Milliseconds{after.max_latency}.count(),
+    };
+}
+
+}  // namespace
+
+TEST(staged_pipeline, BlockingStagesKeepEveryItemInOrder) {
+    constexpr auto kItems = std::uint64_t{5000};
+
+    auto produced = std::uint64_t{0};
+    auto received = std::vector<std::uint64_t>{};
+    auto finished = std::atomic<bool>{false};
+
+    auto stages = std::vector<Pipeline::StageConfig>{};
+    stages.push_back({
+        .name  = "source",
+        .steps = {[&](Item& item) {
+            if (produced == kItems) {
+                return false;
+            }
+            item.sequence = ++produced;
+            item.visited.clear();
+            return true;
+        }},
+    });
+    for (int i = 1; i <= 3; ++i) {
+        stages.push_back({
+            .name     = "stage",
+            .steps    = {[i](Item& item) {
+                item.visited.push_back(i);
+                return true;
+            }},
+            .capacity = 2,
+        });
+    }
+    stages.back().steps.push_back([&](Item& item) {
+        if (item.visited == std::vector<int>{1, 2, 3}) {
+            received.push_back(item.sequence);
+        }
+        if (item.sequence == kItems) {
+            finished.store(true);
+        }
+        return true;
+    });
+
+    auto pipeline = Pipeline{std::move(stages), std::chrono::microseconds{100}};
+    pipeline.start();
+    wait_until(finished);
+    const auto metrics = pipeline.collect();
+    pipeline.stop();
+
+    ASSERT_EQ(received.size(), kItems);
+    for (std::uint64_t i = 0; i < kItems; ++i) {
+        ASSERT_EQ(received[i], i + 1);
+    }
+    EXPECT_EQ(metrics.completed, kItems);
+    for (const auto& stage : metrics.stages) {
+        EXPECT_EQ(stage.dropped, 0U);
+    }
+}
+
+TEST(staged_pipeline, DropPolicyShedsLoadInFrontOfASlowStage) {
+    auto produced = std::atomic<std::uint64_t>{0};
+
+    auto stages = std::vector<Pipeline::StageConfig>{};
+    stages.push_back({
+        .name  = "source",
+        .steps = {[&](Item& item) {
+            item.sequence = ++produced;
+            std::this_thread::sleep_for(std::chrono::microseconds{200});
+            return true;
+        }},
+    });
+    stages.push_back({
+        .name         = "slow",
+        .steps        = {sleeping(std::chrono::microseconds{2000})},
+        .capacity     = 1,
+        .backpressure = Backpressure::DROP,
+    });
+
+    auto pipeline = Pipeline{std::move(stages)};
+    pipeline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+    pipeline.stop();
+    const auto metrics = pipeline.collect();
+
+    const auto& slow = metrics.stages[1];
+    EXPECT_GT(slow.dropped, 0U);
+    EXPECT_GT(slow.processed, 0U);
+    // The source never waited on the slow stage
+    EXPECT_GT(metrics.stages[0].processed, 3 * slow.processed);
+    EXPECT_LE(slow.processed + slow.dropped, metrics.stages[0].processed);
+
+    // Latency stays bounded by the queue, at most one item waits
+    std::cout << "drop in front of a 2ms stage: latency max "
+              << std::chrono::duration<double, std::milli>{metrics.max_latency}.count() << "ms"
+              << std::endl;
+}
+
+TEST(staged_pipeline, StagedAgainstSerial) {
+    const auto costs = Costs{};
+
+    // The serial loop: one thread runs every step of a frame before fetching the next one
+    auto serial = std::vector<Pipeline::StageConfig>{};
+    serial.push_back({
+        .name  = "serial",
+        .steps = {sleeping(costs.capture), sleeping(costs.preprocess), sleeping(costs.infer),
+                  sleeping(costs.track), sleeping(costs.visualize)},
+    });
+
+    auto staged = std::vector<Pipeline::StageConfig>{};
+    staged.push_back({.name = "capture", .steps = {sleeping(costs.capture)}});
+    staged.push_back({.name = "preprocess", .steps = {sleeping(costs.preprocess)}, .capacity = 2});
+    // Frames the detector cannot keep up with are shed in front of it rather than queued
+    staged.push_back({
+        .name         = "infer",
+        .steps        = {sleeping(costs.infer)},
+        .capacity     = 1,
+        .backpressure = Backpressure::DROP,
+    });
+    staged.push_back({.name = "track", .steps = {sleeping(costs.track)}, .capacity = 2});
+    staged.push_back({
+        .name         = "visualize",
+        .steps        = {sleeping(costs.visualize)},
+        .capacity     = 2,
+        .backpressure = Backpressure::DROP,
+    });
+
+    const auto serial_result = measure(std::move(serial));
+    const auto staged_result = measure(std::move(staged));
+
+    // Throughput is bound by the slowest stage instead of the sum of all of them, latency by the
+    // sum plus at most one frame waiting in front of the detector
+    std::cout << "serial: " << serial_result.fps << " fps, latency mean "
+              << serial_result.mean_latency_ms << "ms max " << serial_result.max_latency_ms
+              << "ms\nstaged: " << staged_result.fps << " fps, latency mean "
+              << staged_result.mean_latency_ms << "ms max " << staged_result.max_latency_ms << "ms"
+              << std::endl;
+}
+
+TEST(staged_pipeline, LateItemsTakeTheCheaperPath) {
+    constexpr auto kItems = std::uint64_t{2000};
+
+    auto produced  = std::uint64_t{0};
+    auto expensive = std::atomic<std::uint64_t>{0};
+    auto cheap     = std::atomic<std::uint64_t>{0};
+    auto stale     = std::atomic<std::uint64_t>{0};
+    auto observed  = std::atomic<std::uint64_t>{0};
+    auto finished  = std::atomic<bool>{false};
+
+    auto stages = std::vector<Pipeline::StageConfig>{};
+    stages.push_back({
+        .name  = "source",
+        .steps = {[&](Item& item) {
+            if (produced == kItems) {
+                return false;
+            }
+            item.sequence = ++produced;
+            // Every other item arrives already a second old
+            item.born = std::chrono::steady_clock::now()
+                      - (item.sequence % 2 == 0 ? std::chrono::seconds{1} : std::chrono::seconds{0});
+            return true;
+        }},
+    });
+    stages.push_back({
+        .name     = "infer",
+        .steps    = {[&](Item& item) {
+            stale += item.sequence % 2 == 0 ? 1 : 0;
+            ++expensive;
+            return true;
+        }},
+        .capacity = 4,
+        .budget   = std::chrono::milliseconds{100},
+        .late     = LatePolicy::DEGRADE,
+        .late_steps  = {[&](Item&) {
+            ++cheap;
+            return true;
+        }},
+        .observe_age = [&](std::chrono::steady_clock::duration) { ++observed; },
+    });
+    stages.back().steps.push_back([&](Item& item) {
+        finished.store(item.sequence == kItems);
+        return true;
+    });
+    stages.back().late_steps.push_back([&](Item& item) {
+        finished.store(item.sequence == kItems);
+        return true;
+    });
+
+    auto pipeline = Pipeline{std::move(stages), std::chrono::microseconds{100},
+                             [](const Item& item) { return item.born; }};
+    pipeline.start();
+    wait_until(finished);
+    const auto metrics = pipeline.collect();
+    pipeline.stop();
+
+    const auto& infer = metrics.stages[1];
+    EXPECT_EQ(stale.load(), 0U);
+    EXPECT_EQ(cheap.load(), kItems / 2);
+    EXPECT_EQ(expensive.load(), kItems / 2);
+    EXPECT_EQ(infer.degraded, kItems / 2);
+    EXPECT_EQ(infer.late, 0U);
+    EXPECT_EQ(observed.load(), kItems);
+    // Stale items never came in a run, the limit stayed put
+    EXPECT_EQ(infer.limit, 4U);
+}
+
+TEST(staged_pipeline, QueueLimitShrinksOnARunOfLateItemsAndGrowsBack) {
+    using std::chrono::milliseconds;
+    constexpr auto kBudget = milliseconds{10};
+    constexpr auto kLate   = milliseconds{11};
+    constexpr auto kFresh  = milliseconds{2};
+    constexpr auto kTimely = milliseconds{8};
+
+    auto limit = QueueLimit{8, kBudget};
+    const auto late_run = [&] {
+        for (std::uint32_t i = 0; i < QueueLimit::kShrinkAfter; ++i) {
+            EXPECT_TRUE(limit.observe(kLate));
+        }
+    };
+
+    // Late items among timely ones are noise
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(limit.observe(kLate));
+        EXPECT_FALSE(limit.observe(kFresh));
+    }
+    EXPECT_EQ(limit.value(), 8U);
+
+    late_run();
+    EXPECT_EQ(limit.value(), 4U);
+    late_run();
+    late_run();
+    EXPECT_EQ(limit.value(), 1U);
+    late_run();
+    EXPECT_EQ(limit.value(), 1U);
+
+    // Within budget but not within half of it neither grows nor resets the run
+    for (std::uint32_t i = 0; i + 1 < QueueLimit::kGrowAfter; ++i) {
+        EXPECT_FALSE(limit.observe(kFresh));
+        EXPECT_FALSE(limit.observe(kTimely));
+    }
+    EXPECT_EQ(limit.value(), 1U);
+    EXPECT_FALSE(limit.observe(kFresh));
+    EXPECT_EQ(limit.value(), 2U);
+
+    // A late item restarts the run towards growing
+    for (std::uint32_t i = 0; i + 1 < QueueLimit::kGrowAfter; ++i) {
+        limit.observe(kFresh);
+    }
+    EXPECT_TRUE(limit.observe(kLate));
+    EXPECT_FALSE(limit.observe(kFresh));
+    EXPECT_EQ(limit.value(), 2U);
+
+    // Back up to the capacity and no further
+    for (std::uint32_t i = 0; i < QueueLimit::kGrowAfter * 10; ++i) {
+        limit.observe(kFresh);
+    }
+    EXPECT_EQ(limit.value(), 8U);
+}
+
+TEST(staged_pipeline, BudgetKeepsABlockingQueueFresh) {
+    const auto run = [](std::chrono::milliseconds budget) {
+        auto stages = std::vector<Pipeline::StageConfig>{};
+        stages.push_back({.name = "camera", .steps = {sleeping(std::chrono::microseconds{500})}});
+        // Slower than the camera, a blocking queue in front of it stays full
+        stages.push_back({
+            .name     = "infer",
+            .steps    = {sleeping(std::chrono::microseconds{2000})},
+            .capacity = 8,
+            .budget   = budget,
+            .late     = LatePolicy::DROP,
+        });
+
+        auto pipeline = Pipeline{std::move(stages)};
+        pipeline.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+        pipeline.collect();
+        std::this_thread::sleep_for(std::chrono::milliseconds{400});
+        auto metrics = pipeline.collect();
+        pipeline.stop();
+        return metrics;
+    };
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const auto unbounded = run(std::chrono::milliseconds{0});
+    const auto bounded   = run(std::chrono::milliseconds{6});
+
+    // With a budget the backlog of eight frames, 16ms, is gone and the queue settles at what is
+    // served in time
+    std::cout << "no budget: latency mean " << Milliseconds{unbounded.mean_latency}.count()
+              << "ms, queue limit " << unbounded.stages[1].limit << "\n6ms budget: latency mean "
+              << Milliseconds{bounded.mean_latency}.count() << "ms, queue limit "
+              << bounded.stages[1].limit << ", " << bounded.stages[1].late << " late"
+              << std::endl;
+
+    EXPECT_EQ(unbounded.stages[1].late, 0U);
+    EXPECT_EQ(unbounded.stages[1].limit, 8U);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <eigen3/Eigen/Cholesky>
+#include <eigen3/Eigen/Geometry>
+
+#include "module/geometry/camera_model.hpp"
+#include "module/geometry/stereo.hpp"
+
+using pingpong_tracker::geometry::CameraModel;
+using pingpong_tracker::geometry::StereoTriangulator;
+using Vec2 = CameraModel::Vec2;
+using Vec3 = CameraModel::Vec3;
+
+namespace {
+
+auto look_at(Vec3 const& eye, Vec3 const& target) -> CameraModel::Pose {
+    const Vec3 forward = (target - eye).normalized();
+    const Vec3 right   = forward.cross(Vec3::UnitZ()).normalized();
+    const Vec3 down    = forward.cross(right);
+
+    auto pose = CameraModel::Pose{};
+    pose.rotation.row(0) = right;
+    pose.rotation.row(1) = down;
+    pose.rotation.row(2) = forward;
+    pose.translation     = -pose.rotation * eye;
+    return pose;
+}
+
+auto make_intrinsics() -> CameraModel::Intrinsics {
+    return CameraModel::Intrinsics{
+        .fx         = 1400.0,
+        .fy         = 1400.0,
+        .cx         = 720.0,
+        .cy         = 540.0,
+        .distortion = {-0.12, 0.05, 0.001, -0.0005, 0.0},
+    };
+}
+
+// Two cameras behind one side of the table, looking at its centre
+auto make_rig() -> StereoTriangulator {
+    const auto target = Vec3{0.0, 0.0, 0.2};
+    const auto left   = CameraModel{make_intrinsics(), look_at({-1.5, -2.0, 1.2}, target)};
+    const auto right  = CameraModel{make_intrinsics(), look_at({1.5, -2.0, 1.2}, target)};
+
+    auto config        = StereoTriangulator::Config{};
+    config.pixel_noise = 0.5;
+    return StereoTriangulator{left, right, config};
+}
+
+auto random_ball(std::mt19937& random) -> Vec3 {
+    auto x = std::uniform_real_distribution<double>{-1.37, 1.37};
+    auto y = std::uniform_real_distribution<double>{-0.76, 0.76};
+    auto z = std::uniform_real_distribution<double>{0.02, 0.6};
+    return {x(random), y(random), z(random)};
+}
+
+}  // namespace
+
+TEST(stereo, UndistortInvertsDistort) {
+    const auto camera = CameraModel{make_intrinsics(), {}};
+    auto random       = std::mt19937{5};
+    auto uniform      = std::uniform_real_distribution<double>{-0.5, 0.5};
+
+    for (int i = 0; i < 1000; ++i) {
+        const auto normalized = Vec2{uniform(random), uniform(random)};
+        const auto pixel      = camera.distort(normalized);
+        EXPECT_LT((camera.undistort(pixel) - normalized).norm() * 1400.0, 1e-3);
+    }
+}
+
+TEST(stereo, TriangulatesRenderedBalls) {
+    const auto rig = make_rig();
+    auto random    = std::mt19937{11};
+    auto noise     = std::normal_distribution<double>{0.0, 0.5};
+
+    constexpr auto kSamples = 2000;
+    auto error_sum          = 0.0;
+    auto nees_sum           = 0.0;
+    for (int i = 0; i < kSamples; ++i) {
+        const auto truth = random_ball(random);
+        auto left        = *rig.left().project(truth);
+        auto right       = *rig.right().project(truth);
+        left += Vec2{noise(random), noise(random)};
+        right += Vec2{noise(random), noise(random)};
+
+        const auto point = rig.triangulate(left, right);
+        ASSERT_TRUE(point.has_value());
+
+        const Vec3 error = point->position - truth;
+        error_sum += error.norm();
+        nees_sum += error.dot(point->covariance.ldlt().solve(error));
+    }
+
+    // Millimetre level at half a pixel of noise, and a covariance consistent with the error
+    const auto mean_error = error_sum / kSamples;
+    const auto mean_nees  = nees_sum / kSamples;
+    std::cout << "mean error: " << mean_error * 1e3 << " mm, mean NEES: " << mean_nees << "\n";
+    EXPECT_LT(mean_error, 0.005);
+    EXPECT_GT(mean_nees, 2.0);
+    EXPECT_LT(mean_nees, 4.0);
+}
+
+TEST(stereo, MatchesMultipleCandidates) {
+    auto rig    = make_rig();
+    auto random = std::mt19937{23};
+    auto noise  = std::normal_distribution<double>{0.0, 0.5};
+    auto pixel  = std::uniform_real_distribution<double>{0.0, 1080.0};
+
+    auto output = std::vector<StereoTriangulator::Point>{};
+    for (int round = 0; round < 50; ++round) {
+        auto truths = std::vector<Vec3>{};
+        auto left   = std::vector<Vec2>{};
+        auto right  = std::vector<Vec2>{};
+        for (int i = 0; i < 5; ++i) {
+            truths.push_back(random_ball(random));
+            left.push_back(*rig.left().project(truths.back()) + Vec2{noise(random), noise(random)});
+            right.push_back(*rig.right().project(truths.back())
+                            + Vec2{noise(random), noise(random)});
+        }
+
+        // The right view lists balls in another order, with a false positive in each view
+        auto order = std::vector<std::size_t>(5);
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::shuffle(order, random);
+        auto shuffled = std::vector<Vec2>{};
+        for (const auto index : order) {
+            shuffled.push_back(right[index]);
+        }
+        left.push_back({pixel(random), pixel(random)});
+        shuffled.push_back({pixel(random), pixel(random)});
+
+        rig.match(left, shuffled, output);
+
+        auto recovered = 0;
+        for (const auto& point : output) {
+            if (point.left < 5 && point.right < 5 && order[point.right] == point.left) {
+                EXPECT_LT((point.position - truths[point.left]).norm(), 0.02);
+                ++recovered;
+            }
+        }
+        EXPECT_EQ(recovered, 5) << "round " << round;
+        EXPECT_LE(output.size(), 6);
+    }
+}
+
+TEST(stereo, MatchCost) {
+    constexpr auto kIterations = 20000;
+
+    auto rig    = make_rig();
+    auto random = std::mt19937{31};
+
+    auto left  = std::vector<Vec2>{};
+    auto right = std::vector<Vec2>{};
+    for (int i = 0; i < 8; ++i) {
+        const auto truth = random_ball(random);
+        left.push_back(*rig.left().project(truth));
+        right.push_back(*rig.right().project(truth));
+    }
+    std::ranges::reverse(right);
+
+    auto output      = std::vector<StereoTriangulator::Point>{};
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        rig.match(left, right, output);
+    }
+    const auto per_match = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - start)
+                               .count()
+                         / kIterations;
+
+    std::cout << "8x8 stereo match: " << per_match << " us\n";
+    EXPECT_EQ(output.size(), 8);
+}
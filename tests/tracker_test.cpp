@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "module/tracker/ball_tracker.hpp"
+
+using pingpong_tracker::tracker::BallTracker;
+using pingpong_tracker::tracker::TrackState;
+using Clock = pingpong_tracker::util::Clock;
+
+namespace {
+
+using Tracker2D = BallTracker<2>;
+using ZVec      = Tracker2D::ZVec;
+
+auto make_config() -> Tracker2D::Config {
+    auto config                 = Tracker2D::Config{};
+    config.model.gravity        = {0.0, 2000.0};
+    config.model.drag           = 0.0;
+    config.process_noise        = 1e4;
+    config.measurement_noise    = 2.0;
+    config.initial_velocity_std = 2e3;
+    config.gate_threshold       = 9.21;
+    config.max_coast            = 5;
+    return config;
+}
+
+// Ground truth parabola in pixel space
+auto truth_at(double t) -> ZVec {
+    return {100.0 + 800.0 * t, 400.0 - 900.0 * t + 0.5 * 2000.0 * t * t};
+}
+
+auto at_seconds(Clock::time_point origin, double t) -> Clock::time_point {
+    return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+}
+
+}  // namespace
+
+TEST(tracker, FollowsBallisticTrajectory) {
+    auto tracker = Tracker2D{make_config()};
+    auto noise   = std::normal_distribution<double>{0.0, 2.0};
+    auto random  = std::mt19937{42};
+
+    const auto origin = Clock::now();
+    for (int i = 0; i < 120; ++i) {
+        // Irregular frame intervals around 240 fps
+        const auto t = i / 240.0 + ((i % 3 == 0) ? 0.001 : 0.0);
+        auto z       = truth_at(t);
+        z.x() += noise(random);
+        z.y() += noise(random);
+
+        const auto candidates = std::vector<ZVec>{z};
+        tracker.update(at_seconds(origin, t), candidates);
+    }
+
+    const auto& snapshot = tracker.snapshot();
+    ASSERT_EQ(snapshot.state, TrackState::TRACKING);
+
+    const auto t_end = 119 / 240.0;
+    EXPECT_NEAR(snapshot.x[0], truth_at(t_end).x(), 3.0);
+    EXPECT_NEAR(snapshot.x[1], truth_at(t_end).y(), 3.0);
+    EXPECT_NEAR(snapshot.x[2], 800.0, 60.0);
+    EXPECT_NEAR(snapshot.x[3], -900.0 + 2000.0 * t_end, 60.0);
+}
+
+TEST(tracker, GatesOutliersAndCoasts) {
+    auto tracker      = Tracker2D{make_config()};
+    const auto origin = Clock::now();
+
+    for (int i = 0; i < 60; ++i) {
+        const auto t = i / 240.0;
+        tracker.update(at_seconds(origin, t), std::vector<ZVec>{truth_at(t)});
+    }
+
+    // A far away false positive next to the real ball, the real one must win
+    {
+        const auto t          = 60 / 240.0;
+        const auto candidates = std::vector<ZVec>{{900.0, 50.0}, truth_at(t)};
+        EXPECT_EQ(tracker.update(at_seconds(origin, t), candidates), 1);
+    }
+
+    // Only outliers for a few frames: the track coasts on the model
+    for (int i = 61; i < 64; ++i) {
+        const auto t = i / 240.0;
+        EXPECT_EQ(tracker.update(at_seconds(origin, t), std::vector<ZVec>{{900.0, 50.0}}),
+                  Tracker2D::npos);
+        EXPECT_EQ(tracker.snapshot().state, TrackState::COASTING);
+    }
+    EXPECT_NEAR(tracker.snapshot().x[0], truth_at(63 / 240.0).x(), 3.0);
+    EXPECT_NEAR(tracker.snapshot().x[1], truth_at(63 / 240.0).y(), 3.0);
+
+    // The real ball re-appears inside the gate
+    {
+        const auto t = 64 / 240.0;
+        EXPECT_EQ(tracker.update(at_seconds(origin, t), std::vector<ZVec>{truth_at(t)}), 0);
+        EXPECT_EQ(tracker.snapshot().state, TrackState::TRACKING);
+    }
+
+    // Too many misses: lost
+    for (int i = 65; i < 72; ++i) {
+        tracker.update(at_seconds(origin, i / 240.0), std::vector<ZVec>{});
+    }
+    EXPECT_EQ(tracker.snapshot().state, TrackState::LOST);
+}
+
+TEST(tracker, IgnoresStaleFrames) {
+    auto tracker      = Tracker2D{make_config()};
+    const auto origin = Clock::now();
+
+    tracker.update(at_seconds(origin, 0.1), std::vector<ZVec>{truth_at(0.1)});
+    const auto before = tracker.snapshot().x;
+
+    EXPECT_EQ(tracker.update(at_seconds(origin, 0.05), std::vector<ZVec>{truth_at(0.05)}),
+              Tracker2D::npos);
+    EXPECT_EQ(tracker.snapshot().x, before);
+}
+
+TEST(tracker, UpdateCost) {
+    constexpr auto kIterations = 100000;
+
+    auto tracker      = Tracker2D{make_config()};
+    const auto origin = Clock::now();
+
+    auto frames = std::vector<std::vector<ZVec>>{};
+    frames.reserve(kIterations);
+    for (int i = 0; i < kIterations; ++i) {
+        const auto t = (i % 240) / 240.0;
+        frames.push_back({truth_at(t), {900.0, 50.0}, {10.0, 10.0}});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        tracker.update(at_seconds(origin, i / 240.0), frames[static_cast<std::size_t>(i)]);
+    }
+    const auto per_update = std::chrono::duration<double, std::micro>(
+                                std::chrono::steady_clock::now() - start)
+                                .count()
+                          / kIterations;
+
+    std::cout << "tracker update with 3 candidates: " << per_update << " us\n";
+}
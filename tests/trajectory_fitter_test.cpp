@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <eigen3/Eigen/QR>
+
+#include "module/tracker/trajectory_fitter.hpp"
+
+using pingpong_tracker::tracker::TrajectoryFitter;
+using Clock = pingpong_tracker::util::Clock;
+
+namespace {
+
+using Fitter2D = TrajectoryFitter<2>;
+using Fitter3D = TrajectoryFitter<3>;
+
+constexpr double kRate = 240.0;
+
+auto at_seconds(Clock::time_point origin, double t) -> Clock::time_point {
+    return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+}
+
+}  // namespace
+
+TEST(trajectory_fitter, ExactOnParabola) {
+    const auto origin = Clock::now();
+    auto fitter       = Fitter3D{};
+
+    auto truth = [](double t) -> Fitter3D::Vec {
+        return {1.0 + 3.0 * t, -0.5 + 0.2 * t, 0.3 + 2.0 * t - 4.905 * t * t};
+    };
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(fitter.add(at_seconds(origin, i / kRate), truth(i / kRate)),
+                  Fitter3D::Result::APPENDED);
+    }
+    EXPECT_EQ(fitter.size(), 16U);
+
+    const auto t     = 110 / kRate;
+    const auto state = fitter.predict(at_seconds(origin, t));
+    ASSERT_TRUE(state.has_value());
+    EXPECT_LT((state->position - truth(t)).norm(), 1e-6);
+    EXPECT_LT((state->velocity - Fitter3D::Vec{3.0, 0.2, 2.0 - 9.81 * t}).norm(), 1e-5);
+}
+
+TEST(trajectory_fitter, RunningSumsMatchBatchFit) {
+    const auto origin = Clock::now();
+    auto random       = std::mt19937{17};
+    auto step         = std::normal_distribution<double>{0.0, 3.0};
+
+    auto config   = Fitter2D::Config{};
+    config.window = 24;
+    // Random walk, the break test must never fire
+    config.break_threshold = 1e9;
+    auto fitter            = Fitter2D{config};
+
+    auto times     = std::vector<double>{};
+    auto positions = std::vector<Fitter2D::Vec>{};
+    auto position  = Fitter2D::Vec{500.0, 300.0};
+    for (int i = 0; i < 100'000; ++i) {
+        position += Fitter2D::Vec{step(random), step(random)};
+        times.push_back(i / kRate);
+        positions.push_back(position);
+        fitter.add(at_seconds(origin, times.back()), position);
+    }
+
+    // Batch least squares over the same window, time relative to the last sample
+    Eigen::Matrix<double, 24, 3> A;
+    Eigen::Matrix<double, 24, 2> B;
+    for (int i = 0; i < 24; ++i) {
+        const auto index = times.size() - 24 + static_cast<std::size_t>(i);
+        const auto t     = times[index] - times.back();
+        A.row(i) << 1.0, t, t * t;
+        B.row(i) = positions[index].transpose();
+    }
+    const Eigen::Matrix<double, 3, 2> expected = A.colPivHouseholderQr().solve(B);
+
+    const auto state = fitter.predict(at_seconds(origin, times.back()));
+    ASSERT_TRUE(state.has_value());
+    EXPECT_LT((state->position - expected.row(0).transpose()).norm(), 1e-6);
+    EXPECT_LT((state->velocity - expected.row(1).transpose()).norm(), 1e-4);
+}
+
+TEST(trajectory_fitter, RestartsOnBounceAndIgnoresOutliers) {
+    const auto origin = Clock::now();
+    auto random       = std::mt19937{23};
+    auto noise        = std::normal_distribution<double>{0.0, 1.0};
+
+    auto fitter   = Fitter2D{};
+    auto position = Fitter2D::Vec{100.0, 500.0};
+    auto velocity = Fitter2D::Vec{600.0, 0.0};
+
+    auto bounce_frame  = -1;
+    auto restart_frame = -1;
+    auto suspects      = 0;
+    for (int i = 0; i < 200; ++i) {
+        Fitter2D::Vec z = position + Fitter2D::Vec{noise(random), noise(random)};
+        if (i == 40) {
+            // A single false detection
+            z += Fitter2D::Vec{30.0, -30.0};
+        }
+
+        const auto result = fitter.add(at_seconds(origin, i / kRate), z);
+        if (result == Fitter2D::Result::SUSPECT) {
+            ++suspects;
+        }
+        if (result == Fitter2D::Result::RESTARTED) {
+            EXPECT_EQ(restart_frame, -1) << "second restart at frame " << i;
+            restart_frame = i;
+        }
+
+        velocity.y() += 2000.0 / kRate;
+        position += velocity / kRate;
+        if (position.y() > 700.0 && bounce_frame < 0) {
+            position.y() = 1400.0 - position.y();
+            velocity.y() = -0.85 * velocity.y();
+            bounce_frame = i + 1;
+        }
+    }
+
+    ASSERT_GT(bounce_frame, 0);
+    // The outlier and the first frame after the bounce
+    EXPECT_EQ(suspects, 2);
+    EXPECT_GE(restart_frame, bounce_frame);
+    EXPECT_LE(restart_frame, bounce_frame + 3);
+
+    // The new segment follows the rising ball
+    const auto state = fitter.predict(at_seconds(origin, 199 / kRate));
+    ASSERT_TRUE(state.has_value());
+    EXPECT_LT((state->position - position).norm(), 5.0);
+    EXPECT_GT(fitter.segment_start(), at_seconds(origin, bounce_frame / kRate - 1e-4));
+}
+
+TEST(trajectory_fitter, CostPerSample) {
+    const auto origin = Clock::now();
+    auto random       = std::mt19937{29};
+    auto noise        = std::normal_distribution<double>{0.0, 1.0};
+
+    constexpr int kSamples = 200'000;
+    auto samples           = std::vector<Fitter3D::Vec>(kSamples);
+    auto stamps            = std::vector<Clock::time_point>(kSamples);
+    for (int i = 0; i < kSamples; ++i) {
+        const auto t = (i % 240) / kRate;
+        samples[i]   = {t, 0.5 * t, 1.0 - 4.9 * t * t};
+        samples[i] += 1e-3 * Fitter3D::Vec{noise(random), noise(random), noise(random)};
+        stamps[i] = at_seconds(origin, i / kRate);
+    }
+
+    auto fitter      = Fitter3D{};
+    auto begin       = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSamples; ++i) {
+        fitter.add(stamps[i], samples[i]);
+    }
+    const auto add = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()
+                                                              - begin)
+                         .count()
+                   / kSamples;
+
+    auto sink = 0.0;
+    begin     = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSamples; ++i) {
+        sink += fitter.predict(stamps[i])->position.z();
+    }
+    const auto query = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()
+                                                                - begin)
+                           .count()
+                     / kSamples;
+
+    std::cout << "per sample: add " << add << "ns, predict " << query << "ns (" << sink << ")"
+              << std::endl;
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "module/tracker/trajectory_predictor.hpp"
+
+using pingpong_tracker::tracker::TrajectoryPredictor;
+using Clock = pingpong_tracker::util::Clock;
+using Vec3  = TrajectoryPredictor::Vec3;
+using State = TrajectoryPredictor::State;
+
+namespace {
+
+auto at_seconds(Clock::time_point origin, double t) -> Clock::time_point {
+    return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+}
+
+auto seconds_between(Clock::time_point from, Clock::time_point to) -> double {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+// Fills the whole horizon by repeating the anchor state, which always agrees with itself
+auto fill(TrajectoryPredictor& predictor, Clock::time_point origin, State const& state) -> void {
+    predictor.update(origin, state);
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_FALSE(predictor.update(origin, state));
+    }
+}
+
+}  // namespace
+
+TEST(trajectory_predictor, LandingMatchesClosedFormWithoutDrag) {
+    auto config       = TrajectoryPredictor::Config{};
+    config.model.drag = 0.0;
+    auto predictor    = TrajectoryPredictor{config};
+
+    const auto origin = Clock::now();
+    const auto start  = State{{-1.0, 0.1, 0.3}, {4.0, 0.0, 1.0}};
+
+    // The first update only integrates max_steps_per_update steps, the bounce is further away
+    predictor.update(origin, start);
+    EXPECT_FALSE(predictor.landing().has_value());
+
+    fill(predictor, origin, start);
+    const auto landing = predictor.landing();
+    ASSERT_TRUE(landing.has_value());
+
+    // z(t) = z0 + vz t - g t^2 / 2 reaches the ball radius
+    const auto g = 9.81;
+    const auto c = 0.3 - config.ball_radius;
+    const auto t = (1.0 + std::sqrt(1.0 + 2.0 * g * c)) / g;
+
+    EXPECT_NEAR(seconds_between(origin, landing->timestamp), t, 1e-6);
+    EXPECT_NEAR(landing->position.x(), -1.0 + 4.0 * t, 1e-5);
+    EXPECT_NEAR(landing->position.y(), 0.1, 1e-9);
+    EXPECT_NEAR(landing->velocity_in.z(), 1.0 - g * t, 1e-5);
+
+    EXPECT_NEAR(landing->velocity_out.z(), -config.restitution * landing->velocity_in.z(), 1e-9);
+    EXPECT_NEAR(landing->velocity_out.x(), (1.0 - config.friction) * 4.0, 1e-9);
+
+    // After the bounce the flight continues from the reflected velocity
+    const auto after = predictor.predict(landing->timestamp + std::chrono::milliseconds{50});
+    ASSERT_TRUE(after.has_value());
+    const auto dt = 0.05;
+    EXPECT_NEAR(after->position.x(), landing->position.x() + landing->velocity_out.x() * dt, 1e-5);
+    EXPECT_NEAR(after->position.z(),
+                config.ball_radius + landing->velocity_out.z() * dt - 0.5 * g * dt * dt, 1e-5);
+}
+
+TEST(trajectory_predictor, MatchesFineReferenceWithDrag) {
+    auto config    = TrajectoryPredictor::Config{};
+    auto predictor = TrajectoryPredictor{config};
+
+    const auto origin = Clock::now();
+    const auto start  = State{{-1.2, 0.0, 0.5}, {6.0, 0.5, 1.5}};
+    fill(predictor, origin, start);
+    const auto landing = predictor.landing();
+    ASSERT_TRUE(landing.has_value());
+    const auto t_land = seconds_between(origin, landing->timestamp);
+
+    // Explicit Euler with a tiny step as an independent reference
+    auto reference = start;
+    auto t         = 0.0;
+    const auto h   = 1e-6;
+    for (const auto query : {0.0123, 0.05, 0.1001, 0.2, t_land - 0.001}) {
+        while (t + h <= query) {
+            const Vec3 a = config.model.acceleration(reference.velocity);
+            reference.position += reference.velocity * h + 0.5 * a * h * h;
+            reference.velocity += a * h;
+            t += h;
+        }
+        const auto predicted = predictor.predict(at_seconds(origin, t));
+        ASSERT_TRUE(predicted.has_value());
+        EXPECT_LT((predicted->position - reference.position).norm(), 2e-5) << "t = " << t;
+        EXPECT_LT((predicted->velocity - reference.velocity).norm(), 2e-4) << "t = " << t;
+    }
+}
+
+TEST(trajectory_predictor, KeepsTrajectoryWhileStatesAgree) {
+    auto predictor    = TrajectoryPredictor{TrajectoryPredictor::Config{}};
+    const auto origin = Clock::now();
+    const auto start  = State{{-1.2, 0.0, 0.5}, {6.0, 0.0, 1.0}};
+    ASSERT_TRUE(predictor.update(origin, start));
+
+    auto random = std::mt19937{1};
+    auto noise  = std::normal_distribution<double>{0.0, 0.001};
+
+    for (int i = 1; i < 40; ++i) {
+        const auto timestamp = at_seconds(origin, i / 240.0);
+        auto state           = *predictor.predict(timestamp);
+        state.position += Vec3{noise(random), noise(random), noise(random)};
+        EXPECT_FALSE(predictor.update(timestamp, state)) << "frame " << i;
+
+        // The consumed head is gone, the present is still answered
+        EXPECT_FALSE(predictor.predict(at_seconds(origin, (i - 1) / 240.0)).has_value());
+        EXPECT_TRUE(predictor.predict(timestamp).has_value());
+    }
+
+    // A hit changes the velocity, the trajectory re-anchors
+    const auto timestamp = at_seconds(origin, 40 / 240.0);
+    auto state           = *predictor.predict(timestamp);
+    state.velocity.x()   = -state.velocity.x();
+    EXPECT_TRUE(predictor.update(timestamp, state));
+
+    // Stale states never re-anchor
+    EXPECT_FALSE(predictor.update(at_seconds(origin, 39 / 240.0), start));
+}
+
+TEST(trajectory_predictor, NoBounceOffTheTable) {
+    auto predictor    = TrajectoryPredictor{TrajectoryPredictor::Config{}};
+    const auto origin = Clock::now();
+
+    // Long ball past the end line
+    fill(predictor, origin, State{{1.0, 0.0, 0.3}, {5.0, 0.0, 0.5}});
+    EXPECT_FALSE(predictor.landing().has_value());
+
+    // Integration stops below the floor, well before the horizon
+    const auto end = predictor.horizon_end();
+    ASSERT_TRUE(end.has_value());
+    EXPECT_LT(seconds_between(origin, *end), predictor.config().horizon);
+    EXPECT_FALSE(predictor.predict(*end + std::chrono::milliseconds{10}).has_value());
+}
+
+TEST(trajectory_predictor, WorstCaseCost) {
+    constexpr auto kIterations = 20000;
+
+    auto predictor    = TrajectoryPredictor{TrajectoryPredictor::Config{}};
+    const auto origin = Clock::now();
+    const auto budget = predictor.config().max_steps_per_update;
+
+    // Alternating states force a re-anchor and a full integration budget every call
+    const auto a = State{{-1.2, 0.0, 0.3}, {6.0, 0.0, 1.0}};
+    const auto b = State{{1.2, 0.0, 0.3}, {-6.0, 0.0, 1.0}};
+
+    auto worst_steps = std::uint64_t{0};
+    auto worst       = 0.0;
+    auto total       = 0.0;
+    for (int i = 0; i < kIterations; ++i) {
+        const auto steps = predictor.integrated_steps();
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_TRUE(predictor.update(at_seconds(origin, i / 240.0), (i % 2) == 0 ? a : b));
+        const auto cost = std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+        worst_steps = std::max(worst_steps, predictor.integrated_steps() - steps);
+        worst       = std::max(worst, cost);
+        total += cost;
+    }
+    const auto average = total / kIterations;
+
+    // The horizon is longer than one budget, so every re-anchor runs exactly up to the bound
+    EXPECT_EQ(worst_steps, budget);
+    EXPECT_EQ(predictor.integrated_steps(), kIterations * budget);
+
+    auto sink          = 0.0;
+    const auto queries = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        const auto t = at_seconds(origin, (kIterations - 1) / 240.0 + (i % 100) * 0.002);
+        if (const auto state = predictor.predict(t)) {
+            sink += state->position.z();
+        }
+    }
+    const auto per_query = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - queries)
+                               .count()
+                         / kIterations;
+
+    std::cout << "re-anchoring update of " << budget << " steps: " << average << " us average, "
+              << worst << " us worst, predict: " << per_query << " us (" << sink << ")\n";
+}
+
+TEST(trajectory_predictor, HorizonFillsWithinTheStepBudget) {
+    auto config                 = TrajectoryPredictor::Config{};
+    config.max_steps_per_update = 32;
+    auto predictor              = TrajectoryPredictor{config};
+    const auto origin           = Clock::now();
+
+    // Slow lob that stays above the table for the whole horizon
+    const auto start = State{{-1.0, 0.0, 1.0}, {0.5, 0.0, 3.0}};
+    predictor.update(origin, start);
+    EXPECT_EQ(predictor.integrated_steps(), config.max_steps_per_update);
+
+    // Consistent updates at the same instant only extend the tail, one budget at a time
+    auto previous = predictor.integrated_steps();
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_FALSE(predictor.update(origin, start));
+        const auto steps = predictor.integrated_steps() - previous;
+        EXPECT_LE(steps, config.max_steps_per_update);
+        previous = predictor.integrated_steps();
+    }
+
+    const auto end = predictor.horizon_end();
+    ASSERT_TRUE(end.has_value());
+    EXPECT_GT(seconds_between(origin, *end), 0.5);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <random>
+
+#include "kernel/visualization.hpp"
+#include "module/debug/visualization/stream_session.hpp"
+
+using namespace pingpong_tracker;
+
+namespace {
+
+constexpr auto kInputPeriod = std::chrono::nanoseconds{8'333'333};
+constexpr auto kJitter      = std::chrono::microseconds{500};
+constexpr auto kSeconds     = 10;
+
+auto period_of(int framerate) -> util::Clock::duration {
+    return std::chrono::duration_cast<util::Clock::duration>(
+        std::chrono::duration<double>{1.0 / framerate});
+}
+
+// Frames sent out of `frames` arriving at 120 Hz, each up to half a millisecond off
+auto sent_at_120hz(int framerate, std::int64_t frames) -> std::int64_t {
+    const auto origin = util::Clock::time_point{std::chrono::seconds{100}};
+    const auto period = period_of(framerate);
+
+    auto random = std::mt19937{7};
+    auto jitter = std::uniform_int_distribution<std::int64_t>{-kJitter.count(), kJitter.count()};
+
+    auto due  = util::Clock::time_point{};
+    auto sent = std::int64_t{0};
+    for (std::int64_t i = 0; i < frames; ++i) {
+        const auto now = origin + kInputPeriod * i + std::chrono::microseconds{jitter(random)};
+        if (const auto next = kernel::Visualization::pace(now, due, period)) {
+            due = *next;
+            ++sent;
+        }
+    }
+    return sent;
+}
+
+auto format(int quality, int bitrate) -> debug::VideoFormat {
+    return {.w = 640, .h = 480, .hz = 30, .quality = quality, .bitrate = bitrate};
+}
+
+}  // namespace
+
+TEST(visualization, PacingHoldsTheCapAgainstFasterInput) {
+    const auto frames = std::int64_t{120} * kSeconds;
+    for (const auto framerate : {30, 60, 100}) {
+        EXPECT_NEAR(sent_at_120hz(framerate, frames), framerate * kSeconds, 1)
+            << framerate << " fps";
+    }
+    // Not capped at all once the cap is above the input rate
+    EXPECT_EQ(sent_at_120hz(240, frames), frames);
+}
+
+TEST(visualization, PacingRestartsAfterAPause) {
+    const auto period = period_of(30);
+    const auto origin = util::Clock::time_point{std::chrono::seconds{100}};
+
+    auto due = kernel::Visualization::pace(origin, {}, period);
+    ASSERT_TRUE(due);
+    EXPECT_EQ(*due, origin + period);
+
+    // Early by more than a quarter period, then early by less
+    EXPECT_FALSE(kernel::Visualization::pace(*due - period / 2, *due, period));
+    const auto early = kernel::Visualization::pace(*due - period / 8, *due, period);
+    ASSERT_TRUE(early);
+    EXPECT_EQ(*early, *due + period);
+
+    // A second later the schedule starts over instead of sending the missed frames in a burst
+    const auto resumed = *early + std::chrono::seconds{1};
+    due                = kernel::Visualization::pace(resumed, *early, period);
+    ASSERT_TRUE(due);
+    EXPECT_EQ(*due, resumed + period);
+    EXPECT_FALSE(kernel::Visualization::pace(resumed + kInputPeriod, *due, period));
+}
+
+TEST(visualization, AdaptationStepsWithinBounds) {
+    const auto adaptation = debug::StreamSession::Adaptation{
+        .enable = true, .min_quality = 30, .min_bitrate = 200};
+    const auto configured = format(80, 600);
+
+    auto current = adaptation.step(configured, configured, 0.9);
+    EXPECT_EQ(current.quality, 70);
+    EXPECT_EQ(current.bitrate, 450);
+    EXPECT_EQ(current.w, configured.w);
+    EXPECT_EQ(current.hz, configured.hz);
+
+    for (int i = 0; i < 10; ++i) {
+        current = adaptation.step(current, configured, 0.9);
+    }
+    EXPECT_EQ(current.quality, 30);
+    EXPECT_EQ(current.bitrate, 200);
+
+    // Nothing changes between the thresholds
+    const auto held = adaptation.step(current, configured, 0.6);
+    EXPECT_EQ(held.quality, 30);
+    EXPECT_EQ(held.bitrate, 200);
+
+    current = adaptation.step(current, configured, 0.2);
+    EXPECT_EQ(current.quality, 35);
+    EXPECT_EQ(current.bitrate, 250);
+
+    for (int i = 0; i < 20; ++i) {
+        current = adaptation.step(current, configured, 0.2);
+    }
+    EXPECT_EQ(current.quality, 80);
+    EXPECT_EQ(current.bitrate, 600);
+}
+
+TEST(visualization, AdaptationLoadIsSmoothedOverFrames) {
+    using Adaptation = debug::StreamSession::Adaptation;
+    // Three quarters of a 60 Hz frame
+    const auto encoding = std::chrono::microseconds{12'500};
+
+    auto load = Adaptation::smooth(0.0, encoding, 60);
+    EXPECT_NEAR(load, Adaptation::kSmoothing * 0.75, 1e-9);
+
+    // A single frame taking three periods is not enough to step down
+    EXPECT_LT(Adaptation::smooth(0.0, encoding * 4, 60), Adaptation::kBehind);
+    for (int i = 0; i < 100; ++i) {
+        load = Adaptation::smooth(load, encoding, 60);
+    }
+    EXPECT_NEAR(load, 0.75, 1e-3);
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "utility/thread/workers.hpp"
+
+using pingpong_tracker::WorkersContext;
+
+namespace {
+
+auto make_pool(std::size_t threads) -> WorkersContext {
+    auto config    = WorkersContext::Config{};
+    config.threads = threads;
+    return WorkersContext{config};
+}
+
+auto fibonacci(WorkersContext& workers, int n) -> std::uint64_t {
+    if (n < 12) {
+        auto a = std::uint64_t{0};
+        auto b = std::uint64_t{1};
+        for (int i = 0; i < n; ++i) {
+            a = std::exchange(b, a + b);
+        }
+        return a;
+    }
+    auto left  = std::uint64_t{0};
+    auto group = WorkersContext::TaskGroup{workers};
+    group.run([&]() noexcept { left = fibonacci(workers, n - 1); });
+    const auto right = fibonacci(workers, n - 2);
+    group.wait();
+    return left + right;
+}
+
+// A few microseconds of arithmetic per element, stands in for a decoded tile or a row of pixels
+auto busy_work(std::size_t index) -> double {
+    auto value = static_cast<double>(index);
+    for (int i = 0; i < 50; ++i) {
+        value = std::sqrt(value + static_cast<double>(i));
+    }
+    return value;
+}
+
+}  // namespace
+
+TEST(workers, EnqueueReturnsFutures) {
+    auto workers = make_pool(4);
+
+    auto futures = std::vector<std::future<int>>{};
+    for (int i = 0; i < 1000; ++i) {
+        futures.push_back(workers.enqueue([](int value) noexcept { return value * 2; }, i));
+    }
+    auto sum = 0;
+    for (auto& future : futures) {
+        sum += future.get();
+    }
+    EXPECT_EQ(sum, 999 * 1000);
+}
+
+TEST(workers, EnqueueAcceptsMoveOnlyArguments) {
+    auto workers = make_pool(2);
+
+    auto value  = std::make_unique<int>(21);
+    auto future = workers.enqueue(
+        [](std::unique_ptr<int> owned) noexcept { return owned; }, std::move(value));
+    const auto result = future.get();
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(*result, 21);
+
+    // A move-only callable is invoked as an rvalue too
+    auto callable = [owned = std::make_unique<int>(4)](int factor) mutable noexcept {
+        return *owned * factor;
+    };
+    EXPECT_EQ(workers.enqueue(std::move(callable), 3).get(), 12);
+}
+
+TEST(workers, ParallelForCoversEveryIndexOnce) {
+    auto workers = make_pool(4);
+
+    constexpr auto kCount = std::size_t{100'003};
+    auto visits           = std::vector<std::atomic<int>>(kCount);
+    workers.parallel_for(0, kCount, 97, [&](std::size_t first, std::size_t last) noexcept {
+        for (auto i = first; i < last; ++i) {
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    EXPECT_TRUE(std::ranges::all_of(visits, [](const auto& visit) { return visit.load() == 1; }));
+
+    auto calls = std::atomic<std::size_t>{0};
+    workers.fork_join(37, [&](std::size_t) noexcept { calls.fetch_add(1); });
+    EXPECT_EQ(calls.load(), 37U);
+}
+
+TEST(workers, NestedForkJoin) {
+    auto workers = make_pool(4);
+    EXPECT_EQ(fibonacci(workers, 27), 196418U);
+}
+
+TEST(workers, StressFromManySubmitters) {
+    auto workers = make_pool(4);
+
+    constexpr auto kSubmitters = 4;
+    constexpr auto kRounds     = 200;
+    auto executed              = std::atomic<std::uint64_t>{0};
+
+    auto submitters = std::vector<std::jthread>{};
+    for (int s = 0; s < kSubmitters; ++s) {
+        submitters.emplace_back([&] {
+            for (int round = 0; round < kRounds; ++round) {
+                // Nested groups spawned from workers, plain spawns and futures from outside
+                workers.parallel_for(0, 64, 4, [&](std::size_t first, std::size_t last) noexcept {
+                    auto group = WorkersContext::TaskGroup{workers};
+                    for (auto i = first; i < last; ++i) {
+                        group.run([&]() noexcept { executed.fetch_add(1); });
+                    }
+                });
+                auto future = workers.enqueue([&]() noexcept { executed.fetch_add(1); });
+                future.wait();
+            }
+        });
+    }
+    submitters.clear();
+
+    EXPECT_EQ(executed.load(), std::uint64_t{kSubmitters} * kRounds * (64 + 1));
+}
+
+TEST(workers, Scaling) {
+    constexpr auto kCount = std::size_t{200'000};
+    auto output           = std::vector<double>(kCount);
+
+    const auto run = [&](auto&& loop) {
+        auto best = std::chrono::nanoseconds::max();
+        for (int round = 0; round < 5; ++round) {
+            const auto begin = std::chrono::steady_clock::now();
+            loop();
+            best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - begin));
+        }
+        return best;
+    };
+
+    const auto serial = run([&] {
+        for (std::size_t i = 0; i < kCount; ++i) {
+            output[i] = busy_work(i);
+        }
+    });
+    const auto expected = output;
+
+    const auto cores = std::max(1U, std::thread::hardware_concurrency());
+    std::cout << "serial: " << serial.count() / 1000 << "us" << std::endl;
+    for (std::size_t threads = 1; threads <= cores; threads *= 2) {
+        auto workers     = make_pool(threads);
+        const auto taken = run([&] {
+            std::ranges::fill(output, 0.0);
+            workers.parallel_for(0, kCount, 256, [&](std::size_t first, std::size_t last) noexcept {
+                for (auto i = first; i < last; ++i) {
+                    output[i] = busy_work(i);
+                }
+            });
+        });
+        ASSERT_EQ(output, expected);
+
+        std::cout << threads << " workers + caller: " << taken.count() / 1000 << "us, speedup "
+                  << static_cast<double>(serial.count()) / static_cast<double>(taken.count())
+                  << std::endl;
+    }
+
+    // Submission overhead, one empty task at a time through the shared queue and back
+    auto workers     = make_pool(1);
+    constexpr auto kTasks = 20'000;
+    auto done        = std::atomic<int>{0};
+    const auto begin = std::chrono::steady_clock::now();
+    {
+        auto group = WorkersContext::TaskGroup{workers};
+        for (int i = 0; i < kTasks; ++i) {
+            group.run([&]() noexcept { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+    }
+    const auto per_task = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - begin)
+                        / kTasks;
+    std::cout << "spawn + run: " << per_task.count() << "ns per task" << std::endl;
+    EXPECT_EQ(done.load(), kTasks);
+}